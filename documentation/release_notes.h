@@ -23,6 +23,8 @@ Release 6.0.0 (UNRELEASED)
    epics::pvAccess::ServerContext() looks up names with the servers() singleton.
  - Removed deprecated epics::pvAccess::Properties
  - The data members of epics::pvAccess::MonitorElement become const, preventing these pointers from being re-targeted.
+ - epics::pvAccess::Monitor::Stats gains the window and rtt members (ABI change).
+   Code implementing or calling epics::pvAccess::Monitor::getStats() must be recompiled.
 - Simplifications
  - use of the epics::pvAccess::ChannelRequester interface is optional
    and may be omitted when calling createChannel().
@@ -57,6 +59,67 @@ Release 6.0.0 (UNRELEASED)
  - epics::pvAccess::RPCServer allows epics::pvAccess::Configuration to be specified and access to ServerContext.
  - Added epics::pvAccess::Configuration::keys() to iterate configuration parameters (excluding environment variables).
  - Added epics::pvAccess::Destoryable::cleaner
+ - Client context may persist channel name to server mappings in the file named by $EPICS_PVA_NAME_CACHE.
+   Cached servers are tried with a direct connect before falling back to search.
+ - Servers may advertise hosted channel names in beacons as a Bloom filter, enabled by setting
+   $EPICS_PVAS_BEACON_FILTER_FPP to the target false-positive rate.  Clients send the first
+   search for a channel only to servers whose filter matches, and to servers without a filter.
+   A server with a provider which can not list all its channels (e.g. ca, wildcard RPC services)
+   advertises no filter.
+ - Client reaction to a (re)started server is spread by a random delay of up to $EPICS_PVA_RECONNECT_SPREAD
+   seconds (default 1), and $EPICS_PVA_MAX_CONNECT_RATE limits channel connects per second to each server.
+ - Server may limit the number of channel names searched per second by a single client address
+   with $EPICS_PVAS_SEARCH_RATE (and $EPICS_PVAS_SEARCH_BURST).  Dropped names are counted, see printInfo().
+ - Added epics::pvAccess::ChannelProvider::createChannels() to create many channels at once.
+   Server accepts CMD_CREATE_CHANNEL requests carrying many channels, and the client sends create requests
+   to the same server together.  Set $EPICS_PVA_BULK_CREATE_CHANNEL=YES to pack them into one message
+   (only with servers from this release).
+ - Client CIDs and IOIDs, and server SIDs, are kept in generation-tagged slab tables instead of maps.
+   Lookup no longer walks a tree, and a stale ID is not mistaken for the next user of its slot.
+ - Per-transport heartbeats, channel (re)connect retries and server search reply delays are scheduled
+   on a hierarchical timing wheel (O(1) schedule and cancel) instead of the shared epics::pvData::Timer.
+ - Client transport liveness is checked by one periodic sweep per context.  Any received data counts
+   as a sign of life, echo requests are sent only on idle connections.
+ - Client detects a server which stopped responding (e.g. a frozen IOC) and disconnects its channels,
+   which then search again, e.g. for a standby server.  An echo is sent after $EPICS_PVA_HEARTBEAT_PERIOD
+   seconds without traffic, and the connection is given up after $EPICS_PVA_LIVENESS_TMO
+   (default 2 x heartbeat period).  Defaults follow $EPICS_PVA_CONN_TMO as before.
+ - Server may call providers from a pool of $EPICS_PVAS_WORKER_THREADS threads instead of the receive
+   thread of each connection.  Get, put, putGet, process and RPC operations of a channel keep their order,
+   at most $EPICS_PVAS_WORKER_QUEUE (default 1024) operations are queued.  Queue depth and latency are
+   shown by printInfo().
+ - epics::pvAccess::RPCServer::registerService() accepts an ExecutionPolicy to call a service from its own
+   worker threads, with a limit of requests in flight and of queued requests (further ones are rejected).
+ - Multiplexed RPC: with the "record[multiplex=true]" pvRequest option a ChannelRPC may have many requests
+   in flight, tagged with request IDs (ChannelRPC::multiplexedRequest()).  RPCClient::issue() and collect()
+   use it, and fall back to one request at a time with servers from earlier releases.
+ - epics::pvAccess::RPCServer::registerService() accepts a CachePolicy to serve repeated requests of
+   pure-function services from a cache keyed by the serialized arguments, with TTL and size bound.
+   See RPCServer::invalidateCache() and RPCServer::getCacheStats().
+ - epics::pvAccess::WildcardMatcher matches a name against a set of wildcard patterns with a single
+   (lazily determinized) automaton.  RPCServer uses it to look up wildcard services.
+ - epics::pvAccess::RPCClient::requestAll() sends requests to many services in parallel, with a status
+   per request and a deadline for all of them.
+ - Pipeline services: the elements move between the service and the sending thread through preallocated
+   single-producer/single-consumer rings, without locking.  See testApp/remote/pipelineServiceBenchmark.
+ - pipeline: "adaptive=true" pvRequest option sizes the credit window (elements sent ahead) from the measured
+   round trip time and release rate of the consumer, instead of ackAny.  Monitor::Stats shows the window and RTT.
+ - pipeline: PipelineControl::claimElement() and publishElement() let several service threads fill elements
+   of one session, sent in claim order or, per element, as soon as published.
+ - ca provider: monitors reuse a fixed pool of queueSize elements filled directly from the DBR data,
+   updates arriving while all elements are in use are coalesced into the last one (overrun bit set).
+ - ChannelProvider::beginBatch() and endBatch() let a thread start many operations to be sent together.
+   The ca provider flushes once at the end of a batch, of createChannels() and of a channel connecting.
+ - ca provider: array values are copied straight into the array storage, which is reused when not shared,
+   the old values are no longer copied first.  See testApp/remote/dbrCopyBenchmark.
+ - pvac: ClientProvider::getAll() and putAll() get or put a list of PVs with one wait and a global timeout,
+   ClientProvider::connect() of a list of names creates the missing channels together.
+ - pvac: CompletionQueue, get(), put(), rpc() and monitor() of ClientChannel post their completions,
+   tagged with a user pointer, to a queue polled in batches, with an eventfd (Linux) for external event loops.
+ - pvac: ClientChannel::monitorShared() shares one server subscription among the Monitors of a Channel
+   with the same pvRequest (record._options.queueSize included), each Monitor keeps its own queue and overrun bits.
+ - pvac: ClientChannel::cacheGets() and ClientProvider::cacheGets() answer get() from the latest value
+   of an active, connected monitorShared() subscription with the same pvRequest.
 - Deprecations
  - epics::pvAccess::GUID in favor of epics::pvAccess::ServerGUID due to win32 name conflict.
 
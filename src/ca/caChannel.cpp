@@ -14,6 +14,7 @@
 
 #define epicsExportSharedSymbols
 #include "caChannel.h"
+#include "dbrCopy.h"
 #include <pv/caStatus.h>
 
 using namespace epics::pvData;
@@ -176,7 +177,7 @@ static PVStructure::shared_pointer createPVStructure(CAChannel::shared_pointer c
         int result = ca_array_get_callback(DBR_GR_ENUM, 1, channel->getChannelID(), ca_get_labels_handler, pvScalarArray.get());
         if (result == ECA_NORMAL)
         {
-            ca_flush_io();
+            channel->flushIO();
 
             // NOTE: we do not wait here, since all subsequent request (over TCP) is serialized
             // and will guarantee that ca_get_labels_handler is called first
@@ -254,6 +255,8 @@ void CAChannel::connected()
         // TODO we need only Structure here
         this->structure = structure;
     }
+    // one flush for all the requests of this channel
+    CAFlushBatch batch(channelProvider);
     while(!putQueue.empty()) {
          putQueue.front()->activate();
          putQueue.pop();
@@ -612,6 +615,11 @@ void CAChannel::threadAttach()
     std::tr1::static_pointer_cast<CAChannelProvider>(channelProvider)->threadAttach();
 }
 
+void CAChannel::flushIO()
+{
+    std::tr1::static_pointer_cast<CAChannelProvider>(channelProvider)->flushIO();
+}
+
 
 CAChannelGetPtr CAChannelGet::create(
     CAChannel::shared_pointer const & channel,
@@ -736,14 +744,7 @@ void copy_DBR(const void * dbr, unsigned count, PVStructure::shared_pointer cons
     else
     {
         std::tr1::shared_ptr<aF> value = pvStructure->getSubField<aF>("value");
-        if (value.get())
-        {
-            std::tr1::shared_ptr<aF> value = pvStructure->getSubField<aF>("value");
-            typename aF::svector temp(value->reuse());
-            temp.resize(count);
-            std::copy(static_cast<const pT*>(dbr), static_cast<const pT*>(dbr) + count, temp.begin());
-            value->replace(freeze(temp));
-        }
+        if (value.get()) copyDBRArray(static_cast<const pT*>(dbr), count, *value);
     }
 }
 
@@ -761,13 +762,7 @@ void copy_DBR<dbr_long_t, PVInt, PVIntArray>(const void * dbr, unsigned count, P
     else
     {
         std::tr1::shared_ptr<PVIntArray> value = pvStructure->getSubField<PVIntArray>("value");
-        if (value.get())
-        {
-            PVIntArray::svector temp(value->reuse());
-            temp.resize(count);
-            std::copy(static_cast<const int32*>(dbr), static_cast<const int32*>(dbr) + count, temp.begin());
-            value->replace(freeze(temp));
-        }
+        if (value.get()) copyDBRArray(static_cast<const dbr_long_t*>(dbr), count, *value);
     }
 }
 #endif
@@ -784,14 +779,7 @@ void copy_DBR<string, PVString, PVStringArray>(const void * dbr, unsigned count,
     else
     {
         std::tr1::shared_ptr<PVStringArray> value = pvStructure->getSubField<PVStringArray>("value");
-        if (value.get())
-        {
-            const dbr_string_t* dbrStrings = static_cast<const dbr_string_t*>(dbr);
-            PVStringArray::svector sA(value->reuse());
-            sA.resize(count);
-            std::copy(dbrStrings, dbrStrings + count, sA.begin());
-            value->replace(freeze(sA));
-        }
+        if (value.get()) copyDBRArray(static_cast<const dbr_string_t*>(dbr), count, *value);
     }
 }
 
@@ -1113,7 +1101,7 @@ void CAChannelGet::get()
          channel->getChannelID(), ca_get_handler, this);
     if (result == ECA_NORMAL)
     {
-        ca_flush_io();
+        channel->flushIO();
     }
     else
     {
@@ -1275,7 +1263,7 @@ int doPut_pvStructure(CAChannel::shared_pointer const & channel, void *usrArg, P
 
         if (result == ECA_NORMAL)
         {
-            ca_flush_io();
+            channel->flushIO();
         }
 
         return result;
@@ -1298,7 +1286,7 @@ int doPut_pvStructure(CAChannel::shared_pointer const & channel, void *usrArg, P
         }
         if (result == ECA_NORMAL)
         {
-            ca_flush_io();
+            channel->flushIO();
         }
 
         return result;
@@ -1329,7 +1317,7 @@ int doPut_pvStructure<string, pvString, PVString, PVStringArray>(CAChannel::shar
         }
         if (result == ECA_NORMAL)
         {
-            ca_flush_io();
+            channel->flushIO();
         }
 
         return result;
@@ -1371,7 +1359,7 @@ int doPut_pvStructure<string, pvString, PVString, PVStringArray>(CAChannel::shar
 
         if (result == ECA_NORMAL)
         {
-            ca_flush_io();
+            channel->flushIO();
         }
 
         return result;
@@ -1402,7 +1390,7 @@ int doPut_pvStructure<dbr_enum_t, pvString, PVString, PVStringArray>(CAChannel::
         }
         if (result == ECA_NORMAL)
         {
-            ca_flush_io();
+            channel->flushIO();
         }
 
         return result;
@@ -1521,7 +1509,7 @@ void CAChannelPut::get()
                                        channel->getChannelID(), ca_put_get_handler, this);
     if (result == ECA_NORMAL)
     {
-        ca_flush_io();
+        channel->flushIO();
     }
     else
     {
@@ -1568,6 +1556,8 @@ static void ca_subscription_handler(struct event_handler_args args)
     channelMonitor->subscriptionEvent(args);
 }
 
+// elements are allocated up front and reused, when all are in use the updates
+// are coalesced into the last free one (like MonitorStrategyQueue does)
 class CACMonitorQueue :
     public std::tr1::enable_shared_from_this<CACMonitorQueue>
 {
@@ -1578,71 +1568,139 @@ private:
     bool overrunInProgress;
     bool isStarted;
     Mutex mutex;
-    
-    std::queue<MonitorElementPtr> monitorElementQueue;
+
+    StructureConstPtr structure;
+    // enum labels arrive asynchronously into the channel structure, shared with the elements
+    PVStringArrayPtr choices;
+
+    std::vector<MonitorElementPtr> freeElements;
+    // ring of filled elements, oldest at head
+    std::vector<MonitorElementPtr> monitorElementQueue;
+    size_t head;
+    size_t count;
+    MonitorElementPtr overrunElement;
+
+    void fill(MonitorElementPtr const & monitorElement,
+              copyDBRtoPVStructure copyFunc, const void * dbr, unsigned dbrCount)
+    {
+        PVStructurePtr const & pvs = monitorElement->pvStructurePtr;
+        copyFunc(dbr, dbrCount, pvs);
+        if (choices) {
+            PVStringArrayPtr elementChoices = pvs->getSubField<PVStringArray>("value.choices");
+            if (elementChoices && elementChoices->view().data() != choices->view().data())
+                elementChoices->replace(choices->view());
+        }
+    }
+
+    // return the queued and the overrun elements to the free ones
+    void clear()
+    {
+        for (; count > 0; count--) {
+            freeElements.push_back(monitorElementQueue[head]);
+            monitorElementQueue[head].reset();
+            head = (head + 1) % queueSize;
+        }
+        head = 0;
+        if (overrunElement) {
+            freeElements.push_back(overrunElement);
+            overrunElement.reset();
+        }
+        overrunInProgress = false;
+    }
+
+    void push(MonitorElementPtr const & monitorElement)
+    {
+        monitorElementQueue[(head + count) % queueSize] = monitorElement;
+        count++;
+    }
 public:
     CACMonitorQueue(
-        int32 queueSize)
+        int32 queueSize,
+        PVStructurePtr const & pvStructure)
      : queueSize(queueSize),
        overrunInProgress(false),
-       isStarted(false)
-     {}
+       isStarted(false),
+       structure(pvStructure->getStructure()),
+       choices(pvStructure->getSubField<PVStringArray>("value.choices")),
+       freeElements(),
+       monitorElementQueue(queueSize),
+       head(0),
+       count(0)
+     {
+         freeElements.reserve(queueSize);
+         for (size_t i = 0; i < this->queueSize; i++) {
+             MonitorElementPtr monitorElement(
+                 new MonitorElement(getPVDataCreate()->createPVStructure(structure)));
+             // CA always sends all
+             monitorElement->changedBitSet->set(0);
+             freeElements.push_back(monitorElement);
+         }
+     }
      ~CACMonitorQueue()
      {
      } 
      void start()
      {
          Lock guard(mutex);
-         while(!monitorElementQueue.empty()) monitorElementQueue.pop();
-         overrunInProgress = false;
+         clear();
          isStarted = true;
      }
      void stop()
      {
          Lock guard(mutex);
-         while(!monitorElementQueue.empty()) monitorElementQueue.pop();
-         overrunInProgress = false;
+         clear();
          isStarted = false;
      }
-     // return true if added to queue
-     bool event(const PVStructurePtr &pvStructure)
+     // fill the DBR data into a free element, return true if added to queue
+     bool event(copyDBRtoPVStructure copyFunc, const void * dbr, unsigned dbrCount)
      {
          Lock guard(mutex);
          if(!isStarted) return false;
-         if(monitorElementQueue.size()==queueSize)
+         if(overrunInProgress)
          {
+              // the latest value wins
+              fill(overrunElement, copyFunc, dbr, dbrCount);
+              overrunElement->overrunBitSet->set(0);
+              return false;
+         }
+         MonitorElementPtr monitorElement(freeElements.back());
+         freeElements.pop_back();
+         fill(monitorElement, copyFunc, dbr, dbrCount);
+         monitorElement->overrunBitSet->clear();
+         if(freeElements.empty()) {
+              // keep the last one for the updates until an element is released
               overrunInProgress = true;
+              overrunElement = monitorElement;
               return false;
-         } else {
-              PVStructure::shared_pointer pvs = 
-                  getPVDataCreate()->createPVStructure(pvStructure->getStructure());
-              pvs->copy(*pvStructure);
-              MonitorElementPtr monitorElement(new MonitorElement(pvs));
-              monitorElement->changedBitSet->set(0);
-              if(overrunInProgress) {
-                   overrunInProgress = false;
-                   monitorElement->overrunBitSet->set(0);
-              }
-              monitorElementQueue.push(monitorElement);
-              return true;
          }
-         
+         push(monitorElement);
+         return true;
      }
      MonitorElementPtr poll()
      {
           Lock guard(mutex);
-          if(!isStarted) return MonitorElementPtr();
-          if(monitorElementQueue.empty()) return MonitorElementPtr();
-          MonitorElementPtr retval = monitorElementQueue.front();
+          if(!isStarted || count == 0) return MonitorElementPtr();
+          MonitorElementPtr retval;
+          retval.swap(monitorElementQueue[head]);
+          head = (head + 1) % queueSize;
+          count--;
           return retval;
      }
      void release(MonitorElementPtr const & monitorElement)
      {
+         // an element of a replaced queue (channel type changed)
+         if(monitorElement->pvStructurePtr->getStructure().get() != structure.get()) return;
+
          Lock guard(mutex);
-         if(monitorElementQueue.empty()) {
+         if(freeElements.size() + count + (overrunElement ? 1 : 0) >= queueSize) {
               throw  std::runtime_error("client error calling release");
          }
-         monitorElementQueue.pop();
+         freeElements.push_back(monitorElement);
+         if(overrunInProgress) {
+              push(overrunElement);
+              overrunElement.reset();
+              overrunInProgress = false;
+         }
      }
 };
 
@@ -1694,7 +1752,7 @@ void CAChannelMonitor::activate()
             if (size > 1) queueSize = size;
         }
     }
-    monitorQueue = CACMonitorQueuePtr(new CACMonitorQueue(queueSize));
+    monitorQueue = CACMonitorQueuePtr(new CACMonitorQueue(queueSize, pvStructure));
     channel->addChannelMonitor(shared_from_this());
     EXCEPTION_GUARD(monitorRequester->monitorConnect(Status::Ok, shared_from_this(),
                     pvStructure->getStructure()));
@@ -1718,7 +1776,7 @@ void CAChannelMonitor::channelCreated(const Status& status,Channel::shared_point
                 if (size > 1) queueSize = size;
             }
         }
-        monitorQueue = CACMonitorQueuePtr(new CACMonitorQueue(queueSize));
+        monitorQueue = CACMonitorQueuePtr(new CACMonitorQueue(queueSize, pvStructure));
     }
     EXCEPTION_GUARD(monitorRequester->monitorConnect(Status::Ok, shared_from_this(),
                     pvStructure->getStructure()));
@@ -1745,8 +1803,7 @@ void CAChannelMonitor::subscriptionEvent(struct event_handler_args &args)
     {
         copyDBRtoPVStructure copyFunc = copyFuncTable[getType];
         if (copyFunc) {
-            copyFunc(args.dbr, args.count, pvStructure);
-            monitorQueue->event(pvStructure);
+            monitorQueue->event(copyFunc, args.dbr, args.count);
             // call monitorRequester even if queue is full
             monitorRequester->monitorEvent(shared_from_this());
         } else {
@@ -1791,7 +1848,7 @@ epics::pvData::Status CAChannelMonitor::start()
     {
         isStarted = true;
         monitorQueue->start();
-        ca_flush_io();
+        channel->flushIO();
         return status;
     } else {
         isStarted = false;
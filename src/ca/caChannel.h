@@ -96,6 +96,7 @@ public:
     /* ---------------------------------------------------------------- */
 
     void threadAttach();
+    void flushIO();
 
     void addChannelGet(const CAChannelGetPtr & get);
     void addChannelPut(const CAChannelPutPtr & get);
@@ -33,7 +33,7 @@ using namespace epics::pvData;
 
 size_t CAChannelProvider::num_instances;
 
-CAChannelProvider::CAChannelProvider() : current_context(0), destroyed(false)
+CAChannelProvider::CAChannelProvider() : current_context(0), batchState(0), destroyed(false)
 {
     REFTRACE_INCREMENT(num_instances);
     initialize();
@@ -41,6 +41,7 @@ CAChannelProvider::CAChannelProvider() : current_context(0), destroyed(false)
 
 CAChannelProvider::CAChannelProvider(const std::tr1::shared_ptr<Configuration>&)
     : current_context(0)
+    , batchState(0)
     , destroyed(false)
 {
     REFTRACE_INCREMENT(num_instances);
@@ -53,6 +54,8 @@ CAChannelProvider::~CAChannelProvider()
 {
     // call destroy() to destroy CA context
     destroy();
+    if (batchState)
+        epicsThreadPrivateDelete(batchState);
     REFTRACE_DECREMENT(num_instances);
 }
 
@@ -113,6 +116,18 @@ Channel::shared_pointer CAChannelProvider::createChannel(
     return CAChannel::create(shared_from_this(), channelName, priority, channelRequester);
 }
 
+std::vector<Channel::shared_pointer> CAChannelProvider::createChannels(
+    std::vector<std::string> const & names,
+    std::vector<ChannelRequester::shared_pointer> const & requesters,
+    short priority,
+    std::string const & address)
+{
+    threadAttach();
+
+    CAFlushBatch batch(shared_from_this());
+    return ChannelProvider::createChannels(names, requesters, priority, address);
+}
+
 void CAChannelProvider::configure(epics::pvData::PVStructure::shared_pointer /*configuration*/)
 {
 }
@@ -125,6 +140,38 @@ void CAChannelProvider::poll()
 {
 }
 
+void CAChannelProvider::beginBatch()
+{
+    size_t state = reinterpret_cast<size_t>(epicsThreadPrivateGet(batchState));
+    epicsThreadPrivateSet(batchState, reinterpret_cast<void*>(state + 2));
+}
+
+void CAChannelProvider::endBatch()
+{
+    size_t state = reinterpret_cast<size_t>(epicsThreadPrivateGet(batchState));
+    if (state < 2)
+        return;     // not in a batch
+
+    state -= 2;
+    // outermost, send what was held back
+    if (state == 1)
+    {
+        state = 0;
+        threadAttach();
+        ca_flush_io();
+    }
+    epicsThreadPrivateSet(batchState, reinterpret_cast<void*>(state));
+}
+
+void CAChannelProvider::flushIO()
+{
+    size_t state = reinterpret_cast<size_t>(epicsThreadPrivateGet(batchState));
+    if (state >= 2)
+        epicsThreadPrivateSet(batchState, reinterpret_cast<void*>(state | 1));
+    else
+        ca_flush_io();
+}
+
 void CAChannelProvider::destroy()
 {
     Lock lock(channelsMutex);
@@ -181,6 +228,8 @@ void CAChannelProvider::initialize()
 
     current_context = ca_current_context();
 
+    batchState = epicsThreadPrivateCreate();
+
     // TODO create a ca_poll thread, if ca_disable_preemptive_callback
 }
 
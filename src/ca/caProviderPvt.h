@@ -8,6 +8,7 @@
 #define CAPROVIDERPVT_H
 
 #include <cadef.h>
+#include <epicsThread.h>
 
 #include <pv/caProvider.h>
 #include <pv/pvAccess.h>
@@ -54,16 +55,30 @@ public:
         short priority,
         std::string const & address);
 
+    virtual std::vector<Channel::shared_pointer> createChannels(
+        std::vector<std::string> const & names,
+        std::vector<ChannelRequester::shared_pointer> const & requesters,
+        short priority,
+        std::string const & address);
+
     virtual void configure(epics::pvData::PVStructure::shared_pointer configuration);
     virtual void flush();
     virtual void poll();
 
+    virtual void beginBatch();
+    virtual void endBatch();
+
     virtual void destroy();
 
     /* ---------------------------------------------------------------- */
 
     void threadAttach();
 
+    /**
+     * ca_flush_io(), held back to the end of the batch if the calling thread is in one.
+     */
+    void flushIO();
+
     void registerChannel(Channel::shared_pointer const & channel);
     void unregisterChannel(Channel::shared_pointer const & channel);
     void unregisterChannel(Channel* pchannel);
@@ -74,6 +89,9 @@ private:
 
     ca_client_context* current_context;
 
+    // per thread: batch depth << 1 | flush pending
+    epicsThreadPrivateId batchState;
+
     epics::pvData::Mutex channelsMutex;
     // TODO std::unordered_map
     // void* is not the nicest thing, but there is no fast weak_ptr::operator==
@@ -84,6 +102,28 @@ private:
     bool destroyed;
 };
 
+/**
+ * beginBatch() and endBatch() of a scope.
+ */
+class CAFlushBatch
+{
+public:
+    explicit CAFlushBatch(CAChannelProvider::shared_pointer const & provider) :
+        provider(provider)
+    {
+        provider->beginBatch();
+    }
+    ~CAFlushBatch()
+    {
+        provider->endBatch();
+    }
+private:
+    CAFlushBatch(const CAFlushBatch&);
+    CAFlushBatch& operator=(const CAFlushBatch&);
+
+    CAChannelProvider::shared_pointer provider;
+};
+
 }
 }
 }
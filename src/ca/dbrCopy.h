@@ -0,0 +1,59 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef DBRCOPY_H
+#define DBRCOPY_H
+
+#include <algorithm>
+
+#include <pv/pvData.h>
+
+namespace epics {
+namespace pvAccess {
+namespace ca {
+
+/**
+ * Replace the value of an array field with count elements of a DBR buffer.
+ *
+ * The storage of the field is overwritten in place if the field holds the only
+ * reference to it and it is large enough, otherwise new storage is allocated.
+ * Unlike <code>reuse()</code> the old values are never copied, a shared array
+ * is left to its other owners as it is.
+ *
+ * libca has already converted to the host byte order and the pvData element type
+ * has the size of the DBR type, so the copy is a memmove (same types) or a loop
+ * over an element cast the compiler vectorizes (e.g. dbr_long_t and int32 on vxWorks).
+ *
+ * @param from DBR value buffer.
+ * @param count number of elements.
+ * @param value array field.
+ */
+template<typename pT, typename aF>
+void copyDBRArray(const pT * from, unsigned count, aF & value)
+{
+    typename aF::const_svector current;
+    value.swap(current);
+
+    typename aF::svector temp;
+    if (current.unique() && current.capacity() >= count)
+        temp = thaw(current);
+    else
+        current.clear();
+
+    if (temp.capacity() >= count)
+        temp.resize(count);
+    else
+        temp = typename aF::svector(count);
+
+    std::copy(from, from + count, temp.begin());
+    value.replace(freeze(temp));
+}
+
+}
+}
+}
+
+#endif  /* DBRCOPY_H */
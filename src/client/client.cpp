@@ -33,7 +33,10 @@ struct ClientChannel::Impl : public pva::ChannelRequester
     // assume few listeners per channel, store in vector
     typedef std::vector<ClientChannel::ConnectCallback*> listeners_t;
     listeners_t listeners;
+    // of the get() cache, <0 when disabled
+    double cacheAge;
 
+    Impl() :cacheAge(-1.0) {}
     virtual ~Impl() {}
 
     virtual std::string getRequesterName() OVERRIDE FINAL { return "ClientChannel::Impl"; }
@@ -155,6 +158,19 @@ std::tr1::shared_ptr<epics::pvAccess::Channel>
 ClientChannel::getChannel()
 { return impl->channel; }
 
+void ClientChannel::cacheGets(double maxAge)
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    Guard G(impl->mutex);
+    impl->cacheAge = maxAge;
+}
+
+double ClientChannel::getCacheAge() const
+{
+    Guard G(impl->mutex);
+    return impl->cacheAge;
+}
+
 struct ClientProvider::Impl
 {
     pva::ChannelProvider::shared_pointer provider;
@@ -162,6 +178,9 @@ struct ClientProvider::Impl
     epicsMutex mutex;
     typedef std::map<std::pair<std::string, ClientChannel::Options>, std::tr1::weak_ptr<ClientChannel::Impl> > channels_t;
     channels_t channels;
+    double cacheAge;
+
+    Impl() :cacheAge(-1.0) {}
 };
 
 ClientProvider::ClientProvider(const std::string& providerName,
@@ -209,10 +228,112 @@ ClientProvider::connect(const std::string& name,
     }
     // cache miss
     ClientChannel ret(impl->provider, name, conf);
+    ret.impl->cacheAge = impl->cacheAge;
     impl->channels[K] = ret.impl;
     return ret;
 }
 
+void
+ClientProvider::connect(const std::vector<std::string>& names,
+                        std::vector<ClientChannel>& channels,
+                        const ClientChannel::Options& conf)
+{
+    channels.clear();
+    channels.resize(names.size());
+
+    // names missing from the cache, each once, and their places in channels
+    typedef std::map<std::string, std::vector<size_t> > misses_t;
+    misses_t misses;
+
+    for(size_t i=0; i<names.size(); i++) {
+        if(names[i].empty())
+            THROW_EXCEPTION2(std::logic_error, "empty channel name not allowed");
+    }
+
+    {
+        Guard G(impl->mutex);
+        for(size_t i=0; i<names.size(); i++) {
+            Impl::channels_t::iterator it(impl->channels.find(std::make_pair(names[i], conf)));
+            if(it!=impl->channels.end()) {
+                // cache hit
+                std::tr1::shared_ptr<ClientChannel::Impl> chan(it->second.lock());
+                if(chan) {
+                    channels[i] = ClientChannel(chan);
+                    continue;
+                }
+            }
+            misses[names[i]].push_back(i);
+        }
+    }
+
+    if(misses.empty())
+        return;
+
+    std::vector<std::string> missNames;
+    std::vector<pva::ChannelRequester::shared_pointer> missRequesters;
+    std::vector<std::tr1::shared_ptr<ClientChannel::Impl> > missImpls;
+    missNames.reserve(misses.size());
+    missRequesters.reserve(misses.size());
+    missImpls.reserve(misses.size());
+    for(misses_t::const_iterator it(misses.begin()), end(misses.end()); it!=end; ++it) {
+        std::tr1::shared_ptr<ClientChannel::Impl> chan(new ClientChannel::Impl);
+        missNames.push_back(it->first);
+        missRequesters.push_back(chan);
+        missImpls.push_back(chan);
+    }
+
+    // not under our lock, the provider may call back or block
+    std::vector<pva::Channel::shared_pointer> created;
+    try {
+        created = impl->provider->createChannels(missNames, missRequesters, conf.priority, conf.address);
+    } catch(...) {
+        channels.clear();
+        throw;
+    }
+
+    bool ok = created.size()==missImpls.size();
+    for(size_t i=0; ok && i<created.size(); i++)
+        ok = !!created[i];
+    if(!ok) {
+        for(size_t i=0; i<created.size(); i++) {
+            if(created[i])
+                created[i]->destroy();
+        }
+        channels.clear();
+        throw std::runtime_error("ChannelProvider failed to create Channel");
+    }
+
+    std::vector<pva::Channel::shared_pointer> unused;
+    {
+        Guard G(impl->mutex);
+        size_t i=0;
+        for(misses_t::const_iterator it(misses.begin()), end(misses.end()); it!=end; ++it, ++i) {
+            Impl::channels_t::key_type K(it->first, conf);
+            std::tr1::shared_ptr<ClientChannel::Impl> chan;
+
+            // connected by another caller meanwhile, keep that one
+            Impl::channels_t::iterator cached(impl->channels.find(K));
+            if(cached!=impl->channels.end())
+                chan = cached->second.lock();
+
+            if(chan) {
+                unused.push_back(created[i]);
+            } else {
+                chan = missImpls[i];
+                chan->channel = created[i];
+                chan->cacheAge = impl->cacheAge;
+                impl->channels[K] = chan;
+            }
+
+            for(size_t j=0; j<it->second.size(); j++)
+                channels[it->second[j]] = ClientChannel(chan);
+        }
+    }
+
+    for(size_t i=0; i<unused.size(); i++)
+        unused[i]->destroy();
+}
+
 bool ClientProvider::disconnect(const std::string& name,
                                     const ClientChannel::Options& conf)
 {
@@ -231,4 +352,17 @@ void ClientProvider::disconnect()
     impl->channels.clear();
 }
 
+void ClientProvider::cacheGets(double maxAge)
+{
+    Guard G(impl->mutex);
+    impl->cacheAge = maxAge;
+    for(Impl::channels_t::const_iterator it(impl->channels.begin()), end(impl->channels.end()); it!=end; ++it) {
+        std::tr1::shared_ptr<ClientChannel::Impl> chan(it->second.lock());
+        if(chan) {
+            Guard G2(chan->mutex);
+            chan->cacheAge = maxAge;
+        }
+    }
+}
+
 } //namespace pvac
@@ -0,0 +1,235 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsEvent.h>
+#include <epicsTime.h>
+
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+#include <pv/createRequest.h>
+
+#define epicsExportSharedSymbols
+#include "pv/logger.h"
+#include "pva/client.h"
+#include "pv/pvAccess.h"
+#include "clientpvt.h"
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+struct BatchWait;
+
+struct BatchCallback
+{
+    BatchWait *wait;
+    pvac::ClientProvider::BatchItem *item;
+    bool done;
+
+    BatchCallback() :wait(0), item(0), done(false) {}
+};
+
+// one wait for the completion of all the operations of a batch
+struct BatchWait
+{
+    epicsMutex mutex;
+    epicsEvent event;
+    size_t pending;
+    // waiting is over, late completions (e.g. of the cancelled operations) are ignored
+    bool finished;
+
+    BatchWait() :pending(0), finished(false) {}
+
+    void complete(BatchCallback& cb, const pvac::PutEvent& evt,
+                  const pvd::PVStructure::const_shared_pointer& value)
+    {
+        bool last;
+        {
+            Guard G(mutex);
+            if(finished)
+                return;
+            if(cb.done) {
+                LOG(pva::logLevelWarn, "oops, double event to batch operation");
+                return;
+            }
+            cb.done = true;
+            cb.item->event = evt.event;
+            cb.item->message = evt.message;
+            cb.item->result = value;
+            last = --pending==0;
+        }
+        if(last)
+            event.signal();
+    }
+
+    void wait(double timeout)
+    {
+        const epicsTime deadline(epicsTime::getCurrent() + timeout);
+        Guard G(mutex);
+        while(pending) {
+            const double remaining = deadline - epicsTime::getCurrent();
+            if(remaining<=0.0)
+                break;
+            epicsGuardRelease<epicsMutex> U(G);
+            event.wait(remaining);
+        }
+        finished = true;
+    }
+};
+
+struct BatchGet : public pvac::ClientChannel::GetCallback,
+                  public BatchCallback
+{
+    virtual ~BatchGet() {}
+    virtual void getDone(const pvac::GetEvent& evt) OVERRIDE FINAL
+    {
+        wait->complete(*this, evt, evt.value);
+    }
+};
+
+struct BatchPut : public pvac::ClientChannel::PutCallback,
+                  public BatchCallback
+{
+    virtual ~BatchPut() {}
+
+    virtual void putBuild(const epics::pvData::StructureConstPtr& build, Args& args) OVERRIDE FINAL
+    {
+        pvac::detail::buildValue(build, item->value, args);
+    }
+
+    virtual void putDone(const pvac::PutEvent& evt) OVERRIDE FINAL
+    {
+        wait->complete(*this, evt, pvd::PVStructure::const_shared_pointer());
+    }
+};
+
+pvac::Operation startBatch(pvac::ClientChannel& channel, BatchGet *cb,
+                           const pvd::PVStructure::const_shared_pointer& pvRequest)
+{
+    return channel.get(cb, pvRequest);
+}
+
+pvac::Operation startBatch(pvac::ClientChannel& channel, BatchPut *cb,
+                           const pvd::PVStructure::const_shared_pointer& pvRequest)
+{
+    return channel.put(cb, pvRequest);
+}
+
+// operations started between construction and destruction are sent together
+struct ProviderBatch
+{
+    pva::ChannelProvider::shared_pointer provider;
+
+    explicit ProviderBatch(const pva::ChannelProvider::shared_pointer& provider) :provider(provider)
+    {
+        if(provider) provider->beginBatch();
+    }
+    ~ProviderBatch()
+    {
+        if(provider) provider->endBatch();
+    }
+};
+
+template<typename CB>
+size_t runBatch(pvac::ClientProvider::BatchItems& items,
+                std::vector<pvac::ClientChannel>& channels,
+                const pva::ChannelProvider::shared_pointer& provider,
+                double timeout,
+                const pvd::PVStructure::const_shared_pointer& pvRequest)
+{
+    BatchWait wait;
+    // callbacks must outlive the operations, which are cancelled before return
+    std::vector<CB> callbacks(items.size());
+    std::vector<pvac::Operation> ops;
+    ops.reserve(items.size());
+
+    wait.pending = items.size();
+    for(size_t i=0; i<items.size(); i++) {
+        items[i].event = pvac::PutEvent::Fail;
+        items[i].message = "Timeout";
+        items[i].result.reset();
+        callbacks[i].wait = &wait;
+        callbacks[i].item = &items[i];
+    }
+
+    {
+        ProviderBatch batch(provider);
+        for(size_t i=0; i<items.size(); i++) {
+            try {
+                ops.push_back(startBatch(channels[i], &callbacks[i], pvRequest));
+            } catch(std::exception& e) {
+                pvac::PutEvent evt;
+                evt.event = pvac::PutEvent::Fail;
+                evt.message = e.what();
+                wait.complete(callbacks[i], evt, pvd::PVStructure::const_shared_pointer());
+            }
+        }
+    }
+
+    wait.wait(timeout);
+
+    for(size_t i=0; i<ops.size(); i++)
+        ops[i].cancel();
+
+    size_t success = 0;
+    for(size_t i=0; i<items.size(); i++) {
+        if(items[i].event==pvac::PutEvent::Success)
+            success++;
+    }
+    return success;
+}
+
+} //namespace
+
+namespace pvac {
+
+size_t
+ClientProvider::getAll(BatchItems& items,
+                       double timeout,
+                       pvd::PVStructure::const_shared_pointer pvRequest,
+                       const ClientChannel::Options& conf)
+{
+    if(items.empty())
+        return 0;
+    // parsed once for the batch
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::vector<std::string> names(items.size());
+    for(size_t i=0; i<items.size(); i++)
+        names[i] = items[i].name;
+
+    std::vector<ClientChannel> channels;
+    connect(names, channels, conf);
+
+    return runBatch<BatchGet>(items, channels, channels[0].getChannel()->getProvider(), timeout, pvRequest);
+}
+
+size_t
+ClientProvider::putAll(BatchItems& items,
+                       double timeout,
+                       pvd::PVStructure::const_shared_pointer pvRequest,
+                       const ClientChannel::Options& conf)
+{
+    if(items.empty())
+        return 0;
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::vector<std::string> names(items.size());
+    for(size_t i=0; i<items.size(); i++)
+        names[i] = items[i].name;
+
+    std::vector<ClientChannel> channels;
+    connect(names, channels, conf);
+
+    return runBatch<BatchPut>(items, channels, channels[0].getChannel()->getProvider(), timeout, pvRequest);
+}
+
+}//namespace pvac
@@ -15,6 +15,7 @@
 #include "pv/logger.h"
 #include "pva/client.h"
 #include "pv/pvAccess.h"
+#include "clientpvt.h"
 
 namespace pvd = epics::pvData;
 namespace pva = epics::pvAccess;
@@ -35,8 +36,14 @@ struct GetPutter : public pva::ChannelPutRequester,
     pvac::ClientChannel::PutCallback *putcb;
     pvac::GetEvent event;
 
-    GetPutter(pvac::ClientChannel::GetCallback* cb) :started(false), getcb(cb), putcb(0) {}
-    GetPutter(pvac::ClientChannel::PutCallback* cb) :started(false), getcb(0), putcb(cb) {}
+    // put of 'value' built here instead of by putcb->putBuild()
+    bool putValue;
+    pvd::shared_vector<const void> value;
+
+    GetPutter(pvac::ClientChannel::GetCallback* cb, void *priv =0) :started(false), getcb(cb), putcb(0), putValue(false)
+    {event.priv = priv;}
+    GetPutter(pvac::ClientChannel::PutCallback* cb, void *priv =0) :started(false), getcb(0), putcb(cb), putValue(false)
+    {event.priv = priv;}
     virtual ~GetPutter() {cancel();}
 
     void callEvent(Guard& G, pvac::GetEvent::event_t evt = pvac::GetEvent::Fail)
@@ -58,6 +65,18 @@ struct GetPutter : public pva::ChannelPutRequester,
         }
     }
 
+    // get answered from ClientChannel::cacheGets(), if value isn't NULL
+    bool complete(const pvd::PVStructure::const_shared_pointer& value)
+    {
+        if(!value)
+            return false;
+        Guard G(mutex);
+        event.message.clear();
+        event.value = value;
+        callEvent(G, pvac::GetEvent::Success);
+        return true;
+    }
+
     virtual std::string name() const OVERRIDE FINAL
     {
         Guard G(mutex);
@@ -104,8 +123,12 @@ struct GetPutter : public pva::ChannelPutRequester,
             pvd::BitSet::shared_pointer tosend(new pvd::BitSet);
             pvac::ClientChannel::PutCallback::Args args(*tosend);
             try {
-                UnGuard U(G);
-                cb->putBuild(structure, args);
+                if(putValue) {
+                    pvac::detail::buildValue(structure, value, args);
+                } else {
+                    UnGuard U(G);
+                    cb->putBuild(structure, args);
+                }
                 if(!args.root)
                     throw std::logic_error("No put value provided");
                 else if(args.root->getStructure().get()!=structure.get())
@@ -176,6 +199,31 @@ struct GetPutter : public pva::ChannelPutRequester,
 
 namespace pvac {
 
+namespace detail {
+
+void buildValue(const epics::pvData::StructureConstPtr& build,
+                const epics::pvData::shared_vector<const void>& value,
+                ClientChannel::PutCallback::Args& args)
+{
+    pvd::PVStructurePtr root(pvd::getPVDataCreate()->createPVStructure(build));
+    pvd::PVFieldPtr field(root->getSubField("value"));
+    pvd::PVScalarPtr scalar(std::tr1::dynamic_pointer_cast<pvd::PVScalar>(field));
+    pvd::PVScalarArrayPtr array(std::tr1::dynamic_pointer_cast<pvd::PVScalarArray>(field));
+    if(scalar) {
+        if(value.size()!=1)
+            throw std::runtime_error("scalar 'value' sub-field needs one element");
+        scalar->putFrom(value.data(), value.original_type());
+    } else if(array) {
+        array->putFrom(value);
+    } else {
+        throw std::runtime_error("PV has no scalar or scalar array 'value' sub-field");
+    }
+    args.tosend.set(field->getFieldOffset());
+    args.root = root;
+}
+
+} // namespace detail
+
 Operation
 ClientChannel::get(ClientChannel::GetCallback* cb,
                   epics::pvData::PVStructure::const_shared_pointer pvRequest)
@@ -186,7 +234,7 @@ ClientChannel::get(ClientChannel::GetCallback* cb,
 
     std::tr1::shared_ptr<GetPutter> ret(new GetPutter(cb));
 
-    {
+    if(!ret->complete(getCached(pvRequest))) {
         Guard G(ret->mutex);
         ret->op = getChannel()->createChannelPut(ret, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest));
     }
@@ -213,4 +261,43 @@ ClientChannel::put(PutCallback* cb,
 
 }
 
+Operation
+ClientChannel::get(CompletionQueue& queue, void *tag,
+                   epics::pvData::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::tr1::shared_ptr<GetPutter> ret(new GetPutter(queue.getCallback(), tag));
+
+    if(!ret->complete(getCached(pvRequest))) {
+        Guard G(ret->mutex);
+        ret->op = getChannel()->createChannelPut(ret, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest));
+    }
+
+    return Operation(ret);
+}
+
+Operation
+ClientChannel::put(CompletionQueue& queue, void *tag,
+                   const epics::pvData::shared_vector<const void>& value,
+                   epics::pvData::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::tr1::shared_ptr<GetPutter> ret(new GetPutter(queue.putCallback(), tag));
+    ret->putValue = true;
+    ret->value = value;
+
+    {
+        Guard G(ret->mutex);
+        ret->op = getChannel()->createChannelPut(ret, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest));
+    }
+
+    return Operation(ret);
+}
+
 }//namespace pvac
@@ -3,8 +3,14 @@
  * found in the file LICENSE that is included with the distribution
  */
 
+#include <deque>
+#include <map>
+#include <sstream>
+
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
 
 #include <pv/current_function.h>
 #include <pv/pvData.h>
@@ -21,6 +27,9 @@ typedef epicsGuard<epicsMutex> Guard;
 typedef epicsGuardRelease<epicsMutex> UnGuard;
 
 namespace pvac {
+namespace {
+struct SharedMonitor;
+}
 
 struct Monitor::Impl : public pva::MonitorRequester
 {
@@ -34,14 +43,51 @@ struct Monitor::Impl : public pva::MonitorRequester
 
     pva::MonitorElement::Ref last;
 
-    Impl(ClientChannel::MonitorCallback* cb)
+    // consumer of a shared subscription, which fills 'updates' instead of 'last'
+    std::tr1::shared_ptr<SharedMonitor> shared;
+    struct Update {
+        pvd::PVStructure::const_shared_pointer root;
+        pvd::BitSet changed, overrun;
+    };
+    std::deque<Update> updates;
+    size_t queueSize;
+
+    Impl(ClientChannel::MonitorCallback* cb, void *priv =0)
         :started(false)
         ,done(false)
         ,seenEmpty(false)
         ,cb(cb)
-    {}
+        ,queueSize(0)
+    {event.priv = priv;}
     virtual ~Impl() {cancel();}
 
+    // queue an update of a shared subscription, squashed into the last one when full.
+    // Call with mutex locked.  Returns true if the queue was empty.
+    bool push(const pvd::PVStructure::const_shared_pointer& root,
+              const pvd::BitSet& changed,
+              const pvd::BitSet& overrun)
+    {
+        if(!cb || done)
+            return false;
+        if(updates.size() < queueSize) {
+            updates.resize(updates.size()+1);
+            Update& U = updates.back();
+            U.root = root;
+            U.changed = changed;
+            U.overrun = overrun;
+            return updates.size()==1;
+        }
+        // root is a complete value, only the bit sets are merged
+        Update& U = updates.back();
+        pvd::BitSet both(U.changed);
+        both &= changed;
+        U.overrun |= both;
+        U.overrun |= overrun;
+        U.changed |= changed;
+        U.root = root;
+        return false;
+    }
+
     void callEvent(Guard& G, MonitorEvent::event_t evt = MonitorEvent::Fail)
     {
         ClientChannel::MonitorCallback *cb=this->cb;
@@ -74,7 +120,9 @@ struct Monitor::Impl : public pva::MonitorRequester
         }
     }
 
-    void cancel()
+    void cancel();
+
+    void cancelOp()
     {
         Guard G(mutex);
 
@@ -153,6 +201,343 @@ struct Monitor::Impl : public pva::MonitorRequester
     }
 };
 
+namespace {
+
+/* One wire subscription fanned out to the consumers (Monitor::Impl) subscribed
+ * through ClientChannel::monitorShared() to the same Channel with the same pvRequest.
+ * Keyed by the Channel, the printed pvRequest without record._options.queueSize,
+ * and the printed record._options.queueSize (empty if not given).
+ *
+ * Each update is merged into a new complete value, which is immutable once made
+ * and so is handed to all the consumer queues without copying.
+ */
+struct SharedMonitor : public pva::MonitorRequester
+{
+    typedef std::pair<std::string, std::string> request_t;
+    typedef std::pair<pva::Channel*, request_t> key_t;
+    typedef std::vector<std::pair<Monitor::Impl*, std::tr1::weak_ptr<Monitor::Impl> > > consumers_t;
+
+    epicsMutex mutex;
+    const key_t key;
+    const pva::Channel::shared_pointer chan;
+    operation_type::shared_pointer op;
+    bool started, done, closed;
+    // latest complete value, NULL until the first update
+    pvd::PVStructure::const_shared_pointer current;
+    consumers_t consumers;
+
+    SharedMonitor(const key_t& key, const pva::Channel::shared_pointer& chan)
+        :key(key)
+        ,chan(chan)
+        ,started(false)
+        ,done(false)
+        ,closed(false)
+    {}
+    virtual ~SharedMonitor() {close();}
+
+    static std::tr1::shared_ptr<SharedMonitor> attach(const std::tr1::shared_ptr<Monitor::Impl>& consumer,
+                                                      const request_t& request,
+                                                      const pvd::PVStructure::const_shared_pointer& pvRequest);
+    void remove(Monitor::Impl *consumer);
+    void close();
+
+    // call without locks
+    static void notify(std::vector<std::tr1::shared_ptr<Monitor::Impl> >& consumers,
+                       MonitorEvent::event_t evt,
+                       const std::string& message)
+    {
+        for(size_t i=0; i<consumers.size(); i++) {
+            Monitor::Impl& C = *consumers[i];
+            Guard G(C.mutex);
+            if(!C.cb || C.done) continue;
+            C.event.message = message;
+            if(evt==MonitorEvent::Data) {
+                // unlisten, what is queued can still be poll()d, then complete()
+                C.done = true;
+            }
+            C.callEvent(G, evt);
+        }
+    }
+
+    void live(std::vector<std::tr1::shared_ptr<Monitor::Impl> >& ret)
+    {
+        for(consumers_t::const_iterator it(consumers.begin()), end(consumers.end()); it!=end; ++it) {
+            std::tr1::shared_ptr<Monitor::Impl> C(it->second.lock());
+            if(C)
+                ret.push_back(C);
+        }
+    }
+
+    virtual std::string getRequesterName() OVERRIDE FINAL
+    {
+        return chan->getRequesterName();
+    }
+
+    virtual void monitorConnect(pvd::Status const & status,
+                                pva::MonitorPtr const & operation,
+                                pvd::StructureConstPtr const & structure) OVERRIDE FINAL
+    {
+        std::vector<std::tr1::shared_ptr<Monitor::Impl> > fail;
+        std::string message;
+        {
+            Guard G(mutex);
+            if(closed || started || done) return;
+
+            if(status.isSuccess()) {
+                // a reconnected subscription starts again with a complete value,
+                // which a local provider may deliver from start()
+                current.reset();
+                pvd::Status sts(operation->start());
+                if(sts.isSuccess()) {
+                    started = true;
+                    return;
+                }
+                message = sts.getMessage();
+            } else {
+                message = status.getMessage();
+            }
+            done = true;
+            live(fail);
+        }
+        // new consumers will not join a failed subscription
+        remove(0);
+        notify(fail, MonitorEvent::Fail, message);
+    }
+
+    virtual void channelDisconnect(bool destroy) OVERRIDE FINAL
+    {
+        std::vector<std::tr1::shared_ptr<Monitor::Impl> > disconnected;
+        {
+            Guard G(mutex);
+            if(closed || done) return;
+            started = false;
+            current.reset();
+            live(disconnected);
+        }
+        notify(disconnected, MonitorEvent::Disconnect, "Disconnect");
+    }
+
+    virtual void monitorEvent(pva::MonitorPtr const & monitor) OVERRIDE FINAL
+    {
+        std::vector<std::tr1::shared_ptr<Monitor::Impl> > targets, wakeup;
+        {
+            Guard G(mutex);
+            if(closed || done) return;
+            live(targets);
+
+            for(pva::MonitorElement::Ref it(monitor); it; ++it) {
+                pvd::PVStructurePtr next(pvd::getPVDataCreate()->createPVStructure(it->pvStructurePtr->getStructure()));
+                if(current)
+                    next->copyUnchecked(*current);
+                next->copyUnchecked(*it->pvStructurePtr, *it->changedBitSet);
+                current = next;
+
+                for(size_t i=0; i<targets.size(); i++) {
+                    Guard G2(targets[i]->mutex);
+                    if(targets[i]->push(current, *it->changedBitSet, *it->overrunBitSet))
+                        wakeup.push_back(targets[i]);
+                }
+            }
+        }
+        for(size_t i=0; i<wakeup.size(); i++) {
+            Monitor::Impl& C = *wakeup[i];
+            Guard G(C.mutex);
+            if(!C.cb || C.done) continue;
+            C.event.message.clear();
+            C.callEvent(G, MonitorEvent::Data);
+        }
+    }
+
+    virtual void unlisten(pva::MonitorPtr const & monitor) OVERRIDE FINAL
+    {
+        std::vector<std::tr1::shared_ptr<Monitor::Impl> > finished;
+        {
+            Guard G(mutex);
+            if(closed || done) return;
+            done = true;
+            live(finished);
+        }
+        remove(0);
+        notify(finished, MonitorEvent::Data, std::string());
+    }
+};
+
+struct sharedGbl_t {
+    epicsMutex mutex;
+    typedef std::map<SharedMonitor::key_t, std::tr1::weak_ptr<SharedMonitor> > monitors_t;
+    monitors_t monitors;
+} *sharedGbl;
+
+epicsThreadOnceId sharedOnce = EPICS_THREAD_ONCE_INIT;
+
+void sharedInit(void*)
+{
+    sharedGbl = new sharedGbl_t;
+}
+
+std::tr1::shared_ptr<SharedMonitor>
+SharedMonitor::attach(const std::tr1::shared_ptr<Monitor::Impl>& consumer,
+                      const request_t& request,
+                      const pvd::PVStructure::const_shared_pointer& pvRequest)
+{
+    epicsThreadOnce(&sharedOnce, &sharedInit, 0);
+
+    key_t key(consumer->chan.get(), request);
+    std::tr1::shared_ptr<SharedMonitor> ret;
+    bool create = false, wakeup = false;
+    {
+        Guard G(sharedGbl->mutex);
+        sharedGbl_t::monitors_t::iterator it(sharedGbl->monitors.find(key));
+        if(it!=sharedGbl->monitors.end())
+            ret = it->second.lock();
+        if(!ret) {
+            ret.reset(new SharedMonitor(key, consumer->chan));
+            sharedGbl->monitors[key] = ret;
+            create = true;
+        }
+
+        Guard G2(ret->mutex);
+        ret->consumers.push_back(std::make_pair(consumer.get(), std::tr1::weak_ptr<Monitor::Impl>(consumer)));
+        if(ret->current) {
+            // late joiner, starts with the latest complete value
+            pvd::BitSet all;
+            all.set(0);
+            Guard G3(consumer->mutex);
+            wakeup = consumer->push(ret->current, all, pvd::BitSet());
+        }
+    }
+
+    if(create) {
+        operation_type::shared_pointer op(consumer->chan->createMonitor(ret, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest)));
+        bool closed;
+        {
+            Guard G(ret->mutex);
+            closed = ret->closed;
+            if(!closed)
+                ret->op = op;
+        }
+        if(closed && op)
+            op->destroy();
+    }
+
+    if(wakeup) {
+        Guard G(consumer->mutex);
+        if(consumer->cb && !consumer->done) {
+            consumer->event.message.clear();
+            consumer->callEvent(G, MonitorEvent::Data);
+        }
+    }
+    return ret;
+}
+
+// remove one consumer, or with NULL only the registry entry.  The subscription is closed with the last consumer.
+void SharedMonitor::remove(Monitor::Impl *consumer)
+{
+    bool last = false;
+    {
+        Guard G(sharedGbl->mutex);
+        Guard G2(mutex);
+        if(consumer) {
+            for(consumers_t::iterator it(consumers.begin()), end(consumers.end()); it!=end; ++it) {
+                if(it->first==consumer) {
+                    consumers.erase(it);
+                    break;
+                }
+            }
+        }
+        sharedGbl_t::monitors_t::iterator it(sharedGbl->monitors.find(key));
+        if((!consumer || consumers.empty()) && it!=sharedGbl->monitors.end()) {
+            std::tr1::shared_ptr<SharedMonitor> self(it->second.lock());
+            // a new subscription may already have replaced this one
+            if(!self || self.get()==this)
+                sharedGbl->monitors.erase(it);
+        }
+        last = consumers.empty();
+    }
+    if(last)
+        close();
+}
+
+void SharedMonitor::close()
+{
+    operation_type::shared_pointer op;
+    bool started;
+    {
+        Guard G(mutex);
+        closed = true;
+        op.swap(this->op);
+        started = this->started;
+        this->started = false;
+        current.reset();
+    }
+    if(op) {
+        if(started)
+            op->stop();
+        op->destroy();
+    }
+}
+
+/* The sharing key of a pvRequest, its printed form without record._options.queueSize,
+ * which goes to queueKey, and to queueSize for the queue of the consumer.
+ */
+void requestKey(const pvd::PVStructure& node, const std::string& path,
+                std::ostringstream& key, std::string& queueKey, size_t& queueSize, bool& pipeline)
+{
+    const pvd::PVFieldPtrArray& fields = node.getPVFields();
+    for(size_t i=0; i<fields.size(); i++) {
+        const pvd::PVField& fld = *fields[i];
+        const std::string name(path + fld.getFieldName());
+
+        if(fld.getField()->getType()==pvd::structure) {
+            key<<fld.getFieldName()<<'{';
+            requestKey(static_cast<const pvd::PVStructure&>(fld), name+".", key, queueKey, queueSize, pipeline);
+            key<<'}';
+            continue;
+
+        } else if(fld.getField()->getType()==pvd::scalar && name=="record._options.queueSize") {
+            std::ostringstream value;
+            value<<fld;
+            queueKey = value.str();
+            try {
+                queueSize = static_cast<const pvd::PVScalar&>(fld).getAs<pvd::uint32>();
+            } catch(std::exception& e) {
+                LOG(pva::logLevelWarn, "Ignoring record._options.queueSize: %s", e.what());
+            }
+            continue;
+
+        } else if(fld.getField()->getType()==pvd::scalar && name=="record._options.pipeline") {
+            try {
+                pipeline = static_cast<const pvd::PVScalar&>(fld).getAs<pvd::boolean>();
+            } catch(std::exception& e) {
+                // not a valid option, leave it to the server
+            }
+        }
+        key<<fld.getFieldName()<<'='<<fld<<';';
+    }
+}
+
+} // namespace
+
+void Monitor::Impl::cancel()
+{
+    if(!queueSize) {
+        cancelOp();
+        return;
+    }
+
+    std::tr1::shared_ptr<SharedMonitor> S;
+    {
+        Guard G(mutex);
+        S.swap(shared);
+    }
+    if(S)
+        S->remove(this);
+
+    Guard G(mutex);
+    updates.clear();
+    callEvent(G, MonitorEvent::Cancel);
+}
+
 Monitor::Monitor(const std::tr1::shared_ptr<Impl>& impl)
     :impl(impl)
 {}
@@ -178,7 +563,20 @@ bool Monitor::poll()
     if(!impl) return false;
     Guard G(impl->mutex);
 
-    if(!impl->done && impl->last.next()) {
+    if(impl->queueSize) {
+        if(!impl->updates.empty()) {
+            Impl::Update& U = impl->updates.front();
+            root = U.root;
+            changed.swap(U.changed);
+            overrun.swap(U.overrun);
+            impl->updates.pop_front();
+        } else {
+            root.reset();
+            changed.clear();
+            overrun.clear();
+        }
+
+    } else if(!impl->done && impl->last.next()) {
         root = impl->last->pvStructurePtr;
         changed = *impl->last->changedBitSet;
         overrun = *impl->last->overrunBitSet;
@@ -195,7 +593,7 @@ bool Monitor::complete() const
 {
     if(!impl) return true;
     Guard G(impl->mutex);
-    return impl->done && impl->seenEmpty;
+    return impl->done && (impl->queueSize ? impl->updates.empty() : impl->seenEmpty);
 }
 
 Monitor
@@ -217,4 +615,96 @@ ClientChannel::monitor(MonitorCallback *cb,
     return Monitor(ret);
 }
 
+Monitor
+ClientChannel::monitor(CompletionQueue& queue, void *tag,
+                       epics::pvData::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::tr1::shared_ptr<Monitor::Impl> ret(new Monitor::Impl(queue.monitorCallback(), tag));
+    ret->chan = getChannel();
+
+    {
+        Guard G(ret->mutex);
+        ret->op = ret->chan->createMonitor(ret, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest));
+    }
+
+    return Monitor(ret);
+}
+
+Monitor
+ClientChannel::monitorShared(MonitorCallback *cb,
+                             epics::pvData::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::ostringstream key;
+    SharedMonitor::request_t request;
+    size_t queueSize = 4;
+    bool pipeline = false;
+    requestKey(*pvRequest, std::string(), key, request.second, queueSize, pipeline);
+    request.first = key.str();
+
+    // flow control is per subscription, can't be shared
+    if(pipeline)
+        return monitor(cb, pvRequest);
+
+    std::tr1::shared_ptr<Monitor::Impl> ret(new Monitor::Impl(cb));
+    ret->chan = getChannel();
+    ret->queueSize = queueSize ? queueSize : 1;
+
+    std::tr1::shared_ptr<SharedMonitor> shared(SharedMonitor::attach(ret, request, pvRequest));
+    {
+        Guard G(ret->mutex);
+        ret->shared = shared;
+    }
+
+    return Monitor(ret);
+}
+
+pvd::PVStructure::const_shared_pointer
+ClientChannel::getCached(const epics::pvData::PVStructure::const_shared_pointer& pvRequest)
+{
+    const double maxAge = getCacheAge();
+    // a get which processes must reach the server
+    if(maxAge<0.0 || pvRequest->getSubField("record._options.process"))
+        return pvd::PVStructure::const_shared_pointer();
+
+    std::ostringstream key;
+    std::string queueKey;
+    size_t queueSize = 0;
+    bool pipeline = false;
+    requestKey(*pvRequest, std::string(), key, queueKey, queueSize, pipeline);
+
+    epicsThreadOnce(&sharedOnce, &sharedInit, 0);
+
+    // the subscriptions of this pvRequest, with any queueSize
+    std::vector<std::tr1::shared_ptr<SharedMonitor> > shared;
+    {
+        Guard G(sharedGbl->mutex);
+        const SharedMonitor::key_t first(getChannel().get(), SharedMonitor::request_t(key.str(), std::string()));
+        for(sharedGbl_t::monitors_t::const_iterator it(sharedGbl->monitors.lower_bound(first)), end(sharedGbl->monitors.end());
+            it!=end && it->first.first==first.first && it->first.second.first==first.second.first; ++it)
+        {
+            std::tr1::shared_ptr<SharedMonitor> S(it->second.lock());
+            if(S)
+                shared.push_back(S);
+        }
+    }
+
+    for(size_t i=0; i<shared.size(); i++) {
+        Guard G(shared[i]->mutex);
+        // a connected subscription is up to date however long ago its last update was,
+        // current is reset on disconnect
+        if(shared[i]->closed || shared[i]->done || !shared[i]->started || !shared[i]->current)
+            continue;
+        return shared[i]->current;
+    }
+    return pvd::PVStructure::const_shared_pointer();
+}
+
 }//namespace pvac
@@ -0,0 +1,161 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <stdexcept>
+
+#ifdef __linux__
+#  include <unistd.h>
+#  include <errno.h>
+#  include <stdint.h>
+#  include <sys/eventfd.h>
+#endif
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsEvent.h>
+#include <epicsTime.h>
+
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+
+#define epicsExportSharedSymbols
+#include "pv/logger.h"
+#include "pva/client.h"
+#include "pv/pvAccess.h"
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+namespace pvac {
+
+// one callback object for all the operations of a queue, the tag comes in PutEvent::priv
+struct CompletionQueue::Impl : public ClientChannel::GetCallback,
+                               public ClientChannel::PutCallback,
+                               public ClientChannel::MonitorCallback
+{
+    epicsMutex mutex;
+    epicsEvent wakeup;
+    Completions pending;
+    int efd;
+
+    Impl() :efd(-1)
+    {
+#ifdef __linux__
+        efd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+        if(efd<0)
+            LOG(pva::logLevelWarn, "CompletionQueue: eventfd() fails, errno=%d\n", errno);
+#endif
+    }
+    virtual ~Impl()
+    {
+#ifdef __linux__
+        if(efd>=0)
+            close(efd);
+#endif
+    }
+
+    void post(void *tag, bool monitor, PutEvent::event_t event, MonitorEvent::event_t mevent,
+              const std::string& message, const pvd::PVStructure::const_shared_pointer& value)
+    {
+        bool wasEmpty;
+        {
+            Guard G(mutex);
+            wasEmpty = pending.empty();
+            pending.resize(pending.size()+1);
+            Completion& C = pending.back();
+            C.tag = tag;
+            C.monitor = monitor;
+            C.event = event;
+            C.mevent = mevent;
+            C.message = message;
+            C.value = value;
+#ifdef __linux__
+            // under the lock so the write can't pass the read of poll()
+            if(wasEmpty && efd>=0) {
+                uint64_t one = 1;
+                if(write(efd, &one, sizeof(one))!=sizeof(one))
+                    LOG(pva::logLevelWarn, "CompletionQueue: eventfd write fails, errno=%d\n", errno);
+            }
+#endif
+        }
+        if(wasEmpty)
+            wakeup.signal();
+    }
+
+    virtual void getDone(const GetEvent& evt) OVERRIDE FINAL
+    {
+        post(evt.priv, false, evt.event, MonitorEvent::Fail, evt.message, evt.value);
+    }
+
+    virtual void putBuild(const epics::pvData::StructureConstPtr& /*build*/, Args& /*args*/) OVERRIDE FINAL
+    {
+        // queue puts send the value given to ClientChannel::put()
+        throw std::logic_error("CompletionQueue can't build a put value");
+    }
+
+    virtual void putDone(const PutEvent& evt) OVERRIDE FINAL
+    {
+        post(evt.priv, false, evt.event, MonitorEvent::Fail, evt.message, pvd::PVStructure::const_shared_pointer());
+    }
+
+    virtual void monitorEvent(const MonitorEvent& evt) OVERRIDE FINAL
+    {
+        post(evt.priv, true, PutEvent::Success, evt.event, evt.message, pvd::PVStructure::const_shared_pointer());
+    }
+};
+
+CompletionQueue::CompletionQueue()
+    :impl(new Impl)
+{}
+
+CompletionQueue::~CompletionQueue() {}
+
+size_t CompletionQueue::poll(Completions& completions)
+{
+    completions.clear();
+    Guard G(impl->mutex);
+    // the caller's (empty) storage is reused for the next completions
+    completions.swap(impl->pending);
+#ifdef __linux__
+    if(!completions.empty() && impl->efd>=0) {
+        uint64_t count;
+        if(read(impl->efd, &count, sizeof(count))!=sizeof(count) && errno!=EAGAIN)
+            LOG(pva::logLevelWarn, "CompletionQueue: eventfd read fails, errno=%d\n", errno);
+    }
+#endif
+    return completions.size();
+}
+
+bool CompletionQueue::wait(double timeout)
+{
+    const epicsTime deadline(epicsTime::getCurrent() + timeout);
+    Guard G(impl->mutex);
+    while(impl->pending.empty()) {
+        const double remaining = deadline - epicsTime::getCurrent();
+        if(remaining<=0.0)
+            return false;
+        UnGuard U(G);
+        impl->wakeup.wait(remaining);
+    }
+    return true;
+}
+
+int CompletionQueue::fd() const
+{
+    return impl->efd;
+}
+
+ClientChannel::GetCallback* CompletionQueue::getCallback() const
+{ return impl.get(); }
+
+ClientChannel::PutCallback* CompletionQueue::putCallback() const
+{ return impl.get(); }
+
+ClientChannel::MonitorCallback* CompletionQueue::monitorCallback() const
+{ return impl.get(); }
+
+}//namespace pvac
@@ -35,7 +35,8 @@ struct RPCer : public pva::ChannelRPCRequester,
     pvd::PVStructure::const_shared_pointer args;
 
     RPCer(pvac::ClientChannel::GetCallback* cb,
-          const pvd::PVStructure::const_shared_pointer& args) :started(false), cb(cb), args(args) {}
+          const pvd::PVStructure::const_shared_pointer& args,
+          void *priv =0) :started(false), cb(cb), args(args) {event.priv = priv;}
     virtual ~RPCer() {cancel();}
 
     void callEvent(Guard& G, pvac::GetEvent::event_t evt = pvac::GetEvent::Fail)
@@ -159,4 +160,23 @@ ClientChannel::rpc(GetCallback* cb,
     return Operation(ret);
 }
 
+Operation
+ClientChannel::rpc(CompletionQueue& queue, void *tag,
+                   const epics::pvData::PVStructure::const_shared_pointer& arguments,
+                   epics::pvData::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::tr1::shared_ptr<RPCer> ret(new RPCer(queue.getCallback(), arguments, tag));
+
+    {
+        Guard G(ret->mutex);
+        ret->op = getChannel()->createChannelRPC(ret, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest));
+    }
+
+    return Operation(ret);
+}
+
 }//namespace pvac
@@ -0,0 +1,30 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef CLIENTPVT_H
+#define CLIENTPVT_H
+
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+
+#include "pva/client.h"
+
+namespace pvac {
+namespace detail {
+
+/** Build the value of a put to the 'value' field
+ *
+ * @param build the structure given by the server
+ * @param value new value, a scalar field takes an array of one element
+ * @param args set to the new value, the 'value' field marked to send
+ * @throw std::runtime_error if the 'value' field is missing, is not a scalar or scalar array,
+ *        or is a scalar and value does not have one element.
+ */
+void buildValue(const epics::pvData::StructureConstPtr& build,
+                const epics::pvData::shared_vector<const void>& value,
+                ClientChannel::PutCallback::Args& args);
+
+}} // namespace pvac::detail
+
+#endif // CLIENTPVT_H
@@ -96,10 +96,13 @@ class epicsShareClass Monitor : public virtual Destroyable{
         size_t nfilled; //!< # of elements ready to be poll()d
         size_t noutstanding; //!< # of elements poll()d but not released()d
         size_t nempty; //!< # of elements available for new remote data
+        size_t window; //!< pipeline credit window, # of elements the server may send ahead (0 if not pipelined)
+        double rtt; //!< measured round trip time of the credits, in seconds (0 if not measured)
     };
 
     virtual void getStats(Stats& s) const {
-        s.nfilled = s.noutstanding = s.nempty = 0;
+        s.nfilled = s.noutstanding = s.nempty = s.window = 0;
+        s.rtt = 0.0;
     }
 
     /**
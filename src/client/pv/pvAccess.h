@@ -745,6 +745,28 @@ public:
      * @param pvArgument The argument structure for an RPC request.
      */
     virtual void request(epics::pvData::PVStructure::shared_pointer const & pvArgument) = 0;
+
+    /**
+     * Check if several requests may be outstanding at once, see multiplexedRequest().
+     * Only known after ChannelRPCRequester::channelRPCConnect(), may change on reconnect.
+     * The pva provider requires the "record[multiplex=true]" pvRequest option and a server supporting it.
+     */
+    virtual bool isMultiplexed() { return false; }
+
+    /**
+     * Issue an RPC request which completes independently of other requests.
+     *
+     * Completion status is reported by calling requestDone() of the given requester,
+     * instead of the one given to Channel::createChannelRPC().
+     * Responses may arrive in any order.
+     *
+     * @pre isMultiplexed(), otherwise requestDone() is called with an error.
+     *
+     * @param pvArgument The argument structure for an RPC request.
+     * @param requester The requester notified of this request only.
+     */
+    virtual void multiplexedRequest(epics::pvData::PVStructure::shared_pointer const & pvArgument,
+                                    std::tr1::shared_ptr<ChannelRPCRequester> const & requester);
 };
 
 
@@ -1238,6 +1260,37 @@ public:
     virtual Channel::shared_pointer createChannel(std::string const & name,ChannelRequester::shared_pointer const & requester,
             short priority, std::string const & address) = 0;
 
+    /**
+     * Request many Channels at once.
+     *
+     * Equivalent to calling createChannel() for each name, which is what the default implementation does.
+     * Providers may override this to batch the work.
+     *
+     * @param names The names of the channels.
+     * @param requesters Requester of each channel, must be the same length as names.
+     * @param priority channel priority, as for createChannel().
+     * @param address as for createChannel().
+     * @return Channels in the order of names, as returned by createChannel().
+     * @throws std::logic_error if names and requesters lengths differ.
+     */
+    virtual std::vector<Channel::shared_pointer> createChannels(std::vector<std::string> const & names,
+            std::vector<ChannelRequester::shared_pointer> const & requesters,
+            short priority = PRIORITY_DEFAULT, std::string const & address = std::string());
+
+    /**
+     * Start a batch of operations on the calling thread.
+     *
+     * Until the matching endBatch(), the provider may hold back sending the requests
+     * of the operations started by this thread, to send them together.
+     * Batches nest, the outermost endBatch() sends.  The default implementation does nothing.
+     */
+    virtual void beginBatch() {}
+
+    /**
+     * End a batch started by beginBatch() on the calling thread.
+     */
+    virtual void endBatch() {}
+
     //! @deprecated Changing of Configuration after start is not supported
     virtual void configure(epics::pvData::PVStructure::shared_pointer /*configuration*/) EPICS_DEPRECATED {};
     //! @deprecated No function
@@ -322,6 +322,13 @@ ChannelRPC::shared_pointer Channel::createChannelRPC(
     return ret;
 }
 
+void ChannelRPC::multiplexedRequest(epics::pvData::PVStructure::shared_pointer const & /*pvArgument*/,
+                                    ChannelRPCRequester::shared_pointer const & requester)
+{
+    requester->requestDone(pvd::Status(pvd::Status::STATUSTYPE_FATAL, "Not Implemented"),
+                           ChannelRPC::shared_pointer(), pvd::PVStructure::shared_pointer());
+}
+
 pvd::Monitor::shared_pointer Channel::createMonitor(
         epics::pvAccess::MonitorRequester::shared_pointer const & requester,
         epics::pvData::PVStructure::shared_pointer const & pvRequest)
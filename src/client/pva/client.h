@@ -6,6 +6,7 @@
 #define PVATESTCLIENT_H
 
 #include <stdexcept>
+#include <vector>
 
 #include <epicsMutex.h>
 
@@ -129,6 +130,7 @@ struct MonitorEvent
         Data=8,      //!< Data queue not empty.  Call Monitor::poll()
     } event;
     std::string message; // set for event=Fail
+    void *priv;
 };
 
 /** Subscription usable w/o callbacks
@@ -164,6 +166,8 @@ private:
     std::tr1::shared_ptr<SImpl> simpl;
 };
 
+class CompletionQueue;
+
 //! information on connect/disconnect
 struct ConnectEvent
 {
@@ -322,6 +326,23 @@ public:
     Monitor monitor(MonitorCallback *cb,
                           epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
 
+    /** Begin a subscription shared with the other shared subscriptions to this Channel with the same pvRequest
+     *
+     * Only one subscription is made to the server, its updates are queued to every
+     * Monitor.  Each Monitor has its own queue, of record._options.queueSize elements
+     * (default 4), the updates of a full queue are squashed into its last element and
+     * marked in Monitor::overrun.  A Monitor joining an active subscription
+     * starts with the latest value.
+     *
+     * Only the same pvRequest, record._options.queueSize included, shares a subscription,
+     * so each server subscription is made with the pvRequest of all its Monitors.
+     * A pipeline=true subscription is not shared.
+     *
+     * @param cb Completion notification callback.  Must outlive Operation (call Operation::cancel() to force release)
+     */
+    Monitor monitorShared(MonitorCallback *cb,
+                          epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
     /** Begin subscription w/o callbacks
      *
      * @param event If not NULL, then subscription events are signaled to this epicsEvent.  Test with poll().
@@ -334,6 +355,28 @@ public:
     MonitorSync monitor(const epics::pvData::PVStructure::const_shared_pointer& pvRequest = epics::pvData::PVStructure::const_shared_pointer(),
                         epicsEvent *event =0);
 
+    //! Issue request to retrieve current PV value, the completion is posted to queue
+    //! @param queue Completion queue.  Must outlive Operation (call Operation::cancel() to force release)
+    //! @param tag CompletionQueue::Completion::tag
+    //! @param pvRequest if NULL defaults to "field()".
+    Operation get(CompletionQueue& queue, void *tag,
+                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
+    //! Initiate request to change the 'value' field, the completion is posted to queue
+    //! @param value new value, a scalar field takes an array of one element
+    Operation put(CompletionQueue& queue, void *tag,
+                  const epics::pvData::shared_vector<const void>& value,
+                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
+    //! Start an RPC call, the completion is posted to queue
+    Operation rpc(CompletionQueue& queue, void *tag,
+                  const epics::pvData::PVStructure::const_shared_pointer& arguments,
+                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
+    //! Begin subscription, the events are posted to queue.  Call Monitor::poll() on MonitorEvent::Data
+    Monitor monitor(CompletionQueue& queue, void *tag,
+                    epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
     //! Connection state change CB
     struct ConnectCallback {
         virtual ~ConnectCallback() {}
@@ -345,8 +388,88 @@ public:
     //! Remove from list of listeners
     void removeConnectListener(ConnectCallback*);
 
+    /** Answer get() from an active monitorShared() subscription when possible
+     *
+     * A get() whose pvRequest is the same as the pvRequest of an active, connected
+     * monitorShared() subscription to this Channel (ignoring record._options.queueSize)
+     * completes at once with the latest value received by the subscription.
+     * While connected the subscription is up to date, so its value is used however
+     * long ago the last update was.  A value is never used after a disconnect.
+     * Otherwise, and for record._options.process requests, get() goes to the server.
+     * The completion callback is then called before get() returns.
+     *
+     * @param maxAge in seconds.  Negative (the default) disables the cache.
+     *        The value of a connected subscription is current, so it is within any maxAge.
+     */
+    void cacheGets(double maxAge);
+
 private:
     std::tr1::shared_ptr<epics::pvAccess::Channel> getChannel();
+    double getCacheAge() const;
+    //! value for get() or NULL, see cacheGets()
+    epics::pvData::PVStructure::const_shared_pointer getCached(const epics::pvData::PVStructure::const_shared_pointer& pvRequest);
+};
+
+/** Queue of operation completions, for event loops
+ *
+ * get(), put(), rpc() and monitor() of ClientChannel with a CompletionQueue post
+ * their completions (monitor events) here, tagged with a user pointer,
+ * instead of calling a callback object on an internal thread.
+ * One thread drains the queue in batches with poll().
+ *
+ * fd() is readable while completions are queued, to add the queue to an external
+ * epoll()/select() loop.  It is an eventfd, written once when the queue becomes
+ * non-empty and read by poll() when emptied.
+ *
+ * The queue must outlive the operations started with it (call Operation::cancel() to force release).
+ */
+class epicsShareClass CompletionQueue
+{
+public:
+    struct Impl;
+
+    //! A completed get/put/rpc, or a monitor event
+    struct Completion {
+        //! as passed when starting the operation
+        void *tag;
+        //! true for a monitor event (see mevent), otherwise a get/put/rpc completion (see event)
+        bool monitor;
+        PutEvent::event_t event;
+        MonitorEvent::event_t mevent;
+        std::string message;
+        //! get/rpc result, NULL unless event==Success
+        epics::pvData::PVStructure::const_shared_pointer value;
+    };
+    typedef std::vector<Completion> Completions;
+
+    CompletionQueue();
+    ~CompletionQueue();
+
+    /** Take all queued completions, does not block.
+     *
+     * @param completions cleared, then filled with the completions in the order they occurred.
+     *        Its storage is recycled by the queue, pass the same vector again to avoid allocations.
+     * @return number of completions
+     */
+    size_t poll(Completions& completions);
+
+    //! Wait until completions are queued
+    //! @return false on timeout
+    bool wait(double timeout);
+
+    //! Readable while completions are queued, -1 where eventfd is not available
+    int fd() const;
+
+private:
+    CompletionQueue(const CompletionQueue&);
+    CompletionQueue& operator=(const CompletionQueue&);
+
+    ClientChannel::GetCallback* getCallback() const;
+    ClientChannel::PutCallback* putCallback() const;
+    ClientChannel::MonitorCallback* monitorCallback() const;
+
+    std::tr1::shared_ptr<Impl> impl;
+    friend class ClientChannel;
 };
 
 //! Central client context.
@@ -376,12 +499,70 @@ public:
     ClientChannel connect(const std::string& name,
                           const ClientChannel::Options& conf = ClientChannel::Options());
 
+    /** Get many Channels
+     *
+     * As connect() for each name, the Channels missing from the cache are created
+     * together with epics::pvAccess::ChannelProvider::createChannels().
+     * Does not block.
+     * @param names channel names
+     * @param channels set to the channels, in the order of names
+     * @throw std::logic_error if a name is an empty string
+     */
+    void connect(const std::vector<std::string>& names,
+                 std::vector<ClientChannel>& channels,
+                 const ClientChannel::Options& conf = ClientChannel::Options());
+
+    //! One channel of getAll() or putAll()
+    struct epicsShareClass BatchItem {
+        //! Channel name
+        std::string name;
+        //! putAll(): new value of the 'value' field, a scalar field takes an array of one element
+        epics::pvData::shared_vector<const void> value;
+        //! Completion, Fail with message "Timeout" if not complete in time
+        PutEvent::event_t event;
+        std::string message;
+        //! getAll(): the value, NULL unless event==Success
+        epics::pvData::PVStructure::const_shared_pointer result;
+
+        BatchItem() :event(PutEvent::Fail) {}
+        explicit BatchItem(const std::string& name) :name(name), event(PutEvent::Fail) {}
+    };
+    typedef std::vector<BatchItem> BatchItems;
+
+    /** Block and retrieve the current values of many PVs
+     *
+     * All the channels are connected and all the gets issued at once,
+     * then one wait for the completion of all of them.
+     * The result of each is in its BatchItem.
+     * @param items channels, updated with the results
+     * @param timeout in seconds, for the whole batch
+     * @param pvRequest if NULL defaults to "field()", used for all the channels
+     * @return number of successful gets
+     */
+    size_t getAll(BatchItems& items,
+                  double timeout = 3.0,
+                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer(),
+                  const ClientChannel::Options& conf = ClientChannel::Options());
+
+    /** Put to the 'value' field of many PVs and block until complete
+     *
+     * As getAll(), with puts of BatchItem::value.
+     * @return number of successful puts
+     */
+    size_t putAll(BatchItems& items,
+                  double timeout = 3.0,
+                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer(),
+                  const ClientChannel::Options& conf = ClientChannel::Options());
+
     //! Remove from channel cache
     bool disconnect(const std::string& name,
                     const ClientChannel::Options& conf = ClientChannel::Options());
 
     //! Clear channel cache
     void disconnect();
+
+    //! ClientChannel::cacheGets() of the channels in the channel cache and of those connected later
+    void cacheGets(double maxAge);
 };
 
 //! @}
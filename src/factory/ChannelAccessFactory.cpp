@@ -6,6 +6,7 @@
 
 #include <map>
 #include <vector>
+#include <stdexcept>
 
 #include <epicsThread.h>
 
@@ -207,6 +208,21 @@ ChannelProvider::createChannel(std::string const & name,
     return createChannel(name, requester, priority, "");
 }
 
+std::vector<Channel::shared_pointer>
+ChannelProvider::createChannels(std::vector<std::string> const & names,
+                                std::vector<ChannelRequester::shared_pointer> const & requesters,
+                                short priority, std::string const & address)
+{
+    if (names.size() != requesters.size())
+        throw std::logic_error("createChannels() names and requesters lengths differ");
+
+    std::vector<Channel::shared_pointer> ret;
+    ret.reserve(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+        ret.push_back(createChannel(names[i], requesters[i], priority, address));
+    return ret;
+}
+
 }
 }
 
@@ -6,12 +6,14 @@
 
 #include <stdexcept>
 #include <vector>
-#include <queue>
+#include <algorithm>
 #include <utility>
 
 #define epicsExportSharedSymbols
 #include <pv/pipelineServer.h>
+#include <pv/serverContextImpl.h>
 #include <pv/wildcard.h>
+#include <pv/spscRing.h>
 
 using namespace epics::pvData;
 using namespace std;
@@ -26,8 +28,8 @@ class ChannelPipelineMonitorImpl :
 {
 private:
 
-    typedef vector<MonitorElement::shared_pointer> FreeElementQueue;
-    typedef queue<MonitorElement::shared_pointer> MonitorElementQueue;
+    // preallocated, the element path (getFreeElement(), putElement(), poll(), release()) does not lock
+    typedef SPSCRing<MonitorElement::shared_pointer> ElementRing;
 
     Channel::shared_pointer m_channel;
     MonitorRequester::shared_pointer m_monitorRequester;
@@ -35,22 +37,58 @@ private:
 
     size_t m_queueSize;
 
-    FreeElementQueue m_freeQueue;
-    MonitorElementQueue m_monitorQueue;
-
-    Mutex m_freeQueueLock;
-    Mutex m_monitorQueueLock;
+    // service thread -> sending thread
+    ElementRing m_monitorQueue;
+    // sending thread (release()) -> service thread
+    ElementRing m_freeQueue;
+
+    // several producer threads (claimElement(), publishElement()) take turns
+    // at the service thread end of the rings
+    enum ReorderState { REORDER_EMPTY, REORDER_READY, REORDER_SKIPPED };
+    Mutex m_claimLock;
+    size_t m_claimSequence;
+    Mutex m_publishLock;
+    size_t m_publishSequence;
+    // published elements waiting for the ones claimed before them, by sequence;
+    // claimElement() stays less than one ring ahead of m_publishSequence, as unordered
+    // elements are sent (and their elements claimed again) while an earlier one is pending
+    std::vector<MonitorElement::shared_pointer> m_reorder;
+    std::vector<char> m_reorderState;
+    size_t m_reorderMask;
+
+    // credit: elements acked by the client (receiving thread) and sent (sending thread),
+    // each written by one thread only
+    AtomicSize m_grantedCount;
+    AtomicSize m_sentCount;
+
+    // guards the changes of the state, reads are atomic
+    Mutex m_stateLock;
+    AtomicSize m_active;
+    AtomicSize m_done;
+    bool m_unlistenReported;
 
-    bool m_active;
     MonitorElement::shared_pointer m_nullMonitorElement;
 
-    size_t m_requestedCount;
-
     bool m_pipeline;
 
-    bool m_done;
+    // adaptive window: produce ahead only as many elements as the client grants credits for,
+    // the elements are created on demand
+    bool m_adaptive;
+    AtomicSize m_window;
+    // written by the service thread (or with m_claimLock held) only
+    AtomicSize m_allocated;
+    Structure::const_shared_pointer m_structure;
 
-    bool m_unlistenReported;
+    // call from the service thread (or with m_claimLock held) only
+    MonitorElement::shared_pointer createElement()
+    {
+        m_allocated.set(m_allocated.get() + 1);
+        PVStructure::shared_pointer pvStructure = getPVDataCreate()->createPVStructure(m_structure);
+        MonitorElement::shared_pointer monitorElement(new MonitorElement(pvStructure));
+        // we always send all
+        monitorElement->changedBitSet->set(0);
+        return monitorElement;
+    }
 
 public:
     ChannelPipelineMonitorImpl(
@@ -61,13 +99,25 @@ public:
         m_channel(channel),
         m_monitorRequester(monitorRequester),
         m_queueSize(2),
-        m_freeQueueLock(),
-        m_monitorQueueLock(),
-        m_active(false),
-        m_requestedCount(0),
+        m_monitorQueue(),
+        m_freeQueue(),
+        m_claimLock(),
+        m_claimSequence(0),
+        m_publishLock(),
+        m_publishSequence(0),
+        m_reorder(),
+        m_reorderState(),
+        m_reorderMask(0),
+        m_grantedCount(0),
+        m_sentCount(0),
+        m_stateLock(),
+        m_active(0),
+        m_done(0),
+        m_unlistenReported(false),
         m_pipeline(false),
-        m_done(false),
-        m_unlistenReported(false)
+        m_adaptive(false),
+        m_window(0),
+        m_allocated(0)
     {
 
         m_pipelineSession = pipelineService->createPipeline(pvRequest);
@@ -87,6 +137,9 @@ public:
             pvString = pvOptions->getSubField<PVString>("pipeline");
             if (pvString)
                 m_pipeline = (pvString->get() == "true");
+            pvString = pvOptions->getSubField<PVString>("adaptive");
+            if (pvString)
+                m_adaptive = (pvString->get() == "true");
         }
 
         // server queue size must be >= client queue size
@@ -94,20 +147,18 @@ public:
         if (m_queueSize < minQueueSize)
             m_queueSize = minQueueSize;
 
-        Structure::const_shared_pointer structure = m_pipelineSession->getStructure();
+        m_structure = m_pipelineSession->getStructure();
 
-        // create free elements
+        // create free elements, each is in one of the rings (or in use), so the rings never overflow
+        m_monitorQueue.reset(m_queueSize);
+        m_freeQueue.reset(m_queueSize);
+        m_reorder.resize(m_freeQueue.capacity());
+        m_reorderState.assign(m_freeQueue.capacity(), REORDER_EMPTY);
+        m_reorderMask = m_freeQueue.capacity() - 1;
+        if (!m_adaptive)
         {
-            Lock guard(m_freeQueueLock);
-            m_freeQueue.reserve(m_queueSize);
             for (size_t i = 0; i < m_queueSize; i++)
-            {
-                PVStructure::shared_pointer pvStructure = getPVDataCreate()->createPVStructure(structure);
-                MonitorElement::shared_pointer monitorElement(new MonitorElement(pvStructure));
-                // we always send all
-                monitorElement->changedBitSet->set(0);
-                m_freeQueue.push_back(monitorElement);
-            }
+                m_freeQueue.push(createElement());
         }
     }
 
@@ -126,19 +177,16 @@ public:
 
     virtual Status start()
     {
-        bool notify = false;
         {
-            Lock guard(m_monitorQueueLock);
+            Lock guard(m_stateLock);
 
             // already started
-            if (m_active)
+            if (m_active.get())
                 return Status::Ok;
-            m_active = true;
-
-            notify = (m_monitorQueue.size() != 0);
+            m_active.set(1);
         }
 
-        if (notify)
+        if (!m_monitorQueue.empty())
         {
             Monitor::shared_pointer thisPtr = shared_from_this();
             m_monitorRequester->monitorEvent(thisPtr);
@@ -149,46 +197,50 @@ public:
 
     virtual Status stop()
     {
-        Lock guard(m_monitorQueueLock);
-        m_active = false;
+        Lock guard(m_stateLock);
+        m_active.set(0);
         return Status::Ok;
     }
 
-    // get next free element
+    // get next element to send, called by the sending thread only
     virtual MonitorElement::shared_pointer poll()
     {
-        Lock guard(m_monitorQueueLock);
-
-        // do not give send more elements than m_requestedCount
+        // do not give send more elements than requested by the client
         // even if m_monitorQueue is not empty
-        bool emptyQueue = m_monitorQueue.empty();
-        if (emptyQueue || m_requestedCount == 0 || !m_active)
+        const size_t sent = m_sentCount.get();
+        if (m_active.get() && m_grantedCount.get() != sent)
         {
-            // report "unlisten" event if queue empty and done, release lock first
-            if (!m_unlistenReported && m_done && emptyQueue)
+            MonitorElement::shared_pointer element;
+            if (m_monitorQueue.pop(element))
             {
-                m_unlistenReported = true;
-                guard.unlock();
-                m_monitorRequester->unlisten(shared_from_this());
+                m_sentCount.set(sent + 1);
+                return element;
             }
-
-            return m_nullMonitorElement;
         }
 
-        MonitorElement::shared_pointer element = m_monitorQueue.front();
-        m_monitorQueue.pop();
-
-        m_requestedCount--;
+        // report "unlisten" event if queue empty and done
+        if (m_done.get() && m_monitorQueue.empty())
+        {
+            bool report;
+            {
+                Lock guard(m_stateLock);
+                report = !m_unlistenReported;
+                m_unlistenReported = true;
+            }
+            if (report)
+                m_monitorRequester->unlisten(shared_from_this());
+        }
 
-        return element;
+        return m_nullMonitorElement;
     }
 
+    // called by the sending thread only
     virtual void release(MonitorElement::shared_pointer const & monitorElement)
     {
-        Lock guard(m_freeQueueLock);
-        m_freeQueue.push_back(monitorElement);
+        m_freeQueue.push(monitorElement);
     }
 
+    // called by the receiving thread only, with the client acks
     virtual void reportRemoteQueueStatus(int32 freeElements)
     {
         // TODO check
@@ -196,16 +248,19 @@ public:
 
         //std::cout << "reportRemoteQueueStatus(" << count << ')' << std::endl;
 
-        bool notify = false;
+        m_grantedCount.set(m_grantedCount.get() + count);
+
+        if (m_adaptive)
         {
-            Lock guard(m_monitorQueueLock);
-            m_requestedCount += count;
-            notify = m_active && (m_monitorQueue.size() != 0);
+            // the credits the client keeps in flight, follows increases at once, decreases slowly
+            const size_t inFlight = getRequestedCount();
+            const size_t window = m_window.get();
+            m_window.set(std::max(inFlight, window - window/8));
         }
 
         // notify
         // TODO too many notify calls?
-        if (notify)
+        if (m_active.get() && !m_monitorQueue.empty())
         {
             Monitor::shared_pointer thisPtr = shared_from_this();
             m_monitorRequester->monitorEvent(thisPtr);
@@ -219,10 +274,10 @@ public:
         bool notifyCancel = false;
 
         {
-            Lock guard(m_monitorQueueLock);
-            m_active = false;
-            notifyCancel = !m_done;
-            m_done = true;
+            Lock guard(m_stateLock);
+            m_active.set(0);
+            notifyCancel = !m_done.get();
+            m_done.set(1);
         }
 
         if (notifyCancel)
@@ -230,43 +285,115 @@ public:
     }
 
     virtual size_t getFreeElementCount() {
-        Lock guard(m_freeQueueLock);
-        return m_freeQueue.size();
+        if (!m_adaptive)
+            return m_freeQueue.size();
+
+        // one window ahead
+        const size_t queued = m_monitorQueue.size();
+        const size_t window = m_window.get();
+        const size_t ahead = (window > queued) ? window - queued : 0;
+        return std::min(ahead, m_freeQueue.size() + (m_queueSize - m_allocated.get()));
+    }
+
+    virtual void getStats(Stats& s) const {
+        s.nfilled = m_monitorQueue.size();
+        s.nempty = m_freeQueue.size();
+        s.noutstanding = 0;
+        s.window = m_adaptive ? m_window.get() : m_queueSize;
+        s.rtt = 0.0;
     }
 
     virtual size_t getRequestedCount() {
-        // TODO consider using atomic ops
-        Lock guard(m_monitorQueueLock);
-        return m_requestedCount;
+        // sent first, it never exceeds granted
+        const size_t sent = m_sentCount.get();
+        return m_grantedCount.get() - sent;
     }
 
+    // called by the service (producer) thread only
     virtual MonitorElement::shared_pointer getFreeElement() {
-        Lock guard(m_freeQueueLock);
-        if (m_freeQueue.empty())
-            return m_nullMonitorElement;
+        MonitorElement::shared_pointer freeElement;
+        if (m_adaptive && m_monitorQueue.size() >= m_window.get())
+            return freeElement;
+        if (!m_freeQueue.pop(freeElement) && m_adaptive && m_allocated.get() < m_queueSize)
+            freeElement = createElement();
+        return freeElement;
+    }
+
+    // called by the service (producer) thread only
+    virtual void putElement(MonitorElement::shared_pointer const & element) {
+
+        if (m_done.get())
+            return;
+        // throw std::logic_error("putElement called after done");
+
+        m_monitorQueue.push(element);
+
+        // notify
+        // TODO there is way to much of notification, per each putElement
+        if (getRequestedCount() != 0)
+        {
+            Monitor::shared_pointer thisPtr = shared_from_this();
+            m_monitorRequester->monitorEvent(thisPtr);
+        }
+    }
 
-        MonitorElement::shared_pointer freeElement = m_freeQueue.back();
-        m_freeQueue.pop_back();
+    // called by any producer thread
+    virtual MonitorElement::shared_pointer claimElement(size_t& sequence) {
+        Lock guard(m_claimLock);
 
+        // the slot of m_claimSequence must not be in use by a pending sequence
+        {
+            Lock publishGuard(m_publishLock);
+            if (m_claimSequence - m_publishSequence >= m_reorder.size())
+                return m_nullMonitorElement;
+        }
+
+        MonitorElement::shared_pointer freeElement(getFreeElement());
+        if (freeElement)
+            sequence = m_claimSequence++;
         return freeElement;
     }
 
-    virtual void putElement(MonitorElement::shared_pointer const & element) {
+    // called by any producer thread
+    virtual void publishElement(MonitorElement::shared_pointer const & element, size_t sequence, bool ordered) {
 
-        bool notify = false;
+        if (m_done.get())
+            return;
+
+        bool published = false;
         {
-            Lock guard(m_monitorQueueLock);
-            if (m_done)
-                return;
-            // throw std::logic_error("putElement called after done");
-
-            m_monitorQueue.push(element);
-            // TODO there is way to much of notification, per each putElement
-            notify = (m_requestedCount != 0);
+            Lock guard(m_publishLock);
+
+            const size_t slot = sequence & m_reorderMask;
+            if (ordered)
+            {
+                m_reorder[slot] = element;
+                m_reorderState[slot] = REORDER_READY;
+            }
+            else
+            {
+                // goes out at once, the later ordered elements must not wait for it
+                m_monitorQueue.push(element);
+                m_reorderState[slot] = REORDER_SKIPPED;
+                published = true;
+            }
+
+            // queue the elements which are next in sequence
+            size_t next;
+            while (m_reorderState[next = (m_publishSequence & m_reorderMask)] != REORDER_EMPTY)
+            {
+                if (m_reorderState[next] == REORDER_READY)
+                {
+                    m_monitorQueue.push(m_reorder[next]);
+                    m_reorder[next].reset();
+                    published = true;
+                }
+                m_reorderState[next] = REORDER_EMPTY;
+                m_publishSequence++;
+            }
         }
 
-        // notify
-        if (notify)
+        if (published && getRequestedCount() != 0)
         {
             Monitor::shared_pointer thisPtr = shared_from_this();
             m_monitorRequester->monitorEvent(thisPtr);
@@ -274,14 +401,15 @@ public:
     }
 
     virtual void done() {
-        Lock guard(m_monitorQueueLock);
-        m_done = true;
-
-        bool report = !m_unlistenReported && m_monitorQueue.empty();
-        if (report)
-            m_unlistenReported = true;
+        bool report;
+        {
+            Lock guard(m_stateLock);
+            m_done.set(1);
 
-        guard.unlock();
+            report = !m_unlistenReported && m_monitorQueue.empty();
+            if (report)
+                m_unlistenReported = true;
+        }
 
         if (report)
             m_monitorRequester->unlisten(shared_from_this());
@@ -629,6 +757,14 @@ PipelineServer::PipelineServer()
                                             .provider(m_channelProviderImpl));
 }
 
+PipelineServer::PipelineServer(const Configuration::const_shared_pointer& conf)
+    :m_channelProviderImpl(new PipelineChannelProvider)
+{
+    m_serverContext = ServerContext::create(ServerContext::Config()
+                                            .config(conf)
+                                            .provider(m_channelProviderImpl));
+}
+
 PipelineServer::~PipelineServer()
 {
     // multiple destroy call is OK
@@ -659,14 +795,26 @@ void PipelineServer::destroy()
     m_serverContext->shutdown();
 }
 
+namespace {
+// the server advertises hosted channel names in beacons
+void channelListChanged(ServerContext::shared_pointer const & context)
+{
+    ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<ServerContextImpl>(context));
+    if (impl)
+        impl->beaconChannelListChanged();
+}
+}
+
 void PipelineServer::registerService(std::string const & serviceName, PipelineService::shared_pointer const & service)
 {
     m_channelProviderImpl->registerService(serviceName, service);
+    channelListChanged(m_serverContext);
 }
 
 void PipelineServer::unregisterService(std::string const & serviceName)
 {
     m_channelProviderImpl->unregisterService(serviceName);
+    channelListChanged(m_serverContext);
 }
 
 }
@@ -45,6 +45,8 @@ public:
 
     PipelineServer();
 
+    explicit PipelineServer(const Configuration::const_shared_pointer& conf);
+
     virtual ~PipelineServer();
 
     void registerService(std::string const & serviceName, PipelineService::shared_pointer const & service);
@@ -64,6 +66,7 @@ public:
      */
     void printInfo();
 
+    const ServerContext::shared_pointer& getServer() const { return m_serverContext; }
 };
 
 epicsShareFunc Channel::shared_pointer createPipelineChannel(ChannelProvider::shared_pointer const & provider,
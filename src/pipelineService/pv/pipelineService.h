@@ -52,7 +52,24 @@ public:
     /// Put element on the local queue (an element to be sent to a client).
     virtual void putElement(MonitorElement::shared_pointer const & element) = 0;
 
+    /// Grab next free element, for services filling elements from several threads.
+    /// Like getFreeElement(), but thread-safe, and the element gets the next sequence number.
+    /// Every claimed element must be given back by calling publishElement().
+    /// Not to be mixed with getFreeElement()/putElement() in one session.
+    /// @param sequence set to the sequence number of the element.
+    /// @return the element, null if there is no free element, or if the element claimed
+    /// a queue size before is still not published.
+    virtual MonitorElement::shared_pointer claimElement(size_t& sequence) = 0;
+
+    /// Put a claimed element on the local queue, thread-safe.
+    /// @param element the element, populated with the data.
+    /// @param sequence the sequence number from claimElement().
+    /// @param ordered if true the element is sent after all the elements claimed before it,
+    /// i.e. it waits for them to be published, otherwise it is sent as soon as possible.
+    virtual void publishElement(MonitorElement::shared_pointer const & element, size_t sequence, bool ordered = true) = 0;
+
     /// Call to notify that there is no more data to pipelined.
+    /// With several producer threads, call after all the claimed elements are published.
     /// This call destroyes corresponding pipeline session.
     virtual void done() = 0;
 
@@ -24,7 +24,8 @@ BeaconHandler::BeaconHandler(Context::shared_pointer const & context,
     _mutex(),
     _serverGUID(),
     _serverChangeCount(-1),
-    _first(true)
+    _first(true),
+    _channelFilter()
 {
 
 }
@@ -36,8 +37,10 @@ BeaconHandler::~BeaconHandler()
 void BeaconHandler::beaconNotify(osiSockAddr* /*from*/, int8 remoteTransportRevision,
                                  TimeStamp* timestamp, ServerGUID const & guid, int16 sequentalID,
                                  int16 changeCount,
-                                 PVFieldPtr /*data*/)
+                                 PVFieldPtr data)
 {
+    updateChannelFilter(data);
+
     bool networkChanged = updateBeacon(remoteTransportRevision, timestamp, guid, sequentalID, changeCount);
     if (networkChanged)
         changedTransport();
@@ -85,6 +88,38 @@ bool BeaconHandler::updateBeacon(int8 /*remoteTransportRevision*/, TimeStamp* /*
     return false;
 }
 
+void BeaconHandler::updateChannelFilter(PVFieldPtr const & data)
+{
+    BloomFilter filter;
+
+    PVStructure::shared_pointer filterData(std::tr1::dynamic_pointer_cast<PVStructure>(data));
+    if (filterData && filterData->getStructure()->getID() == "channelFilter_t")
+    {
+        PVUByteArray::shared_pointer bits(filterData->getSubField<PVUByteArray>("bits"));
+        PVInt::shared_pointer hashCount(filterData->getSubField<PVInt>("hashCount"));
+        if (bits && hashCount && hashCount->get() > 0)
+        {
+            PVUByteArray::const_svector view(bits->view());
+            BloomFilter(BloomFilter::bits_t(view.begin(), view.end()), hashCount->get()).swap(filter);
+        }
+    }
+
+    Lock guard(_mutex);
+    _channelFilter.swap(filter);
+}
+
+bool BeaconHandler::mightHostChannel(BloomFilter::Hash const & hash)
+{
+    Lock guard(_mutex);
+    return _channelFilter.mightContain(hash);
+}
+
+bool BeaconHandler::hasChannelFilter()
+{
+    Lock guard(_mutex);
+    return !_channelFilter.empty();
+}
+
 void BeaconHandler::changedTransport()
 {
     auto_ptr<TransportRegistry::transportVector_t> transports =
@@ -25,11 +25,13 @@ namespace pvAccess {
 BlockingTCPConnector::BlockingTCPConnector(
     Context::shared_pointer const & context,
     int receiveBufferSize,
-    float heartbeatInterval) :
+    float heartbeatInterval,
+    float livenessTimeout) :
     _context(context),
     _namedLocker(),
     _receiveBufferSize(receiveBufferSize),
-    _heartbeatInterval(heartbeatInterval)
+    _heartbeatInterval(heartbeatInterval),
+    _livenessTimeout(livenessTimeout)
 {
 }
 
@@ -156,7 +158,7 @@ Transport::shared_pointer BlockingTCPConnector::connect(TransportClient::shared_
 
             transport = detail::BlockingClientTCPTransportCodec::create(
                             context, socket, responseHandler, _receiveBufferSize, _socketSendBufferSize,
-                            client, transportRevision, _heartbeatInterval, priority);
+                            client, transportRevision, _heartbeatInterval, _livenessTimeout, priority);
 
             // verify
             if(!transport->verify(5000)) {
@@ -55,6 +55,7 @@ BlockingUDPTransport::BlockingUDPTransport(bool serverFlag,
     _sendAddresses(0),
     _ignoredAddresses(0),
     _tappedNIF(0),
+    _originTagged(false),
     _sendToEnabled(false),
     _localMulticastAddressEnabled(false),
     _receiveBuffer(MAX_UDP_RECV+RECEIVE_BUFFER_PRE_RESERVE),
@@ -297,6 +298,7 @@ void BlockingUDPTransport::run() {
 bool BlockingUDPTransport::processBuffer(Transport::shared_pointer const & transport,
         osiSockAddr& fromAddress, ByteBuffer* receiveBuffer) {
 
+    _originTagged = false;
 
     // handle response(s)
     while(likely((int)receiveBuffer->getRemaining()>=PVA_MESSAGE_HEADER_SIZE)) {
@@ -342,6 +344,8 @@ bool BlockingUDPTransport::processBuffer(Transport::shared_pointer const & trans
         // NOTE: from design point of view this is not a right place to process application message here
         if (unlikely(command == CMD_ORIGIN_TAG))
         {
+            _originTagged = true;
+
             // enabled?
             if (!_tappedNIF.empty())
             {
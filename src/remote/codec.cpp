@@ -1332,6 +1332,7 @@ int BlockingTCPTransportCodec::read(epics::pvData::ByteBuffer* dst) {
         }
 
         dst->setPosition(dst->getPosition() + bytesRead);
+        _readCount.increment();
         return bytesRead;
     }
 
@@ -1409,7 +1410,7 @@ BlockingServerTCPTransportCodec::BlockingServerTCPTransportCodec(
     int32_t receiveBufferSize) :
     BlockingTCPTransportCodec(true, context, channel, responseHandler,
                               sendBufferSize, receiveBufferSize, PVA_DEFAULT_PRIORITY),
-    _lastChannelSID(0), _verifyOrVerified(false), _securityRequired(false)
+    _verifyOrVerified(false), _securityRequired(false)
 {
     // NOTE: priority not yet known, default priority is used to
     //register/unregister
@@ -1425,11 +1426,18 @@ BlockingServerTCPTransportCodec::~BlockingServerTCPTransportCodec() {
 pvAccessID BlockingServerTCPTransportCodec::preallocateChannelSID() {
 
     Lock lock(_channelsMutex);
-    // search first free (theoretically possible loop of death)
-    pvAccessID sid = ++_lastChannelSID;
-    while(_channels.find(sid)!=_channels.end())
-        sid = ++_lastChannelSID;
-    return sid;
+    // reserve SID
+    return _channels.insert(ServerChannel::shared_pointer());
+}
+
+
+void BlockingServerTCPTransportCodec::depreallocateChannelSID(pvAccessID sid) {
+
+    Lock lock(_channelsMutex);
+    // only if registerChannel() was not called
+    ServerChannel::shared_pointer* channel = _channels.find(sid);
+    if(channel && !*channel)
+        _channels.erase(sid);
 }
 
 
@@ -1438,7 +1446,8 @@ void BlockingServerTCPTransportCodec::registerChannel(
     ServerChannel::shared_pointer const & channel) {
 
     Lock lock(_channelsMutex);
-    _channels[sid] = channel;
+    ServerChannel::shared_pointer* slot = _channels.find(sid);
+    if(slot) *slot = channel;
 
 }
 
@@ -1455,10 +1464,9 @@ BlockingServerTCPTransportCodec::getChannel(pvAccessID sid) {
 
     Lock lock(_channelsMutex);
 
-    std::map<pvAccessID, ServerChannel::shared_pointer>::iterator it =
-        _channels.find(sid);
+    ServerChannel::shared_pointer* channel = _channels.find(sid);
 
-    if(it!=_channels.end()) return it->second;
+    if(channel) return *channel;
 
     return ServerChannel::shared_pointer();
 }
@@ -1552,7 +1560,7 @@ void BlockingServerTCPTransportCodec::send(ByteBuffer* buffer,
 
 void BlockingServerTCPTransportCodec::destroyAllChannels() {
     Lock lock(_channelsMutex);
-    if(_channels.size()==0) return;
+    if(_channels.empty()) return;
 
     if (IS_LOGGABLE(logLevelDebug))
     {
@@ -1562,9 +1570,10 @@ void BlockingServerTCPTransportCodec::destroyAllChannels() {
             _socketName.c_str(), _channels.size());
     }
 
-    std::map<pvAccessID, ServerChannel::shared_pointer>::iterator it = _channels.begin();
-    for(; it!=_channels.end(); it++)
-        it->second->destroy();
+    std::vector<ServerChannel::shared_pointer> channels;
+    _channels.values(channels);
+    for(size_t i=0; i<channels.size(); i++)
+        if(channels[i]) channels[i]->destroy();
 
     _channels.clear();
 }
@@ -1670,11 +1679,16 @@ BlockingClientTCPTransportCodec::BlockingClientTCPTransportCodec(
     TransportClient::shared_pointer const & client,
     epics::pvData::int8 /*remoteTransportRevision*/,
     float heartbeatInterval,
+    float livenessTimeout,
     int16_t priority ) :
     BlockingTCPTransportCodec(false, context, channel, responseHandler,
                               sendBufferSize, receiveBufferSize, priority),
-    _connectionTimeout(heartbeatInterval*1000),
+    _heartbeatInterval(heartbeatInterval),
+    // an echo has to have a chance to be answered
+    _livenessTimeout(livenessTimeout > heartbeatInterval ? livenessTimeout : 2*heartbeatInterval),
     _unresponsiveTransport(false),
+    _lastReadCount(0),
+    _echoPending(false),
     _verifyOrEcho(true)
 {
     // initialize owners list, send queue
@@ -1689,8 +1703,9 @@ BlockingClientTCPTransportCodec::BlockingClientTCPTransportCodec(
 
 void BlockingClientTCPTransportCodec::start()
 {
-    TimerCallbackPtr tcb = std::tr1::dynamic_pointer_cast<TimerCallback>(shared_from_this());
-    _context->getTimer()->schedulePeriodic(tcb, _connectionTimeout, _connectionTimeout);
+    HeartbeatService::shared_pointer heartbeatService(_context->getHeartbeatService());
+    if (heartbeatService)
+        heartbeatService->add(std::tr1::dynamic_pointer_cast<HeartbeatService::Client>(shared_from_this()));
     BlockingTCPTransportCodec::start();
 }
 
@@ -1705,20 +1720,39 @@ BlockingClientTCPTransportCodec::~BlockingClientTCPTransportCodec() {
 
 
 
-void BlockingClientTCPTransportCodec::callback() {
-    epicsTimeStamp currentTime;
-    epicsTimeGetCurrent(&currentTime);
+void BlockingClientTCPTransportCodec::heartbeatSweep(epicsTimeStamp const & now) {
+    const std::size_t readCount = _readCount.get();
 
-    _mutex.lock();
-    // no exception expected here
-    double diff = epicsTimeDiffInSeconds(&currentTime, &_aliveTimestamp);
-    _mutex.unlock();
+    Lock lock(_mutex);
+    if(readCount!=_lastReadCount) {
+        // traffic received since the last sweep, no need to ask for a sign of life
+        _lastReadCount = readCount;
+        _aliveTimestamp = now;
+        _echoPending = false;
+        if(_unresponsiveTransport) responsiveTransport();
+        return;
+    }
+
+    double diff = epicsTimeDiffInSeconds(&now, &_aliveTimestamp);
+
+    if(diff>=_livenessTimeout) {
+        lock.unlock();
 
-    if(diff>((3*_connectionTimeout)/2)) {
+        if (IS_LOGGABLE(logLevelDebug))
+        {
+            LOG(logLevelDebug, "No traffic from %s for %f s, closing the transport.",
+                _socketName.c_str(), diff);
+        }
+
+        // let the channels disconnect (and search again), then drop the connection
         unresponsiveTransport();
+        close();
     }
-    // use some k (3/4) to handle "jitter"
-    else if(diff>=((3*_connectionTimeout)/4)) {
+    // one echo per idle period
+    else if(diff>=_heartbeatInterval && !_echoPending) {
+        _echoPending = true;
+        lock.unlock();
+
         // send echo
         TransportSender::shared_pointer transportSender = std::tr1::dynamic_pointer_cast<TransportSender>(shared_from_this());
         enqueueSendRequest(transportSender);
@@ -1730,19 +1764,26 @@ void BlockingClientTCPTransportCodec::callback() {
                 catch (...) { LOG(logLevelError, "Unhandled exception caught from code at %s:%d.", __FILE__, __LINE__); }
 
 void BlockingClientTCPTransportCodec::unresponsiveTransport() {
-    Lock lock(_mutex);
-    if(!_unresponsiveTransport) {
+    std::vector<TransportClient::shared_pointer> clients;
+    {
+        Lock lock(_mutex);
+        if(_unresponsiveTransport)
+            return;
         _unresponsiveTransport = true;
 
+        // notified w/o lock, clients release the transport (modify _owners)
+        clients.reserve(_owners.size());
         TransportClientMap_t::iterator it = _owners.begin();
         for(; it!=_owners.end(); it++) {
             TransportClient::shared_pointer client = it->second.lock();
             if (client)
-            {
-                EXCEPTION_GUARD(client->transportUnresponsive());
-            }
+                clients.push_back(client);
         }
     }
+
+    for(size_t i=0; i<clients.size(); i++) {
+        EXCEPTION_GUARD(clients[i]->transportUnresponsive());
+    }
 }
 
 bool BlockingClientTCPTransportCodec::acquire(TransportClient::shared_pointer const & client) {
@@ -1764,8 +1805,9 @@ bool BlockingClientTCPTransportCodec::acquire(TransportClient::shared_pointer co
 void BlockingClientTCPTransportCodec::internalClose(bool forced) {
     BlockingTCPTransportCodec::internalClose(forced);
 
-    TimerCallbackPtr tcb = std::tr1::dynamic_pointer_cast<TimerCallback>(shared_from_this());
-    _context->getTimer()->cancel(tcb);
+    HeartbeatService::shared_pointer heartbeatService(_context->getHeartbeatService());
+    if (heartbeatService)
+        heartbeatService->remove(this);
 }
 
 void BlockingClientTCPTransportCodec::internalPostClose(bool forced) {
@@ -1830,6 +1872,7 @@ void BlockingClientTCPTransportCodec::release(pvAccessID clientID) {
 void BlockingClientTCPTransportCodec::aliveNotification() {
     Lock guard(_mutex);
     epicsTimeGetCurrent(&_aliveTimestamp);
+    _echoPending = false;
     if(_unresponsiveTransport) responsiveTransport();
 }
 
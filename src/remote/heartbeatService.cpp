@@ -0,0 +1,118 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+
+#define epicsExportSharedSymbols
+#include <pv/heartbeatService.h>
+#include <pv/logger.h>
+
+using namespace epics::pvData;
+
+namespace epics {
+namespace pvAccess {
+
+HeartbeatService::HeartbeatService(TimingWheel::shared_pointer const & timingWheel, double period) :
+    _timingWheel(timingWheel),
+    _period(period),
+    _clients(),
+    _mutex(),
+    _timerEntry()
+{
+}
+
+HeartbeatService::~HeartbeatService()
+{
+}
+
+// The timer is (re)scheduled and cancelled with _mutex held, together with the
+// change of _clients it follows from, so that a concurrent remove() of the last
+// client cannot cancel the sweeps an add() has just restarted.
+// TimingWheel does not call back with its own lock held.
+
+void HeartbeatService::add(Client::shared_pointer const & client)
+{
+    TimingWheel::shared_pointer timingWheel(_timingWheel.lock());
+
+    Lock guard(_mutex);
+    bool first = _clients.empty();
+    _clients[client.get()] = client;
+
+    if (first && timingWheel && !timingWheel->isScheduled(_timerEntry))
+        timingWheel->schedule(_timerEntry, shared_from_this(), _period, _period);
+}
+
+void HeartbeatService::remove(Client const * client)
+{
+    TimingWheel::shared_pointer timingWheel(_timingWheel.lock());
+    // cancel() releases the reference the timer holds to us, keep one until unlocked
+    HeartbeatService::shared_pointer self(shared_from_this());
+
+    Lock guard(_mutex);
+    if (!_clients.erase(client))
+        return;
+
+    if (_clients.empty() && timingWheel)
+        timingWheel->cancel(_timerEntry);
+}
+
+std::size_t HeartbeatService::size()
+{
+    Lock guard(_mutex);
+    return _clients.size();
+}
+
+void HeartbeatService::callback()
+{
+    std::vector<Client::shared_pointer> clients;
+    {
+        Lock guard(_mutex);
+        clients.reserve(_clients.size());
+        for (clients_t::iterator it = _clients.begin(); it != _clients.end(); )
+        {
+            Client::shared_pointer client(it->second.lock());
+            if (client)
+            {
+                clients.push_back(client);
+                it++;
+            }
+            else
+            {
+                _clients.erase(it++);
+            }
+        }
+
+        if (_clients.empty())
+        {
+            // add() restarts the sweeps, the timer holds a reference to us while calling back
+            TimingWheel::shared_pointer timingWheel(_timingWheel.lock());
+            if (timingWheel)
+                timingWheel->cancel(_timerEntry);
+            return;
+        }
+    }
+
+    // one time stamp per sweep
+    epicsTimeStamp now;
+    epicsTimeGetCurrent(&now);
+
+    for (std::size_t i = 0; i < clients.size(); i++)
+    {
+        try {
+            clients[i]->heartbeatSweep(now);
+        } catch (std::exception& e) {
+            LOG(logLevelError, "Unhandled exception caught from heartbeat sweep: %s", e.what());
+        }
+    }
+}
+
+void HeartbeatService::timerStopped()
+{
+    // noop
+}
+
+}
+}
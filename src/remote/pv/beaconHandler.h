@@ -25,6 +25,7 @@
 #include <pv/pvaDefs.h>
 #include <pv/remote.h>
 #include <pv/pvAccess.h>
+#include <pv/bloomFilter.h>
 
 namespace epics {
 namespace pvAccess {
@@ -61,6 +62,19 @@ public:
                       epics::pvData::int16 sequentalID,
                       epics::pvData::int16 changeCount,
                       epics::pvData::PVFieldPtr data);
+
+    /**
+     * Check the channel filter advertised in beacons.
+     * @param hash hash of the channel name.
+     * @return <code>true</code> if the server advertises a filter and the name might be in it.
+     */
+    bool mightHostChannel(BloomFilter::Hash const & hash);
+
+    /**
+     * Does the server advertise a channel filter in its beacons.
+     * @return <code>true</code> if it does.
+     */
+    bool hasChannelFilter();
 private:
     /**
      * Context instance.
@@ -90,6 +104,16 @@ private:
      * First beacon flag.
      */
     bool _first;
+    /**
+     * Filter of channel names hosted by the server, empty if not advertised.
+     */
+    BloomFilter _channelFilter;
+
+    /**
+     * Update channel filter from beacon data.
+     * @param data server status data, can be <code>NULL</code>.
+     */
+    void updateChannelFilter(epics::pvData::PVFieldPtr const & data);
 
     /**
      * Update beacon.
@@ -52,7 +52,7 @@ public:
     POINTER_DEFINITIONS(BlockingTCPConnector);
 
     BlockingTCPConnector(Context::shared_pointer const & context, int receiveBufferSize,
-                         float beaconInterval);
+                         float heartbeatInterval, float livenessTimeout);
 
     virtual ~BlockingTCPConnector();
 
@@ -85,6 +85,11 @@ private:
      */
     float _heartbeatInterval;
 
+    /**
+     * Liveness timeout.
+     */
+    float _livenessTimeout;
+
     /**
      * Tries to connect to the given address.
      * @param[in] address
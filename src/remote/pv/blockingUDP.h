@@ -281,6 +281,15 @@ public:
         return _tappedNIF;
     }
 
+    /**
+     * Check if the datagram being processed is tagged with CMD_ORIGIN_TAG,
+     * i.e. it was forwarded to the local multicast group.
+     * Only valid while a response handler is called.
+     */
+    bool isOriginTagged() const {
+        return _originTagged;
+    }
+
     bool send(const char* buffer, size_t length, const osiSockAddr& address);
 
     bool send(epics::pvData::ByteBuffer* buffer, const osiSockAddr& address);
@@ -388,6 +397,11 @@ private:
      */
     InetAddrVector _tappedNIF;
 
+    /**
+     * CMD_ORIGIN_TAG seen in the datagram being processed.
+     */
+    bool _originTagged;
+
     /**
      * Send address.
      */
@@ -38,6 +38,8 @@
 #include <pv/introspectionRegistry.h>
 #include <pv/namedLockPattern.h>
 #include <pv/inetAddressUtil.h>
+#include <pv/idTable.h>
+#include <pv/heartbeatService.h>
 
 /* C++11 keywords
  @code
@@ -89,6 +91,9 @@ public:
     inline T get() {
         return epics::atomic::get(val);
     }
+    inline T increment() {
+        return epics::atomic::increment(val);
+    }
 };
 // treat bool as int
 template<>
@@ -128,6 +133,13 @@ public:
         return tmp;
     }
 
+    T increment() {
+        mutex.lock();
+        T tmp = ++_value;
+        mutex.unlock();
+        return tmp;
+    }
+
 private:
     T _value;
     epics::pvData::Mutex mutex;
@@ -478,6 +490,11 @@ protected:
 
     SecuritySession::shared_pointer _securitySession;
 
+    /**
+     * Number of successful socket reads, any traffic proves the peer is alive.
+     */
+    AtomicValue<std::size_t> _readCount;
+
 private:
 
     ResponseHandler::shared_pointer _responseHandler;
@@ -536,9 +553,7 @@ public:
 
     virtual pvAccessID preallocateChannelSID() OVERRIDE FINAL;
 
-    virtual void depreallocateChannelSID(pvAccessID /*sid*/) OVERRIDE FINAL {
-        // noop
-    }
+    virtual void depreallocateChannelSID(pvAccessID sid) OVERRIDE FINAL;
 
     virtual void registerChannel(
             pvAccessID sid,
@@ -590,15 +605,10 @@ protected:
 
 private:
 
-    /**
-    * Last SID cache.
-    */
-    pvAccessID _lastChannelSID;
-
     /**
     * Channel table (SID -> channel mapping).
     */
-    std::map<pvAccessID, ServerChannel::shared_pointer> _channels;
+    IDTable<ServerChannel::shared_pointer> _channels;
 
     epics::pvData::Mutex _channelsMutex;
 
@@ -616,7 +626,7 @@ private:
 class BlockingClientTCPTransportCodec :
     public BlockingTCPTransportCodec,
     public TransportSender,
-    public epics::pvData::TimerCallback {
+    public HeartbeatService::Client {
 
 public:
     POINTER_DEFINITIONS(BlockingClientTCPTransportCodec);
@@ -631,6 +641,7 @@ protected:
         TransportClient::shared_pointer const & client,
         epics::pvData::int8 remoteTransportRevision,
         float heartbeatInterval,
+        float livenessTimeout,
         int16_t priority);
 
 public:
@@ -643,6 +654,7 @@ public:
         TransportClient::shared_pointer const & client,
         int8_t remoteTransportRevision,
         float heartbeatInterval,
+        float livenessTimeout,
         int16_t priority )
     {
         shared_pointer thisPointer(
@@ -650,7 +662,7 @@ public:
                 context, channel, responseHandler,
                 sendBufferSize, receiveBufferSize,
                 client, remoteTransportRevision,
-                heartbeatInterval, priority)
+                heartbeatInterval, livenessTimeout, priority)
         );
         thisPointer->activate();
         return thisPointer;
@@ -662,11 +674,7 @@ public:
 
     virtual ~BlockingClientTCPTransportCodec() OVERRIDE FINAL;
 
-    virtual void timerStopped() OVERRIDE FINAL {
-        // noop
-    }
-
-    virtual void callback() OVERRIDE FINAL;
+    virtual void heartbeatSweep(epicsTimeStamp const & now) OVERRIDE FINAL;
 
     virtual bool acquire(TransportClient::shared_pointer const & client) OVERRIDE FINAL;
 
@@ -698,9 +706,14 @@ private:
     TransportClientMap_t _owners;
 
     /**
-     * Connection timeout (no-traffic) flag.
+     * No-traffic period after which an echo is sent.
+     */
+    double _heartbeatInterval;
+
+    /**
+     * No-traffic period after which the transport is considered dead.
      */
-    double _connectionTimeout;
+    double _livenessTimeout;
 
     /**
      * Unresponsive transport flag.
@@ -712,6 +725,16 @@ private:
      */
     epicsTimeStamp _aliveTimestamp;
 
+    /**
+     * Value of _readCount at the last heartbeat sweep.
+     */
+    std::size_t _lastReadCount;
+
+    /**
+     * Echo sent, no traffic received since.
+     */
+    bool _echoPending;
+
     bool _verifyOrEcho;
 
     /**
@@ -0,0 +1,105 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef HEARTBEATSERVICE_H
+#define HEARTBEATSERVICE_H
+
+#include <map>
+
+#ifdef epicsExportSharedSymbols
+#   define heartbeatServiceEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <epicsTime.h>
+
+#include <pv/lock.h>
+#include <pv/timer.h>
+#include <pv/sharedPtr.h>
+
+#ifdef heartbeatServiceEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef heartbeatServiceEpicsExportSharedSymbols
+#endif
+
+#include <pv/timingWheel.h>
+#include <pv/pvAccess.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Checks liveness of all the (client) transports of a context in periodic sweeps,
+ * instead of a timer per transport.
+ * A single timer entry wakes up once per sweep period, regardless of the number of transports.
+ */
+class HeartbeatService :
+    public epics::pvData::TimerCallback,
+    public std::tr1::enable_shared_from_this<HeartbeatService>
+{
+public:
+    POINTER_DEFINITIONS(HeartbeatService);
+
+    /**
+     * Interface implemented by the checked transports.
+     */
+    class Client
+    {
+    public:
+        POINTER_DEFINITIONS(Client);
+        virtual ~Client() {}
+
+        /**
+         * Called once per sweep, from the timer thread.
+         * @param now time of the sweep.
+         */
+        virtual void heartbeatSweep(epicsTimeStamp const & now) = 0;
+    };
+
+    /**
+     * Constructor.
+     * @param timingWheel timer used for the sweeps.
+     * @param period sweep period in seconds.
+     */
+    HeartbeatService(TimingWheel::shared_pointer const & timingWheel, double period);
+    virtual ~HeartbeatService();
+
+    /**
+     * Add a client, the first one starts the sweeps.
+     * @param client client, only a weak reference is kept.
+     */
+    void add(Client::shared_pointer const & client);
+
+    /**
+     * Remove a client, the last one stops the sweeps.
+     * @param client client.
+     */
+    void remove(Client const * client);
+
+    std::size_t size();
+
+    double getPeriod() const {
+        return _period;
+    }
+
+    virtual void callback() OVERRIDE FINAL;
+    virtual void timerStopped() OVERRIDE FINAL;
+
+private:
+    const TimingWheel::weak_pointer _timingWheel;
+    const double _period;
+
+    typedef std::map<const Client*, Client::weak_pointer> clients_t;
+    clients_t _clients;
+    epics::pvData::Mutex _mutex;
+
+    TimingWheel::Entry _timerEntry;
+};
+
+}
+}
+
+#endif  /* HEARTBEATSERVICE_H */
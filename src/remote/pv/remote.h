@@ -14,6 +14,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <osiSock.h>
 
@@ -32,6 +33,7 @@
 #include <pv/pvaConstants.h>
 #include <pv/configuration.h>
 #include <pv/fairQueue.h>
+#include <pv/timingWheel.h>
 #include <pv/pvaDefs.h>
 
 /// TODO only here because of the Lockable
@@ -84,7 +86,12 @@ enum QoS {
     /**
      * Get-put.
      */
-    QOS_GET_PUT = 0x80
+    QOS_GET_PUT = 0x80,
+    /**
+     * RPC only (same bit as QOS_GET): multiplexed mode requested/granted on init,
+     * request ID follows on requests and responses.
+     */
+    QOS_RPC_MULTIPLEX = 0x40
 };
 
 enum ApplicationCommands {
@@ -312,6 +319,7 @@ public:
 
 class Channel;
 class SecurityPlugin;
+class HeartbeatService;
 
 /**
  * Not public IF, used by Transports, etc.
@@ -324,6 +332,11 @@ public:
 
     virtual epics::pvData::Timer::shared_pointer getTimer() = 0;
 
+    /**
+     * Timer for the many per-object callbacks (per transport, channel or request).
+     */
+    virtual TimingWheel::shared_pointer getTimingWheel() = 0;
+
     //virtual TransportRegistry::shared_pointer getTransportRegistry() = 0;
     virtual TransportRegistry* getTransportRegistry() = 0;
 
@@ -347,6 +360,22 @@ public:
 
     virtual std::tr1::shared_ptr<Channel> getChannel(pvAccessID id) = 0;
     virtual Transport::shared_pointer getSearchTransport() = 0;
+
+    /**
+     * Get (UDP search) addresses of servers which advertise in their beacons
+     * that they might host a channel, plus the servers which advertise nothing
+     * (older versions), if any server advertises a filter at all.
+     * @param name channel name.
+     * @param servers addresses are appended here.
+     */
+    virtual void getLikelyServers(std::string const & /*name*/, std::vector<osiSockAddr>& /*servers*/) {}
+
+    /**
+     * Service checking liveness of the client transports, none by default.
+     */
+    virtual std::tr1::shared_ptr<HeartbeatService> getHeartbeatService() {
+        return std::tr1::shared_ptr<HeartbeatService>();
+    }
 };
 
 /**
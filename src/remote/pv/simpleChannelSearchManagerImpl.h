@@ -7,6 +7,8 @@
 #ifndef SIMPLECHANNELSEARCHMANAGERIMPL_H
 #define SIMPLECHANNELSEARCHMANAGERIMPL_H
 
+#include <deque>
+
 #ifdef epicsExportSharedSymbols
 #   define simpleChannelSearchManagerEpicsExportSharedSymbols
 #   undef epicsExportSharedSymbols
@@ -23,6 +25,8 @@
 
 #include <pv/channelSearchManager.h>
 #include <pv/remote.h>
+#include <pv/inetAddressUtil.h>
+#include <pv/tokenBucket.h>
 
 namespace epics {
 namespace pvAccess {
@@ -109,6 +113,20 @@ public:
     /// Timer stooped callback.
     void timerStopped();
 
+    /**
+     * Search timer period, ATOMIC_PERIOD with a random jitter of +/- PERIOD_JITTER_MS,
+     * so that all the clients do not send at the same time.
+     * @return period in seconds.
+     */
+    epicsShareFunc static double searchPeriod();
+
+    /**
+     * Random delay of the search boost after a new server is detected.
+     * @param spread max. delay in seconds.
+     * @return delay in seconds, in <code>[0, spread]</code>, <code>0</code> if spread is not positive.
+     */
+    epicsShareFunc static double reconnectDelay(double spread);
+
 private:
 
     /**
@@ -120,12 +138,36 @@ private:
 
     bool generateSearchRequestMessage(SearchInstance::shared_pointer const & channel, bool allowNewFrame, bool flush);
 
+    typedef std::map<osiSockAddr, std::vector<SearchInstance::shared_pointer>, comp_osiSock_lt> targetedSearches_t;
+    void sendTargetedSearches(targetedSearches_t const & targets);
+
     static bool generateSearchRequestMessage(SearchInstance::shared_pointer const & channel,
             epics::pvData::ByteBuffer* byteBuffer, TransportSendControl* control);
 
     void boost();
 
+    /**
+     * Boost searching of all channels and search.
+     * Called (with a random delay) when a new server is detected.
+     */
+    void boostAndSearch();
+
+    /**
+     * Pass search response to the channel, or queue it if the server
+     * connect rate limit is exceeded.
+     */
+    void passSearchResponse(SearchInstance::shared_pointer const & si,
+                            const ServerGUID & guid, int8_t minorRevision, osiSockAddr* serverAddress);
+
+    /**
+     * Pass queued search responses as permitted by the server connect rate limit.
+     */
+    void releaseSearchResponses();
+
+    void scheduleReleaseSearchResponses(double delay);
+
     void initializeSendBuffer();
+    void initializeSendBuffer(epics::pvData::ByteBuffer* buffer);
     void flushSendBuffer();
 
     static bool isPowerOfTwo(int32_t x);
@@ -186,6 +228,48 @@ private:
      */
     epics::pvData::Mutex m_mutex;
 
+    class DelayedCallback;
+
+    /**
+     * Max. random delay of search boost after a new server is detected, in seconds.
+     */
+    double m_reconnectSpread;
+
+    /**
+     * Max. number of channel connects (search responses passed on) per second per server,
+     * <code>0</code> for unlimited.
+     */
+    double m_maxConnectRate;
+
+    /**
+     * Delayed boostAndSearch() call.
+     */
+    epics::pvData::TimerCallbackPtr m_boostCallback;
+
+    /**
+     * Delayed releaseSearchResponses() call.
+     */
+    epics::pvData::TimerCallbackPtr m_releaseCallback;
+
+    struct PendingResponse {
+        SearchInstance::weak_pointer instance;
+        ServerGUID guid;
+        int8_t minorRevision;
+        osiSockAddr serverAddress;
+    };
+
+    struct ServerConnectQueue {
+        TokenBucket bucket;
+        std::deque<PendingResponse> pending;
+        explicit ServerConnectQueue(TokenBucket const & bucket) : bucket(bucket) {}
+    };
+
+    /**
+     * Per server connect rate limits and responses waiting for their turn, guarded by m_mutex.
+     */
+    typedef std::map<osiSockAddr, ServerConnectQueue, comp_osiSock_lt> m_connectQueues_t;
+    m_connectQueues_t m_connectQueues;
+
     static const int DATA_COUNT_POSITION;
     static const int CAST_POSITION;
     static const int PAYLOAD_POSITION;
@@ -201,6 +285,8 @@ private:
     static const int MAX_FRAMES_AT_ONCE;
     static const int DELAY_BETWEEN_FRAMES_MS;
 
+    static const double DEFAULT_RECONNECT_SPREAD;
+
 };
 
 }
@@ -39,6 +39,33 @@ const int SimpleChannelSearchManagerImpl::MAX_FALLBACK_COUNT_VALUE = (1 << 7) +
 const int SimpleChannelSearchManagerImpl::MAX_FRAMES_AT_ONCE = 10;
 const int SimpleChannelSearchManagerImpl::DELAY_BETWEEN_FRAMES_MS = 50;
 
+const double SimpleChannelSearchManagerImpl::DEFAULT_RECONNECT_SPREAD = 1.0;
+
+/**
+ * One-shot timer callback calling a method of the search manager.
+ */
+class SimpleChannelSearchManagerImpl::DelayedCallback : public TimerCallback
+{
+public:
+    typedef void (SimpleChannelSearchManagerImpl::*method_t)();
+
+    DelayedCallback(SimpleChannelSearchManagerImpl::shared_pointer const & owner, method_t method) :
+        m_owner(owner), m_method(method) {}
+
+    virtual void callback() OVERRIDE FINAL
+    {
+        SimpleChannelSearchManagerImpl::shared_pointer owner(m_owner.lock());
+        if (owner)
+            ((*owner).*m_method)();
+    }
+
+    virtual void timerStopped() OVERRIDE FINAL {}
+
+private:
+    SimpleChannelSearchManagerImpl::weak_pointer m_owner;
+    method_t m_method;
+};
+
 
 SimpleChannelSearchManagerImpl::shared_pointer
 SimpleChannelSearchManagerImpl::create(Context::shared_pointer const & context)
@@ -59,8 +86,21 @@ SimpleChannelSearchManagerImpl::SimpleChannelSearchManagerImpl(Context::shared_p
     m_mockTransportSendControl(),
     m_channelMutex(),
     m_userValueMutex(),
-    m_mutex()
+    m_mutex(),
+    m_reconnectSpread(DEFAULT_RECONNECT_SPREAD),
+    m_maxConnectRate(0.0),
+    m_connectQueues()
 {
+    Configuration::const_shared_pointer configuration(context->getConfiguration());
+    if (configuration)
+    {
+        m_reconnectSpread = configuration->getPropertyAsDouble("EPICS_PVA_RECONNECT_SPREAD", m_reconnectSpread);
+        m_maxConnectRate = configuration->getPropertyAsDouble("EPICS_PVA_MAX_CONNECT_RATE", m_maxConnectRate);
+    }
+    if (m_reconnectSpread < 0.0)
+        m_reconnectSpread = 0.0;
+    if (m_maxConnectRate < 0.0)
+        m_maxConnectRate = 0.0;
 
     // initialize send buffer
     initializeSendBuffer();
@@ -72,8 +112,10 @@ SimpleChannelSearchManagerImpl::SimpleChannelSearchManagerImpl(Context::shared_p
 
 void SimpleChannelSearchManagerImpl::activate()
 {
-    // add some jitter so that all the clients do not send at the same time
-    double period = ATOMIC_PERIOD + (rand() % (2*PERIOD_JITTER_MS+1) - PERIOD_JITTER_MS)/(double)1000;
+    double period = searchPeriod();
+
+    m_boostCallback.reset(new DelayedCallback(shared_from_this(), &SimpleChannelSearchManagerImpl::boostAndSearch));
+    m_releaseCallback.reset(new DelayedCallback(shared_from_this(), &SimpleChannelSearchManagerImpl::releaseSearchResponses));
 
     Context::shared_pointer context = m_context.lock();
     if (context.get())
@@ -97,9 +139,15 @@ void SimpleChannelSearchManagerImpl::cancel()
         return;
     m_canceled.set();
 
+    m_connectQueues.clear();
+
     Context::shared_pointer context = m_context.lock();
     if (context.get())
+    {
         context->getTimer()->cancel(shared_from_this());
+        context->getTimer()->cancel(m_boostCallback);
+        context->getTimer()->cancel(m_releaseCallback);
+    }
 }
 
 int32_t SimpleChannelSearchManagerImpl::registeredCount()
@@ -153,7 +201,7 @@ void SimpleChannelSearchManagerImpl::searchResponse(const ServerGUID & guid, pvA
         // enable duplicate reports
         SearchInstance::shared_pointer si = std::tr1::dynamic_pointer_cast<SearchInstance>(ctxt->getChannel(cid));
         if (si)
-            si->searchResponse(guid, minorRevision, serverAddress);
+            passSearchResponse(si, guid, minorRevision, serverAddress);
     }
     else
     {
@@ -166,48 +214,181 @@ void SimpleChannelSearchManagerImpl::searchResponse(const ServerGUID & guid, pvA
 
         // then notify SearchInstance
         if(si)
-            si->searchResponse(guid, minorRevision, serverAddress);
+            passSearchResponse(si, guid, minorRevision, serverAddress);
+    }
+}
+
+void SimpleChannelSearchManagerImpl::passSearchResponse(SearchInstance::shared_pointer const & si,
+        const ServerGUID & guid, int8_t minorRevision, osiSockAddr* serverAddress)
+{
+    if (m_maxConnectRate > 0.0)
+    {
+        Lock guard(m_mutex);
+
+        double nowSec = TokenBucket::now();
+
+        m_connectQueues_t::iterator iter = m_connectQueues.find(*serverAddress);
+        if (iter == m_connectQueues.end())
+        {
+            // allow one second worth of connects at once
+            TokenBucket bucket(m_maxConnectRate, m_maxConnectRate);
+            iter = m_connectQueues.insert(std::make_pair(*serverAddress, ServerConnectQueue(bucket))).first;
+        }
+
+        ServerConnectQueue& queue = iter->second;
+        if (!queue.pending.empty() || !queue.bucket.tryAcquire(nowSec))
+        {
+            PendingResponse response;
+            response.instance = si;
+            response.guid = guid;
+            response.minorRevision = minorRevision;
+            response.serverAddress = *serverAddress;
+            queue.pending.push_back(response);
+
+            scheduleReleaseSearchResponses(queue.bucket.delay(nowSec));
+            return;
+        }
+    }
+
+    si->searchResponse(guid, minorRevision, serverAddress);
+}
+
+void SimpleChannelSearchManagerImpl::scheduleReleaseSearchResponses(double delay)
+{
+    Lock guard(m_mutex);
+
+    if (m_canceled.get())
+        return;
+
+    Context::shared_pointer context = m_context.lock();
+    if (context && !context->getTimer()->isScheduled(m_releaseCallback))
+        context->getTimer()->scheduleAfterDelay(m_releaseCallback, delay);
+}
+
+void SimpleChannelSearchManagerImpl::releaseSearchResponses()
+{
+    std::vector<PendingResponse> toRelease;
+    {
+        Lock guard(m_mutex);
+
+        double nowSec = TokenBucket::now();
+
+        double nextDelay = -1.0;
+        m_connectQueues_t::iterator iter = m_connectQueues.begin();
+        while (iter != m_connectQueues.end())
+        {
+            ServerConnectQueue& queue = iter->second;
+            while (!queue.pending.empty() && queue.bucket.tryAcquire(nowSec))
+            {
+                toRelease.push_back(queue.pending.front());
+                queue.pending.pop_front();
+            }
+
+            if (!queue.pending.empty())
+            {
+                double delay = queue.bucket.delay(nowSec);
+                if (nextDelay < 0.0 || delay < nextDelay)
+                    nextDelay = delay;
+                iter++;
+            }
+            // idle, forget about the server
+            else if (queue.bucket.full(nowSec))
+                m_connectQueues.erase(iter++);
+            else
+                iter++;
+        }
+
+        if (nextDelay >= 0.0)
+            scheduleReleaseSearchResponses(nextDelay);
+    }
+
+    for (size_t i = 0; i < toRelease.size(); i++)
+    {
+        SearchInstance::shared_pointer si(toRelease[i].instance.lock());
+        if (si)
+            si->searchResponse(toRelease[i].guid, toRelease[i].minorRevision, &toRelease[i].serverAddress);
     }
 }
 
 void SimpleChannelSearchManagerImpl::newServerDetected()
+{
+    // a restarted server is detected by all the clients at the same time,
+    // spread their searches (and connects) over m_reconnectSpread seconds
+    if (m_reconnectSpread <= 0.0)
+    {
+        boostAndSearch();
+        return;
+    }
+
+    Lock guard(m_mutex);
+
+    if (m_canceled.get())
+        return;
+
+    // already pending, the boost covers all the channels
+    Context::shared_pointer context = m_context.lock();
+    if (!context || context->getTimer()->isScheduled(m_boostCallback))
+        return;
+
+    context->getTimer()->scheduleAfterDelay(m_boostCallback, reconnectDelay(m_reconnectSpread));
+}
+
+double SimpleChannelSearchManagerImpl::searchPeriod()
+{
+    // add some jitter so that all the clients do not send at the same time
+    return ATOMIC_PERIOD + (rand() % (2*PERIOD_JITTER_MS+1) - PERIOD_JITTER_MS)/(double)1000;
+}
+
+double SimpleChannelSearchManagerImpl::reconnectDelay(double spread)
+{
+    if (spread <= 0.0)
+        return 0.0;
+    return spread * (rand() / (double)RAND_MAX);
+}
+
+void SimpleChannelSearchManagerImpl::boostAndSearch()
 {
     boost();
     callback();
 }
 
 void SimpleChannelSearchManagerImpl::initializeSendBuffer()
+{
+    initializeSendBuffer(&m_sendBuffer);
+}
+
+void SimpleChannelSearchManagerImpl::initializeSendBuffer(ByteBuffer* buffer)
 {
     // for now OK, since it is only set here
     m_sequenceNumber++;
 
 
     // new buffer
-    m_sendBuffer.clear();
-    m_sendBuffer.putByte(PVA_MAGIC);
-    m_sendBuffer.putByte(PVA_VERSION);
-    m_sendBuffer.putByte((EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG) ? 0x80 : 0x00); // data + 7-bit endianess
-    m_sendBuffer.putByte(CMD_SEARCH);
-    m_sendBuffer.putInt(4+1+3+16+2+1);		// "zero" payload
-    m_sendBuffer.putInt(m_sequenceNumber);
+    buffer->clear();
+    buffer->putByte(PVA_MAGIC);
+    buffer->putByte(PVA_VERSION);
+    buffer->putByte((EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG) ? 0x80 : 0x00); // data + 7-bit endianess
+    buffer->putByte(CMD_SEARCH);
+    buffer->putInt(4+1+3+16+2+1);		// "zero" payload
+    buffer->putInt(m_sequenceNumber);
 
     // multicast vs unicast mask
-    m_sendBuffer.putByte((int8_t)0);
+    buffer->putByte((int8_t)0);
 
     // reserved part
-    m_sendBuffer.putByte((int8_t)0);
-    m_sendBuffer.putShort((int16_t)0);
+    buffer->putByte((int8_t)0);
+    buffer->putShort((int16_t)0);
 
     // NOTE: is it possible (very likely) that address is any local address ::ffff:0.0.0.0
-    encodeAsIPv6Address(&m_sendBuffer, &m_responseAddress);
-    m_sendBuffer.putShort((int16_t)ntohs(m_responseAddress.ia.sin_port));
+    encodeAsIPv6Address(buffer, &m_responseAddress);
+    buffer->putShort((int16_t)ntohs(m_responseAddress.ia.sin_port));
 
     // TODO now only TCP is supported
     // note: this affects DATA_COUNT_POSITION
-    m_sendBuffer.putByte((int8_t)1);
+    buffer->putByte((int8_t)1);
     // TODO "tcp" constant
-    SerializeHelper::serializeString("tcp", &m_sendBuffer, &m_mockTransportSendControl);
-    m_sendBuffer.putShort((int16_t)0);	// count
+    SerializeHelper::serializeString("tcp", buffer, &m_mockTransportSendControl);
+    buffer->putShort((int16_t)0);	// count
 }
 
 void SimpleChannelSearchManagerImpl::flushSendBuffer()
@@ -226,6 +407,37 @@ void SimpleChannelSearchManagerImpl::flushSendBuffer()
     initializeSendBuffer();
 }
 
+void SimpleChannelSearchManagerImpl::sendTargetedSearches(targetedSearches_t const & targets)
+{
+    Lock guard(m_mutex);
+
+    Context::shared_pointer context = m_context.lock();
+    if (!context)
+        return;
+    BlockingUDPTransport::shared_pointer ut = std::tr1::static_pointer_cast<BlockingUDPTransport>(context->getSearchTransport());
+
+    ByteBuffer sendBuffer(MAX_UDP_UNFRAGMENTED_SEND);
+    for (targetedSearches_t::const_iterator iter = targets.begin(); iter != targets.end(); iter++)
+    {
+        initializeSendBuffer(&sendBuffer);
+        sendBuffer.putByte(CAST_POSITION, (int8_t)0x80);  // unicast, no reply required
+
+        const std::vector<SearchInstance::shared_pointer>& channels = iter->second;
+        for (size_t i = 0; i < channels.size(); i++)
+        {
+            if (!generateSearchRequestMessage(channels[i], &sendBuffer, &m_mockTransportSendControl))
+            {
+                // frame full
+                ut->send(&sendBuffer, iter->first);
+                initializeSendBuffer(&sendBuffer);
+                sendBuffer.putByte(CAST_POSITION, (int8_t)0x80);
+                generateSearchRequestMessage(channels[i], &sendBuffer, &m_mockTransportSendControl);
+            }
+        }
+        ut->send(&sendBuffer, iter->first);
+    }
+}
+
 
 bool SimpleChannelSearchManagerImpl::generateSearchRequestMessage(SearchInstance::shared_pointer const & channel,
         ByteBuffer* requestMessage, TransportSendControl* control)
@@ -295,9 +507,7 @@ void SimpleChannelSearchManagerImpl::callback()
     {
         Lock guard(m_mutex);
 
-        epics::pvData::TimeStamp now;
-        now.getCurrent();
-        int64_t nowMS = now.getMilliseconds();
+        int64_t nowMS = (int64_t)(TokenBucket::now() * 1000.0);
 
         if (nowMS - m_lastTimeSent < 100)
             return;
@@ -322,12 +532,20 @@ void SimpleChannelSearchManagerImpl::callback()
         }
     }
 
+    Context::shared_pointer context = m_context.lock();
+    if (!context)
+        return;
+
+    targetedSearches_t targeted;
+    std::vector<osiSockAddr> servers;
+
     vector<SearchInstance::shared_pointer>::iterator siter = toSend.begin();
     for (; siter != toSend.end(); siter++)
     {
         m_userValueMutex.lock();
         int32_t& countValue = (*siter)->getUserValue();
         bool skip = !isPowerOfTwo(countValue);
+        bool firstAttempt = (countValue == DEFAULT_USER_VALUE);
 
         if (countValue >= MAX_COUNT_VALUE)
             countValue = MAX_FALLBACK_COUNT_VALUE;
@@ -339,6 +557,20 @@ void SimpleChannelSearchManagerImpl::callback()
         if (skip)
             continue;
 
+        // first attempt is sent only to the servers whose beacons advertise the name
+        // and to the ones advertising no filter (if any), the following ones are broadcast as usual
+        if (firstAttempt)
+        {
+            servers.clear();
+            context->getLikelyServers((*siter)->getSearchInstanceName(), servers);
+            if (!servers.empty())
+            {
+                for (size_t i = 0; i < servers.size(); i++)
+                    targeted[servers[i]].push_back(*siter);
+                continue;
+            }
+        }
+
         count++;
 
         if (generateSearchRequestMessage(*siter, true, false))
@@ -352,6 +584,9 @@ void SimpleChannelSearchManagerImpl::callback()
 
     if (count > 0)
         flushSendBuffer();
+
+    if (!targeted.empty())
+        sendTargetedSearches(targeted);
 }
 
 bool SimpleChannelSearchManagerImpl::isPowerOfTwo(int32_t x)
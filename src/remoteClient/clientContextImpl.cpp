@@ -8,6 +8,7 @@
 #include <sstream>
 #include <memory>
 #include <queue>
+#include <algorithm>
 #include <stdexcept>
 
 #include <pv/lock.h>
@@ -29,6 +30,10 @@
 #include <pv/serializationHelper.h>
 #include <pv/simpleChannelSearchManagerImpl.h>
 #include <pv/clientContextImpl.h>
+#include <pv/nameCache.h>
+#include <pv/idTable.h>
+#include <pv/heartbeatService.h>
+#include <pv/workerPool.h>
 #include <pv/configuration.h>
 #include <pv/beaconHandler.h>
 #include <pv/logger.h>
@@ -63,6 +68,11 @@ class ChannelGetFieldRequestImpl;
 //typedef std::tr1::unordered_map<pvAccessID, ResponseRequest::weak_pointer> IOIDResponseRequestMap;
 typedef std::map<pvAccessID, ResponseRequest::weak_pointer> IOIDResponseRequestMap;
 
+// a client may have more than 64k channels and requests (CIDs, IOIDs): up to 1M live IDs,
+// 16k free slots keep the reuse distance of the IDTable defaults (16384 * 2047, about 3.4e7)
+const unsigned CLIENT_ID_INDEX_BITS = 20;
+const std::size_t CLIENT_ID_MIN_FREE = 16384;
+
 
 #define EXCEPTION_GUARD(code) try { code; } \
         catch (std::exception &e) { LOG(logLevelError, "Unhandled exception caught from client code at %s:%d: %s", __FILE__, __LINE__, e.what()); } \
@@ -96,6 +106,7 @@ public:
     static Status invalidPutArrayStatus;
     static Status invalidBitSetLengthStatus;
     static Status pvRequestNull;
+    static Status notMultiplexedStatus;
 
     static BitSet::shared_pointer createBitSetFor(
         PVStructure::shared_pointer const & pvStructure,
@@ -362,7 +373,7 @@ public:
         // TODO notify?
     }
 
-    void reportStatus(Channel::ConnectionState status) OVERRIDE FINAL {
+    virtual void reportStatus(Channel::ConnectionState status) OVERRIDE {
         // destroy, since channel (parent) was destroyed
         if (status == Channel::DESTROYED)
             destroy();
@@ -422,6 +433,7 @@ Status BaseRequestImpl::invalidPutStructureStatus(Status::STATUSTYPE_ERROR, "inc
 Status BaseRequestImpl::invalidPutArrayStatus(Status::STATUSTYPE_ERROR, "incompatible put array");
 Status BaseRequestImpl::invalidBitSetLengthStatus(Status::STATUSTYPE_ERROR, "invalid bit-set length");
 Status BaseRequestImpl::pvRequestNull(Status::STATUSTYPE_ERROR, "pvRequest == 0");
+Status BaseRequestImpl::notMultiplexedStatus(Status::STATUSTYPE_ERROR, "multiplexed requests not supported");
 
 PVACCESS_REFCOUNT_MONITOR_DEFINE(channelProcess);
 
@@ -1333,12 +1345,28 @@ public:
 
     Mutex m_structureMutex;
 
+    // multiplexed mode requested by the pvRequest, and granted by the server
+    bool m_multiplex;
+    bool m_multiplexed;
+
+    // multiplexed requests, guarded by m_mutex
+    int32 m_nextRequestID;
+    typedef std::map<int32, ChannelRPCRequester::shared_pointer> MultiplexedRequesters;
+    MultiplexedRequesters m_multiplexedRequesters;
+    typedef std::deque<std::pair<int32, PVStructure::shared_pointer> > MultiplexedArguments;
+    MultiplexedArguments m_multiplexedArguments;
+    bool m_multiplexedSendQueued;
+
     ChannelRPCImpl(ChannelImpl::shared_pointer const & channel,
                    ChannelRPCRequester::shared_pointer const & requester,
                    PVStructure::shared_pointer const & pvRequest) :
         BaseRequestImpl(channel),
         m_callback(requester),
-        m_pvRequest(pvRequest)
+        m_pvRequest(pvRequest),
+        m_multiplex(false),
+        m_multiplexed(false),
+        m_nextRequestID(0),
+        m_multiplexedSendQueued(false)
     {
         PVACCESS_REFCOUNT_MONITOR_CONSTRUCT(channelRPC);
     }
@@ -1351,6 +1379,13 @@ public:
             return;
         }
 
+        PVStructurePtr pvOptions = m_pvRequest->getSubField<PVStructure>("record._options");
+        if (pvOptions) {
+            PVStringPtr pvString = pvOptions->getSubField<PVString>("multiplex");
+            if (pvString)
+                m_multiplex = (pvString->get() == "true");
+        }
+
         BaseRequestImpl::activate();
 
         // subscribe
@@ -1370,7 +1405,35 @@ public:
     ChannelBaseRequester::shared_pointer getRequester() OVERRIDE FINAL { return m_callback.lock(); }
 
     virtual void send(ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL {
+        // all queued multiplexed requests, one message each
+        MultiplexedArguments arguments;
+        {
+            Lock guard(m_mutex);
+            arguments.swap(m_multiplexedArguments);
+            m_multiplexedSendQueued = false;
+        }
+
+        for (MultiplexedArguments::const_iterator it = arguments.begin(); it != arguments.end(); ++it)
+        {
+            if (it != arguments.begin())
+                control->endMessage();
+            control->startMessage((int8)CMD_RPC, 4+4+1+4);
+            buffer->putInt(m_channel->getServerChannelID());
+            buffer->putInt(m_ioid);
+            buffer->putByte((int8)QOS_RPC_MULTIPLEX);
+            buffer->putInt(it->first);
+            SerializationHelper::serializeStructureFull(buffer, control, it->second);
+        }
+
         int32 pendingRequest = getPendingRequest();
+        if (pendingRequest == NULL_REQUEST)
+            return;
+        // request() did not set the argument yet, it is sent on its own send request
+        if (pendingRequest >= 0 && (pendingRequest & QOS_INIT) == 0 && !m_structure)
+            return;
+        if (!arguments.empty())
+            control->endMessage();
+
         if (pendingRequest < 0)
         {
             BaseRequestImpl::send(buffer, control);
@@ -1385,7 +1448,7 @@ public:
 
         if (pendingRequest & QOS_INIT)
         {
-            buffer->putByte((int8)QOS_INIT);
+            buffer->putByte((int8)(m_multiplex ? (QOS_INIT | QOS_RPC_MULTIPLEX) : QOS_INIT));
 
             // pvRequest
             SerializationHelper::serializePVRequest(buffer, control, m_pvRequest);
@@ -1404,21 +1467,59 @@ public:
         stopRequest();
     }
 
-    virtual void initResponse(Transport::shared_pointer const & /*transport*/, int8 /*version*/, ByteBuffer* /*payloadBuffer*/, int8 /*qos*/, const Status& status) OVERRIDE FINAL {
+    virtual void initResponse(Transport::shared_pointer const & /*transport*/, int8 /*version*/, ByteBuffer* /*payloadBuffer*/, int8 qos, const Status& status) OVERRIDE FINAL {
         if (!status.isSuccess())
         {
             EXCEPTION_GUARD3(m_callback, cb, cb->channelRPCConnect(status, external_from_this<ChannelRPCImpl>()));
             return;
         }
 
+        // older servers do not grant (nor know) the multiplexed mode
+        {
+            Lock guard(m_mutex);
+            m_multiplexed = m_multiplex && (qos & QOS_RPC_MULTIPLEX) != 0;
+        }
+
         // notify
         EXCEPTION_GUARD3(m_callback, cb, cb->channelRPCConnect(status, external_from_this<ChannelRPCImpl>()));
     }
 
-    virtual void normalResponse(Transport::shared_pointer const & transport, int8 /*version*/, ByteBuffer* payloadBuffer, int8 /*qos*/, const Status& status) OVERRIDE FINAL {
+    virtual void normalResponse(Transport::shared_pointer const & transport, int8 /*version*/, ByteBuffer* payloadBuffer, int8 qos, const Status& status) OVERRIDE FINAL {
 
         ChannelRPC::shared_pointer thisPtr(external_from_this<ChannelRPCImpl>());
 
+        if (qos & QOS_RPC_MULTIPLEX)
+        {
+            transport->ensureData(4);
+            const int32 requestID = payloadBuffer->getInt();
+
+            ChannelRPCRequester::shared_pointer requester;
+            {
+                Lock guard(m_mutex);
+                MultiplexedRequesters::iterator it = m_multiplexedRequesters.find(requestID);
+                if (it != m_multiplexedRequesters.end())
+                {
+                    requester = it->second;
+                    m_multiplexedRequesters.erase(it);
+                }
+            }
+
+            PVStructure::shared_pointer response;
+            if (status.isSuccess())
+                response = SerializationHelper::deserializeStructureFull(payloadBuffer, transport.get());
+
+            // already failed (e.g. by a disconnect)
+            if (!requester)
+                return;
+
+            try {
+                requester->requestDone(status, thisPtr, response);
+            } catch (std::exception &e) {
+                LOG(logLevelError, "Unhandled exception caught from client code at %s:%d: %s", __FILE__, __LINE__, e.what());
+            }
+            return;
+        }
+
         if (!status.isSuccess())
         {
             EXCEPTION_GUARD3(m_callback, cb, cb->requestDone(status, thisPtr, PVStructurePtr()));
@@ -1463,6 +1564,100 @@ public:
         }
     }
 
+    virtual bool isMultiplexed() OVERRIDE FINAL
+    {
+        Lock guard(m_mutex);
+        return m_multiplexed;
+    }
+
+    virtual void multiplexedRequest(epics::pvData::PVStructure::shared_pointer const & pvArgument,
+                                    ChannelRPCRequester::shared_pointer const & requester) OVERRIDE FINAL {
+
+        ChannelRPC::shared_pointer thisPtr(external_from_this<ChannelRPCImpl>());
+
+        Status error;
+        bool enqueue = false;
+        {
+            Lock guard(m_mutex);
+            if (m_destroyed)
+                error = destroyedStatus;
+            else if (!m_initialized)
+                error = notInitializedStatus;
+            else if (!m_multiplexed)
+                error = notMultiplexedStatus;
+            else
+            {
+                const int32 requestID = m_nextRequestID++;
+                m_multiplexedRequesters[requestID] = requester;
+                m_multiplexedArguments.push_back(std::make_pair(requestID, pvArgument));
+                enqueue = !m_multiplexedSendQueued;
+                m_multiplexedSendQueued = true;
+            }
+        }
+
+        if (!error.isSuccess())
+        {
+            requester->requestDone(error, thisPtr, PVStructurePtr());
+            return;
+        }
+
+        // requests issued until the send are put on the wire together
+        if (!enqueue)
+            return;
+
+        try {
+            m_channel->checkAndGetTransport()->enqueueSendRequest(internal_from_this<ChannelRPCImpl>());
+        } catch (std::runtime_error &rte) {
+            {
+                Lock guard(m_mutex);
+                m_multiplexedSendQueued = false;
+            }
+            failMultiplexed(channelNotConnected);
+        }
+    }
+
+    /**
+     * Complete all outstanding multiplexed requests with an error,
+     * the server forgets about them on disconnect.
+     */
+    void failMultiplexed(const Status& status)
+    {
+        MultiplexedRequesters requesters;
+        {
+            Lock guard(m_mutex);
+            requesters.swap(m_multiplexedRequesters);
+            m_multiplexedArguments.clear();
+        }
+
+        if (requesters.empty())
+            return;
+
+        // also called on destruction, when there is no external reference anymore
+        ChannelRPC::shared_pointer thisPtr(std::tr1::static_pointer_cast<ChannelRPCImpl>(m_this_external.lock()));
+        for (MultiplexedRequesters::const_iterator it = requesters.begin(); it != requesters.end(); ++it)
+        {
+            try {
+                it->second->requestDone(status, thisPtr, PVStructurePtr());
+            } catch (std::exception &e) {
+                LOG(logLevelError, "Unhandled exception caught from client code at %s:%d: %s", __FILE__, __LINE__, e.what());
+            }
+        }
+    }
+
+    virtual void reportStatus(Channel::ConnectionState status) OVERRIDE FINAL
+    {
+        BaseRequestImpl::reportStatus(status);
+
+        if (status == Channel::DISCONNECTED)
+        {
+            {
+                Lock guard(m_mutex);
+                m_multiplexed = false;
+            }
+            failMultiplexed(channelNotConnected);
+        }
+    }
+
     virtual Channel::shared_pointer getChannel() OVERRIDE FINAL
     {
         return BaseRequestImpl::getChannel();
@@ -1476,6 +1671,7 @@ public:
     virtual void destroy() OVERRIDE FINAL
     {
         BaseRequestImpl::destroy();
+        failMultiplexed(destroyedStatus);
     }
 
     virtual void lastRequest() OVERRIDE FINAL
@@ -1858,6 +2054,9 @@ public:
 typedef vector<MonitorElement::shared_pointer> FreeElementQueue;
 typedef queue<MonitorElement::shared_pointer> MonitorElementQueue;
 
+// minimal adaptive pipeline window
+static const int32 minPipelineWindow = 2;
+
 
 class MonitorStrategyQueue :
     public MonitorStrategy,
@@ -1875,7 +2074,7 @@ private:
 
     MonitorRequester::weak_pointer m_callback;
 
-    Mutex m_mutex;
+    mutable Mutex m_mutex;
 
     BitSet m_bitSet1;
     BitSet m_bitSet2;
@@ -1899,12 +2098,32 @@ private:
 
     bool m_unlisten;
 
+    // adaptive credit window: the credits the server may use ahead (window) follow
+    // the bandwidth-delay product, 2 x release rate x round trip time
+    const bool m_adaptive;
+    const int32 m_initialWindow;
+    int32 m_window;
+    // elements created, at most m_queueSize, created on demand with the adaptive window
+    int32 m_allocated;
+    // credits sent and elements received since init()
+    int64 m_granted;
+    int64 m_received;
+    // round trip time sample, in flight until element m_rttElement arrives
+    int64 m_rttElement;
+    epicsTime m_rttStart;
+    double m_rtt;
+    // release rate
+    int32 m_releasedSinceRate;
+    epicsTime m_rateStart;
+    double m_releaseRate;
+
 public:
 
     MonitorStrategyQueue(ChannelImpl::shared_pointer channel, pvAccessID ioid,
                          MonitorRequester::weak_pointer const & callback,
                          int32 queueSize,
-                         bool pipeline, int32 ackAny) :
+                         bool pipeline, int32 ackAny,
+                         bool adaptive = false, int32 initialWindow = 0) :
         m_queueSize(queueSize), m_lastStructure(),
         m_freeQueue(),
         m_monitorQueue(),
@@ -1915,7 +2134,19 @@ public:
         m_reportQueueStateInProgress(false),
         m_channel(channel), m_ioid(ioid),
         m_pipeline(pipeline), m_ackAny(ackAny),
-        m_unlisten(false)
+        m_unlisten(false),
+        m_adaptive(pipeline && adaptive),
+        m_initialWindow(initialWindow),
+        m_window(m_adaptive ? initialWindow : queueSize),
+        m_allocated(0),
+        m_granted(0),
+        m_received(0),
+        m_rttElement(0),
+        m_rttStart(),
+        m_rtt(0.0),
+        m_releasedSinceRate(0),
+        m_rateStart(),
+        m_releaseRate(0.0)
     {
         if (queueSize <= 1)
             throw std::invalid_argument("queueSize <= 1");
@@ -1935,6 +2166,13 @@ public:
         m_releasedCount = 0;
         m_reportQueueStateInProgress = false;
 
+        // the INIT request granted the initial window
+        m_granted = m_initialWindow;
+        m_received = 0;
+        m_rttElement = 0;
+        m_releasedSinceRate = 0;
+        m_rateStart = epicsTime::getCurrent();
+
         // reuse on reconnect
         if (m_lastStructure.get() == 0 ||
                 *(m_lastStructure.get()) != *(structure.get()))
@@ -1942,16 +2180,89 @@ public:
             while (!m_monitorQueue.empty())
                 m_monitorQueue.pop();
             m_freeQueue.clear();
-            for (int32 i = 0; i < m_queueSize; i++)
-            {
-                PVStructure::shared_pointer pvStructure = getPVDataCreate()->createPVStructure(structure);
-                MonitorElement::shared_pointer monitorElement(new MonitorElement(pvStructure));
-                m_freeQueue.push_back(monitorElement);
-            }
             m_lastStructure = structure;
+            m_allocated = 0;
+            const int32 count = m_adaptive ? m_window : m_queueSize;
+            for (int32 i = 0; i < count; i++)
+                m_freeQueue.push_back(createElement());
+        }
+    }
+
+    virtual void getStats(Monitor::Stats& s) const OVERRIDE FINAL {
+        Lock guard(m_mutex);
+        s.nfilled = m_monitorQueue.size();
+        s.nempty = m_freeQueue.size();
+        s.noutstanding = m_allocated - s.nfilled - s.nempty - (m_overrunElement ? 1 : 0);
+        s.window = m_pipeline ? m_window : 0;
+        s.rtt = m_rtt;
+    }
+
+private:
+    // call with m_mutex locked
+    MonitorElement::shared_pointer createElement()
+    {
+        m_allocated++;
+        PVStructure::shared_pointer pvStructure = getPVDataCreate()->createPVStructure(m_lastStructure);
+        return MonitorElement::shared_pointer(new MonitorElement(pvStructure));
+    }
+
+    // credits which can be granted (adaptive window), call with m_mutex locked
+    int32 grantableCredits() const
+    {
+        // credits in use by the server
+        const int64 inFlight = m_granted - m_received;
+        // elements which can still receive data
+        const int64 capacity = int64(m_freeQueue.size()) + (m_queueSize - m_allocated);
+        const int64 credits = std::min(int64(m_window), capacity) - inFlight;
+        return credits > 0 ? int32(credits) : 0;
+    }
+
+    // call with m_mutex locked
+    bool ackNeeded() const
+    {
+        if (!m_pipeline || m_reportQueueStateInProgress)
+            return false;
+        if (!m_adaptive)
+            return m_releasedCount >= m_ackAny;
+
+        // refill the window when half empty, at once if the server has no credit left
+        const int32 credits = grantableCredits();
+        const int32 threshold = (m_granted == m_received) ? 1 : std::max(1, m_window / 2);
+        return credits >= threshold;
+    }
+
+    // call with m_mutex locked
+    void requestAck()
+    {
+        m_reportQueueStateInProgress = true;
+        try
+        {
+            m_channel->checkAndGetTransport()->enqueueSendRequest(shared_from_this());
+        } catch (std::runtime_error&) {
+            // assume wrong connection state from checkAndGetTransport()
+            m_reportQueueStateInProgress = false;
+        } catch (std::exception& e) {
+            LOG(logLevelWarn, "Ignore exception during MonitorStrategyQueue::release: %s", e.what());
+            m_reportQueueStateInProgress = false;
         }
     }
 
+    // new round trip time sample, call with m_mutex locked
+    void updateWindow(double rtt)
+    {
+        // smoothed like TCP
+        m_rtt = (m_rtt > 0.0) ? (0.875 * m_rtt + 0.125 * rtt) : rtt;
+        if (m_releaseRate <= 0.0)
+            return;
+
+        double window = 2.0 * m_releaseRate * m_rtt;
+        if (window > m_queueSize)
+            window = m_queueSize;
+        m_window = std::max(minPipelineWindow, std::min(m_queueSize, int32(window + 0.5)));
+    }
+
+public:
+
 
     virtual void response(Transport::shared_pointer const & transport, ByteBuffer* payloadBuffer) OVERRIDE FINAL {
 
@@ -1961,6 +2272,9 @@ public:
 
             if (m_overrunInProgress)
             {
+                if (m_adaptive)
+                    m_received++;
+
                 PVStructurePtr pvStructure = m_overrunElement->pvStructurePtr;
                 BitSet::shared_pointer changedBitSet = m_overrunElement->changedBitSet;
                 BitSet::shared_pointer overrunBitSet = m_overrunElement->overrunBitSet;
@@ -1985,15 +2299,30 @@ public:
                 return;
             }
 
+            if (m_freeQueue.empty() && m_allocated < m_queueSize)
+                m_freeQueue.push_back(createElement());
+
             MonitorElementPtr newElement = m_freeQueue.back();
             m_freeQueue.pop_back();
 
-            if (m_freeQueue.empty())
+            if (m_freeQueue.empty() && m_allocated >= m_queueSize)
             {
                 m_overrunInProgress = true;
                 m_overrunElement = newElement;
             }
 
+            if (m_adaptive)
+            {
+                m_received++;
+                if (m_rttElement && m_received >= m_rttElement)
+                {
+                    m_rttElement = 0;
+                    updateWindow(epicsTime::getCurrent() - m_rttStart);
+                }
+                if (ackNeeded())
+                    requestAck();
+            }
+
             // setup current fields
             PVStructurePtr pvStructure = newElement->pvStructurePtr;
             BitSet::shared_pointer changedBitSet = newElement->changedBitSet;
@@ -2060,11 +2389,14 @@ public:
         if (monitorElement->pvStructurePtr->getStructure().get() != m_lastStructure.get())
             return;
 
-        bool sendAck = false;
         {
             Lock guard(m_mutex);
 
-            m_freeQueue.push_back(monitorElement);
+            // with the adaptive window, keep no more free elements than can be in flight
+            if (m_adaptive && int32(m_freeQueue.size()) >= m_window && !m_overrunInProgress)
+                m_allocated--;
+            else
+                m_freeQueue.push_back(monitorElement);
 
             if (m_overrunInProgress)
             {
@@ -2082,25 +2414,9 @@ public:
             if (m_pipeline)
             {
                 m_releasedCount++;
-                if (!m_reportQueueStateInProgress && m_releasedCount >= m_ackAny)
-                {
-                    sendAck = true;
-                    m_reportQueueStateInProgress = true;
-                }
-            }
-
-            if (sendAck)
-            {
-                try
-                {
-                    m_channel->checkAndGetTransport()->enqueueSendRequest(shared_from_this());
-                } catch (std::runtime_error&) {
-                    // assume wrong connection state from checkAndGetTransport()
-                    m_reportQueueStateInProgress = false;
-                } catch (std::exception& e) {
-                    LOG(logLevelWarn, "Ignore exception during MonitorStrategyQueue::release: %s", e.what());
-                    m_reportQueueStateInProgress = false;
-                }
+                m_releasedSinceRate++;
+                if (ackNeeded())
+                    requestAck();
             }
         }
     }
@@ -2113,7 +2429,35 @@ public:
 
         {
             Lock guard(m_mutex);
-            buffer->putInt(m_releasedCount);
+            if (m_adaptive)
+            {
+                const int32 credits = grantableCredits();
+                const epicsTime now(epicsTime::getCurrent());
+
+                // consumer release rate, over at least 10ms
+                const double interval = now - m_rateStart;
+                if (interval >= 0.01)
+                {
+                    const double rate = m_releasedSinceRate / interval;
+                    m_releaseRate = (m_releaseRate > 0.0) ? (0.75 * m_releaseRate + 0.25 * rate) : rate;
+                    m_releasedSinceRate = 0;
+                    m_rateStart = now;
+                }
+
+                // the first element sent on these credits completes a round trip
+                if (!m_rttElement && credits > 0)
+                {
+                    m_rttElement = m_granted + 1;
+                    m_rttStart = now;
+                }
+
+                m_granted += credits;
+                buffer->putInt(credits);
+            }
+            else
+            {
+                buffer->putInt(m_releasedCount);
+            }
             m_releasedCount = 0;
             m_reportQueueStateInProgress = false;
         }
@@ -2166,6 +2510,9 @@ public:
     int32 m_queueSize;
     bool m_pipeline;
     int32 m_ackAny;
+    bool m_adaptive;
+    // credits granted by the INIT request
+    int32 m_initialWindow;
 
     ChannelMonitorImpl(
         ChannelImpl::shared_pointer const & channel,
@@ -2178,7 +2525,9 @@ public:
         m_pvRequest(pvRequest),
         m_queueSize(2),
         m_pipeline(false),
-        m_ackAny(0)
+        m_ackAny(0),
+        m_adaptive(false),
+        m_initialWindow(0)
     {
         PVACCESS_REFCOUNT_MONITOR_CONSTRUCT(channelMonitor);
     }
@@ -2230,14 +2579,25 @@ public:
                     else
                         m_ackAny = (m_ackAny <= m_queueSize) ? size : m_queueSize;
                 }
+
+                // credit window sized from the round trip time and release rate, ackAny is ignored
+                pvString = pvOptions->getSubField<PVString>("adaptive");
+                if (pvString)
+                    m_adaptive = (pvString->get() == "true");
             }
         }
 
+        // the window grows from a quarter of the queue
+        m_initialWindow = m_adaptive ?
+                          std::max(minPipelineWindow, m_queueSize/4) :
+                          m_queueSize;
+
         BaseRequestImpl::activate();
 
         std::tr1::shared_ptr<MonitorStrategyQueue> tp(
             new MonitorStrategyQueue(m_channel, m_ioid, m_callback, m_queueSize,
-                                     m_pipeline, m_ackAny)
+                                     m_pipeline, m_ackAny,
+                                     m_adaptive, m_initialWindow)
         );
         m_monitorStrategy = tp;
 
@@ -2285,11 +2645,11 @@ public:
             // pvRequest
             SerializationHelper::serializePVRequest(buffer, control, m_pvRequest);
 
-            // if streaming
+            // if streaming, initial credits
             if (pendingRequest & QOS_GET_PUT)
             {
                 control->ensureBuffer(4);
-                buffer->putInt(m_queueSize);
+                buffer->putInt(m_initialWindow);
             }
         }
 
@@ -2457,6 +2817,14 @@ public:
         m_monitorStrategy->release(monitorElement);
     }
 
+    virtual void getStats(Stats& s) const OVERRIDE FINAL
+    {
+        if (m_monitorStrategy)
+            m_monitorStrategy->getStats(s);
+        else
+            Monitor::getStats(s);
+    }
+
 };
 
 
@@ -3256,6 +3624,21 @@ private:
          */
         ServerGUID m_guid;
 
+        /**
+         * Direct connect to a server remembered in the name cache is in progress.
+         */
+        bool m_nameCacheAttempt;
+
+        /**
+         * Name cache entry being tried.
+         */
+        ChannelNameCache::Entry m_nameCacheEntry;
+
+        /**
+         * Entry of the (re)connect timer, see callback().
+         */
+        TimingWheel::Entry m_timerEntry;
+
     public:
         static size_t num_instances;
         static size_t num_active;
@@ -3286,7 +3669,8 @@ private:
             m_needSubscriptionUpdate(false),
             m_allowCreation(true),
             m_serverChannelID(0xFFFFFFFF),
-            m_issueCreateMessage(true)
+            m_issueCreateMessage(true),
+            m_nameCacheAttempt(false)
         {
             REFTRACE_INCREMENT(num_instances);
             PVACCESS_REFCOUNT_MONITOR_CONSTRUCT(channel);
@@ -3476,7 +3860,21 @@ public:
             }
 
             m_transport = transport;
-            m_transport->enqueueSendRequest(internal_from_this());
+            m_context->getChannelCreateBatch(transport)->add(internal_from_this());
+        }
+
+        /**
+         * Check if create channel request is still to be sent over the given transport.
+         * @param transport transport.
+         * @return <code>true</code> if create channel request is to be sent.
+         */
+        bool isCreatePending(Transport const * transport)
+        {
+            Lock guard(m_channelMutex);
+            return m_issueCreateMessage &&
+                   m_transport.get() == transport &&
+                   m_connectionState != CONNECTED &&
+                   m_connectionState != DESTROYED;
         }
 
         virtual void cancel() {
@@ -3503,6 +3901,16 @@ public:
                 m_transport.reset();
             }
 
+            if (m_nameCacheAttempt)
+            {
+                // stale name cache entry, forget it and do a regular search
+                m_nameCacheAttempt = false;
+                if (m_context->m_nameCache)
+                    m_context->m_nameCache->remove(m_name);
+                initiateSearch();
+                return;
+            }
+
             // ... and search again, with penalty
             initiateSearch(true);
         }
@@ -3533,6 +3941,16 @@ public:
 
                     m_addressIndex = 0; // reset
 
+                    // server has validated the name, remember where it lives
+                    if (m_nameCacheAttempt)
+                    {
+                        // a search started meanwhile is not needed any more
+                        m_nameCacheAttempt = false;
+                        m_context->getChannelSearchManager()->unregisterSearchInstance(internal_from_this());
+                    }
+                    if (m_addresses.empty() && m_context->m_nameCache && m_transport)
+                        m_context->m_nameCache->update(m_name, *m_transport->getRemoteAddress(), m_guid);
+
                     // user might create monitors in listeners, so this has to be done before this can happen
                     // however, it would not be nice if events would come before connection event is fired
                     // but this cannot happen since transport (TCP) is serving in this thread
@@ -3665,6 +4083,7 @@ public:
 
 #define STATIC_SEARCH_BASE_DELAY_SEC 5
 #define STATIC_SEARCH_MAX_MULTIPLIER 10
+#define NAME_CACHE_CONNECT_TMO_SEC 1.0
 
         /**
          * Initiate search (connect) procedure.
@@ -3677,16 +4096,102 @@ public:
 
             if (m_addresses.empty())
             {
-                m_context->getChannelSearchManager()->registerSearchInstance(internal_from_this(), penalize);
+                // try the server which hosted this channel last time first (see nameCacheConnect()),
+                // search if that does not succeed within NAME_CACHE_CONNECT_TMO_SEC (see callback())
+                if (!penalize && m_context->m_nameCache && m_context->m_nameCachePool &&
+                        m_context->m_nameCache->lookup(m_name, m_nameCacheEntry) &&
+                        m_context->m_nameCachePool->trySubmit(this,
+                                WorkerPool::Task::shared_pointer(new NameCacheConnect(internal_from_this()))))
+                {
+                    m_nameCacheAttempt = true;
+                    m_context->getTimingWheel()->schedule(m_timerEntry, internal_from_this(), NAME_CACHE_CONNECT_TMO_SEC);
+                }
+                else
+                {
+                    m_nameCacheAttempt = false;
+                    m_context->getChannelSearchManager()->registerSearchInstance(internal_from_this(), penalize);
+                }
             }
             else
             {
-                m_context->getTimer()->scheduleAfterDelay(internal_from_this(),
+                m_context->getTimingWheel()->schedule(m_timerEntry, internal_from_this(),
                         (m_addressIndex / m_addresses.size())*STATIC_SEARCH_BASE_DELAY_SEC);
             }
         }
 
+        /**
+         * Direct connect to the server found in the name cache, run by the name cache pool.
+         */
+        class NameCacheConnect : public WorkerPool::Task
+        {
+        public:
+            explicit NameCacheConnect(InternalChannelImpl::shared_pointer const & channel) : m_channel(channel) {}
+
+            virtual void run() OVERRIDE FINAL
+            {
+                InternalChannelImpl::shared_pointer channel(m_channel.lock());
+                if (channel)
+                    channel->nameCacheConnect();
+            }
+
+        private:
+            InternalChannelImpl::weak_pointer m_channel;
+        };
+
+        void nameCacheConnect()
+        {
+            ServerGUID guid;
+            osiSockAddr serverAddress;
+            {
+                Lock guard(m_channelMutex);
+                if (!m_nameCacheAttempt || m_transport || m_connectionState == DESTROYED)
+                    return;
+                guid = m_nameCacheEntry.guid;
+                serverAddress = m_nameCacheEntry.address;
+            }
+
+            // blocks up to the connection timeout for a dead server, hence neither under the lock nor on a timer thread
+            Transport::shared_pointer transport(m_context->getTransport(internal_from_this(), &serverAddress,
+                                                PVA_PROTOCOL_REVISION, m_priority));
+
+            Lock guard(m_channelMutex);
+            if (!transport)
+            {
+                // unreachable, forget it and search right away
+                if (m_nameCacheAttempt)
+                {
+                    m_nameCacheAttempt = false;
+                    if (m_context->m_nameCache)
+                        m_context->m_nameCache->remove(m_name);
+                    if (!m_transport && m_connectionState != DESTROYED)
+                        m_context->getChannelSearchManager()->registerSearchInstance(internal_from_this());
+                }
+                return;
+            }
+
+            if (!m_nameCacheAttempt || m_transport || m_connectionState == DESTROYED)
+            {
+                // the search was faster, or the channel is gone
+                if (transport.get() != m_transport.get())
+                    transport->release(getID());
+                return;
+            }
+
+            // NOTE: calls createChannelFailed() on failure, which falls back to search
+            std::copy(guid.value, guid.value + 12, m_guid.value);
+            createChannel(transport);
+        }
+
         virtual void callback() OVERRIDE FINAL {
+            if (m_addresses.empty())
+            {
+                // the direct connect to the server found in the name cache takes too long, search as well
+                Lock guard(m_channelMutex);
+                if (m_nameCacheAttempt && !m_transport && m_connectionState != DESTROYED)
+                    m_context->getChannelSearchManager()->registerSearchInstance(internal_from_this());
+                return;
+            }
+
             // TODO cancellaction?!
             // TODO not in this timer thread !!!
             // TODO boost when a server (from address list) is started!!! IP vs address !!!
@@ -3794,21 +4299,15 @@ public:
         }
 
         void transportUnresponsive() OVERRIDE FINAL {
-            /*
+            // the server did not answer within the liveness timeout,
+            // give up the transport and search again (e.g. for a standby server)
+            if (isConnected())
             {
-                Lock guard(m_channelMutex);
-                if (m_connectionState == CONNECTED)
-                {
-            		// TODO 2 types of disconnected state - distinguish them otherwise disconnect will handle connection loss right
-                    setConnectionState(DISCONNECTED);
+                disconnect(true, false);
 
-                    // ... PVA notifies also w/ no access rights callback, although access right are not changed
-                }
+                // should be called without any lock hold
+                reportChannelStateChange();
             }
-
-            // should be called without any lock hold
-            reportChannelStateChange();
-            */
         }
 
         /**
@@ -4052,6 +4551,131 @@ public:
         }
     };
 
+    /**
+     * Collects create channel requests of the channels connecting over the same transport,
+     * so that they are sent (and flushed) together.
+     */
+    class ChannelCreateBatch :
+        public TransportSender,
+        public std::tr1::enable_shared_from_this<ChannelCreateBatch>
+    {
+    public:
+        POINTER_DEFINITIONS(ChannelCreateBatch);
+
+        /**
+         * Constructor.
+         * @param transport transport to send requests over.
+         * @param bulkMessages put many channels into one CMD_CREATE_CHANNEL message (requires server support).
+         */
+        ChannelCreateBatch(Transport::shared_pointer const & transport, bool bulkMessages) :
+            m_transport(transport),
+            m_bulkMessages(bulkMessages),
+            m_queued(false)
+        {
+        }
+
+        void add(InternalChannelImpl::shared_pointer const & channel)
+        {
+            {
+                Lock guard(m_mutex);
+                m_channels.push_back(channel);
+                if (m_queued)
+                    return;
+                m_queued = true;
+            }
+
+            Transport::shared_pointer transport(m_transport.lock());
+            if (transport)
+                transport->enqueueSendRequest(shared_from_this());
+        }
+
+        bool isTransportAlive() const {
+            return !m_transport.expired();
+        }
+
+        virtual void send(ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL {
+            channels_t channels;
+            {
+                Lock guard(m_mutex);
+                channels.swap(m_channels);
+                m_queued = false;
+            }
+
+            Transport::shared_pointer transport(m_transport.lock());
+            if (!transport)
+                return;
+
+            // skip channels destroyed or moved to another server in the meantime
+            std::vector<InternalChannelImpl::shared_pointer> pending;
+            pending.reserve(channels.size());
+            for (size_t i = 0; i < channels.size(); i++)
+            {
+                InternalChannelImpl::shared_pointer channel(channels[i].lock());
+                if (channel && channel->isCreatePending(transport.get()))
+                    pending.push_back(channel);
+            }
+
+            const size_t perMessage = m_bulkMessages ? (size_t)MAX_CHANNELS_PER_MESSAGE : 1;
+            for (size_t i = 0; i < pending.size(); )
+            {
+                const size_t count = (pending.size() - i < perMessage) ? pending.size() - i : perMessage;
+
+                if (i > 0)
+                    control->endMessage();
+                control->startMessage((int8)CMD_CREATE_CHANNEL, 2+4);
+
+                // count
+                buffer->putShort((int16)count);
+                // array of CIDs and names
+                for (size_t n = 0; n < count; n++, i++)
+                {
+                    control->ensureBuffer(4);
+                    buffer->putInt(pending[i]->getChannelID());
+                    SerializeHelper::serializeString(pending[i]->getChannelName(), buffer, control);
+                }
+            }
+
+            // send immediately
+            if (!pending.empty())
+                control->flush(true);
+        }
+
+    private:
+        static const size_t MAX_CHANNELS_PER_MESSAGE = 256;
+
+        Transport::weak_pointer m_transport;
+        const bool m_bulkMessages;
+
+        typedef std::vector<InternalChannelImpl::weak_pointer> channels_t;
+        channels_t m_channels;
+        bool m_queued;
+        Mutex m_mutex;
+    };
+
+    /**
+     * Get (and if necessary create) create channel request batch of a transport.
+     * @param transport transport.
+     * @return batch.
+     */
+    ChannelCreateBatch::shared_pointer getChannelCreateBatch(Transport::shared_pointer const & transport)
+    {
+        Lock guard(m_channelCreateBatchesMutex);
+
+        // forget batches of destroyed transports (before the address could be reused)
+        for (ChannelCreateBatchMap::iterator it = m_channelCreateBatches.begin(); it != m_channelCreateBatches.end(); )
+        {
+            if (it->second->isTransportAlive())
+                it++;
+            else
+                m_channelCreateBatches.erase(it++);
+        }
+
+        ChannelCreateBatch::shared_pointer& batch = m_channelCreateBatches[transport.get()];
+        if (!batch)
+            batch.reset(new ChannelCreateBatch(transport, m_bulkCreateChannel));
+        return batch;
+    }
+
 
 
 
@@ -4059,9 +4683,12 @@ public:
     static size_t num_instances;
 
     InternalClientContextImpl(const Configuration::shared_pointer& conf) :
-        m_addressList(""), m_autoAddressList(true), m_connectionTimeout(30.0f), m_beaconPeriod(15.0f),
+        m_addressList(""), m_autoAddressList(true), m_connectionTimeout(30.0f),
+        m_heartbeatPeriod(0.0f), m_livenessTimeout(0.0f), m_beaconPeriod(15.0f),
         m_broadcastPort(PVA_BROADCAST_PORT), m_receiveBufferSize(MAX_TCP_RECV),
-        m_lastCID(0), m_lastIOID(0),
+        m_bulkCreateChannel(false),
+        m_channelsByCID(CLIENT_ID_INDEX_BITS, CLIENT_ID_MIN_FREE),
+        m_pendingResponseRequests(CLIENT_ID_INDEX_BITS, CLIENT_ID_MIN_FREE),
         m_version("pvAccess Client", "cpp",
                   EPICS_PVA_MAJOR_VERSION,
                   EPICS_PVA_MINOR_VERSION,
@@ -4093,6 +4720,16 @@ public:
         return m_timer;
     }
 
+    virtual TimingWheel::shared_pointer getTimingWheel() OVERRIDE FINAL
+    {
+        return m_timingWheel;
+    }
+
+    virtual HeartbeatService::shared_pointer getHeartbeatService() OVERRIDE FINAL
+    {
+        return m_heartbeatService;
+    }
+
     virtual TransportRegistry* getTransportRegistry() OVERRIDE FINAL
     {
         return &m_transportRegistry;
@@ -4103,6 +4740,36 @@ public:
         return m_searchTransport;
     }
 
+    virtual void getLikelyServers(std::string const & name, std::vector<osiSockAddr>& servers) OVERRIDE FINAL
+    {
+        BloomFilter::Hash hash(name);
+
+        // servers not advertising a filter might host anything
+        std::vector<osiSockAddr> unfiltered;
+        bool filtered = false;
+
+        Lock guard(m_beaconMapMutex);
+        for (AddressBeaconHandlerMap::const_iterator it = m_beaconHandlers.begin(); it != m_beaconHandlers.end(); it++)
+        {
+            // beacon source address, servers listen for searches on the broadcast port
+            osiSockAddr address(it->first);
+            address.ia.sin_port = htons(m_broadcastPort);
+
+            if (!it->second->hasChannelFilter())
+                unfiltered.push_back(address);
+            else
+            {
+                filtered = true;
+                if (it->second->mightHostChannel(hash))
+                    servers.push_back(address);
+            }
+        }
+
+        // no filters at all, let the search be broadcast
+        if (filtered)
+            servers.insert(servers.end(), unfiltered.begin(), unfiltered.end());
+    }
+
     virtual void initialize() OVERRIDE FINAL {
         Lock lock(m_contextMutex);
 
@@ -4124,9 +4791,13 @@ public:
         out << "ADDR_LIST          : " << m_addressList << std::endl;
         out << "AUTO_ADDR_LIST     : " << (m_autoAddressList ? "true" : "false") << std::endl;
         out << "CONNECTION_TIMEOUT : " << m_connectionTimeout << std::endl;
+        out << "HEARTBEAT_PERIOD   : " << m_heartbeatPeriod << std::endl;
+        out << "LIVENESS_TIMEOUT   : " << m_livenessTimeout << std::endl;
         out << "BEACON_PERIOD      : " << m_beaconPeriod << std::endl;
         out << "BROADCAST_PORT     : " << m_broadcastPort << std::endl;;
         out << "RCV_BUFFER_SIZE    : " << m_receiveBufferSize << std::endl;
+        out << "NAME_CACHE         : " << m_nameCacheFile << std::endl;
+        out << "BULK_CREATE_CHANNEL: " << (m_bulkCreateChannel ? "YES" : "NO") << std::endl;
         out << "STATE              : ";
         switch (m_contextState)
         {
@@ -4195,18 +4866,35 @@ private:
         m_addressList = m_configuration->getPropertyAsString("EPICS_PVA_ADDR_LIST", m_addressList);
         m_autoAddressList = m_configuration->getPropertyAsBoolean("EPICS_PVA_AUTO_ADDR_LIST", m_autoAddressList);
         m_connectionTimeout = m_configuration->getPropertyAsFloat("EPICS_PVA_CONN_TMO", m_connectionTimeout);
+        // defaults keep the old behaviour: echo after 3/4, disconnect after 3/2 of the connection timeout
+        m_heartbeatPeriod = m_configuration->getPropertyAsFloat("EPICS_PVA_HEARTBEAT_PERIOD", (3*m_connectionTimeout)/4);
+        if (m_heartbeatPeriod <= 0.0f)
+            m_heartbeatPeriod = (3*m_connectionTimeout)/4;
+        m_livenessTimeout = m_configuration->getPropertyAsFloat("EPICS_PVA_LIVENESS_TMO", 2*m_heartbeatPeriod);
+        if (m_livenessTimeout <= m_heartbeatPeriod)
+        {
+            LOG(logLevelWarn, "EPICS_PVA_LIVENESS_TMO must be greater than EPICS_PVA_HEARTBEAT_PERIOD, using %f s.",
+                2*m_heartbeatPeriod);
+            m_livenessTimeout = 2*m_heartbeatPeriod;
+        }
         m_beaconPeriod = m_configuration->getPropertyAsFloat("EPICS_PVA_BEACON_PERIOD", m_beaconPeriod);
         m_broadcastPort = m_configuration->getPropertyAsInteger("EPICS_PVA_BROADCAST_PORT", m_broadcastPort);
         m_receiveBufferSize = m_configuration->getPropertyAsInteger("EPICS_PVA_MAX_ARRAY_BYTES", m_receiveBufferSize);
+        m_nameCacheFile = m_configuration->getPropertyAsString("EPICS_PVA_NAME_CACHE", m_nameCacheFile);
+        m_bulkCreateChannel = m_configuration->getPropertyAsBoolean("EPICS_PVA_BULK_CREATE_CHANNEL", m_bulkCreateChannel);
     }
 
     void internalInitialize() {
 
         osiSockAttach();
         m_timer.reset(new Timer("pvAccess-client timer", lowPriority));
+        m_timingWheel.reset(new TimingWheel("pvAccess-client wheel", lowPriority));
+        // liveness is checked with a resolution of 1/4 of the heartbeat period,
+        // a dead server is detected within m_livenessTimeout + m_heartbeatPeriod/4
+        m_heartbeatService.reset(new HeartbeatService(m_timingWheel, m_heartbeatPeriod/4));
         InternalClientContextImpl::shared_pointer thisPointer = internal_from_this();
         // stores weak_ptr
-        m_connector.reset(new BlockingTCPConnector(thisPointer, m_receiveBufferSize, m_connectionTimeout));
+        m_connector.reset(new BlockingTCPConnector(thisPointer, m_receiveBufferSize, m_heartbeatPeriod, m_livenessTimeout));
 
         // stores many weak_ptr
         m_responseHandler.reset(new ClientResponseHandler(thisPointer));
@@ -4222,6 +4910,16 @@ private:
         // setup search manager
         m_channelSearchManager = SimpleChannelSearchManagerImpl::create(thisPointer);
 
+        // load name -> server cache from the previous run
+        if (!m_nameCacheFile.empty())
+        {
+            m_nameCache.reset(new ChannelNameCache(m_nameCacheFile));
+            size_t count = m_nameCache->load();
+            LOG(logLevelDebug, "Loaded %u entries from channel name cache '%s'.",
+                (unsigned)count, m_nameCacheFile.c_str());
+            m_nameCachePool.reset(new WorkerPool("pvAccess-client name cache", 4, 1024, lowPriority));
+        }
+
         // TODO what if initialization failed!!!
     }
 
@@ -4261,6 +4959,13 @@ private:
         // this will also close all PVA transports
         destroyAllChannels();
 
+        // the channels are destroyed, the remaining tasks return at once (a connect in progress aside)
+        if (m_nameCachePool)
+            m_nameCachePool->close();
+
+        if (m_nameCache)
+            m_nameCache->save();
+
         // stop UDPs
         for (BlockingUDPTransportVector::const_iterator iter = m_udpTransports.begin();
                 iter != m_udpTransports.end(); iter++)
@@ -4284,25 +4989,23 @@ private:
 
         if (transportCount)
             LOG(logLevelDebug, "PVA client context destroyed with %d transport(s) active.", transportCount);
+
+        // scheduled channels hold references to this context
+        if (m_timingWheel)
+            m_timingWheel->close();
     }
 
     void destroyAllChannels() {
         Lock guard(m_cidMapMutex);
 
-        int count = 0;
-        std::vector<ChannelImpl::weak_pointer> channels(m_channelsByCID.size());
-        for (CIDChannelMap::iterator iter = m_channelsByCID.begin();
-                iter != m_channelsByCID.end();
-                iter++)
-        {
-            channels[count++] = iter->second;
-        }
+        std::vector<ChannelImpl::weak_pointer> channels;
+        m_channelsByCID.values(channels);
 
         guard.unlock();
 
 
         ChannelImpl::shared_pointer ptr;
-        for (int i = 0; i < count; i++)
+        for (size_t i = 0; i < channels.size(); i++)
         {
             ptr = channels[i].lock();
             if (ptr)
@@ -4341,7 +5044,10 @@ private:
     void registerChannel(ChannelImpl::shared_pointer const & channel) OVERRIDE FINAL
     {
         Lock guard(m_cidMapMutex);
-        m_channelsByCID[channel->getChannelID()] = ChannelImpl::weak_pointer(channel);
+        // CID is reserved by generateCID()
+        ChannelImpl::weak_pointer* slot = m_channelsByCID.find(channel->getChannelID());
+        if (slot)
+            *slot = channel;
     }
 
     /**
@@ -4362,8 +5068,8 @@ private:
     Channel::shared_pointer getChannel(pvAccessID channelID) OVERRIDE FINAL
     {
         Lock guard(m_cidMapMutex);
-        CIDChannelMap::iterator it = m_channelsByCID.find(channelID);
-        return (it == m_channelsByCID.end() ? Channel::shared_pointer() : static_pointer_cast<Channel>(it->second.lock()));
+        ChannelImpl::weak_pointer* slot = m_channelsByCID.find(channelID);
+        return (slot ? static_pointer_cast<Channel>(slot->lock()) : Channel::shared_pointer());
     }
 
     /**
@@ -4374,11 +5080,8 @@ private:
     {
         Lock guard(m_cidMapMutex);
 
-        // search first free (theoretically possible loop of death)
-        while (m_channelsByCID.find(++m_lastCID) != m_channelsByCID.end()) ;
         // reserve CID
-        m_channelsByCID[m_lastCID].reset();
-        return m_lastCID;
+        return m_channelsByCID.insert(ChannelImpl::weak_pointer());
     }
 
     /**
@@ -4399,9 +5102,9 @@ private:
     ResponseRequest::shared_pointer getResponseRequest(pvAccessID ioid) OVERRIDE FINAL
     {
         Lock guard(m_ioidMapMutex);
-        IOIDResponseRequestMap::iterator it = m_pendingResponseRequests.find(ioid);
-        if (it == m_pendingResponseRequests.end()) return ResponseRequest::shared_pointer();
-        return it->second.lock();
+        ResponseRequest::weak_pointer* slot = m_pendingResponseRequests.find(ioid);
+        if (!slot) return ResponseRequest::shared_pointer();
+        return slot->lock();
     }
 
     /**
@@ -4412,9 +5115,7 @@ private:
     pvAccessID registerResponseRequest(ResponseRequest::shared_pointer const & request) OVERRIDE FINAL
     {
         Lock guard(m_ioidMapMutex);
-        pvAccessID ioid = generateIOID();
-        m_pendingResponseRequests[ioid] = ResponseRequest::weak_pointer(request);
-        return ioid;
+        return m_pendingResponseRequests.insert(ResponseRequest::weak_pointer(request));
     }
 
     /**
@@ -4427,33 +5128,15 @@ private:
         if (ioid == INVALID_IOID) return ResponseRequest::shared_pointer();
 
         Lock guard(m_ioidMapMutex);
-        IOIDResponseRequestMap::iterator it = m_pendingResponseRequests.find(ioid);
-        if (it == m_pendingResponseRequests.end())
+        ResponseRequest::weak_pointer* slot = m_pendingResponseRequests.find(ioid);
+        if (!slot)
             return ResponseRequest::shared_pointer();
 
-        ResponseRequest::shared_pointer retVal = it->second.lock();
-        m_pendingResponseRequests.erase(it);
+        ResponseRequest::shared_pointer retVal = slot->lock();
+        m_pendingResponseRequests.erase(ioid);
         return retVal;
     }
 
-    /**
-     * Generate IOID.
-     * @return IOID.
-     */
-    pvAccessID generateIOID()
-    {
-        Lock guard(m_ioidMapMutex);
-
-        // search first free (theoretically possible loop of death)
-        do {
-            while (m_pendingResponseRequests.find(++m_lastIOID) != m_pendingResponseRequests.end()) ;
-        } while (m_lastIOID == INVALID_IOID);
-
-        // reserve IOID
-        m_pendingResponseRequests[m_lastIOID].reset();
-        return m_lastIOID;
-    }
-
     /**
      * Called each time beacon anomaly is detected.
      */
@@ -4619,6 +5302,17 @@ private:
      */
     float m_connectionTimeout;
 
+    /**
+     * If there is no traffic from a server for heartbeatPeriod seconds, an echo is sent to it.
+     */
+    float m_heartbeatPeriod;
+
+    /**
+     * If there is no traffic from a server for livenessTimeout seconds (an echo was not answered),
+     * its channels are disconnected and searched for again.
+     */
+    float m_livenessTimeout;
+
     /**
      * Period in second between two beacon signals.
      */
@@ -4634,11 +5328,52 @@ private:
      */
     int m_receiveBufferSize;
 
+    /**
+     * File of the persistent channel name to server cache, empty if disabled.
+     */
+    string m_nameCacheFile;
+
+    /**
+     * Channel name to server cache, <code>0</code> if disabled.
+     */
+    ChannelNameCache::shared_pointer m_nameCache;
+
+    /**
+     * Threads of the direct connects to the servers of the name cache.
+     */
+    WorkerPool::shared_pointer m_nameCachePool;
+
+    /**
+     * Send create requests of many channels in one message (requires server support).
+     */
+    bool m_bulkCreateChannel;
+
+    /**
+     * Create channel request batch of each transport.
+     */
+    typedef std::map<const Transport*, ChannelCreateBatch::shared_pointer> ChannelCreateBatchMap;
+    ChannelCreateBatchMap m_channelCreateBatches;
+
+    /**
+     * m_channelCreateBatches mutex.
+     */
+    Mutex m_channelCreateBatchesMutex;
+
     /**
      * Timer.
      */
     Timer::shared_pointer m_timer;
 
+    /**
+     * Timing wheel.
+     */
+    TimingWheel::shared_pointer m_timingWheel;
+
+    /**
+     * Liveness checks of all the transports.
+     */
+    HeartbeatService::shared_pointer m_heartbeatService;
+
     /**
      * UDP transports needed to receive channel searches.
      */
@@ -4666,37 +5401,25 @@ private:
     ClientResponseHandler::shared_pointer m_responseHandler;
 
     /**
-     * Map of channels (keys are CIDs).
+     * Table of channels (keys are CIDs).
      */
-    // TODO consider std::unordered_map
-    typedef std::map<pvAccessID, ChannelImpl::weak_pointer> CIDChannelMap;
-    CIDChannelMap m_channelsByCID;
+    IDTable<ChannelImpl::weak_pointer> m_channelsByCID;
 
     /**
-     *  CIDChannelMap mutex.
+     *  m_channelsByCID mutex.
      */
     Mutex m_cidMapMutex;
 
     /**
-     * Last CID cache.
+     * Table of pending response requests (keys are IOIDs).
      */
-    pvAccessID m_lastCID;
+    IDTable<ResponseRequest::weak_pointer> m_pendingResponseRequests;
 
     /**
-     * Map of pending response requests (keys are IOID).
-     */
-    IOIDResponseRequestMap m_pendingResponseRequests;
-
-    /**
-     *  IOIDResponseRequestMap mutex.
+     *  m_pendingResponseRequests mutex.
      */
     Mutex m_ioidMapMutex;
 
-    /**
-     * Last IOID cache.
-     */
-    pvAccessID m_lastIOID;
-
     /**
      * Channel search manager.
      * Manages UDP search requests.
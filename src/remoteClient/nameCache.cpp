@@ -0,0 +1,196 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+
+#define epicsExportSharedSymbols
+#include <pv/nameCache.h>
+#include <pv/inetAddressUtil.h>
+#include <pv/logger.h>
+
+using namespace std;
+using namespace epics::pvData;
+
+namespace epics {
+namespace pvAccess {
+
+namespace {
+
+const char hexDigits[] = "0123456789abcdef";
+
+string guidToHex(const ServerGUID& guid)
+{
+    string ret(2*sizeof(guid.value), '0');
+    for (size_t i = 0; i < sizeof(guid.value); i++)
+    {
+        unsigned char c = (unsigned char)guid.value[i];
+        ret[2*i]   = hexDigits[c >> 4];
+        ret[2*i+1] = hexDigits[c & 0xF];
+    }
+    return ret;
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool hexToGUID(const string& hex, ServerGUID& guid)
+{
+    if (hex.length() != 2*sizeof(guid.value))
+        return false;
+    for (size_t i = 0; i < sizeof(guid.value); i++)
+    {
+        int hi = hexValue(hex[2*i]), lo = hexValue(hex[2*i+1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        guid.value[i] = (char)((hi << 4) | lo);
+    }
+    return true;
+}
+
+} // namespace
+
+ChannelNameCache::ChannelNameCache(std::string const & fileName) :
+    m_fileName(fileName),
+    m_entries(),
+    m_dirty(false),
+    m_mutex()
+{
+}
+
+ChannelNameCache::~ChannelNameCache()
+{
+}
+
+bool ChannelNameCache::lookup(std::string const & name, Entry& entry) const
+{
+    Lock guard(m_mutex);
+    entries_t::const_iterator it = m_entries.find(name);
+    if (it == m_entries.end())
+        return false;
+    entry = it->second;
+    return true;
+}
+
+void ChannelNameCache::update(std::string const & name, const osiSockAddr& address, const ServerGUID& guid)
+{
+    Lock guard(m_mutex);
+    entries_t::iterator it = m_entries.find(name);
+    if (it != m_entries.end() &&
+            sockAddrAreIdentical(&it->second.address, &address) &&
+            memcmp(it->second.guid.value, guid.value, sizeof(guid.value)) == 0)
+        return;
+
+    Entry& entry = m_entries[name];
+    entry.address = address;
+    entry.guid = guid;
+    m_dirty = true;
+}
+
+void ChannelNameCache::remove(std::string const & name)
+{
+    Lock guard(m_mutex);
+    if (m_entries.erase(name))
+        m_dirty = true;
+}
+
+size_t ChannelNameCache::size() const
+{
+    Lock guard(m_mutex);
+    return m_entries.size();
+}
+
+size_t ChannelNameCache::load()
+{
+    ifstream in(m_fileName.c_str());
+    if (!in.is_open())
+        return 0;
+
+    entries_t entries;
+    string line;
+    size_t lineNo = 0;
+    while (getline(in, line))
+    {
+        lineNo++;
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        istringstream strm(line);
+        string address, guid, name;
+        strm >> address >> guid >> ws;
+        getline(strm, name);
+
+        Entry entry;
+        memset(&entry.address, 0, sizeof(entry.address));
+        if (name.empty() ||
+                aToIPAddr(address.c_str(), 0, &entry.address.ia) != 0 ||
+                entry.address.ia.sin_port == 0 ||
+                !hexToGUID(guid, entry.guid))
+        {
+            LOG(logLevelDebug, "Ignoring malformed line %u of channel name cache '%s'.",
+                (unsigned)lineNo, m_fileName.c_str());
+            continue;
+        }
+
+        entries[name] = entry;
+    }
+
+    Lock guard(m_mutex);
+    m_entries.swap(entries);
+    m_dirty = false;
+    return m_entries.size();
+}
+
+bool ChannelNameCache::save()
+{
+    Lock guard(m_mutex);
+    if (!m_dirty)
+        return true;
+
+    // write aside and rename, so that a crash never leaves a truncated cache
+    const string tmpFileName(m_fileName + ".tmp");
+    {
+        ofstream out(tmpFileName.c_str(), ios::out | ios::trunc);
+        if (!out.is_open())
+        {
+            LOG(logLevelWarn, "Failed to open channel name cache '%s' for writing.", tmpFileName.c_str());
+            return false;
+        }
+
+        for (entries_t::const_iterator it = m_entries.begin(); it != m_entries.end(); it++)
+            out << inetAddressToString(it->second.address) << ' '
+                << guidToHex(it->second.guid) << ' '
+                << it->first << '\n';
+
+        out.flush();
+        if (!out.good())
+        {
+            LOG(logLevelWarn, "Failed to write channel name cache '%s'.", tmpFileName.c_str());
+            return false;
+        }
+    }
+
+    // rename() does not replace an existing file on all targets
+    ::remove(m_fileName.c_str());
+    if (::rename(tmpFileName.c_str(), m_fileName.c_str()) != 0)
+    {
+        LOG(logLevelWarn, "Failed to rename '%s' to '%s'.", tmpFileName.c_str(), m_fileName.c_str());
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+}
+}
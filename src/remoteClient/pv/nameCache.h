@@ -0,0 +1,117 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef NAMECACHE_H
+#define NAMECACHE_H
+
+#include <map>
+#include <string>
+
+#ifdef epicsExportSharedSymbols
+#   define nameCacheEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <osiSock.h>
+
+#include <pv/lock.h>
+#include <pv/sharedPtr.h>
+
+#ifdef nameCacheEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef nameCacheEpicsExportSharedSymbols
+#endif
+
+#include <pv/pvaDefs.h>
+
+#include <shareLib.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Persistent channel name to server (address, GUID) resolution cache.
+ *
+ * Used by the client context to connect directly to the server
+ * which hosted a channel the last time it was connected,
+ * skipping the broadcast search.  An entry is only a hint,
+ * the server validates it when the channel is created.
+ *
+ * File format is one entry per line: "<address:port> <GUID hex> <name>".
+ */
+class epicsShareClass ChannelNameCache
+{
+public:
+    POINTER_DEFINITIONS(ChannelNameCache);
+
+    struct Entry {
+        osiSockAddr address;
+        ServerGUID guid;
+    };
+
+    /**
+     * Constructor.
+     * @param fileName file where the cache is persisted.
+     */
+    explicit ChannelNameCache(std::string const & fileName);
+    ~ChannelNameCache();
+
+    /**
+     * Lookup server of a channel.
+     * @param name channel name.
+     * @param entry set on success.
+     * @return <code>true</code> if the name is cached.
+     */
+    bool lookup(std::string const & name, Entry& entry) const;
+
+    /**
+     * Remember the server which hosts a channel.
+     * @param name channel name.
+     * @param address server address.
+     * @param guid server GUID.
+     */
+    void update(std::string const & name, const osiSockAddr& address, const ServerGUID& guid);
+
+    /**
+     * Forget a (stale) entry.
+     * @param name channel name.
+     */
+    void remove(std::string const & name);
+
+    /**
+     * Load entries from the cache file, replacing entries in memory.
+     * A missing file is not an error.
+     * @return number of entries loaded.
+     */
+    size_t load();
+
+    /**
+     * Write entries to the cache file, if changed since last load()/save().
+     * @return <code>true</code> on success.
+     */
+    bool save();
+
+    size_t size() const;
+
+    const std::string& getFileName() const {
+        return m_fileName;
+    }
+
+private:
+    const std::string m_fileName;
+
+    typedef std::map<std::string, Entry> entries_t;
+    entries_t m_entries;
+
+    bool m_dirty;
+
+    mutable epics::pvData::Mutex m_mutex;
+};
+
+}
+}
+
+#endif  /* NAMECACHE_H */
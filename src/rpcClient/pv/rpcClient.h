@@ -8,6 +8,7 @@
 #define RPCCLIENT_H
 
 #include <string>
+#include <vector>
 
 #ifdef epicsExportSharedSymbols
 #   define rpcClientEpicsExportSharedSymbols
@@ -136,6 +137,77 @@ public:
      */
     epics::pvData::PVStructure::shared_pointer waitResponse(double timeout = RPCCLIENT_DEFAULT_TIMEOUT);
 
+    /**
+     * Issue a request and return immediately, any number of requests may be outstanding.
+     * With the "record[multiplex=true]" pvRequest option and a server supporting it,
+     * the requests are in flight at the same time (see ChannelRPC::isMultiplexed()),
+     * otherwise they are sent one after the other.
+     * Requests issued before the connection is made are sent once connected.
+     * Must not be mixed with issueRequest().
+     * @param pvArgument The argument to pass to the server.
+     * @return the ID of the request, to be passed to collect().
+     */
+    epics::pvData::uint32 issue(epics::pvData::PVStructure::shared_pointer const & pvArgument);
+
+    /**
+     * Check if the response of a request issued by issue() has arrived,
+     * i.e. collect() does not block.
+     * @param id the ID returned by issue().
+     * @return true if complete (or the ID is unknown).
+     */
+    bool isComplete(epics::pvData::uint32 id);
+
+    /**
+     * Wait for the response of a request issued by issue(), and forget the request.
+     * On timeout the request remains outstanding and may be collected later.
+     * To be called from one thread at a time.
+     * @param id the ID returned by issue().
+     * @param timeout the time in seconds to wait for the response, 0 means forever.
+     * @return request response.
+     * @throws RPCRequestException exception thrown on error or timeout.
+     * @throws std::logic_error for an unknown (e.g. already collected) ID.
+     */
+    epics::pvData::PVStructure::shared_pointer collect(epics::pvData::uint32 id,
+            double timeout = RPCCLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * One request of requestAll(), the status and response are filled in.
+     */
+    struct BatchRequest
+    {
+        BatchRequest() {}
+        BatchRequest(std::string const & serviceName,
+                     epics::pvData::PVStructure::shared_pointer const & argument) :
+            serviceName(serviceName), argument(argument) {}
+
+        std::string serviceName;
+        epics::pvData::PVStructure::shared_pointer argument;
+
+        /** Result of the request, an error on failure or if not complete before the deadline. */
+        epics::pvData::Status status;
+        /** The response, null on failure. */
+        epics::pvData::PVStructure::shared_pointer response;
+    };
+    typedef std::vector<BatchRequest> BatchRequests;
+
+    /**
+     * Performs many blocking RPC calls at once, e.g. the same request to the services of many IOCs.
+     * All the channels are connected in parallel, each request is sent as soon as its channel
+     * is connected (channels to the same server share its connection), so the call takes
+     * as long as the slowest service, bounded by the timeout.
+     * Does not throw on failure of a request, see BatchRequest::status.
+     *
+     * @param requests   the requests, the results are filled in.
+     * @param timeout    the deadline (in seconds) of all the requests, 0 means forever.
+     * @param pvRequest  the pvRequest for the ChannelRPCs.
+     * @param provider   the provider, "pva" by default.
+     * @return           the number of successful requests.
+     */
+    static std::size_t requestAll(BatchRequests& requests,
+                                  double timeout = RPCCLIENT_DEFAULT_TIMEOUT,
+                                  epics::pvData::PVStructure::shared_pointer const & pvRequest = epics::pvData::PVStructure::shared_pointer(),
+                                  ChannelProvider::shared_pointer const & provider = ChannelProvider::shared_pointer());
+
 private:
 
     const std::string m_serviceName;
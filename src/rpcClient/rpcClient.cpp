@@ -6,8 +6,12 @@
 
 #include <iostream>
 #include <string>
+#include <map>
+#include <deque>
+#include <vector>
 
 #include <epicsEvent.h>
+#include <epicsTime.h>
 #include <pv/pvData.h>
 #include <pv/event.h>
 #include <pv/current_function.h>
@@ -31,7 +35,8 @@ namespace pva = epics::pvAccess;
 
 namespace epics{namespace pvAccess{
 
-struct RPCClient::RPCRequester : public pva::ChannelRPCRequester
+struct RPCClient::RPCRequester : public pva::ChannelRPCRequester,
+                                  public std::tr1::enable_shared_from_this<RPCClient::RPCRequester>
 {
     POINTER_DEFINITIONS(RPCRequester);
 
@@ -42,14 +47,123 @@ struct RPCClient::RPCRequester : public pva::ChannelRPCRequester
     epicsEvent event;
     bool inprogress, last;
 
+    // requests of issue()/collect()
+    struct Issued {
+        Issued() :done(false) {}
+        pvd::PVStructure::shared_pointer args; // until sent
+        bool done;
+        pvd::Status status;
+        pvd::PVStructure::shared_pointer data;
+    };
+    typedef std::map<pvd::uint32, Issued> issued_t;
+    issued_t issued;
+    std::deque<pvd::uint32> unsent;
+    pvd::uint32 next_id;
+    // without multiplexing, the request in flight as a plain request()
+    bool serial_busy;
+    pvd::uint32 serial_id;
+    epicsEvent collect_event;
+
+    // completes one multiplexed request
+    struct Multiplexed : public pva::ChannelRPCRequester
+    {
+        const RPCRequester::weak_pointer owner;
+        const pvd::uint32 id;
+
+        Multiplexed(const RPCRequester::shared_pointer& owner, pvd::uint32 id) :owner(owner), id(id) {}
+        virtual ~Multiplexed() {}
+
+        virtual std::string getRequesterName() { return "RPCClient::RPCRequester::Multiplexed"; }
+
+        // never called, the operation is connected already
+        virtual void channelRPCConnect(
+            const pvd::Status& /*status*/,
+            ChannelRPC::shared_pointer const & /*operation*/) {}
+
+        virtual void requestDone(
+            const pvd::Status& status,
+            ChannelRPC::shared_pointer const & /*operation*/,
+            pvd::PVStructure::shared_pointer const & pvResponse)
+        {
+            RPCRequester::shared_pointer O(owner.lock());
+            if(!O)
+                return;
+            {
+                pvd::Lock L(O->mutex);
+                O->finish(id, status, pvResponse);
+            }
+            O->collect_event.signal();
+        }
+    };
+
     RPCRequester()
         :conn_status(pvd::Status::error("Never connected"))
         ,resp_status(pvd::Status::error("Never connected"))
         ,inprogress(false)
         ,last(false)
+        ,next_id(0)
+        ,serial_busy(false)
+        ,serial_id(0)
     {}
     virtual ~RPCRequester() {}
 
+    // call with mutex locked
+    void finish(pvd::uint32 id, const pvd::Status& status, pvd::PVStructure::shared_pointer const & pvResponse)
+    {
+        issued_t::iterator it(issued.find(id));
+        if(it==issued.end() || it->second.done)
+            return;
+        it->second.done = true;
+        it->second.args.reset();
+        it->second.status = status;
+        it->second.data = pvResponse;
+        if(status.isSuccess() && !pvResponse)
+            it->second.status = pvd::Status::error("No reply data");
+    }
+
+    // send what issue() queued, all at once if multiplexed
+    void pump()
+    {
+        ChannelRPC::shared_pointer operation;
+        {
+            pvd::Lock L(mutex);
+            if(unsent.empty() || !conn_status.isSuccess() || !op)
+                return;
+            operation = op;
+        }
+
+        const bool multiplexed = operation->isMultiplexed();
+
+        std::vector<std::pair<pvd::uint32, pvd::PVStructure::shared_pointer> > requests;
+        {
+            pvd::Lock L(mutex);
+            while(!unsent.empty()) {
+                if(!multiplexed && (serial_busy || inprogress))
+                    break;
+                const pvd::uint32 id = unsent.front();
+                unsent.pop_front();
+                issued_t::iterator it(issued.find(id));
+                if(it==issued.end() || it->second.done)
+                    continue;
+                requests.push_back(std::make_pair(id, it->second.args));
+                it->second.args.reset();
+                if(!multiplexed) {
+                    serial_busy = true;
+                    serial_id = id;
+                }
+            }
+        }
+
+        for(size_t i=0; i<requests.size(); i++) {
+            TRACE("issue "<<requests[i].first<<" args: "<<requests[i].second);
+            if(multiplexed)
+                operation->multiplexedRequest(requests[i].second,
+                                              ChannelRPCRequester::shared_pointer(new Multiplexed(shared_from_this(), requests[i].first)));
+            else
+                operation->request(requests[i].second);
+        }
+    }
+
     virtual std::string getRequesterName() { return "RPCClient::RPCRequester"; }
 
     virtual void channelRPCConnect(
@@ -76,6 +190,8 @@ struct RPCClient::RPCRequester : public pva::ChannelRPCRequester
             operation->request(args);
         }
         event.signal();
+        if(status.isSuccess())
+            pump();
     }
 
     virtual void requestDone(
@@ -86,6 +202,14 @@ struct RPCClient::RPCRequester : public pva::ChannelRPCRequester
         TRACE("status="<<status<<" response:\n"<<pvResponse<<"\n");
         {
             pvd::Lock L(mutex);
+            if(serial_busy) {
+                serial_busy = false;
+                finish(serial_id, status, pvResponse);
+                L.unlock();
+                collect_event.signal();
+                pump();
+                return;
+            }
             if(!inprogress) {
                 std::cerr<<"pva provider give RPC requestDone() when no request in progress\n";
             } else {
@@ -109,11 +233,106 @@ struct RPCClient::RPCRequester : public pva::ChannelRPCRequester
             last_data.reset();
             next_args.reset();
             inprogress = false;
+
+            for(issued_t::iterator it(issued.begin()); it!=issued.end(); ++it)
+                finish(it->first, conn_status, pvd::PVStructure::shared_pointer());
+            unsent.clear();
+            serial_busy = false;
         }
         event.signal();
+        collect_event.signal();
+    }
+};
+
+namespace {
+
+// results of one RPCClient::requestAll(), shared with the requesters
+struct BatchState
+{
+    POINTER_DEFINITIONS(BatchState);
+
+    struct Result {
+        Result() :done(false), connected(false) {}
+        bool done, connected;
+        pvd::Status status;
+        pvd::PVStructure::shared_pointer data;
+    };
+
+    pvd::Mutex mutex;
+    epicsEvent event;
+    std::vector<Result> results;
+    size_t pending;
+
+    explicit BatchState(size_t count) :results(count), pending(count) {}
+
+    void complete(size_t index, const pvd::Status& status, pvd::PVStructure::shared_pointer const & data)
+    {
+        {
+            pvd::Lock L(mutex);
+            Result& result = results[index];
+            if(result.done)
+                return;
+            result.done = true;
+            result.status = status;
+            result.data = data;
+            if(status.isSuccess() && !data)
+                result.status = pvd::Status::error("No reply data");
+            if(--pending)
+                return;
+        }
+        event.signal();
+    }
+};
+
+// sends the request of one item as soon as connected
+struct BatchRequester : public pva::ChannelRPCRequester
+{
+    const BatchState::shared_pointer state;
+    const size_t index;
+    const pvd::PVStructure::shared_pointer args;
+
+    BatchRequester(const BatchState::shared_pointer& state, size_t index,
+                   pvd::PVStructure::shared_pointer const & args)
+        :state(state), index(index), args(args) {}
+    virtual ~BatchRequester() {}
+
+    virtual std::string getRequesterName() { return "RPCClient::BatchRequester"; }
+
+    virtual void channelRPCConnect(
+        const pvd::Status& status,
+        ChannelRPC::shared_pointer const & operation)
+    {
+        if(!status.isSuccess()) {
+            state->complete(index, status, pvd::PVStructure::shared_pointer());
+            return;
+        }
+        {
+            pvd::Lock L(state->mutex);
+            BatchState::Result& result = state->results[index];
+            // reconnected after a response or a failure
+            if(result.done || result.connected)
+                return;
+            result.connected = true;
+        }
+        TRACE("batch "<<index<<" args: "<<args);
+        operation->request(args);
+    }
+
+    virtual void requestDone(
+        const pvd::Status& status,
+        ChannelRPC::shared_pointer const & /*operation*/,
+        pvd::PVStructure::shared_pointer const & pvResponse)
+    {
+        state->complete(index, status, pvResponse);
+    }
+
+    virtual void channelDisconnect(bool /*destroy*/)
+    {
+        state->complete(index, pvd::Status::error("Connection lost"), pvd::PVStructure::shared_pointer());
     }
 };
 
+} // namespace
 
 RPCClient::RPCClient(const std::string & serviceName,
                      pvd::PVStructure::shared_pointer const & pvRequest,
@@ -207,7 +426,7 @@ void RPCClient::issueRequest(
         TRACE("conn_status="<<m_rpc_requester->conn_status
             <<" resp_status="<<m_rpc_requester->resp_status
             <<" args:\n"<<pvArgument);
-        if(m_rpc_requester->inprogress)
+        if(m_rpc_requester->inprogress || m_rpc_requester->serial_busy)
             throw std::logic_error("Request already in progress");
         m_rpc_requester->inprogress = true;
         m_rpc_requester->resp_status = pvd::Status::error("No Data");
@@ -263,6 +482,158 @@ pvd::PVStructure::shared_pointer RPCClient::waitResponse(double timeout)
     return ret;
 }
 
+pvd::uint32 RPCClient::issue(pvd::PVStructure::shared_pointer const & pvArgument)
+{
+    pvd::uint32 id;
+    {
+        pvd::Lock L(m_rpc_requester->mutex);
+        id = m_rpc_requester->next_id++;
+        m_rpc_requester->issued[id].args = pvArgument;
+        m_rpc_requester->unsent.push_back(id);
+    }
+    m_rpc_requester->pump();
+    return id;
+}
+
+bool RPCClient::isComplete(pvd::uint32 id)
+{
+    pvd::Lock L(m_rpc_requester->mutex);
+    RPCRequester::issued_t::const_iterator it(m_rpc_requester->issued.find(id));
+    return it==m_rpc_requester->issued.end() || it->second.done;
+}
+
+pvd::PVStructure::shared_pointer RPCClient::collect(pvd::uint32 id, double timeout)
+{
+    const epicsTime deadline(epicsTime::getCurrent() + timeout);
+
+    pvd::Lock L(m_rpc_requester->mutex);
+    RPCRequester::issued_t::iterator it(m_rpc_requester->issued.find(id));
+    if(it==m_rpc_requester->issued.end())
+        throw std::logic_error("Unknown request ID");
+
+    while(!it->second.done)
+    {
+        L.unlock();
+        if(timeout <= 0.0) {
+            m_rpc_requester->collect_event.wait();
+        } else {
+            const double left = deadline - epicsTime::getCurrent();
+            if(left <= 0.0 || !m_rpc_requester->collect_event.wait(left)) {
+                L.lock();
+                if(it->second.done)
+                    break;
+                TRACE("TIMEOUT");
+                throw RPCRequestException(pvd::Status::STATUSTYPE_ERROR, "RPC timeout");
+            }
+        }
+        L.lock();
+    }
+
+    const pvd::Status status(it->second.status);
+    pvd::PVStructure::shared_pointer data(it->second.data);
+    m_rpc_requester->issued.erase(it);
+    L.unlock();
+
+    if(!status.isSuccess())
+        throw RPCRequestException(pvd::Status::STATUSTYPE_ERROR, status.getMessage());
+
+    // copy it, like waitResponse()
+    pvd::PVStructure::shared_pointer ret(pvd::getPVDataCreate()->createPVStructure(data->getStructure()));
+    ret->copyUnchecked(*data);
+
+    return ret;
+}
+
+size_t RPCClient::requestAll(BatchRequests& requests,
+                             double timeout,
+                             pvd::PVStructure::shared_pointer const & pvRequest,
+                             ChannelProvider::shared_pointer const & provider)
+{
+    ClientFactory::start();
+    ChannelProvider::shared_pointer prov(provider);
+    if(!prov)
+        prov = ChannelProviderRegistry::clients()->getProvider("pva");
+    if(!prov)
+        throw std::logic_error("Unknown Provider");
+
+    const pvd::PVStructure::shared_pointer request(pvRequest ? pvRequest : pvd::createRequest(""));
+    const epicsTime deadline(epicsTime::getCurrent() + timeout);
+    const size_t count = requests.size();
+
+    BatchState::shared_pointer state(new BatchState(count));
+    std::vector<Channel::shared_pointer> channels(count);
+    std::vector<ChannelRPC::shared_pointer> operations(count);
+
+    // start connecting all the channels, the requests are sent from the callbacks
+    for(size_t i=0; i<count; i++) {
+        try {
+            channels[i] = prov->createChannel(requests[i].serviceName, DefaultChannelRequester::build(),
+                                              ChannelProvider::PRIORITY_DEFAULT);
+            if(!channels[i])
+                throw std::logic_error("provider createChannel() succeeds w/ NULL Channel");
+
+            ChannelRPCRequester::shared_pointer requester(new BatchRequester(state, i, requests[i].argument));
+            operations[i] = channels[i]->createChannelRPC(requester, request);
+            if(!operations[i])
+                throw std::logic_error("channel createChannelRPC() NULL");
+        } catch(std::exception& e) {
+            state->complete(i, pvd::Status::error(e.what()), pvd::PVStructure::shared_pointer());
+        }
+    }
+
+    std::vector<BatchState::Result> results;
+    {
+        pvd::Lock L(state->mutex);
+        while(state->pending) {
+            L.unlock();
+            bool signaled = true;
+            if(timeout <= 0.0) {
+                state->event.wait();
+            } else {
+                const double left = deadline - epicsTime::getCurrent();
+                signaled = left > 0.0 && state->event.wait(left);
+            }
+            L.lock();
+            if(!signaled)
+                break;
+        }
+
+        // what is left timed out, later callbacks (e.g. of the destroy below) are ignored
+        for(size_t i=0; i<count; i++) {
+            BatchState::Result& result = state->results[i];
+            if(result.done)
+                continue;
+            result.done = true;
+            result.status = pvd::Status::error(result.connected ? "RPC timeout" : "connection timeout");
+        }
+        state->pending = 0;
+        results = state->results;
+    }
+
+    for(size_t i=0; i<count; i++) {
+        if(operations[i])
+            operations[i]->destroy();
+        if(channels[i])
+            channels[i]->destroy();
+    }
+
+    size_t succeeded = 0;
+    for(size_t i=0; i<count; i++) {
+        requests[i].status = results[i].status;
+        requests[i].response.reset();
+        if(!results[i].status.isSuccess())
+            continue;
+
+        // copy it, like waitResponse()
+        const pvd::PVStructure::shared_pointer& data(results[i].data);
+        requests[i].response = pvd::getPVDataCreate()->createPVStructure(data->getStructure());
+        requests[i].response->copyUnchecked(*data);
+        succeeded++;
+    }
+
+    return succeeded;
+}
+
 RPCClient::shared_pointer RPCClient::create(const std::string & serviceName,
         pvd::PVStructure::shared_pointer const & pvRequest)
 {
@@ -47,10 +47,119 @@ public:
 
     virtual ~RPCServer();
 
+    /**
+     * How the requests of a service are executed.
+     *
+     * By default a service is called on the thread delivering the request,
+     * so requests arriving over the same connection are executed one after the other.
+     */
+    class epicsShareClass ExecutionPolicy {
+        friend class RPCServer;
+        std::size_t _workers;
+        std::size_t _maxInFlight;
+        std::size_t _maxQueued;
+    public:
+        ExecutionPolicy() : _workers(0), _maxInFlight(0), _maxQueued(100) {}
+        //! Number of threads calling the service, 0 (default) to call it on the thread delivering the request.
+        ExecutionPolicy& workers(std::size_t n) { _workers = n; return *this; }
+        //! Max. number of requests executed at once, including asynchronous ones not completed yet.
+        //! Default (0) is the number of workers.
+        ExecutionPolicy& maxInFlight(std::size_t n) { _maxInFlight = n; return *this; }
+        //! Max. number of requests waiting to be executed, further requests are rejected with an error status.
+        ExecutionPolicy& maxQueued(std::size_t n) { _maxQueued = n; return *this; }
+    };
+
+    /**
+     * Caching of the responses of a service which is a pure function of its arguments.
+     *
+     * Responses are keyed by the serialized argument structure (type and value),
+     * only successful responses are cached.  A cached response is served without
+     * calling the service, concurrent identical requests share a single service call.
+     * Cached responses are shared, they must not be modified.
+     */
+    class epicsShareClass CachePolicy {
+        friend class RPCServer;
+        double _ttl;
+        std::size_t _maxEntries;
+    public:
+        CachePolicy() : _ttl(0.0), _maxEntries(1000) {}
+        //! Time in seconds a response is served from the cache, 0 (default) until evicted or invalidated.
+        CachePolicy& ttl(double seconds) { _ttl = seconds; return *this; }
+        //! Max. number of cached responses, the least recently used one is evicted first.
+        CachePolicy& maxEntries(std::size_t n) { _maxEntries = n; return *this; }
+    };
+
+    struct CacheStats {
+        //! Requests served from the cache.
+        epics::pvData::uint64 hits;
+        //! Requests passed to the service.
+        epics::pvData::uint64 misses;
+        //! Requests served by an identical request in progress.
+        epics::pvData::uint64 coalesced;
+        //! Responses dropped because of the size bound or the TTL.
+        epics::pvData::uint64 evictions;
+        std::size_t entries;
+    };
+
     void registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service);
 
+    /**
+     * Register a service executed according to a policy.
+     * @param serviceName name of the service (may be a wildcard pattern).
+     * @param service service.
+     * @param policy execution policy.
+     */
+    void registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                         ExecutionPolicy const & policy);
+
+    /**
+     * Register a service whose responses are cached.
+     * @param serviceName name of the service (may be a wildcard pattern).
+     * @param service service.
+     * @param cache caching policy.
+     */
+    void registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                         CachePolicy const & cache);
+
+    /**
+     * Register a service executed according to a policy, whose responses are cached.
+     * Cache hits do not take a place in the queue of the service.
+     * @param serviceName name of the service (may be a wildcard pattern).
+     * @param service service.
+     * @param policy execution policy.
+     * @param cache caching policy.
+     */
+    void registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                         ExecutionPolicy const & policy, CachePolicy const & cache);
+
     void unregisterService(std::string const & serviceName);
 
+    /**
+     * Drop all the cached responses of a service.
+     * Service calls in progress still answer their requests, but are not cached,
+     * and later requests start a new call.
+     * @param serviceName name of the service, as registered.
+     * @return false if the service is not registered with a cache.
+     */
+    bool invalidateCache(std::string const & serviceName);
+
+    /**
+     * Drop the cached response of a service for an argument,
+     * a service call in progress for it is treated as by invalidateCache(std::string const &).
+     * @param serviceName name of the service, as registered.
+     * @param args request argument.
+     * @return false if the service is not registered with a cache.
+     */
+    bool invalidateCache(std::string const & serviceName, epics::pvData::PVStructure::shared_pointer const & args);
+
+    /**
+     * Get the cache counters of a service.
+     * @param serviceName name of the service, as registered.
+     * @param stats counters.
+     * @return false if the service is not registered with a cache.
+     */
+    bool getCacheStats(std::string const & serviceName, CacheStats& stats);
+
     void run(int seconds = 0);
 
     /// Method requires usage of std::tr1::shared_ptr<RPCServer>. This instance must be
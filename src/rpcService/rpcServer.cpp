@@ -6,8 +6,18 @@
 
 #include <stdexcept>
 #include <vector>
+#include <deque>
+#include <list>
+#include <map>
 #include <utility>
 
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/byteBuffer.h>
+
 #define epicsExportSharedSymbols
 #include <pv/rpcServer.h>
 #include <pv/serverContextImpl.h>
@@ -114,6 +124,551 @@ public:
 
 
 
+/**
+ * Executes the requests of a service on its own threads, see RPCServer::ExecutionPolicy.
+ */
+class RPCServiceExecutor :
+    public RPCServiceAsync,
+    public std::tr1::enable_shared_from_this<RPCServiceExecutor>
+{
+public:
+    POINTER_DEFINITIONS(RPCServiceExecutor);
+
+    static Status rejectedStatus;
+    static Status shutdownStatus;
+
+    RPCServiceExecutor(RPCServiceAsync::shared_pointer const & service,
+                       std::size_t maxInFlight, std::size_t maxQueued) :
+        m_service(service),
+        m_maxInFlight(maxInFlight),
+        m_maxQueued(maxQueued),
+        m_inFlight(0),
+        m_alive(true)
+    {
+    }
+
+    virtual ~RPCServiceExecutor()
+    {
+        close();
+    }
+
+    /**
+     * Start the worker threads, this instance is kept alive until close() joins them.
+     */
+    void start(std::string const & name, std::size_t workers)
+    {
+        m_self = shared_from_this();
+
+        m_threads.reserve(workers);
+        for (std::size_t i = 0; i < workers; i++)
+        {
+            std::tr1::shared_ptr<Thread> thread(new Thread(Thread::Config(this, &RPCServiceExecutor::run)
+                                                .prio(epicsThreadPriorityMedium)
+                                                .stack(epicsThreadStackBig)
+                                                .name(name)
+                                                .autostart(false)));
+            m_threads.push_back(thread);
+            thread->start();
+        }
+    }
+
+    virtual void request(
+        epics::pvData::PVStructure::shared_pointer const & args,
+        RPCResponseCallback::shared_pointer const & callback)
+    {
+        Status status;
+        {
+            Lock guard(m_mutex);
+            if (!m_alive)
+                status = shutdownStatus;
+            else if (m_queue.size() + m_inFlight >= m_maxQueued + m_maxInFlight)
+                status = rejectedStatus;
+            else
+            {
+                m_queue.push_back(Pending(args, callback));
+                if (m_inFlight < m_maxInFlight)
+                    m_wakeup.signal();
+                return;
+            }
+        }
+
+        callback->requestDone(status, PVStructure::shared_pointer());
+    }
+
+    /**
+     * Stop and join the workers, queued requests are rejected.
+     * Requests in flight are waited for, unless called from a worker (by the service).
+     */
+    void close()
+    {
+        // released last, may destroy this instance
+        RPCServiceExecutor::shared_pointer self;
+        std::deque<Pending> rejected;
+        {
+            Lock guard(m_mutex);
+            if (!m_alive)
+                return;
+            m_alive = false;
+            rejected.swap(m_queue);
+            self.swap(m_self);
+        }
+        m_wakeup.signal();
+
+        for (std::size_t i = 0; i < rejected.size(); i++)
+            rejected[i].callback->requestDone(shutdownStatus, PVStructure::shared_pointer());
+
+        for (std::size_t i = 0; i < m_threads.size(); i++)
+            if (!m_threads[i]->isCurrentThread())
+                m_threads[i]->exitWait();
+    }
+
+private:
+
+    struct Pending
+    {
+        Pending(PVStructure::shared_pointer const & args, RPCResponseCallback::shared_pointer const & callback) :
+            args(args), callback(callback) {}
+        PVStructure::shared_pointer args;
+        RPCResponseCallback::shared_pointer callback;
+    };
+
+    /**
+     * Passes the response on and frees an in-flight slot (once).
+     */
+    class Completion : public RPCResponseCallback
+    {
+    public:
+        Completion(RPCServiceExecutor::shared_pointer const & executor,
+                   RPCResponseCallback::shared_pointer const & callback) :
+            m_executor(executor), m_callback(callback), m_done(false)
+        {
+        }
+
+        virtual void requestDone(
+            epics::pvData::Status const & status,
+            epics::pvData::PVStructure::shared_pointer const & result)
+        {
+            {
+                Lock guard(m_mutex);
+                if (m_done)
+                    return;
+                m_done = true;
+            }
+
+            m_executor->completed();
+            m_callback->requestDone(status, result);
+        }
+
+    private:
+        const RPCServiceExecutor::shared_pointer m_executor;
+        const RPCResponseCallback::shared_pointer m_callback;
+        epics::pvData::Mutex m_mutex;
+        bool m_done;
+    };
+
+    void run()
+    {
+        Lock guard(m_mutex);
+        while (m_alive)
+        {
+            if (m_queue.empty() || m_inFlight >= m_maxInFlight)
+            {
+                guard.unlock();
+                m_wakeup.wait();
+                guard.lock();
+                continue;
+            }
+
+            Pending pending(m_queue.front());
+            m_queue.pop_front();
+            m_inFlight++;
+
+            // wake up another worker if there is more to do
+            if (!m_queue.empty() && m_inFlight < m_maxInFlight)
+                m_wakeup.signal();
+
+            guard.unlock();
+
+            RPCResponseCallback::shared_pointer completion(new Completion(shared_from_this(), pending.callback));
+            try
+            {
+                m_service->request(pending.args, completion);
+            }
+            catch (std::exception& ex)
+            {
+                // handle user unexpected errors
+                completion->requestDone(Status(Status::STATUSTYPE_FATAL, ex.what()), PVStructure::shared_pointer());
+            }
+            catch (...)
+            {
+                // handle user unexpected errors
+                completion->requestDone(Status(Status::STATUSTYPE_FATAL,
+                                               "Unexpected exception caught while calling RPCServiceAsync.request(PVStructure, RPCResponseCallback)."),
+                                        PVStructure::shared_pointer());
+            }
+
+            guard.lock();
+        }
+
+        // let the next worker exit
+        m_wakeup.signal();
+    }
+
+    void completed()
+    {
+        {
+            Lock guard(m_mutex);
+            m_inFlight--;
+        }
+        m_wakeup.signal();
+    }
+
+    const RPCServiceAsync::shared_pointer m_service;
+    const std::size_t m_maxInFlight;
+    const std::size_t m_maxQueued;
+
+    epics::pvData::Mutex m_mutex;
+    std::deque<Pending> m_queue;
+    std::size_t m_inFlight;
+    bool m_alive;
+    epics::pvData::Event m_wakeup;
+
+    std::vector<std::tr1::shared_ptr<epics::pvData::Thread> > m_threads;
+    // keeps the instance alive while the workers run
+    RPCServiceExecutor::shared_pointer m_self;
+};
+
+Status RPCServiceExecutor::rejectedStatus(Status::STATUSTYPE_ERROR, "service busy, request rejected");
+Status RPCServiceExecutor::shutdownStatus(Status::STATUSTYPE_ERROR, "service shut down");
+
+
+/**
+ * Caches the responses of a service, see RPCServer::CachePolicy.
+ */
+class RPCServiceCache :
+    public RPCServiceAsync,
+    public std::tr1::enable_shared_from_this<RPCServiceCache>
+{
+public:
+    POINTER_DEFINITIONS(RPCServiceCache);
+
+    RPCServiceCache(RPCServiceAsync::shared_pointer const & service,
+                    double ttl, std::size_t maxEntries) :
+        m_service(service),
+        m_ttl(ttl),
+        m_maxEntries(maxEntries),
+        m_lastCall(0)
+    {
+        m_stats.hits = m_stats.misses = m_stats.coalesced = m_stats.evictions = 0;
+        m_stats.entries = 0;
+    }
+
+    virtual ~RPCServiceCache() {}
+
+    RPCServiceAsync::shared_pointer const & getService() const
+    {
+        return m_service;
+    }
+
+    virtual void request(
+        epics::pvData::PVStructure::shared_pointer const & args,
+        RPCResponseCallback::shared_pointer const & callback)
+    {
+        const std::string key(makeKey(args));
+
+        PVStructure::shared_pointer response;
+        std::size_t call = 0;
+        {
+            Lock guard(m_mutex);
+            Entries::iterator iter = m_entries.find(key);
+            if (iter != m_entries.end())
+            {
+                if (m_ttl > 0.0 && epicsTime::getCurrent() > iter->second.expires)
+                {
+                    erase(iter);
+                    m_stats.evictions++;
+                }
+                else
+                {
+                    response = iter->second.response;
+                    // most recently used
+                    m_lru.splice(m_lru.end(), m_lru, iter->second.lru);
+                    m_stats.hits++;
+                }
+            }
+
+            if (!response)
+            {
+                Waiting::iterator waiting = m_waiting.find(key);
+                if (waiting != m_waiting.end())
+                {
+                    waiting->second.callbacks.push_back(callback);
+                    m_stats.coalesced++;
+                    return;
+                }
+
+                Pending& pending = m_waiting[key];
+                pending.call = call = ++m_lastCall;
+                pending.callbacks.push_back(callback);
+                m_stats.misses++;
+            }
+        }
+
+        if (response)
+        {
+            callback->requestDone(Status::Ok, response);
+            return;
+        }
+
+        RPCResponseCallback::shared_pointer fill(new Fill(shared_from_this(), key, call));
+        try
+        {
+            m_service->request(args, fill);
+        }
+        catch (std::exception& ex)
+        {
+            // handle user unexpected errors
+            fill->requestDone(Status(Status::STATUSTYPE_FATAL, ex.what()), PVStructure::shared_pointer());
+        }
+        catch (...)
+        {
+            // handle user unexpected errors
+            fill->requestDone(Status(Status::STATUSTYPE_FATAL,
+                                     "Unexpected exception caught while calling RPCServiceAsync.request(PVStructure, RPCResponseCallback)."),
+                              PVStructure::shared_pointer());
+        }
+    }
+
+    void invalidate()
+    {
+        Lock guard(m_mutex);
+        m_entries.clear();
+        m_lru.clear();
+        m_stats.entries = 0;
+
+        // responses in progress may be stale already
+        for (Waiting::iterator iter = m_waiting.begin(); iter != m_waiting.end(); iter++)
+            detach(iter);
+        m_waiting.clear();
+    }
+
+    void invalidate(PVStructure::shared_pointer const & args)
+    {
+        const std::string key(makeKey(args));
+
+        Lock guard(m_mutex);
+        Entries::iterator iter = m_entries.find(key);
+        if (iter != m_entries.end())
+            erase(iter);
+
+        Waiting::iterator waiting = m_waiting.find(key);
+        if (waiting != m_waiting.end())
+        {
+            detach(waiting);
+            m_waiting.erase(waiting);
+        }
+    }
+
+    void getStats(RPCServer::CacheStats& stats)
+    {
+        Lock guard(m_mutex);
+        stats = m_stats;
+    }
+
+private:
+
+    /**
+     * Serializes the type and the value of a structure into a string.
+     */
+    class KeySerializer : public SerializableControl
+    {
+    public:
+        KeySerializer() : m_buffer(1024) {}
+
+        virtual void flushSerializeBuffer()
+        {
+            m_key.append(m_buffer.getArray(), m_buffer.getPosition());
+            m_buffer.clear();
+        }
+
+        virtual void ensureBuffer(std::size_t size)
+        {
+            if (m_buffer.getRemaining() < size)
+                flushSerializeBuffer();
+        }
+
+        virtual void alignBuffer(std::size_t /*alignment*/)
+        {
+            // not needed, the key is never deserialized
+        }
+
+        virtual bool directSerialize(ByteBuffer* /*existingBuffer*/, const char* /*toSerialize*/,
+                                     std::size_t /*elementCount*/, std::size_t /*elementSize*/)
+        {
+            return false;
+        }
+
+        virtual void cachedSerialize(std::tr1::shared_ptr<const Field> const & field, ByteBuffer* buffer)
+        {
+            field->serialize(buffer, this);
+        }
+
+        std::string const & serialize(PVStructure::shared_pointer const & pvStructure)
+        {
+            if (pvStructure)
+            {
+                cachedSerialize(pvStructure->getStructure(), &m_buffer);
+                pvStructure->serialize(&m_buffer, this);
+            }
+            flushSerializeBuffer();
+            return m_key;
+        }
+
+    private:
+        ByteBuffer m_buffer;
+        std::string m_key;
+    };
+
+    static std::string makeKey(PVStructure::shared_pointer const & args)
+    {
+        KeySerializer serializer;
+        return serializer.serialize(args);
+    }
+
+    /**
+     * Caches the response and passes it on to all the waiting requests (once).
+     */
+    class Fill : public RPCResponseCallback
+    {
+    public:
+        Fill(RPCServiceCache::shared_pointer const & cache, std::string const & key, std::size_t call) :
+            m_cache(cache), m_key(key), m_call(call) {}
+
+        virtual void requestDone(
+            epics::pvData::Status const & status,
+            epics::pvData::PVStructure::shared_pointer const & result)
+        {
+            m_cache->filled(m_key, m_call, status, result);
+        }
+
+    private:
+        const RPCServiceCache::shared_pointer m_cache;
+        const std::string m_key;
+        const std::size_t m_call;
+    };
+
+    void filled(std::string const & key, std::size_t call,
+                Status const & status, PVStructure::shared_pointer const & result)
+    {
+        // the service may reuse its result structure, keep a copy
+        PVStructure::shared_pointer response;
+        if (status.isSuccess() && result)
+            response = getPVDataCreate()->createPVStructure(result);
+        else
+            response = result;
+
+        std::vector<RPCResponseCallback::shared_pointer> callbacks;
+        {
+            Lock guard(m_mutex);
+            Waiting::iterator waiting = m_waiting.find(key);
+            if (waiting != m_waiting.end() && waiting->second.call == call)
+            {
+                callbacks.swap(waiting->second.callbacks);
+                m_waiting.erase(waiting);
+
+                if (status.isSuccess() && response && m_maxEntries > 0)
+                    insert(key, response);
+            }
+            else
+            {
+                // invalidated while in progress, answer its requests but do not cache
+                Detached::iterator detached = m_detached.find(call);
+                if (detached == m_detached.end())
+                    return;
+                callbacks.swap(detached->second.callbacks);
+                m_detached.erase(detached);
+            }
+        }
+
+        for (std::size_t i = 0; i < callbacks.size(); i++)
+            callbacks[i]->requestDone(status, response);
+    }
+
+    // assumes sync on m_mutex
+    void insert(std::string const & key, PVStructure::shared_pointer const & response)
+    {
+        std::pair<Entries::iterator, bool> inserted(m_entries.insert(std::make_pair(key, Entry())));
+        Entry& entry = inserted.first->second;
+        if (inserted.second)
+        {
+            m_lru.push_back(&inserted.first->first);
+            entry.lru = --m_lru.end();
+        }
+        else
+            m_lru.splice(m_lru.end(), m_lru, entry.lru);
+
+        entry.response = response;
+        if (m_ttl > 0.0)
+            entry.expires = epicsTime::getCurrent() + m_ttl;
+
+        while (m_entries.size() > m_maxEntries)
+        {
+            erase(m_entries.find(*m_lru.front()));
+            m_stats.evictions++;
+        }
+        m_stats.entries = m_entries.size();
+    }
+
+    struct Entry
+    {
+        PVStructure::shared_pointer response;
+        epicsTime expires;
+        // position in m_lru
+        std::list<const std::string*>::iterator lru;
+    };
+    typedef std::map<std::string, Entry> Entries;
+
+    struct Pending
+    {
+        Pending() : call(0) {}
+        std::vector<RPCResponseCallback::shared_pointer> callbacks;
+        // identifies the service call
+        std::size_t call;
+    };
+    // calls in progress, new requests of the same key wait for them
+    typedef std::map<std::string, Pending> Waiting;
+    // calls in progress invalidated, by call
+    typedef std::map<std::size_t, Pending> Detached;
+
+    // assumes sync on m_mutex
+    void erase(Entries::iterator iter)
+    {
+        m_lru.erase(iter->second.lru);
+        m_entries.erase(iter);
+        m_stats.entries = m_entries.size();
+    }
+
+    // assumes sync on m_mutex, the caller removes the entry from m_waiting
+    void detach(Waiting::iterator waiting)
+    {
+        m_detached[waiting->second.call].callbacks.swap(waiting->second.callbacks);
+    }
+
+    const RPCServiceAsync::shared_pointer m_service;
+    const double m_ttl;
+    const std::size_t m_maxEntries;
+
+    epics::pvData::Mutex m_mutex;
+    Entries m_entries;
+    // keys of m_entries, least recently used first
+    std::list<const std::string*> m_lru;
+    Waiting m_waiting;
+    Detached m_detached;
+    std::size_t m_lastCall;
+    RPCServer::CacheStats m_stats;
+};
+
+
 class RPCChannel :
     public Channel,
     public std::tr1::enable_shared_from_this<RPCChannel>
@@ -252,8 +807,6 @@ public:
 
     static Status noSuchChannelStatus;
 
-    // TODO thread pool support
-
     RPCChannelProvider() {
     }
 
@@ -292,17 +845,23 @@ public:
             throw std::runtime_error("null requester");
 
         PVStringArray::svector channelNames;
+        bool hasDynamic;
         {
             Lock guard(m_mutex);
             channelNames.reserve(m_services.size());
             for (RPCServiceMap::const_iterator iter = m_services.begin();
                     iter != m_services.end();
                     iter++)
-                channelNames.push_back(iter->first);
+            {
+                // a pattern is not a channel name, the names it matches can not be listed
+                if (!isWildcardPattern(iter->first))
+                    channelNames.push_back(iter->first);
+            }
+            hasDynamic = !m_wildServices.empty();
         }
 
         ChannelFind::shared_pointer thisPtr(shared_from_this());
-        channelListRequester->channelListResult(Status::Ok, thisPtr, freeze(channelNames), false);
+        channelListRequester->channelListResult(Status::Ok, thisPtr, freeze(channelNames), hasDynamic);
         return thisPtr;
     }
 
@@ -313,17 +872,16 @@ public:
     {
         RPCServiceAsync::shared_pointer service;
 
-        RPCServiceMap::const_iterator iter;
         {
             Lock guard(m_mutex);
-            iter = m_services.find(channelName);
-        }
-        if (iter != m_services.end())
-            service = iter->second;
+            RPCServiceMap::const_iterator iter = m_services.find(channelName);
+            if (iter != m_services.end())
+                service = iter->second;
 
-        // check for wild services
-        if (!service)
-            service = findWildService(channelName);
+            // check for wild services
+            if (!service)
+                service = findWildService(channelName);
+        }
 
         if (!service)
         {
@@ -356,41 +914,107 @@ public:
 
     void registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service)
     {
-        Lock guard(m_mutex);
-        m_services[serviceName] = service;
-
-        if (isWildcardPattern(serviceName))
-            m_wildServices.push_back(std::make_pair(serviceName, service));
+        RPCServiceAsync::shared_pointer replaced;
+        {
+            Lock guard(m_mutex);
+            RPCServiceMap::iterator iter = m_services.find(serviceName);
+            if (iter != m_services.end())
+            {
+                replaced = iter->second;
+                removeWildService(serviceName);
+            }
+
+            m_services[serviceName] = service;
+
+            if (isWildcardPattern(serviceName))
+            {
+                m_wildServices.push_back(std::make_pair(serviceName, service));
+                m_wildMatcher.add(serviceName);
+            }
+        }
+        closeExecutor(replaced);
     }
 
     void unregisterService(std::string const & serviceName)
+    {
+        RPCServiceAsync::shared_pointer removed;
+        {
+            Lock guard(m_mutex);
+            RPCServiceMap::iterator iter = m_services.find(serviceName);
+            if (iter == m_services.end())
+                return;
+            removed = iter->second;
+            m_services.erase(iter);
+
+            removeWildService(serviceName);
+        }
+        closeExecutor(removed);
+    }
+
+    /**
+     * Stop the worker threads of all the services.
+     */
+    void closeExecutors()
+    {
+        std::vector<RPCServiceAsync::shared_pointer> services;
+        {
+            Lock guard(m_mutex);
+            for (RPCServiceMap::const_iterator iter = m_services.begin();
+                    iter != m_services.end();
+                    iter++)
+                services.push_back(iter->second);
+        }
+        for (std::size_t i = 0; i < services.size(); i++)
+            closeExecutor(services[i]);
+    }
+
+    /**
+     * Get the cache of a registered service.
+     * @param serviceName name of the service, as registered.
+     * @return the cache, null if the service is not registered with one.
+     */
+    RPCServiceCache::shared_pointer getCache(std::string const & serviceName)
     {
         Lock guard(m_mutex);
-        m_services.erase(serviceName);
+        RPCServiceMap::const_iterator iter = m_services.find(serviceName);
+        if (iter == m_services.end())
+            return RPCServiceCache::shared_pointer();
+        return std::tr1::dynamic_pointer_cast<RPCServiceCache>(iter->second);
+    }
 
+private:
+    static void closeExecutor(RPCServiceAsync::shared_pointer const & service)
+    {
+        // the cache wraps the executor
+        RPCServiceCache::shared_pointer cache(std::tr1::dynamic_pointer_cast<RPCServiceCache>(service));
+        RPCServiceExecutor::shared_pointer executor(std::tr1::dynamic_pointer_cast<RPCServiceExecutor>(
+                    cache ? cache->getService() : service));
+        if (executor)
+            executor->close();
+    }
+
+    // assumes sync on services
+    void removeWildService(string const & serviceName)
+    {
         if (isWildcardPattern(serviceName))
         {
-            for (RPCWildServiceList::iterator iter = m_wildServices.begin();
-                    iter != m_wildServices.end();
-                    iter++)
-                if (iter->first == serviceName)
+            for (std::size_t i = 0; i < m_wildServices.size(); i++)
+                if (m_wildServices[i].first == serviceName)
                 {
-                    m_wildServices.erase(iter);
+                    m_wildServices.erase(m_wildServices.begin() + i);
+                    m_wildMatcher.remove(i);
                     break;
                 }
         }
     }
 
-private:
     // assumes sync on services
     RPCServiceAsync::shared_pointer findWildService(string const & wildcard)
     {
-        if (!m_wildServices.empty())
-            for (RPCWildServiceList::iterator iter = m_wildServices.begin();
-                    iter != m_wildServices.end();
-                    iter++)
-                if (Wildcard::wildcardfit(iter->first.c_str(), wildcard.c_str()))
-                    return iter->second;
+        // first registered matching pattern, the matcher keeps the order of m_wildServices
+        const int index = m_wildMatcher.match(wildcard.c_str());
+        if (index >= 0)
+            return m_wildServices[index].second;
 
         return RPCServiceAsync::shared_pointer();
     }
@@ -409,6 +1033,8 @@ private:
 
     typedef std::vector<std::pair<string, RPCServiceAsync::shared_pointer> > RPCWildServiceList;
     RPCWildServiceList m_wildServices;
+    // compiled patterns of m_wildServices, used for the lookups
+    WildcardMatcher m_wildMatcher;
 
     epics::pvData::Mutex m_mutex;
 };
@@ -476,16 +1102,99 @@ void RPCServer::runInNewThread(int seconds)
 void RPCServer::destroy()
 {
     m_serverContext->shutdown();
+    m_channelProviderImpl->closeExecutors();
+}
+
+namespace {
+// the server advertises hosted channel names in beacons
+void channelListChanged(ServerContext::shared_pointer const & context)
+{
+    ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<ServerContextImpl>(context));
+    if (impl)
+        impl->beaconChannelListChanged();
+}
 }
 
 void RPCServer::registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service)
 {
     m_channelProviderImpl->registerService(serviceName, service);
+    channelListChanged(m_serverContext);
+}
+
+namespace {
+RPCServiceAsync::shared_pointer createExecutor(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                                               std::size_t workers, std::size_t maxInFlight, std::size_t maxQueued)
+{
+    if (workers == 0)
+        return service;
+
+    RPCServiceExecutor::shared_pointer executor(new RPCServiceExecutor(service, maxInFlight ? maxInFlight : workers, maxQueued));
+    try {
+        executor->start(serviceName, workers);
+    } catch (...) {
+        executor->close();
+        throw;
+    }
+    return executor;
+}
+}
+
+void RPCServer::registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                                ExecutionPolicy const & policy)
+{
+    m_channelProviderImpl->registerService(serviceName,
+                                           createExecutor(serviceName, service, policy._workers,
+                                                          policy._maxInFlight, policy._maxQueued));
+    channelListChanged(m_serverContext);
+}
+
+void RPCServer::registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                                CachePolicy const & cache)
+{
+    registerService(serviceName, service, ExecutionPolicy(), cache);
+}
+
+void RPCServer::registerService(std::string const & serviceName, RPCServiceAsync::shared_pointer const & service,
+                                ExecutionPolicy const & policy, CachePolicy const & cache)
+{
+    RPCServiceAsync::shared_pointer executor(createExecutor(serviceName, service, policy._workers,
+                                                            policy._maxInFlight, policy._maxQueued));
+    RPCServiceAsync::shared_pointer cached(new RPCServiceCache(executor, cache._ttl, cache._maxEntries));
+    m_channelProviderImpl->registerService(serviceName, cached);
+    channelListChanged(m_serverContext);
+}
+
+bool RPCServer::invalidateCache(std::string const & serviceName)
+{
+    RPCServiceCache::shared_pointer cache(m_channelProviderImpl->getCache(serviceName));
+    if (!cache)
+        return false;
+    cache->invalidate();
+    return true;
+}
+
+bool RPCServer::invalidateCache(std::string const & serviceName, epics::pvData::PVStructure::shared_pointer const & args)
+{
+    RPCServiceCache::shared_pointer cache(m_channelProviderImpl->getCache(serviceName));
+    if (!cache)
+        return false;
+    cache->invalidate(args);
+    return true;
+}
+
+bool RPCServer::getCacheStats(std::string const & serviceName, CacheStats& stats)
+{
+    RPCServiceCache::shared_pointer cache(m_channelProviderImpl->getCache(serviceName));
+    if (!cache)
+        return false;
+    cache->getStats(stats);
+    return true;
 }
 
 void RPCServer::unregisterService(std::string const & serviceName)
 {
     m_channelProviderImpl->unregisterService(serviceName);
+    channelListChanged(m_serverContext);
 }
 
 }
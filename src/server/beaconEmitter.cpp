@@ -38,7 +38,8 @@ BeaconEmitter::BeaconEmitter(std::string const & protocol,
     _serverAddress(*(context->getServerInetAddress())),
     _serverPort(context->getServerPort()),
     _serverStatusProvider(context->getBeaconServerStatusProvider()),
-    _timer(context->getTimer())
+    _timer(context->getTimer()),
+    _context(context)
 {
 }
 
@@ -64,6 +65,13 @@ void BeaconEmitter::send(ByteBuffer* buffer, TransportSendControl* control)
             LOG(logLevelDebug, "BeaconServerStatusProvider implementation thrown an exception.");
         }
     }
+    else
+    {
+        // advertise hosted channel names instead, if enabled
+        std::tr1::shared_ptr<ServerContextImpl> context(_context.lock());
+        if (context)
+            serverStatus = context->getBeaconChannelFilterData();
+    }
 
     // send beacon
     control->startMessage((int8)0, 12+2+2+16+2);
@@ -128,6 +136,10 @@ void BeaconEmitter::reschedule()
 
 void BeaconEmitter::callback()
 {
+    std::tr1::shared_ptr<ServerContextImpl> context(_context.lock());
+    if (context && context->isBeaconChannelFilterEnabled() && !_serverStatusProvider)
+        context->refreshBeaconChannelFilter();
+
     _transport->enqueueSendRequest(shared_from_this());
 }
 
@@ -146,6 +146,11 @@ private:
      * Timer.
      */
     epics::pvData::Timer::shared_pointer _timer;
+
+    /**
+     * Context, used to get the channel filter.
+     */
+    std::tr1::weak_ptr<ServerContextImpl> _context;
 };
 
 }
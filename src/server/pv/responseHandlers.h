@@ -7,6 +7,9 @@
 #ifndef RESPONSEHANDLERS_H_
 #define RESPONSEHANDLERS_H_
 
+#include <vector>
+#include <deque>
+
 #include <pv/timer.h>
 
 #include <pv/serverContext.h>
@@ -173,6 +176,10 @@ public:
     void callback();
     void timerStopped();
 
+    TimingWheel::Entry& getTimerEntry() {
+        return _timerEntry;
+    }
+
 private:
     ServerGUID _guid;
     std::string _name;
@@ -186,6 +193,7 @@ private:
     epics::pvData::int32 _expectedResponseCount;
     epics::pvData::int32 _responseCount;
     bool _serverSearch;
+    TimingWheel::Entry _timerEntry;
 };
 
 /****************************************************************************************/
@@ -208,6 +216,11 @@ public:
 private:
     static std::string SERVER_CHANNEL_NAME;
 
+    struct BulkCreateRequest {
+        std::vector<std::string> names;
+        std::vector<ChannelRequester::shared_pointer> requesters;
+    };
+
     void disconnect(Transport::shared_pointer const & transport);
     std::vector<ChannelProvider::shared_pointer> _providers;
 };
@@ -240,7 +253,7 @@ private:
     Transport::weak_pointer _transport;
     const std::string _channelName;
     const pvAccessID _cid;
-    ChannelSecuritySession::shared_pointer const & _css;
+    const ChannelSecuritySession::shared_pointer _css;
     epics::pvData::Status _status;
     epics::pvData::Mutex _mutex;
 };
@@ -755,15 +768,21 @@ class ServerChannelRPCRequesterImpl :
 public:
     typedef std::tr1::shared_ptr<ServerChannelRPCRequesterImpl> shared_pointer;
     typedef std::tr1::shared_ptr<const ServerChannelRPCRequesterImpl> const_shared_pointer;
+
+    /**
+     * Upper limit of provider instances, i.e. outstanding multiplexed requests.
+     */
+    static const std::size_t maxMultiplexedRequests = 1024;
 protected:
     ServerChannelRPCRequesterImpl(ServerContextImpl::shared_pointer const & context,
                                   ServerChannelImpl::shared_pointer const & channel, const pvAccessID ioid,
-                                  Transport::shared_pointer const & transport);
+                                  Transport::shared_pointer const & transport, bool multiplexed);
     void activate(epics::pvData::PVStructure::shared_pointer const & pvRequest);
 public:
     static ChannelRPCRequester::shared_pointer create(ServerContextImpl::shared_pointer const & context,
             ServerChannelImpl::shared_pointer const & channel, const pvAccessID ioid,
-            Transport::shared_pointer const & transport,epics::pvData::PVStructure::shared_pointer const & pvRequest);
+            Transport::shared_pointer const & transport,epics::pvData::PVStructure::shared_pointer const & pvRequest,
+            bool multiplexed = false);
     virtual ~ServerChannelRPCRequesterImpl() {}
 
     void channelRPCConnect(const epics::pvData::Status& status, ChannelRPC::shared_pointer const & channelRPC);
@@ -774,12 +793,58 @@ public:
      */
     ChannelRPC::shared_pointer getChannelRPC();
 
+    bool isMultiplexed() const {
+        return _multiplexed;
+    }
+
+    /**
+     * Take an idle provider instance for a multiplexed request, creating one if there is none.
+     * Provider ChannelRPC instances handle one request at a time.
+     * @param requestID request ID, as sent by the client.
+     * @param pvArgument request argument.
+     * @return the instance to issue the request to, or null if the instance issues it
+     *         once connected or the request has already failed.
+     */
+    ChannelRPC::shared_pointer startMultiplexedRequest(epics::pvData::int32 requestID,
+            epics::pvData::PVStructure::shared_pointer const & pvArgument);
+
+    /**
+     * Queue the response of a multiplexed request.
+     * @param requestID request ID.
+     * @param status completion status.
+     * @param pvResponse response, if successful.
+     */
+    void multiplexedRequestDone(epics::pvData::int32 requestID, const epics::pvData::Status& status,
+                                epics::pvData::PVStructure::shared_pointer const & pvResponse);
+
     void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control);
 private:
+    class Instance;
+    friend class Instance;
+    typedef std::tr1::shared_ptr<Instance> InstancePtr;
+
+    void instanceDone(InstancePtr const & instance, epics::pvData::int32 requestID, const epics::pvData::Status& status,
+                      epics::pvData::PVStructure::shared_pointer const & pvResponse);
+
     // Note: this forms a reference loop, which is broken in destroy()
     ChannelRPC::shared_pointer _channelRPC;
     epics::pvData::PVStructure::shared_pointer _pvResponse;
     epics::pvData::Status _status;
+    bool _responseReady;
+
+    const bool _multiplexed;
+    bool _destroyed;
+    epics::pvData::PVStructure::shared_pointer _pvRequest;
+    std::vector<InstancePtr> _instances;
+    std::vector<InstancePtr> _idleInstances;
+
+    struct MultiplexedResponse {
+        epics::pvData::int32 requestID;
+        epics::pvData::Status status;
+        epics::pvData::PVStructure::shared_pointer pvResponse;
+    };
+    std::deque<MultiplexedResponse> _multiplexedResponses;
+    bool _multiplexedSendQueued;
 };
 }
 }
@@ -1,6 +1,9 @@
 #ifndef SERVERCONTEXTIMPL_H
 #define SERVERCONTEXTIMPL_H
 
+#include <map>
+#include <set>
+
 #ifdef epicsExportSharedSymbols
 #   define serverContextImplEpicsExportSharedSymbols
 #   undef epicsExportSharedSymbols
@@ -16,13 +19,16 @@
 #include <pv/blockingUDP.h>
 #include <pv/blockingTCP.h>
 #include <pv/beaconEmitter.h>
+#include <pv/bloomFilter.h>
+#include <pv/tokenBucket.h>
+#include <pv/workerPool.h>
 
 #include "serverContext.h"
 
 namespace epics {
 namespace pvAccess {
 
-class ServerContextImpl :
+class epicsShareClass ServerContextImpl :
     public ServerContext,
     public Context,
     public std::tr1::enable_shared_from_this<ServerContextImpl>
@@ -47,6 +53,7 @@ public:
     void setBeaconServerStatusProvider(BeaconServerStatusProvider::shared_pointer const & beaconServerStatusProvider) OVERRIDE FINAL;
     //**************** derived from Context ****************//
     epics::pvData::Timer::shared_pointer getTimer() OVERRIDE FINAL;
+    TimingWheel::shared_pointer getTimingWheel() OVERRIDE FINAL;
     Channel::shared_pointer getChannel(pvAccessID id) OVERRIDE FINAL;
     Transport::shared_pointer getSearchTransport() OVERRIDE FINAL;
     Configuration::const_shared_pointer getConfiguration() OVERRIDE FINAL;
@@ -137,6 +144,80 @@ public:
      */
     bool isChannelProviderNamePreconfigured();
 
+    /**
+     * Is advertising of hosted channel names in beacons enabled.
+     * @return <code>true</code> if enabled.
+     */
+    bool isBeaconChannelFilterEnabled();
+
+    /**
+     * Add a channel name hosted by one of the providers to the beacon channel filter.
+     * @param name channel name.
+     */
+    void advertiseChannel(std::string const & name);
+
+    /**
+     * Query all channel providers for the list of their channels and advertise them,
+     * unless already done since the last beaconChannelListChanged().
+     */
+    void refreshBeaconChannelFilter();
+
+    /**
+     * Notify that channels were added to or removed from a provider,
+     * the channel lists are queried again before the next beacon.
+     */
+    void beaconChannelListChanged();
+
+    /**
+     * Notify that a provider hosts channels it can not list (failed channelList() or hasDynamic),
+     * no filter is advertised until the next refresh of the channel lists.
+     */
+    void beaconChannelListDynamic();
+
+    /**
+     * Get the channel filter data to be sent with beacons.
+     * @return filter data, <code>NULL</code> if disabled, if a provider has unlisted channels,
+     * or if the filter is too full to be useful.
+     */
+    epics::pvData::PVStructure::shared_pointer getBeaconChannelFilterData();
+
+    /**
+     * Apply the search rate limit of a client (search source address).
+     * @param from origin address of the search request.
+     * @param count number of channel names searched.
+     * @return number of names which may be processed, the rest is to be dropped.
+     */
+    std::size_t acquireSearchTokens(const osiSockAddr& from, std::size_t count);
+
+    /**
+     * Check the search rate limit of a client without taking any tokens,
+     * used before forwarding a search to the local multicast group
+     * (the forwarded copy is charged when processed).
+     * @param from origin address of the search request.
+     * @param count number of channel names searched, counted as dropped if over the limit.
+     * @return <code>true</code> if the client is within the limit.
+     */
+    bool checkSearchRate(const osiSockAddr& from, std::size_t count);
+
+    /**
+     * Check if an address is one of this host, i.e. loopback or the address of a used NIF.
+     * @param address address to check.
+     * @return <code>true</code> if local.
+     */
+    bool isLocalAddress(const osiSockAddr& address) const;
+
+    /**
+     * Get number of channel names dropped due to the search rate limit.
+     * @return dropped names count.
+     */
+    epics::pvData::uint64 getDroppedSearchCount();
+
+    /**
+     * Get the pool provider operations are dispatched to.
+     * @return worker pool, <code>NULL</code> if operations are called on the receive thread of a connection.
+     */
+    WorkerPool::shared_pointer getWorkerPool();
+
 private:
 
     /**
@@ -193,6 +274,11 @@ private:
      */
     epics::pvData::Timer::shared_pointer _timer;
 
+    /**
+     * Timing wheel.
+     */
+    TimingWheel::shared_pointer _timingWheel;
+
     /**
      * UDP transports needed to receive channel searches.
      */
@@ -244,6 +330,92 @@ private:
      */
     BeaconServerStatusProvider::shared_pointer _beaconServerStatusProvider;
 
+    /**
+     * False-positive rate of the beacon channel filter, <code>0</code> if disabled.
+     */
+    float _beaconChannelFilterFPP;
+
+    /**
+     * Filter of channel names hosted by the providers (advertised in beacons).
+     */
+    BloomFilter _beaconChannelFilter;
+
+    /**
+     * Names added to _beaconChannelFilter, needed to rebuild the filter when it grows.
+     */
+    std::set<std::string> _beaconChannelNames;
+
+    /**
+     * Number of names _beaconChannelFilter is sized for.
+     */
+    std::size_t _beaconChannelFilterCapacity;
+
+    /**
+     * Are _beaconChannelNames up to date with the providers' channel lists.
+     */
+    bool _beaconChannelListValid;
+
+    /**
+     * Does a provider host channels missing from its channel list.
+     */
+    bool _beaconChannelListDynamic;
+
+    /**
+     * Beacon channel filter mutex.
+     */
+    epics::pvData::Mutex _beaconChannelFilterMutex;
+
+    /**
+     * Rebuild beacon channel filter from _beaconChannelNames.
+     */
+    void rebuildBeaconChannelFilter();
+
+    /**
+     * Channel names searched per second allowed to a single client (source address), <code>0</code> for unlimited.
+     */
+    float _searchRate;
+
+    /**
+     * Channel names a single client may search at once.
+     */
+    float _searchBurst;
+
+    /**
+     * Search rate limit of each client, keyed by IPv4 address.
+     */
+    typedef std::map<epics::pvData::uint32, TokenBucket> searchBuckets_t;
+    searchBuckets_t _searchBuckets;
+
+    /**
+     * Limit shared by clients not fitting into _searchBuckets.
+     */
+    TokenBucket _searchOverflowBucket;
+
+    /**
+     * Number of channel names dropped.
+     */
+    epics::pvData::uint64 _searchDroppedCount;
+
+    /**
+     * Search rate limit mutex.
+     */
+    epics::pvData::Mutex _searchRateMutex;
+
+    /**
+     * Number of worker threads, <code>0</code> to call providers on the receive threads.
+     */
+    epics::pvData::int32 _workerThreads;
+
+    /**
+     * Maximal number of operations queued for the workers.
+     */
+    epics::pvData::int32 _workerQueueSize;
+
+    /**
+     * Worker pool (optional).
+     */
+    WorkerPool::shared_pointer _workerPool;
+
     /**
      * Generate ServerGUID.
      */
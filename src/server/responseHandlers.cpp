@@ -9,6 +9,7 @@
 #endif
 
 #include <sstream>
+#include <algorithm>
 #include <time.h>
 #include <stdlib.h>
 
@@ -83,6 +84,134 @@ static PVField::shared_pointer reuseOrCreatePVField(
         return pvDataCreate->createPVField(field);
 }
 
+namespace {
+
+/**
+ * Calls an operation w/o arguments, e.g. ChannelGet::get().
+ */
+template<typename Operation>
+class OperationTask : public WorkerPool::Task
+{
+public:
+    typedef void (Operation::*method_t)();
+
+    OperationTask(std::tr1::shared_ptr<Operation> const & operation, method_t method) :
+        _operation(operation), _method(method) {}
+
+    virtual void run() OVERRIDE FINAL {
+        (_operation.get()->*_method)();
+    }
+
+private:
+    const std::tr1::shared_ptr<Operation> _operation;
+    const method_t _method;
+};
+
+/**
+ * Calls ChannelPut::put() or ChannelPutGet::putGet().
+ */
+template<typename Operation>
+class PutTask : public WorkerPool::Task
+{
+public:
+    typedef void (Operation::*method_t)(PVStructure::shared_pointer const &, BitSet::shared_pointer const &);
+
+    PutTask(std::tr1::shared_ptr<Operation> const & operation, method_t method,
+            PVStructure::shared_pointer const & pvPutStructure, BitSet::shared_pointer const & putBitSet) :
+        _operation(operation), _method(method), _pvPutStructure(pvPutStructure), _putBitSet(putBitSet) {}
+
+    virtual void run() OVERRIDE FINAL {
+        (_operation.get()->*_method)(_pvPutStructure, _putBitSet);
+    }
+
+private:
+    const std::tr1::shared_ptr<Operation> _operation;
+    const method_t _method;
+    const PVStructure::shared_pointer _pvPutStructure;
+    const BitSet::shared_pointer _putBitSet;
+};
+
+class RPCTask : public WorkerPool::Task
+{
+public:
+    RPCTask(ChannelRPC::shared_pointer const & channelRPC, PVStructure::shared_pointer const & pvArgument) :
+        _channelRPC(channelRPC), _pvArgument(pvArgument) {}
+
+    virtual void run() OVERRIDE FINAL {
+        _channelRPC->request(_pvArgument);
+    }
+
+private:
+    const ChannelRPC::shared_pointer _channelRPC;
+    const PVStructure::shared_pointer _pvArgument;
+};
+
+class DestroyRequestTask : public WorkerPool::Task
+{
+public:
+    DestroyRequestTask(ServerChannelImpl::shared_pointer const & channel,
+                       Destroyable::shared_pointer const & request, pvAccessID ioid) :
+        _channel(channel), _request(request), _ioid(ioid) {}
+
+    virtual void run() OVERRIDE FINAL {
+        _request->destroy();
+        _channel->unregisterRequest(_ioid);
+    }
+
+private:
+    const ServerChannelImpl::shared_pointer _channel;
+    const Destroyable::shared_pointer _request;
+    const pvAccessID _ioid;
+};
+
+/**
+ * Run a provider operation on the worker pool of the context, in order per channel,
+ * or right away (on the receive thread) if there is no pool.
+ */
+void dispatch(ServerContextImpl::shared_pointer const & context,
+              const void* key,
+              WorkerPool::Task::shared_pointer const & task)
+{
+    WorkerPool::shared_pointer workerPool(context->getWorkerPool());
+    if (!workerPool || !workerPool->submit(key, task))
+        task->run();
+}
+
+void dispatch(ServerContextImpl::shared_pointer const & context,
+              ServerChannelImpl::shared_pointer const & channel,
+              WorkerPool::Task::shared_pointer const & task)
+{
+    dispatch(context, channel.get(), task);
+}
+
+/**
+ * Run ChannelPut::put() or ChannelPutGet::putGet() like dispatch().
+ * The request's put structure and bitset are deserialized into by the next put
+ * (on the receive thread), so a task run on the worker pool gets its own copy.
+ */
+template<typename Operation>
+void dispatchPut(ServerContextImpl::shared_pointer const & context,
+                 ServerChannelImpl::shared_pointer const & channel,
+                 std::tr1::shared_ptr<Operation> const & operation, typename PutTask<Operation>::method_t method,
+                 PVStructure::shared_pointer const & pvPutStructure, BitSet::shared_pointer const & putBitSet)
+{
+    WorkerPool::shared_pointer workerPool(context->getWorkerPool());
+    if (!workerPool)
+    {
+        (operation.get()->*method)(pvPutStructure, putBitSet);
+        return;
+    }
+
+    BitSet::shared_pointer bitSetCopy(new BitSet());
+    *bitSetCopy = *putBitSet;
+    WorkerPool::Task::shared_pointer task(new PutTask<Operation>(operation, method,
+                                          pvDataCreate->createPVStructure(pvPutStructure), bitSetCopy));
+    if (!workerPool->submit(channel.get(), task))
+        task->run();
+}
+
+}
+
 
 
 void ServerBadResponse::handleResponse(osiSockAddr* responseFrom,
@@ -265,17 +394,31 @@ void ServerSearchHandler::handleResponse(osiSockAddr* responseFrom,
     transport->ensureData(2);
     const int32 count = payloadBuffer->getShort() & 0xFFFF;
 
-    // TODO DoS attack?
     const bool responseRequired = (QOS_REPLY_REQUIRED & qosCode) != 0;
 
+    // a server (ping) search counts as one name
+    const int32 names = count > 0 ? count : 1;
+
+    BlockingUDPTransport::shared_pointer bt = dynamic_pointer_cast<BlockingUDPTransport>(transport);
+
     //
     // locally broadcast if unicast (qosCode & 0x80 == 0x80) via UDP
     //
     if ((qosCode & 0x80) == 0x80)
     {
-        BlockingUDPTransport::shared_pointer bt = dynamic_pointer_cast<BlockingUDPTransport>(transport);
         if (bt && bt->hasLocalMulticastAddress())
         {
+            // do not forward searches of a client over its rate limit;
+            // the forwarded copy is charged to the response address when processed,
+            // if the sender named another one it is charged here
+            if (responseAddress.ia.sin_addr.s_addr == responseFrom->ia.sin_addr.s_addr)
+            {
+                if (!_context->checkSearchRate(*responseFrom, names))
+                    return;
+            }
+            else if (_context->acquireSearchTokens(*responseFrom, names) < (std::size_t)names)
+                return;
+
             // RECEIVE_BUFFER_PRE_RESERVE allows to pre-fix message
             size_t newStartPos = (startPosition-PVA_MESSAGE_HEADER_SIZE)-PVA_MESSAGE_HEADER_SIZE-16;
             payloadBuffer->setPosition(newStartPos);
@@ -304,9 +447,18 @@ void ServerSearchHandler::handleResponse(osiSockAddr* responseFrom,
         }
     }
 
+    // limit the rate of searches of a single client, so that a runaway client
+    // cannot make the server do unbounded provider lookups and replies;
+    // the client is identified by the source address, the response address
+    // is chosen by the sender and only trusted for searches forwarded by this host
+    const bool forwarded = bt && bt->isOriginTagged() && _context->isLocalAddress(*responseFrom);
+    const int32 permitted = (int32)_context->acquireSearchTokens(forwarded ? responseAddress : *responseFrom, names);
+    if (permitted == 0)
+        return;
+
     if (count > 0)
     {
-        for (int32 i = 0; i < count; i++)
+        for (int32 i = 0; i < permitted; i++)
         {
             transport->ensureData(4);
             const int32 cid = payloadBuffer->getInt();
@@ -340,7 +492,7 @@ void ServerSearchHandler::handleResponse(osiSockAddr* responseFrom,
 
             // TODO use std::make_shared
             TimerCallback::shared_pointer tc = tp;
-            _context->getTimer()->scheduleAfterDelay(tc, period);
+            _context->getTimingWheel()->schedule(tp->getTimerEntry(), tc, period);
         }
     }
 }
@@ -417,6 +569,10 @@ void ServerChannelFindRequesterImpl::channelFindResult(const Status& /*status*/,
             ServerSearchHandler::s_channelNameToProvider[_name] = channelFind->getChannelProvider();
         }
         _wasFound = wasFound;
+
+        // learn names of dynamic channels, not reported by channelList()
+        if (wasFound)
+            _context->advertiseChannel(_name);
         
         BlockingUDPTransport::shared_pointer bt = _context->getBroadcastTransport();
         if (bt)
@@ -688,68 +844,105 @@ void ServerCreateChannelHandler::handleResponse(osiSockAddr* responseFrom,
     AbstractServerResponseHandler::handleResponse(responseFrom,
             transport, version, command, payloadSize, payloadBuffer);
 
-    // TODO for not only one request at the time is supported, i.e. dataCount == 1
-    transport->ensureData((sizeof(int32)+sizeof(int16))/sizeof(int8));
-    const int16 count = payloadBuffer->getShort();
-    if (count != 1)
-    {
-        THROW_BASE_EXCEPTION("only 1 supported for now");
-    }
-    const pvAccessID cid = payloadBuffer->getInt();
-
-    string channelName = SerializeHelper::deserializeString(payloadBuffer, transport.get());
-    if (channelName.size() == 0)
-    {
-
-        char host[100];
-        sockAddrToDottedIP(&transport->getRemoteAddress()->sa,host,100);
-        LOG(logLevelDebug,"Zero length channel name, disconnecting client: %s", host);
-        disconnect(transport);
-        return;
-    }
-    else if (channelName.size() > MAX_CHANNEL_NAME_LENGTH)
+    // one or more (cid, name) pairs
+    transport->ensureData(sizeof(int16)/sizeof(int8));
+    const int32 count = payloadBuffer->getShort() & 0xFFFF;
+    if (count == 0)
     {
         char host[100];
         sockAddrToDottedIP(&transport->getRemoteAddress()->sa,host,100);
-        LOG(logLevelDebug,"Unreasonable channel name length, disconnecting client: %s", host);
+        LOG(logLevelDebug,"Empty create channel request, disconnecting client: %s", host);
         disconnect(transport);
         return;
     }
 
+    // channels of the same provider are created together (see ChannelProvider::createChannels())
+    typedef std::map<ChannelProvider::shared_pointer, BulkCreateRequest> bulkRequests_t;
+    bulkRequests_t bulkRequests;
+
     SecuritySession::shared_pointer securitySession = transport->getSecuritySession();
-    ChannelSecuritySession::shared_pointer css;
-    try {
-        css = securitySession->createChannelSession(channelName);
-        if (!css)
-            throw SecurityException("null channelSecuritySession");
-    } catch (SecurityException& se) {
-        // TODO use std::make_shared
-        std::tr1::shared_ptr<ServerChannelRequesterImpl> tp(new ServerChannelRequesterImpl(transport, channelName, cid, css));
-        ChannelRequester::shared_pointer cr = tp;
-
-        Status asStatus(Status::STATUSTYPE_ERROR,
-                        string("Insufficient rights to create a channel: ") + se.what());
-        cr->channelCreated(asStatus, Channel::shared_pointer());
-        return;
-    }
 
-    if (channelName == SERVER_CHANNEL_NAME)
+    for (int32 i = 0; i < count; i++)
     {
-        // TODO singleton!!!
-        ServerRPCService::shared_pointer serverRPCService(new ServerRPCService(_context));
+        transport->ensureData(sizeof(int32)/sizeof(int8));
+        const pvAccessID cid = payloadBuffer->getInt();
+
+        string channelName = SerializeHelper::deserializeString(payloadBuffer, transport.get());
+        if (channelName.size() == 0)
+        {
+
+            char host[100];
+            sockAddrToDottedIP(&transport->getRemoteAddress()->sa,host,100);
+            LOG(logLevelDebug,"Zero length channel name, disconnecting client: %s", host);
+            disconnect(transport);
+            return;
+        }
+        else if (channelName.size() > MAX_CHANNEL_NAME_LENGTH)
+        {
+            char host[100];
+            sockAddrToDottedIP(&transport->getRemoteAddress()->sa,host,100);
+            LOG(logLevelDebug,"Unreasonable channel name length, disconnecting client: %s", host);
+            disconnect(transport);
+            return;
+        }
 
-        // TODO use std::make_shared
-        std::tr1::shared_ptr<ServerChannelRequesterImpl> tp(new ServerChannelRequesterImpl(transport, channelName, cid, css));
-        ChannelRequester::shared_pointer cr = tp;
-        Channel::shared_pointer serverChannel = createRPCChannel(ChannelProvider::shared_pointer(), channelName, cr, serverRPCService);
-        cr->channelCreated(Status::Ok, serverChannel);
+        ChannelSecuritySession::shared_pointer css;
+        try {
+            css = securitySession->createChannelSession(channelName);
+            if (!css)
+                throw SecurityException("null channelSecuritySession");
+        } catch (SecurityException& se) {
+            // TODO use std::make_shared
+            std::tr1::shared_ptr<ServerChannelRequesterImpl> tp(new ServerChannelRequesterImpl(transport, channelName, cid, css));
+            ChannelRequester::shared_pointer cr = tp;
+
+            Status asStatus(Status::STATUSTYPE_ERROR,
+                            string("Insufficient rights to create a channel: ") + se.what());
+            cr->channelCreated(asStatus, Channel::shared_pointer());
+            continue;
+        }
+
+        if (channelName == SERVER_CHANNEL_NAME)
+        {
+            // TODO singleton!!!
+            ServerRPCService::shared_pointer serverRPCService(new ServerRPCService(_context));
+
+            // TODO use std::make_shared
+            std::tr1::shared_ptr<ServerChannelRequesterImpl> tp(new ServerChannelRequesterImpl(transport, channelName, cid, css));
+            ChannelRequester::shared_pointer cr = tp;
+            Channel::shared_pointer serverChannel = createRPCChannel(ChannelProvider::shared_pointer(), channelName, cr, serverRPCService);
+            cr->channelCreated(Status::Ok, serverChannel);
+        }
+        else
+        {
+            ChannelProvider::shared_pointer provider;
+            if (_providers.size() == 1)
+                provider = _providers[0];
+            else
+                provider = ServerSearchHandler::s_channelNameToProvider[channelName].lock();     // TODO !!!!
+
+            // TODO use std::make_shared
+            std::tr1::shared_ptr<ServerChannelRequesterImpl> tp(new ServerChannelRequesterImpl(transport, channelName, cid, css));
+            BulkCreateRequest& request = bulkRequests[provider];
+            request.names.push_back(channelName);
+            request.requesters.push_back(tp);
+        }
     }
-    else
+
+    for (bulkRequests_t::const_iterator it = bulkRequests.begin(); it != bulkRequests.end(); it++)
     {
-        if (_providers.size() == 1)
-            ServerChannelRequesterImpl::create(_providers[0], transport, channelName, cid, css);
-        else
-            ServerChannelRequesterImpl::create(ServerSearchHandler::s_channelNameToProvider[channelName].lock(), transport, channelName, cid, css);     // TODO !!!!
+        const BulkCreateRequest& request = it->second;
+        if (!it->first)
+        {
+            // provider gone (or not known)
+            for (size_t i = 0; i < request.requesters.size(); i++)
+                request.requesters[i]->channelCreated(Status::error("No provider for channel " + request.names[i]),
+                                                      Channel::shared_pointer());
+            continue;
+        }
+
+        // TODO exception guard and report error back
+        it->first->createChannels(request.names, request.requesters, transport->getPriority());
     }
 }
 
@@ -1059,7 +1252,8 @@ void ServerGetHandler::handleResponse(osiSockAddr* responseFrom,
         ChannelGet::shared_pointer channelGet = request->getChannelGet();
         if (lastRequest)
             channelGet->lastRequest();
-        channelGet->get();
+        dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                     new OperationTask<ChannelGet>(channelGet, &ChannelGet::get)));
     }
 }
 
@@ -1324,7 +1518,8 @@ void ServerPutHandler::handleResponse(osiSockAddr* responseFrom,
                 return;
             }
 
-            channelPut->get();
+            dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                         new OperationTask<ChannelPut>(channelPut, &ChannelPut::get)));
         }
         else
         {
@@ -1352,7 +1547,7 @@ void ServerPutHandler::handleResponse(osiSockAddr* responseFrom,
                     return;
                 }
 
-                channelPut->put(putPVStructure, putBitSet);
+                dispatchPut(_context, channel, channelPut, &ChannelPut::put, putPVStructure, putBitSet);
             }
         }
     }
@@ -1594,7 +1789,8 @@ void ServerPutGetHandler::handleResponse(osiSockAddr* responseFrom,
                 return;
             }
 
-            channelPutGet->getGet();
+            dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                         new OperationTask<ChannelPutGet>(channelPutGet, &ChannelPutGet::getGet)));
         }
         else if(getPut)
         {
@@ -1608,7 +1804,8 @@ void ServerPutGetHandler::handleResponse(osiSockAddr* responseFrom,
                 return;
             }
 
-            channelPutGet->getPut();
+            dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                         new OperationTask<ChannelPutGet>(channelPutGet, &ChannelPutGet::getPut)));
         }
         else
         {
@@ -1635,7 +1832,7 @@ void ServerPutGetHandler::handleResponse(osiSockAddr* responseFrom,
                     return;
                 }
 
-                channelPutGet->putGet(putPVStructure, putBitSet);
+                dispatchPut(_context, channel, channelPutGet, &ChannelPutGet::putGet, putPVStructure, putBitSet);
             }
         }
     }
@@ -2496,11 +2693,9 @@ void ServerDestroyRequestHandler::handleResponse(osiSockAddr* responseFrom,
         return;
     }
 
-    // destroy
-    request->destroy();
-
-    // ... and remove from channel
-    channel->unregisterRequest(ioid);
+    // destroy and remove from channel, after the operations already dispatched
+    dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                 new DestroyRequestTask(channel, request, ioid)));
 }
 
 void ServerDestroyRequestHandler::failureResponse(Transport::shared_pointer const & transport, pvAccessID ioid, const Status& errorStatus)
@@ -2624,7 +2819,8 @@ void ServerProcessHandler::handleResponse(osiSockAddr* responseFrom,
             return;
         }
 
-        request->getChannelProcess()->process();
+        dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                     new OperationTask<ChannelProcess>(request->getChannelProcess(), &ChannelProcess::process)));
     }
 }
 
@@ -2830,10 +3026,13 @@ void ServerRPCHandler::handleResponse(osiSockAddr* responseFrom,
     // mode
     const int8 qosCode = payloadBuffer->getByte();
 
+    // failures without a request ID are never reported as multiplexed
+    const int8 plainQosCode = qosCode & ~QOS_RPC_MULTIPLEX;
+
     ServerChannelImpl::shared_pointer channel = static_pointer_cast<ServerChannelImpl>(casTransport->getChannel(sid));
     if (!channel.get())
     {
-        BaseChannelRequester::sendFailureMessage((int8)CMD_RPC, transport, ioid, qosCode, BaseChannelRequester::badCIDStatus);
+        BaseChannelRequester::sendFailureMessage((int8)CMD_RPC, transport, ioid, plainQosCode, BaseChannelRequester::badCIDStatus);
         return;
     }
 
@@ -2847,12 +3046,49 @@ void ServerRPCHandler::handleResponse(osiSockAddr* responseFrom,
         Status asStatus = channel->getChannelSecuritySession()->authorizeCreateChannelRPC(ioid, pvRequest);
         if (!asStatus.isSuccess())
         {
-            BaseChannelRequester::sendFailureMessage((int8)CMD_RPC, transport, ioid, qosCode, asStatus);
+            BaseChannelRequester::sendFailureMessage((int8)CMD_RPC, transport, ioid, plainQosCode, asStatus);
             return;
         }
 
         // create...
-        ServerChannelRPCRequesterImpl::create(_context, channel, ioid, transport, pvRequest);
+        ServerChannelRPCRequesterImpl::create(_context, channel, ioid, transport, pvRequest,
+                                              (QOS_RPC_MULTIPLEX & qosCode) != 0);
+    }
+    else if ((QOS_RPC_MULTIPLEX & qosCode) != 0)
+    {
+        ServerChannelRPCRequesterImpl::shared_pointer request = static_pointer_cast<ServerChannelRPCRequesterImpl>(channel->getRequest(ioid));
+        if (!request.get() || !request->isMultiplexed())
+        {
+            BaseChannelRequester::sendFailureMessage((int8)CMD_RPC, transport, ioid, plainQosCode, BaseChannelRequester::badIOIDStatus);
+            return;
+        }
+
+        transport->ensureData(sizeof(int32)/sizeof(int8));
+        const int32 requestID = payloadBuffer->getInt();
+
+        // pvArgument
+        PVStructure::shared_pointer pvArgument;
+        try {
+            pvArgument = SerializationHelper::deserializeStructureFull(payloadBuffer, transport.get());
+        } catch (std::exception &e) {
+            request->multiplexedRequestDone(requestID, Status(Status::STATUSTYPE_ERROR, e.what()), PVStructure::shared_pointer());
+            throw;
+        }
+
+        // asCheck
+        Status asStatus = channel->getChannelSecuritySession()->authorizeRPC(ioid, pvArgument);
+        if (!asStatus.isSuccess())
+        {
+            request->multiplexedRequestDone(requestID, asStatus, PVStructure::shared_pointer());
+            return;
+        }
+
+        // no pending request check, each request has its own provider instance,
+        // and its own order, so that the requests of a channel run in parallel
+        ChannelRPC::shared_pointer channelRPC(request->startMultiplexedRequest(requestID, pvArgument));
+        if (channelRPC)
+            dispatch(_context, channelRPC.get(), WorkerPool::Task::shared_pointer(
+                         new RPCTask(channelRPC, pvArgument)));
     }
     else
     {
@@ -2893,32 +3129,168 @@ void ServerRPCHandler::handleResponse(osiSockAddr* responseFrom,
             return;
         }
 
-        channelRPC->request(pvArgument);
+        dispatch(_context, channel, WorkerPool::Task::shared_pointer(
+                     new RPCTask(channelRPC, pvArgument)));
     }
 }
 
+namespace {
+Status multiplexedLimitStatus(Status::STATUSTYPE_ERROR, "too many outstanding requests");
+}
+
+/**
+ * Provider ChannelRPC instance serving multiplexed requests, one at a time.
+ */
+class ServerChannelRPCRequesterImpl::Instance :
+    public ChannelRPCRequester,
+    public std::tr1::enable_shared_from_this<ServerChannelRPCRequesterImpl::Instance>
+{
+public:
+    POINTER_DEFINITIONS(Instance);
+
+    explicit Instance(ServerChannelRPCRequesterImpl::shared_pointer const & owner) :
+        _owner(owner), _state(CONNECTING), _requestID(0)
+    {
+    }
+
+    virtual std::string getRequesterName() OVERRIDE FINAL {
+        return "ServerChannelRPCRequesterImpl::Instance";
+    }
+
+    virtual void message(std::string const & message, epics::pvData::MessageType messageType) OVERRIDE FINAL {
+        ServerChannelRPCRequesterImpl::shared_pointer owner(_owner.lock());
+        if (owner)
+            owner->message(message, messageType);
+    }
+
+    void created(ChannelRPC::shared_pointer const & channelRPC)
+    {
+        Lock guard(_mutex);
+        if (!_channelRPC && _state != FAILED)
+            _channelRPC = channelRPC;
+    }
+
+    /**
+     * @return the provider instance if connected, otherwise the request is issued on connect,
+     *         or <code>status</code> is set if the connection failed.
+     */
+    ChannelRPC::shared_pointer start(int32 requestID, PVStructure::shared_pointer const & pvArgument, Status& status)
+    {
+        Lock guard(_mutex);
+        _requestID = requestID;
+        switch (_state)
+        {
+        case CONNECTED:
+            return _channelRPC;
+        case CONNECTING:
+            _pvArgument = pvArgument;
+            break;
+        case FAILED:
+            status = _connectStatus;
+            break;
+        }
+        return ChannelRPC::shared_pointer();
+    }
+
+    bool isConnected()
+    {
+        Lock guard(_mutex);
+        return _state == CONNECTED;
+    }
+
+    virtual void channelRPCConnect(const Status& status, ChannelRPC::shared_pointer const & channelRPC) OVERRIDE FINAL
+    {
+        PVStructure::shared_pointer pvArgument;
+        int32 requestID;
+        {
+            Lock guard(_mutex);
+            _connectStatus = status;
+            _state = status.isSuccess() ? CONNECTED : FAILED;
+            _channelRPC = channelRPC;
+            pvArgument.swap(_pvArgument);
+            requestID = _requestID;
+        }
+
+        // connected after start()
+        if (!pvArgument)
+            return;
+
+        if (status.isSuccess())
+            channelRPC->request(pvArgument);
+        else
+            done(requestID, status, PVStructure::shared_pointer());
+    }
+
+    virtual void requestDone(const Status& status, ChannelRPC::shared_pointer const & /*channelRPC*/,
+                             PVStructure::shared_pointer const & pvResponse) OVERRIDE FINAL
+    {
+        int32 requestID;
+        {
+            Lock guard(_mutex);
+            requestID = _requestID;
+        }
+        done(requestID, status, pvResponse);
+    }
+
+    void destroy()
+    {
+        ChannelRPC::shared_pointer channelRPC;
+        {
+            Lock guard(_mutex);
+            _state = FAILED;
+            channelRPC.swap(_channelRPC);
+            _pvArgument.reset();
+        }
+        if (channelRPC)
+            channelRPC->destroy();
+    }
+
+private:
+    void done(int32 requestID, const Status& status, PVStructure::shared_pointer const & pvResponse)
+    {
+        ServerChannelRPCRequesterImpl::shared_pointer owner(_owner.lock());
+        if (owner)
+            owner->instanceDone(shared_from_this(), requestID, status, pvResponse);
+    }
+
+    const ServerChannelRPCRequesterImpl::weak_pointer _owner;
+
+    Mutex _mutex;
+    enum { CONNECTING, CONNECTED, FAILED } _state;
+    Status _connectStatus;
+    // Note: this forms a reference loop, which is broken in destroy()
+    ChannelRPC::shared_pointer _channelRPC;
+    int32 _requestID;
+    PVStructure::shared_pointer _pvArgument;
+};
+
 ServerChannelRPCRequesterImpl::ServerChannelRPCRequesterImpl(
     ServerContextImpl::shared_pointer const & context, ServerChannelImpl::shared_pointer const & channel,
-    const pvAccessID ioid, Transport::shared_pointer const & transport):
+    const pvAccessID ioid, Transport::shared_pointer const & transport, bool multiplexed):
     BaseChannelRequester(context, channel, ioid, transport),
-    _channelRPC(), _pvResponse()
+    _channelRPC(), _pvResponse(), _responseReady(false),
+    _multiplexed(multiplexed), _destroyed(false),
+    _multiplexedSendQueued(false)
 
 {
 }
 
 ChannelRPCRequester::shared_pointer ServerChannelRPCRequesterImpl::create(
     ServerContextImpl::shared_pointer const & context, ServerChannelImpl::shared_pointer const & channel,
-    const pvAccessID ioid, Transport::shared_pointer const & transport, PVStructure::shared_pointer const & pvRequest)
+    const pvAccessID ioid, Transport::shared_pointer const & transport, PVStructure::shared_pointer const & pvRequest,
+    bool multiplexed)
 {
     // TODO use std::make_shared
-    std::tr1::shared_ptr<ServerChannelRPCRequesterImpl> tp(new ServerChannelRPCRequesterImpl(context, channel, ioid, transport));
+    std::tr1::shared_ptr<ServerChannelRPCRequesterImpl> tp(new ServerChannelRPCRequesterImpl(context, channel, ioid, transport, multiplexed));
     tp->activate(pvRequest);
     return tp;
 }
 
 void ServerChannelRPCRequesterImpl::activate(PVStructure::shared_pointer const & pvRequest)
 {
-    startRequest(QOS_INIT);
+    // the init response grants the multiplexed mode
+    startRequest(_multiplexed ? (QOS_INIT | QOS_RPC_MULTIPLEX) : QOS_INIT);
+    _pvRequest = pvRequest;
     ChannelRPCRequester::shared_pointer thisPointer = shared_from_this();
     Destroyable::shared_pointer thisDestroyable = shared_from_this();
     _channel->registerRequest(_ioid, thisDestroyable);
@@ -2931,6 +3303,7 @@ void ServerChannelRPCRequesterImpl::channelRPCConnect(const Status& status, Chan
         Lock guard(_mutex);
         _status = status;
         _channelRPC = channelRPC;
+        _responseReady = true;
     }
     TransportSender::shared_pointer thisSender = shared_from_this();
     _transport->enqueueSendRequest(thisSender);
@@ -2948,6 +3321,92 @@ void ServerChannelRPCRequesterImpl::requestDone(const Status& status, ChannelRPC
         Lock guard(_mutex);
         _status = status;
         _pvResponse = pvResponse;
+        _responseReady = true;
+    }
+    TransportSender::shared_pointer thisSender = shared_from_this();
+    _transport->enqueueSendRequest(thisSender);
+}
+
+ChannelRPC::shared_pointer ServerChannelRPCRequesterImpl::startMultiplexedRequest(int32 requestID,
+        PVStructure::shared_pointer const & pvArgument)
+{
+    InstancePtr instance;
+    bool create = false;
+    {
+        Lock guard(_mutex);
+        if (_destroyed)
+            return ChannelRPC::shared_pointer();
+
+        if (!_idleInstances.empty())
+        {
+            instance = _idleInstances.back();
+            _idleInstances.pop_back();
+        }
+        else if (_instances.size() < maxMultiplexedRequests)
+        {
+            instance.reset(new Instance(shared_from_this()));
+            _instances.push_back(instance);
+            create = true;
+        }
+    }
+
+    if (!instance)
+    {
+        multiplexedRequestDone(requestID, multiplexedLimitStatus, PVStructure::shared_pointer());
+        return ChannelRPC::shared_pointer();
+    }
+
+    Status status;
+    if (create)
+    {
+        try {
+            instance->created(_channel->getChannel()->createChannelRPC(instance, _pvRequest));
+        } catch (std::exception &e) {
+            instance->channelRPCConnect(Status(Status::STATUSTYPE_FATAL, e.what()), ChannelRPC::shared_pointer());
+        }
+    }
+
+    ChannelRPC::shared_pointer channelRPC(instance->start(requestID, pvArgument, status));
+    if (!status.isSuccess())
+        instanceDone(instance, requestID, status, PVStructure::shared_pointer());
+    return channelRPC;
+}
+
+void ServerChannelRPCRequesterImpl::instanceDone(InstancePtr const & instance, int32 requestID,
+        const Status& status, PVStructure::shared_pointer const & pvResponse)
+{
+    {
+        Lock guard(_mutex);
+        if (_destroyed)
+            return;
+
+        // failed instances are dropped, the next request creates a new one
+        if (instance->isConnected())
+            _idleInstances.push_back(instance);
+        else
+            _instances.erase(std::remove(_instances.begin(), _instances.end(), instance), _instances.end());
+    }
+    multiplexedRequestDone(requestID, status, pvResponse);
+}
+
+void ServerChannelRPCRequesterImpl::multiplexedRequestDone(int32 requestID, const Status& status,
+        PVStructure::shared_pointer const & pvResponse)
+{
+    {
+        Lock guard(_mutex);
+        if (_destroyed)
+            return;
+
+        _multiplexedResponses.push_back(MultiplexedResponse());
+        MultiplexedResponse& response = _multiplexedResponses.back();
+        response.requestID = requestID;
+        response.status = status;
+        response.pvResponse = pvResponse;
+
+        // responses completed until the send are put on the wire together
+        if (_multiplexedSendQueued)
+            return;
+        _multiplexedSendQueued = true;
     }
     TransportSender::shared_pointer thisSender = shared_from_this();
     _transport->enqueueSendRequest(thisSender);
@@ -2960,8 +3419,14 @@ void ServerChannelRPCRequesterImpl::destroy()
     // destroyed prematurely
     shared_pointer self(shared_from_this());
 
+    std::vector<InstancePtr> instances;
     {
         Lock guard(_mutex);
+        _destroyed = true;
+        instances.swap(_instances);
+        _idleInstances.clear();
+        _multiplexedResponses.clear();
+
         _channel->unregisterRequest(_ioid);
 
         // asCheck
@@ -2974,6 +3439,9 @@ void ServerChannelRPCRequesterImpl::destroy()
     }
     // TODO
     _channelRPC.reset();
+
+    for (std::size_t i = 0; i < instances.size(); i++)
+        instances[i]->destroy();
 }
 
 ChannelRPC::shared_pointer ServerChannelRPCRequesterImpl::getChannelRPC()
@@ -2984,6 +3452,36 @@ ChannelRPC::shared_pointer ServerChannelRPCRequesterImpl::getChannelRPC()
 
 void ServerChannelRPCRequesterImpl::send(ByteBuffer* buffer, TransportSendControl* control)
 {
+    std::deque<MultiplexedResponse> responses;
+    bool responseReady;
+    {
+        Lock guard(_mutex);
+        responses.swap(_multiplexedResponses);
+        _multiplexedSendQueued = false;
+        responseReady = _responseReady;
+        _responseReady = false;
+    }
+
+    // status, then request ID and response
+    for (std::deque<MultiplexedResponse>::const_iterator it = responses.begin(); it != responses.end(); ++it)
+    {
+        if (it != responses.begin())
+            control->endMessage();
+        control->startMessage((int32)CMD_RPC, sizeof(int32)/sizeof(int8) + 1);
+        buffer->putInt(_ioid);
+        buffer->putByte((int8)QOS_RPC_MULTIPLEX);
+        it->status.serialize(buffer, control);
+        control->ensureBuffer(sizeof(int32)/sizeof(int8));
+        buffer->putInt(it->requestID);
+        if (it->status.isSuccess())
+            SerializationHelper::serializeStructureFull(buffer, control, it->pvResponse);
+    }
+
+    if (!responseReady)
+        return;
+    if (!responses.empty())
+        control->endMessage();
+
     const int32 request = getPendingRequest();
 
     control->startMessage((int32)CMD_RPC, sizeof(int32)/sizeof(int8) + 1);
@@ -4,12 +4,20 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include <algorithm>
+
 #include <epicsSignal.h>
 
 #include <pv/lock.h>
 #include <pv/timer.h>
 #include <pv/thread.h>
 #include <pv/reftrack.h>
+#include <pv/pvData.h>
+#include <pv/timeStamp.h>
 
 #define epicsExportSharedSymbols
 #include <pv/responseHandlers.h>
@@ -39,11 +47,26 @@ ServerContextImpl::ServerContextImpl():
     _serverPort(PVA_SERVER_PORT),
     _receiveBufferSize(MAX_TCP_RECV),
     _timer(new Timer("pvAccess-server timer", lowerPriority)),
+    _timingWheel(new TimingWheel("pvAccess-server wheel", lowerPriority)),
     _beaconEmitter(),
     _acceptor(),
     _transportRegistry(),
     _channelProviders(),
     _beaconServerStatusProvider(),
+    _beaconChannelFilterFPP(0.0f),
+    _beaconChannelFilter(),
+    _beaconChannelNames(),
+    _beaconChannelFilterCapacity(0),
+    _beaconChannelListValid(false),
+    _beaconChannelListDynamic(false),
+    _searchRate(0.0f),
+    _searchBurst(0.0f),
+    _searchBuckets(),
+    _searchOverflowBucket(),
+    _searchDroppedCount(0),
+    _workerThreads(0),
+    _workerQueueSize(1024),
+    _workerPool(),
     _startTime()
 {
     REFTRACE_INCREMENT(num_instances);
@@ -149,6 +172,24 @@ void ServerContextImpl::loadConfiguration()
     _receiveBufferSize = config->getPropertyAsInteger("EPICS_PVA_MAX_ARRAY_BYTES", _receiveBufferSize);
     _receiveBufferSize = config->getPropertyAsInteger("EPICS_PVAS_MAX_ARRAY_BYTES", _receiveBufferSize);
 
+    _beaconChannelFilterFPP = config->getPropertyAsFloat("EPICS_PVAS_BEACON_FILTER_FPP", _beaconChannelFilterFPP);
+    if (_beaconChannelFilterFPP < 0.0f || _beaconChannelFilterFPP >= 1.0f)
+        _beaconChannelFilterFPP = 0.0f;
+
+    _searchRate = config->getPropertyAsFloat("EPICS_PVAS_SEARCH_RATE", _searchRate);
+    if (_searchRate < 0.0f)
+        _searchRate = 0.0f;
+    // one second worth of names by default
+    _searchBurst = config->getPropertyAsFloat("EPICS_PVAS_SEARCH_BURST", _searchRate);
+    _searchOverflowBucket = TokenBucket(_searchRate, _searchBurst);
+
+    _workerThreads = config->getPropertyAsInteger("EPICS_PVAS_WORKER_THREADS", _workerThreads);
+    if (_workerThreads < 0)
+        _workerThreads = 0;
+    _workerQueueSize = config->getPropertyAsInteger("EPICS_PVAS_WORKER_QUEUE", _workerQueueSize);
+    if (_workerQueueSize < 1)
+        _workerQueueSize = 1;
+
     if(_channelProviders.empty()) {
         std::string providers = config->getPropertyAsString("EPICS_PVAS_PROVIDER_NAMES", PVACCESS_DEFAULT_PROVIDER);
 
@@ -254,6 +295,14 @@ ServerContextImpl::getCurrentConfig()
 
     SET("EPICS_PVAS_PROVIDER_NAMES", providerName.str());
 
+    SET("EPICS_PVAS_BEACON_FILTER_FPP", _beaconChannelFilterFPP);
+
+    SET("EPICS_PVAS_SEARCH_RATE", _searchRate);
+    SET("EPICS_PVAS_SEARCH_BURST", _searchBurst);
+
+    SET("EPICS_PVAS_WORKER_THREADS", _workerThreads);
+    SET("EPICS_PVAS_WORKER_QUEUE", _workerQueueSize);
+
 #undef SET
 
     return B.push_map().build();
@@ -273,6 +322,10 @@ void ServerContextImpl::initialize()
     //osiSockAttach();
 
     ServerContextImpl::shared_pointer thisServerContext = shared_from_this();
+
+    if (_workerThreads > 0)
+        _workerPool.reset(new WorkerPool("pvAccess-server worker", _workerThreads, _workerQueueSize, lowerPriority));
+
     // we create reference cycles here which are broken by our shutdown() method,
     _responseHandler.reset(new ServerResponseHandler(thisServerContext));
 
@@ -346,10 +399,24 @@ void ServerContextImpl::shutdown()
     // this will also destroy all channels
     destroyAllTransports();
 
+    // no more operations are queued, run the remaining ones
+    if (_workerPool)
+    {
+        _workerPool->close();
+        LEAK_CHECK(_workerPool, "_workerPool")
+        _workerPool.reset();
+    }
+
     // drop timer queue
     LEAK_CHECK(_timer, "_timer")
     _timer.reset();
 
+    // callbacks hold references to transports and channels
+    if (_timingWheel)
+        _timingWheel->close();
+    LEAK_CHECK(_timingWheel, "_timingWheel")
+    _timingWheel.reset();
+
     // response handlers hold strong references to us,
     // so must break the cycles
     LEAK_CHECK(_responseHandler, "_responseHandler")
@@ -427,7 +494,13 @@ void ServerContextImpl::printInfo(ostream& str)
         << "SERVER_PORT : " << _serverPort << endl
         << "RCV_BUFFER_SIZE : " << _receiveBufferSize << endl
         << "IGNORE_ADDR_LIST: " << _ignoreAddressList << endl
+        << "BEACON_FILTER_FPP : " << _beaconChannelFilterFPP << endl
+        << "SEARCH_RATE : " << _searchRate << endl
+        << "SEARCH_BURST : " << _searchBurst << endl
+        << "SEARCH_DROPPED : " << getDroppedSearchCount() << endl
         << "INTF_ADDR_LIST : " << inetAddressToString(_ifaceAddr, false) << endl;
+    if (_workerPool)
+        _workerPool->printInfo(str);
 }
 
 void ServerContext::dispose()
@@ -491,6 +564,259 @@ BeaconServerStatusProvider::shared_pointer ServerContextImpl::getBeaconServerSta
     return _beaconServerStatusProvider;
 }
 
+namespace {
+
+// maximal size of the filter so that a beacon fits into an unfragmented UDP packet
+const std::size_t MAX_BEACON_CHANNEL_FILTER_BYTES = 1024;
+
+// do not advertise a filter which would match (almost) anything
+const double MAX_BEACON_CHANNEL_FILTER_FPP = 0.5;
+
+const std::size_t MIN_BEACON_CHANNEL_FILTER_CAPACITY = 64;
+
+class BeaconChannelListRequester : public ChannelListRequester
+{
+public:
+    BeaconChannelListRequester(ServerContextImpl::shared_pointer const & context) :
+        _context(context)
+    {}
+
+    virtual void channelListResult(
+        const epics::pvData::Status& status,
+        ChannelFind::shared_pointer const & /*channelFind*/,
+        PVStringArray::const_svector const & channelNames,
+        bool hasDynamic)
+    {
+        ServerContextImpl::shared_pointer context(_context.lock());
+        if (!context)
+            return;
+
+        // names which can not be listed can not be in the filter
+        if (!status.isSuccess() || hasDynamic)
+        {
+            context->beaconChannelListDynamic();
+            if (!status.isSuccess())
+                return;
+        }
+
+        for (size_t i = 0; i < channelNames.size(); i++)
+            context->advertiseChannel(channelNames[i]);
+    }
+
+private:
+    std::tr1::weak_ptr<ServerContextImpl> _context;
+};
+
+StructureConstPtr beaconChannelFilterStructure(
+    getFieldCreate()->createFieldBuilder()->
+    setId("channelFilter_t")->
+    addArray("bits", pvUByte)->
+    add("hashCount", pvInt)->
+    createStructure());
+
+}
+
+bool ServerContextImpl::isBeaconChannelFilterEnabled()
+{
+    return _beaconChannelFilterFPP > 0.0f;
+}
+
+void ServerContextImpl::advertiseChannel(std::string const & name)
+{
+    if (!isBeaconChannelFilterEnabled())
+        return;
+
+    Lock guard(_beaconChannelFilterMutex);
+    if (!_beaconChannelNames.insert(name).second)
+        return;
+
+    if (_beaconChannelNames.size() > _beaconChannelFilterCapacity)
+        rebuildBeaconChannelFilter();
+    else
+        _beaconChannelFilter.add(name);
+}
+
+void ServerContextImpl::rebuildBeaconChannelFilter()
+{
+    // leave room to grow before next rebuild
+    _beaconChannelFilterCapacity = std::max(MIN_BEACON_CHANNEL_FILTER_CAPACITY, 2*_beaconChannelNames.size());
+
+    BloomFilter filter(_beaconChannelFilterCapacity, _beaconChannelFilterFPP, MAX_BEACON_CHANNEL_FILTER_BYTES);
+    for (std::set<std::string>::const_iterator iter = _beaconChannelNames.begin();
+            iter != _beaconChannelNames.end(); iter++)
+        filter.add(*iter);
+
+    _beaconChannelFilter.swap(filter);
+}
+
+void ServerContextImpl::beaconChannelListChanged()
+{
+    Lock guard(_beaconChannelFilterMutex);
+    _beaconChannelListValid = false;
+}
+
+void ServerContextImpl::beaconChannelListDynamic()
+{
+    Lock guard(_beaconChannelFilterMutex);
+    _beaconChannelListDynamic = true;
+}
+
+void ServerContextImpl::refreshBeaconChannelFilter()
+{
+    {
+        Lock guard(_beaconChannelFilterMutex);
+        if (_beaconChannelListValid)
+            return;
+        _beaconChannelListValid = true;
+        _beaconChannelListDynamic = false;
+
+        // drop the names of removed channels, found ones are learned again
+        _beaconChannelNames.clear();
+        BloomFilter().swap(_beaconChannelFilter);
+        _beaconChannelFilterCapacity = 0;
+    }
+
+    ChannelListRequester::shared_pointer requester(new BeaconChannelListRequester(shared_from_this()));
+
+    for (size_t i = 0; i < _channelProviders.size(); i++)
+    {
+        try
+        {
+            _channelProviders[i]->channelList(requester);
+        }
+        catch (std::exception& e)
+        {
+            LOG(logLevelDebug, "Provider '%s' channelList() failed: %s",
+                _channelProviders[i]->getProviderName().c_str(), e.what());
+            beaconChannelListDynamic();
+        }
+    }
+}
+
+PVStructure::shared_pointer ServerContextImpl::getBeaconChannelFilterData()
+{
+    if (!isBeaconChannelFilterEnabled())
+        return PVStructure::shared_pointer();
+
+    PVUByteArray::svector bits;
+    int32 hashCount;
+    {
+        Lock guard(_beaconChannelFilterMutex);
+        // no filter, so that the clients search this server in the first round
+        if (_beaconChannelListDynamic || _beaconChannelFilter.empty() ||
+                _beaconChannelFilter.estimatedFalsePositiveRate() > MAX_BEACON_CHANNEL_FILTER_FPP)
+            return PVStructure::shared_pointer();
+
+        const BloomFilter::bits_t& filterBits = _beaconChannelFilter.getBits();
+        bits.resize(filterBits.size());
+        std::copy(filterBits.begin(), filterBits.end(), bits.begin());
+        hashCount = _beaconChannelFilter.getHashCount();
+    }
+
+    PVStructure::shared_pointer data(getPVDataCreate()->createPVStructure(beaconChannelFilterStructure));
+    data->getSubFieldT<PVUByteArray>("bits")->replace(freeze(bits));
+    data->getSubFieldT<PVInt>("hashCount")->put(hashCount);
+    return data;
+}
+
+bool ServerContextImpl::isLocalAddress(const osiSockAddr& address) const
+{
+    // 127.0.0.0/8
+    if ((ntohl(address.ia.sin_addr.s_addr) & 0xFF000000) == (INADDR_LOOPBACK & 0xFF000000))
+        return true;
+
+    for (IfaceNodeVector::const_iterator iter = _ifaceList.begin(); iter != _ifaceList.end(); iter++)
+    {
+        if (iter->ifaceAddr.ia.sin_addr.s_addr == address.ia.sin_addr.s_addr)
+            return true;
+    }
+    return false;
+}
+
+namespace {
+// bounds memory used by the search rate limit (spoofed source addresses)
+const std::size_t MAX_SEARCH_RATE_CLIENTS = 4096;
+}
+
+std::size_t ServerContextImpl::acquireSearchTokens(const osiSockAddr& from, std::size_t count)
+{
+    if (_searchRate <= 0.0f || count == 0)
+        return count;
+
+    const double nowSec = TokenBucket::now();
+
+    Lock guard(_searchRateMutex);
+
+    TokenBucket* bucket = &_searchOverflowBucket;
+    searchBuckets_t::iterator it = _searchBuckets.find(from.ia.sin_addr.s_addr);
+    if (it != _searchBuckets.end())
+    {
+        bucket = &it->second;
+    }
+    else
+    {
+        // forget idle clients
+        if (_searchBuckets.size() >= MAX_SEARCH_RATE_CLIENTS)
+        {
+            for (it = _searchBuckets.begin(); it != _searchBuckets.end(); )
+            {
+                if (it->second.full(nowSec))
+                    _searchBuckets.erase(it++);
+                else
+                    it++;
+            }
+        }
+
+        if (_searchBuckets.size() < MAX_SEARCH_RATE_CLIENTS)
+            bucket = &_searchBuckets.insert(std::make_pair(from.ia.sin_addr.s_addr,
+                                                           TokenBucket(_searchRate, _searchBurst))).first->second;
+    }
+
+    std::size_t permitted = 0;
+    while (permitted < count && bucket->tryAcquire(nowSec))
+        permitted++;
+
+    if (permitted < count)
+    {
+        _searchDroppedCount += count - permitted;
+        LOG(logLevelDebug, "Search rate limit exceeded by %s, %u channel name(s) dropped.",
+            inetAddressToString(from, false).c_str(), (unsigned)(count - permitted));
+    }
+
+    return permitted;
+}
+
+bool ServerContextImpl::checkSearchRate(const osiSockAddr& from, std::size_t count)
+{
+    if (_searchRate <= 0.0f || count == 0)
+        return true;
+
+    const double nowSec = TokenBucket::now();
+
+    Lock guard(_searchRateMutex);
+
+    TokenBucket* bucket = &_searchOverflowBucket;
+    searchBuckets_t::iterator it = _searchBuckets.find(from.ia.sin_addr.s_addr);
+    if (it != _searchBuckets.end())
+        bucket = &it->second;
+    else if (_searchBuckets.size() < MAX_SEARCH_RATE_CLIENTS)
+        return true;    // a new client starts with a full bucket
+
+    if (bucket->delay(nowSec) == 0.0)
+        return true;
+
+    _searchDroppedCount += count;
+    LOG(logLevelDebug, "Search rate limit exceeded by %s, %u channel name(s) not forwarded.",
+        inetAddressToString(from, false).c_str(), (unsigned)count);
+    return false;
+}
+
+epics::pvData::uint64 ServerContextImpl::getDroppedSearchCount()
+{
+    Lock guard(_searchRateMutex);
+    return _searchDroppedCount;
+}
+
 const osiSockAddr* ServerContextImpl::getServerInetAddress()
 {
     if(_acceptor.get())
@@ -515,6 +841,16 @@ Timer::shared_pointer ServerContextImpl::getTimer()
     return _timer;
 }
 
+WorkerPool::shared_pointer ServerContextImpl::getWorkerPool()
+{
+    return _workerPool;
+}
+
+TimingWheel::shared_pointer ServerContextImpl::getTimingWheel()
+{
+    return _timingWheel;
+}
+
 epics::pvAccess::TransportRegistry* ServerContextImpl::getTransportRegistry()
 {
     return &_transportRegistry;
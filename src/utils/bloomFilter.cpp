@@ -0,0 +1,137 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+#define epicsExportSharedSymbols
+#include <pv/bloomFilter.h>
+
+using namespace epics::pvData;
+
+namespace epics {
+namespace pvAccess {
+
+namespace {
+// ln(2) and ln(2)^2
+const double LN2 = 0.69314718055994530942;
+const double LN2_SQUARED = LN2*LN2;
+
+const unsigned MAX_HASH_COUNT = 16;
+}
+
+BloomFilter::BloomFilter() :
+    m_bits(),
+    m_hashCount(0),
+    m_count(0)
+{
+}
+
+BloomFilter::BloomFilter(std::size_t expectedCount, double falsePositiveRate, std::size_t maxBytes) :
+    m_bits(),
+    m_hashCount(1),
+    m_count(0)
+{
+    if (expectedCount == 0)
+        expectedCount = 1;
+    if (falsePositiveRate <= 0.0 || falsePositiveRate >= 1.0)
+        falsePositiveRate = 0.01;
+
+    // optimal number of bits and hash functions
+    double nbits = -(double)expectedCount * std::log(falsePositiveRate) / LN2_SQUARED;
+    std::size_t nbytes = std::max<std::size_t>(1u, (std::size_t)std::ceil(nbits / 8.0));
+    if (maxBytes && nbytes > maxBytes)
+        nbytes = maxBytes;
+    m_bits.resize(nbytes, 0);
+
+    double k = (8.0 * nbytes / expectedCount) * LN2;
+    m_hashCount = std::max(1u, std::min(MAX_HASH_COUNT, (unsigned)(k + 0.5)));
+}
+
+BloomFilter::BloomFilter(const bits_t& bits, unsigned hashCount) :
+    m_bits(bits),
+    m_hashCount(std::min(MAX_HASH_COUNT, hashCount)),
+    m_count(0)
+{
+}
+
+BloomFilter::Hash::Hash(const std::string& name)
+{
+    // 64-bit FNV-1a, split into two 32-bit halves for double hashing
+    uint64 hash = 14695981039346656037ULL;
+    for (std::string::size_type i = 0; i < name.length(); i++)
+    {
+        hash ^= (uint8)name[i];
+        hash *= 1099511628211ULL;
+    }
+    h1 = (uint32)hash;
+    h2 = (uint32)(hash >> 32) | 1u; // odd, so that probes differ
+}
+
+void BloomFilter::add(const std::string& name)
+{
+    add(Hash(name));
+}
+
+void BloomFilter::add(const Hash& hash)
+{
+    if (m_bits.empty())
+        return;
+
+    const uint32 nbits = (uint32)(m_bits.size() * 8);
+    uint32 h = hash.h1;
+    for (unsigned i = 0; i < m_hashCount; i++, h += hash.h2)
+    {
+        uint32 bit = h % nbits;
+        m_bits[bit >> 3] |= (uint8)(1u << (bit & 7));
+    }
+    m_count++;
+}
+
+bool BloomFilter::mightContain(const Hash& hash) const
+{
+    if (m_bits.empty())
+        return false;
+
+    const uint32 nbits = (uint32)(m_bits.size() * 8);
+    uint32 h = hash.h1;
+    for (unsigned i = 0; i < m_hashCount; i++, h += hash.h2)
+    {
+        uint32 bit = h % nbits;
+        if ((m_bits[bit >> 3] & (1u << (bit & 7))) == 0)
+            return false;
+    }
+    return true;
+}
+
+double BloomFilter::estimatedFalsePositiveRate() const
+{
+    if (m_bits.empty())
+        return 1.0;
+    // (1 - e^(-kn/m))^k
+    double m = 8.0 * m_bits.size();
+    return std::pow(1.0 - std::exp(-(double)m_hashCount * m_count / m), (double)m_hashCount);
+}
+
+void BloomFilter::clear()
+{
+    std::fill(m_bits.begin(), m_bits.end(), 0);
+    m_count = 0;
+}
+
+void BloomFilter::swap(BloomFilter& other)
+{
+    m_bits.swap(other.m_bits);
+    std::swap(m_hashCount, other.m_hashCount);
+    std::swap(m_count, other.m_count);
+}
+
+}
+}
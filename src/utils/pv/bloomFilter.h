@@ -0,0 +1,95 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <string>
+#include <vector>
+
+#ifdef epicsExportSharedSymbols
+#   define bloomFilterEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <pv/pvType.h>
+
+#ifdef bloomFilterEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#   undef bloomFilterEpicsExportSharedSymbols
+#endif
+
+#include <shareLib.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Bloom filter of (channel) names.
+ *
+ * Bit positions are derived from a FNV-1a hash using double hashing,
+ * so the encoding is platform independent and can be sent over the wire.
+ */
+class epicsShareClass BloomFilter
+{
+public:
+    typedef std::vector<epics::pvData::uint8> bits_t;
+
+    //! Empty filter, contains nothing.
+    BloomFilter();
+
+    /**
+     * Create a filter sized for a given number of entries.
+     * @param expectedCount number of entries the filter is sized for.
+     * @param falsePositiveRate false-positive rate at expectedCount entries.
+     * @param maxBytes upper limit of the bit array size, <code>0</code> for no limit.
+     */
+    BloomFilter(std::size_t expectedCount, double falsePositiveRate, std::size_t maxBytes = 0);
+
+    /**
+     * Create a filter from its encoded form (eg. received over the wire).
+     * @param bits bit array.
+     * @param hashCount number of hash functions.
+     */
+    BloomFilter(const bits_t& bits, unsigned hashCount);
+
+    //! Pre-computed hash of a name, to test one name against many filters.
+    struct Hash {
+        epics::pvData::uint32 h1, h2;
+        explicit Hash(const std::string& name);
+    };
+
+    void add(const std::string& name);
+    void add(const Hash& hash);
+
+    bool mightContain(const std::string& name) const { return mightContain(Hash(name)); }
+    bool mightContain(const Hash& hash) const;
+
+    //! Number of add() calls since creation or clear().
+    std::size_t count() const { return m_count; }
+
+    //! Estimated false-positive rate for the current count().
+    double estimatedFalsePositiveRate() const;
+
+    bool empty() const { return m_bits.empty(); }
+
+    void clear();
+
+    const bits_t& getBits() const { return m_bits; }
+    unsigned getHashCount() const { return m_hashCount; }
+
+    void swap(BloomFilter& other);
+
+private:
+    bits_t m_bits;
+    unsigned m_hashCount;
+    std::size_t m_count;
+};
+
+}
+}
+
+#endif  /* BLOOMFILTER_H */
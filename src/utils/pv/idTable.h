@@ -0,0 +1,224 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef IDTABLE_H
+#define IDTABLE_H
+
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+#include <pv/pvaDefs.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Table of values keyed by locally allocated IDs (CIDs, SIDs, IOIDs).
+ *
+ * Values are kept in a slab (vector of slots), an ID is the slot index
+ * combined with a generation number of the slot:
+ * <code>id = (generation << indexBits) | index</code>.
+ * Lookup is a vector index and a generation compare instead of a tree lookup.
+ *
+ * The generation of a slot is incremented whenever its ID is released,
+ * so a stale ID (e.g. from a late response) does not match the next user of the slot.
+ * Released slots are reused in FIFO order, and only once more than <code>minFree</code>
+ * slots are free, which spreads reuse over many slots and makes it take a long
+ * time until an ID value is handed out again.
+ *
+ * Reuse distance: a slot takes <code>G = 2^(31 - indexBits) - 1</code> generations
+ * before its IDs repeat, and each of them is used only after about <code>minFree</code>
+ * other IDs were released.  So an ID value is handed out again only after about
+ * <code>minFree * G</code> releases, 1024 * 32767 (about 3.4e7) with the defaults.
+ * Once all the <code>2^indexBits</code> slots exist, free slots are reused as soon
+ * as they are released and the distance becomes shorter.
+ *
+ * IDs are always positive (never <code>0</code>, i.e. never INVALID_IOID).
+ * Not thread-safe, callers provide locking.
+ */
+template<typename T>
+class IDTable
+{
+public:
+    /** Default number of ID bits used for the slot index (up to 64k live IDs, 15 generation bits). */
+    static const unsigned DEFAULT_INDEX_BITS = 16;
+    /** Default number of free slots kept before one is reused. */
+    static const std::size_t DEFAULT_MIN_FREE = 1024;
+
+    /**
+     * Constructor.
+     * @param indexBits number of ID bits used for the slot index, the remaining
+     *        bits (less the sign bit) hold the generation.
+     * @param minFree number of free slots kept before one is reused.
+     */
+    explicit IDTable(unsigned indexBits = DEFAULT_INDEX_BITS, std::size_t minFree = DEFAULT_MIN_FREE) :
+        m_indexBits(indexBits < 1 ? 1 : (indexBits > 30 ? 30 : indexBits)),
+        m_indexMask((epicsUInt32(1) << m_indexBits) - 1),
+        m_maxGeneration((epicsUInt32(1) << (31 - m_indexBits)) - 1),
+        m_minFree(minFree),
+        m_slots(),
+        m_freeHead(NIL),
+        m_freeTail(NIL),
+        m_freeCount(0),
+        m_size(0)
+    {
+    }
+
+    /**
+     * Allocate an ID for a value.
+     * @param value value to store.
+     * @return new ID.
+     * @throws std::runtime_error if all IDs are in use.
+     */
+    pvAccessID insert(T const & value)
+    {
+        epicsUInt32 index;
+        if (m_freeCount > m_minFree || (m_freeCount && m_slots.size() > m_indexMask))
+        {
+            index = m_freeHead;
+            m_freeHead = m_slots[index].next;
+            if (m_freeHead == NIL)
+                m_freeTail = NIL;
+            m_freeCount--;
+        }
+        else if (m_slots.size() <= m_indexMask)
+        {
+            index = static_cast<epicsUInt32>(m_slots.size());
+            m_slots.push_back(Slot());
+        }
+        else
+        {
+            throw std::runtime_error("no free ID available");
+        }
+
+        Slot& slot = m_slots[index];
+        slot.value = value;
+        slot.used = true;
+        slot.next = NIL;
+        m_size++;
+        return static_cast<pvAccessID>((slot.generation << m_indexBits) | index);
+    }
+
+    /**
+     * Find a value.
+     * @param id ID.
+     * @return pointer to the value, <code>NULL</code> if the ID is not (or no longer) allocated.
+     *         Valid until the table is modified.
+     */
+    T* find(pvAccessID id)
+    {
+        Slot* slot = lookup(id);
+        return slot ? &slot->value : 0;
+    }
+
+    const T* find(pvAccessID id) const
+    {
+        const Slot* slot = const_cast<IDTable*>(this)->lookup(id);
+        return slot ? &slot->value : 0;
+    }
+
+    /**
+     * Release an ID, its value is reset to <code>T()</code>.
+     * @param id ID.
+     * @return <code>true</code> if the ID was allocated.
+     */
+    bool erase(pvAccessID id)
+    {
+        Slot* slot = lookup(id);
+        if (!slot)
+            return false;
+
+        const epicsUInt32 index = static_cast<epicsUInt32>(id) & m_indexMask;
+        slot->value = T();
+        slot->used = false;
+        slot->generation = (slot->generation >= m_maxGeneration) ? 1 : slot->generation + 1;
+        slot->next = NIL;
+
+        if (m_freeTail == NIL)
+            m_freeHead = index;
+        else
+            m_slots[m_freeTail].next = index;
+        m_freeTail = index;
+        m_freeCount++;
+        m_size--;
+        return true;
+    }
+
+    /**
+     * Copy all values (in slot order).
+     * @param values vector to which the values are appended.
+     */
+    void values(std::vector<T>& values) const
+    {
+        values.reserve(values.size() + m_size);
+        for (typename slots_t::const_iterator it = m_slots.begin(); it != m_slots.end(); it++)
+            if (it->used)
+                values.push_back(it->value);
+    }
+
+    /**
+     * Release all IDs.
+     */
+    void clear()
+    {
+        for (std::size_t i = 0; i < m_slots.size(); i++)
+            if (m_slots[i].used)
+                erase(static_cast<pvAccessID>((m_slots[i].generation << m_indexBits) | i));
+    }
+
+    /** Number of allocated IDs. */
+    std::size_t size() const {
+        return m_size;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    /** Number of slots, allocated or free. */
+    std::size_t capacity() const {
+        return m_slots.size();
+    }
+
+private:
+    static const epicsUInt32 NIL = 0xFFFFFFFFu;
+
+    struct Slot {
+        Slot() : value(), generation(1), next(NIL), used(false) {}
+        T value;
+        epicsUInt32 generation;
+        epicsUInt32 next;
+        bool used;
+    };
+    typedef std::vector<Slot> slots_t;
+
+    Slot* lookup(pvAccessID id)
+    {
+        const epicsUInt32 uid = static_cast<epicsUInt32>(id);
+        const epicsUInt32 index = uid & m_indexMask;
+        if (index >= m_slots.size())
+            return 0;
+        Slot& slot = m_slots[index];
+        return (slot.used && slot.generation == (uid >> m_indexBits)) ? &slot : 0;
+    }
+
+    const unsigned m_indexBits;
+    const epicsUInt32 m_indexMask;
+    const epicsUInt32 m_maxGeneration;
+    const std::size_t m_minFree;
+
+    slots_t m_slots;
+    epicsUInt32 m_freeHead;
+    epicsUInt32 m_freeTail;
+    std::size_t m_freeCount;
+    std::size_t m_size;
+};
+
+}
+}
+
+#endif  /* IDTABLE_H */
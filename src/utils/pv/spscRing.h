@@ -0,0 +1,180 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <vector>
+#include <cstddef>
+
+#ifdef epicsExportSharedSymbols
+#   define spscRingEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <epicsVersion.h>
+
+#ifdef EPICS_VERSION_INT
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,1,0)
+#include <epicsAtomic.h>
+#define PVA_SPSC_USE_ATOMIC
+#endif
+#endif
+
+#include <pv/lock.h>
+
+#ifdef spscRingEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef spscRingEpicsExportSharedSymbols
+#endif
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * size_t value read and written without a lock, the accesses are ordered
+ * with the other memory accesses of the threads (a mutex with Base < 3.15.1).
+ * A read-modify-write (e.g. <code>set(get() + 1)</code>) is only safe
+ * with a single writer thread.
+ */
+class AtomicSize
+{
+public:
+    explicit AtomicSize(std::size_t value = 0) : m_value(value) {}
+
+#ifdef PVA_SPSC_USE_ATOMIC
+    std::size_t get() const {
+        return epics::atomic::get(m_value);
+    }
+    void set(std::size_t value) {
+        epics::atomic::set(m_value, value);
+    }
+#else
+    std::size_t get() const {
+        epics::pvData::Lock guard(m_mutex);
+        return m_value;
+    }
+    void set(std::size_t value) {
+        epics::pvData::Lock guard(m_mutex);
+        m_value = value;
+    }
+#endif
+
+private:
+    AtomicSize(const AtomicSize&);
+    AtomicSize& operator=(const AtomicSize&);
+
+    std::size_t m_value;
+#ifndef PVA_SPSC_USE_ATOMIC
+    mutable epics::pvData::Mutex m_mutex;
+#endif
+};
+
+/**
+ * Bounded FIFO between one producer and one consumer thread.
+ *
+ * The slots are allocated up front, push() and pop() neither lock
+ * (with Base >= 3.15.1) nor allocate.
+ * Only one thread at a time may call push(), the same for pop().
+ */
+template<typename T>
+class SPSCRing
+{
+public:
+    /**
+     * Constructor.
+     * @param capacity number of elements, rounded up to a power of 2.
+     */
+    explicit SPSCRing(std::size_t capacity = 0) :
+        m_slots(), m_mask(0), m_head(), m_tail()
+    {
+        reset(capacity);
+    }
+
+    /**
+     * Drop the elements and change the capacity, not thread-safe.
+     * @param capacity number of elements, rounded up to a power of 2.
+     */
+    void reset(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        m_slots.assign(size, T());
+        m_mask = size - 1;
+        m_head.set(0);
+        m_tail.set(0);
+    }
+
+    /**
+     * Append an element, producer thread only.
+     * @return <code>false</code> if full.
+     */
+    bool push(T const & value)
+    {
+        const std::size_t tail = m_tail.get();
+        if (tail - m_head.get() > m_mask)
+            return false;
+        m_slots[tail & m_mask] = value;
+        m_tail.set(tail + 1);
+        return true;
+    }
+
+    /**
+     * Take the oldest element, consumer thread only.
+     * @return <code>false</code> if empty.
+     */
+    bool pop(T& value)
+    {
+        const std::size_t head = m_head.get();
+        if (head == m_tail.get())
+            return false;
+        // leaves the old value in the slot, no deallocation here
+        value = m_slots[head & m_mask];
+        m_head.set(head + 1);
+        return true;
+    }
+
+    /**
+     * Number of elements, exact only in the producer or consumer thread.
+     */
+    std::size_t size() const
+    {
+        const std::size_t head = m_head.get();
+        return m_tail.get() - head;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+private:
+    SPSCRing(const SPSCRing&);
+    SPSCRing& operator=(const SPSCRing&);
+
+    std::vector<T> m_slots;
+    std::size_t m_mask;
+
+    // consumer and producer positions, on separate cache lines
+    char m_pad0[64];
+    AtomicSize m_head;
+    char m_pad1[64];
+    AtomicSize m_tail;
+    char m_pad2[64];
+};
+
+}
+}
+
+#undef PVA_SPSC_USE_ATOMIC
+
+#endif  /* SPSCRING_H */
@@ -0,0 +1,230 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <string>
+#include <vector>
+
+#ifdef epicsExportSharedSymbols
+#   define timingWheelEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <epicsTime.h>
+
+#include <pv/pvType.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/timer.h>
+#include <pv/sharedPtr.h>
+
+#ifdef timingWheelEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef timingWheelEpicsExportSharedSymbols
+#endif
+
+#include <shareLib.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Hierarchical timing wheel (the data structure only, no thread, no locking).
+ *
+ * Time is counted in ticks.  Four levels of 256 slots cover 2^32 ticks,
+ * entries further in the future are parked in the last level and re-cascaded.
+ * An entry is put into the slot of the lowest level that covers its deadline,
+ * and is moved (cascaded) to a lower level when the wheel reaches its slot.
+ * add() and remove() are O(1), and each entry is cascaded at most once per level.
+ *
+ * Entries are intrusive, an entry must not be destroyed while it is linked.
+ */
+class epicsShareClass TimingWheelBase
+{
+public:
+    class epicsShareClass Entry
+    {
+    public:
+        Entry() : m_prev(0), m_next(0), m_deadline(0), m_period(0) {}
+
+        /** Check if the entry is in a wheel. */
+        bool linked() const {
+            return m_prev != 0;
+        }
+
+        /** Tick at which the entry expires. */
+        epics::pvData::uint64 deadline() const {
+            return m_deadline;
+        }
+
+    private:
+        Entry(const Entry&);
+        Entry& operator=(const Entry&);
+
+        friend class TimingWheelBase;
+        friend class TimingWheel;
+
+        Entry* m_prev;
+        Entry* m_next;
+        epics::pvData::uint64 m_deadline;
+        // used by TimingWheel
+        epics::pvData::uint64 m_period;
+        epics::pvData::TimerCallbackPtr m_callback;
+    };
+
+    TimingWheelBase();
+
+    /**
+     * Add an entry.
+     * @param entry entry, must not be linked.
+     * @param deadline tick at which the entry expires,
+     *        a deadline not after the current tick expires on the next tick.
+     */
+    void add(Entry& entry, epics::pvData::uint64 deadline);
+
+    /**
+     * Remove an entry.
+     * @param entry entry.
+     * @return <code>false</code> if the entry was not linked.
+     */
+    bool remove(Entry& entry);
+
+    /**
+     * Move the wheel forward.
+     * @param now current tick.
+     * @param expired entries which expired, in order of their deadlines, are appended (and unlinked).
+     */
+    void advance(epics::pvData::uint64 now, std::vector<Entry*>& expired);
+
+    /**
+     * Remove all the entries.
+     * @param removed removed entries are appended.
+     */
+    void clear(std::vector<Entry*>& removed);
+
+    /**
+     * Earliest tick at which advance() has something to do.
+     * @param tick set to the tick, an entry expires at this tick or is cascaded.
+     * @return <code>false</code> if the wheel is empty.
+     */
+    bool nextTick(epics::pvData::uint64& tick) const;
+
+    /** Last tick the wheel was advanced to. */
+    epics::pvData::uint64 current() const {
+        return m_current;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+private:
+    TimingWheelBase(const TimingWheelBase&);
+    TimingWheelBase& operator=(const TimingWheelBase&);
+
+    enum { LEVEL_BITS = 8, SLOTS = 1 << LEVEL_BITS, LEVELS = 4 };
+
+    void link(Entry& entry);
+    static void unlink(Entry& entry);
+    void cascade(unsigned level, unsigned slot);
+
+    // slot heads, circular lists
+    Entry m_slots[LEVELS][SLOTS];
+    epics::pvData::uint64 m_current;
+    std::size_t m_size;
+};
+
+/**
+ * Timer based on a TimingWheelBase with its own thread.
+ *
+ * An alternative to epics::pvData::Timer for many entries (thousands of channels,
+ * transports or requests), scheduling and cancellation are O(1).
+ * Callbacks are called with a resolution of one tick.
+ *
+ * Unlike epics::pvData::Timer the caller provides the (intrusive) entry,
+ * typically a member of the callback object.  The wheel keeps a reference to
+ * the callback while it is scheduled, which also keeps such an entry alive.
+ */
+class epicsShareClass TimingWheel
+{
+public:
+    POINTER_DEFINITIONS(TimingWheel);
+
+    typedef TimingWheelBase::Entry Entry;
+
+    static const double DEFAULT_TICK;
+
+    /**
+     * Constructor, starts the thread.
+     * @param threadName name of the thread.
+     * @param priority priority of the thread.
+     * @param tick tick period in seconds.
+     */
+    TimingWheel(std::string const & threadName, unsigned int priority, double tick = DEFAULT_TICK);
+    ~TimingWheel();
+
+    /**
+     * Schedule a callback, an already scheduled entry is rescheduled.
+     * @param entry entry.
+     * @param callback callback.
+     * @param delay delay in seconds.
+     * @param period period in seconds, <code>0</code> for a one-shot callback.
+     */
+    void schedule(Entry& entry, epics::pvData::TimerCallbackPtr const & callback,
+                  double delay, double period = 0.0);
+
+    /**
+     * Cancel a scheduled callback, timerStopped() is not called.
+     * A callback already being called is not waited for.
+     * @param entry entry.
+     * @return <code>false</code> if the entry was not scheduled.
+     */
+    bool cancel(Entry& entry);
+
+    bool isScheduled(Entry const & entry) const;
+
+    /** Number of scheduled entries. */
+    std::size_t size() const;
+
+    double getTick() const {
+        return m_tick;
+    }
+
+    /**
+     * Stop the thread, timerStopped() is called for all scheduled entries.
+     * Entries scheduled after close() are stopped immediately.
+     */
+    void close();
+
+private:
+    TimingWheel(const TimingWheel&);
+    TimingWheel& operator=(const TimingWheel&);
+
+    void run();
+    double elapsed() const;
+    epics::pvData::uint64 currentTick() const;
+    epics::pvData::uint64 toTicks(double seconds) const;
+
+    const double m_tick;
+    const epicsTime m_start;
+
+    mutable epics::pvData::Mutex m_mutex;
+    TimingWheelBase m_wheel;
+    std::vector<Entry*> m_expired;
+    epics::pvData::uint64 m_wakeTick;
+    bool m_alive;
+    epics::pvData::Event m_wakeup;
+
+    epics::pvData::Thread m_thread;
+};
+
+}
+}
+
+#endif  /* TIMINGWHEEL_H */
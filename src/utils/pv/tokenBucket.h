@@ -0,0 +1,160 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#ifdef epicsExportSharedSymbols
+#   define tokenBucketEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <epicsVersion.h>
+#include <epicsTime.h>
+
+#ifdef EPICS_VERSION_INT
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,5,0)
+#define PVA_TOKENBUCKET_USE_MONOTONIC
+#endif
+#endif
+
+#ifdef tokenBucketEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef tokenBucketEpicsExportSharedSymbols
+#endif
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Token bucket rate limiter.
+ *
+ * Tokens are added at a fixed rate, up to the bucket size (burst).
+ * Each permitted event takes one token.  A new bucket is full.
+ *
+ * Time is passed in by the caller (in seconds), which keeps the class
+ * independent of the clock used and easy to test.  Callers use now().
+ * Not thread-safe, callers provide locking.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * Constructor.
+     * @param rate tokens added per second, <code>0</code> (or less) for unlimited.
+     * @param burst bucket size, at least one token.
+     */
+    explicit TokenBucket(double rate = 0.0, double burst = 1.0) :
+        m_rate(rate),
+        m_burst(burst < 1.0 ? 1.0 : burst),
+        m_tokens(m_burst),
+        m_last(0.0),
+        m_started(false)
+    {
+    }
+
+    /**
+     * Current time for the bucket methods, in seconds.
+     * A monotonic clock, not affected by the system time being set.
+     * With Base older than 3.15.5 this falls back to the wall clock.
+     * @return seconds since an arbitrary origin.
+     */
+    static double now()
+    {
+#ifdef PVA_TOKENBUCKET_USE_MONOTONIC
+        return epicsMonotonicGet() * 1e-9;
+#else
+        epicsTimeStamp ts;
+        epicsTimeGetCurrent(&ts);
+        return ts.secPastEpoch + ts.nsec * 1e-9;
+#endif
+    }
+
+    bool unlimited() const {
+        return m_rate <= 0.0;
+    }
+
+    /**
+     * Take a token, if one is available.
+     * @param now current time in seconds.
+     * @return <code>true</code> if the event is permitted.
+     */
+    bool tryAcquire(double now)
+    {
+        if (unlimited())
+            return true;
+
+        refill(now);
+        if (m_tokens < 1.0)
+            return false;
+        m_tokens -= 1.0;
+        return true;
+    }
+
+    /**
+     * Time until a token will be available.
+     * @param now current time in seconds.
+     * @return delay in seconds, <code>0</code> if a token is available now.
+     */
+    double delay(double now)
+    {
+        if (unlimited())
+            return 0.0;
+
+        refill(now);
+        return (m_tokens >= 1.0) ? 0.0 : (1.0 - m_tokens) / m_rate;
+    }
+
+    /**
+     * Check if the bucket has been refilled completely,
+     * i.e. it is in the same state as a new one and can be discarded.
+     * @param now current time in seconds.
+     */
+    bool full(double now)
+    {
+        if (unlimited())
+            return true;
+
+        refill(now);
+        return m_tokens >= m_burst;
+    }
+
+private:
+    void refill(double now)
+    {
+        if (!m_started)
+        {
+            m_started = true;
+            m_last = now;
+            return;
+        }
+
+        // a clock going backwards (wall clock fallback) adds no tokens,
+        // refilling continues from the new time
+        double elapsed = now - m_last;
+        if (elapsed <= 0.0)
+        {
+            m_last = now;
+            return;
+        }
+
+        m_last = now;
+        m_tokens += elapsed * m_rate;
+        if (m_tokens > m_burst)
+            m_tokens = m_burst;
+    }
+
+    double m_rate;
+    double m_burst;
+    double m_tokens;
+    double m_last;
+    bool m_started;
+};
+
+}
+}
+
+#endif  /* TOKENBUCKET_H */
@@ -12,6 +12,10 @@
 #ifndef WILDCARD_H
 #define WILDCARD_H
 
+#include <string>
+#include <vector>
+#include <map>
+
 #include <shareLib.h>
 
 namespace epics {
@@ -36,9 +40,95 @@ public:
     static int wildcardfit (const char *wildcard, const char *test);
 };
 
+/**
+ * Matches a string against a set of wildcard patterns at once,
+ * with the same semantics as Wildcard::wildcardfit().
+ *
+ * The patterns are compiled into a single automaton, which is determinized
+ * lazily while matching, so the cost of a match depends on the length of
+ * the string, not on the number of patterns.  Strings which can not match
+ * any pattern are rejected at the first character which rules them out.
+ *
+ * Not thread-safe, match() updates the automaton.
+ */
+class epicsShareClass WildcardMatcher
+{
+public:
+    WildcardMatcher();
+
+    /**
+     * Append a pattern.
+     * @param pattern wildcard pattern.
+     * @return the index of the pattern.
+     */
+    std::size_t add(std::string const & pattern);
+
+    /**
+     * Remove a pattern, the following ones move down by one.
+     * @param index index of the pattern.
+     */
+    void remove(std::size_t index);
+
+    void clear();
+
+    std::size_t size() const {
+        return m_patterns.size();
+    }
+
+    /**
+     * Find the first pattern matching a string.
+     * @param test string to test.
+     * @return index of the first matching pattern, -1 if none matches.
+     */
+    int match(const char *test);
+
+    /**
+     * Number of automaton states built so far.
+     */
+    std::size_t getStateCount() const {
+        return m_states.size();
+    }
+
+private:
+    // pattern tokens, a character or one of these
+    enum { ANY_ONE = -1, ANY_SEQUENCE = -2, END = -3 };
+
+    typedef std::vector<int> NFAStates;
+
+    struct State
+    {
+        NFAStates nfa;
+        // next state by character class, -1 if not built yet
+        std::vector<int> next;
+        // first matching pattern, -1 if none
+        int accept;
+    };
+
+    void compile();
+    void reset();
+    void closure(NFAStates& states) const;
+    int intern(NFAStates& states);
+    int step(int state, unsigned char c);
+
+    std::vector<std::string> m_patterns;
+    bool m_compiled;
+
+    // positions of all the patterns, flattened
+    std::vector<int> m_tokens;
+    std::vector<int> m_owner;
+    NFAStates m_initial;
+
+    // characters which appear in no pattern form class 0
+    unsigned char m_class[256];
+    std::size_t m_classCount;
+
+    std::vector<State> m_states;
+    std::map<NFAStates, int> m_index;
+    int m_start;
+};
+
 }
 }
 
 
 #endif
-
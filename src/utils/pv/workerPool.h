@@ -0,0 +1,160 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <ostream>
+
+#ifdef epicsExportSharedSymbols
+#   define workerPoolEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <epicsTime.h>
+
+#include <pv/pvType.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/sharedPtr.h>
+
+#ifdef workerPoolEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef workerPoolEpicsExportSharedSymbols
+#endif
+
+#include <shareLib.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Bounded pool of worker threads.
+ *
+ * Tasks are submitted with a key, tasks with the same key are run one at a time
+ * in the order of submission (e.g. all operations of a channel), tasks with
+ * different keys run in parallel.  Keys with queued tasks are served round-robin.
+ *
+ * The number of queued tasks is bounded, submit() blocks while the queue is full.
+ * A task must therefore not submit to its own pool.
+ */
+class epicsShareClass WorkerPool
+{
+public:
+    POINTER_DEFINITIONS(WorkerPool);
+
+    class epicsShareClass Task
+    {
+    public:
+        POINTER_DEFINITIONS(Task);
+        virtual ~Task() {}
+
+        /** Called on a worker thread, exceptions are logged. */
+        virtual void run() = 0;
+    };
+
+    struct Stats
+    {
+        std::size_t threads;
+        std::size_t capacity;
+        /** Currently queued (not running) tasks. */
+        std::size_t queued;
+        /** Highest number of queued tasks. */
+        std::size_t maxQueued;
+        epics::pvData::uint64 executed;
+        /** Number of submit() calls which had to wait for a free slot. */
+        epics::pvData::uint64 blocked;
+        /** Time from submit() to the start of run(), in seconds. */
+        double totalLatency;
+        double maxLatency;
+        /** Duration of run(), in seconds. */
+        double totalRunTime;
+        double maxRunTime;
+    };
+
+    /**
+     * Constructor, starts the threads.
+     * @param name name of the threads (a number is appended).
+     * @param threads number of threads, at least 1.
+     * @param capacity maximal number of queued tasks, at least 1.
+     * @param priority priority of the threads.
+     */
+    WorkerPool(std::string const & name, std::size_t threads, std::size_t capacity, unsigned int priority);
+    ~WorkerPool();
+
+    /**
+     * Queue a task, waits while the queue is full.
+     * @param key tasks with the same key are run in order, one at a time.
+     * @param task task.
+     * @return <code>false</code> if the pool is closed, the task was not queued.
+     */
+    bool submit(const void* key, Task::shared_pointer const & task);
+
+    /**
+     * Queue a task if there is a free slot, does not wait.
+     * @param key tasks with the same key are run in order, one at a time.
+     * @param task task.
+     * @return <code>false</code> if the queue is full or the pool is closed, the task was not queued.
+     */
+    bool trySubmit(const void* key, Task::shared_pointer const & task);
+
+    /**
+     * Stop accepting tasks, run the already queued ones and join the threads.
+     */
+    void close();
+
+    void getStats(Stats& stats) const;
+
+    void printInfo(std::ostream& out) const;
+
+private:
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+
+    void run();
+    void enqueue(const void* key, Task::shared_pointer const & task);
+
+    struct Item
+    {
+        Task::shared_pointer task;
+        epicsTime queued;
+    };
+
+    struct Strand
+    {
+        Strand() : running(false) {}
+        std::deque<Item> items;
+        bool running;
+    };
+
+    typedef std::map<const void*, Strand> strands_t;
+
+    const std::size_t m_capacity;
+
+    mutable epics::pvData::Mutex m_mutex;
+    strands_t m_strands;
+    // keys with queued tasks and no running task
+    std::deque<const void*> m_ready;
+    std::size_t m_queued;
+    std::size_t m_waiting;
+    bool m_alive;
+    epics::pvData::Event m_work;
+    epics::pvData::Event m_space;
+
+    Stats m_stats;
+
+    std::vector<std::tr1::shared_ptr<epics::pvData::Thread> > m_threads;
+};
+
+}
+}
+
+#endif  /* WORKERPOOL_H */
@@ -0,0 +1,385 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdexcept>
+
+#define epicsExportSharedSymbols
+#include <pv/timingWheel.h>
+#include <pv/logger.h>
+
+using namespace epics::pvData;
+
+namespace epics {
+namespace pvAccess {
+
+TimingWheelBase::TimingWheelBase() :
+    m_current(0),
+    m_size(0)
+{
+    for (unsigned level = 0; level < LEVELS; level++)
+        for (unsigned slot = 0; slot < SLOTS; slot++)
+            m_slots[level][slot].m_prev = m_slots[level][slot].m_next = &m_slots[level][slot];
+}
+
+void TimingWheelBase::add(Entry& entry, uint64 deadline)
+{
+    if (entry.linked())
+        throw std::logic_error("timing wheel entry already linked");
+
+    entry.m_deadline = (deadline > m_current) ? deadline : m_current + 1;
+    link(entry);
+    m_size++;
+}
+
+bool TimingWheelBase::remove(Entry& entry)
+{
+    if (!entry.linked())
+        return false;
+
+    unlink(entry);
+    m_size--;
+    return true;
+}
+
+void TimingWheelBase::link(Entry& entry)
+{
+    // deadline >= m_current, only equal while cascading
+    const uint64 delta = entry.m_deadline - m_current;
+    uint64 slotTick = entry.m_deadline;
+
+    unsigned level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64(1) << (LEVEL_BITS * (level + 1))))
+        level++;
+
+    // beyond the range of the wheel, park and cascade again later
+    const uint64 range = uint64(1) << (LEVEL_BITS * LEVELS);
+    if (delta >= range)
+        slotTick = m_current + range - 1;
+
+    Entry& head = m_slots[level][(slotTick >> (LEVEL_BITS * level)) & (SLOTS - 1)];
+    entry.m_next = &head;
+    entry.m_prev = head.m_prev;
+    head.m_prev->m_next = &entry;
+    head.m_prev = &entry;
+}
+
+void TimingWheelBase::unlink(Entry& entry)
+{
+    entry.m_prev->m_next = entry.m_next;
+    entry.m_next->m_prev = entry.m_prev;
+    entry.m_prev = entry.m_next = 0;
+}
+
+void TimingWheelBase::cascade(unsigned level, unsigned slot)
+{
+    Entry& head = m_slots[level][slot];
+    while (head.m_next != &head)
+    {
+        Entry* entry = head.m_next;
+        unlink(*entry);
+        link(*entry);
+    }
+}
+
+void TimingWheelBase::advance(uint64 now, std::vector<Entry*>& expired)
+{
+    while (m_current < now)
+    {
+        // skip ticks with nothing to do
+        if (now - m_current > SLOTS)
+        {
+            uint64 next;
+            if (!nextTick(next) || next > now)
+            {
+                m_current = now;
+                break;
+            }
+            m_current = next - 1;
+        }
+
+        const uint64 tick = ++m_current;
+
+        // cascade the higher levels whose slot starts at this tick
+        for (unsigned level = 1; level < LEVELS; level++)
+        {
+            if (tick & ((uint64(1) << (LEVEL_BITS * level)) - 1))
+                break;
+            cascade(level, (tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+        }
+
+        Entry& head = m_slots[0][tick & (SLOTS - 1)];
+        while (head.m_next != &head)
+        {
+            Entry* entry = head.m_next;
+            unlink(*entry);
+            m_size--;
+            expired.push_back(entry);
+        }
+    }
+}
+
+void TimingWheelBase::clear(std::vector<Entry*>& removed)
+{
+    for (unsigned level = 0; level < LEVELS; level++)
+    {
+        for (unsigned slot = 0; slot < SLOTS; slot++)
+        {
+            Entry& head = m_slots[level][slot];
+            while (head.m_next != &head)
+            {
+                Entry* entry = head.m_next;
+                unlink(*entry);
+                removed.push_back(entry);
+            }
+        }
+    }
+    m_size = 0;
+}
+
+bool TimingWheelBase::nextTick(uint64& tick) const
+{
+    if (m_size == 0)
+        return false;
+
+    bool found = false;
+    for (unsigned level = 0; level < LEVELS; level++)
+    {
+        const unsigned shift = LEVEL_BITS * level;
+        const uint64 base = m_current >> shift;
+        // the current slot of a level is visited again after a full turn
+        for (unsigned i = 1; i <= SLOTS; i++)
+        {
+            const Entry& head = m_slots[level][(base + i) & (SLOTS - 1)];
+            if (head.m_next != &head)
+            {
+                const uint64 candidate = (base + i) << shift;
+                if (!found || candidate < tick)
+                    tick = candidate;
+                found = true;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+
+const double TimingWheel::DEFAULT_TICK = 0.01;
+
+TimingWheel::TimingWheel(std::string const & threadName, unsigned int priority, double tick) :
+    m_tick(tick > 0.0 ? tick : DEFAULT_TICK),
+    m_start(epicsTime::getCurrent()),
+    m_mutex(),
+    m_wheel(),
+    m_expired(),
+    m_wakeTick(0),
+    m_alive(true),
+    m_wakeup(),
+    m_thread(Thread::Config(this, &TimingWheel::run)
+             .prio(priority)
+             .name(threadName)
+             .autostart(false))
+{
+    m_thread.start();
+}
+
+TimingWheel::~TimingWheel()
+{
+    close();
+}
+
+double TimingWheel::elapsed() const
+{
+    double elapsed = epicsTime::getCurrent() - m_start;
+    // ignore clock going backwards
+    return (elapsed > 0.0) ? elapsed : 0.0;
+}
+
+uint64 TimingWheel::currentTick() const
+{
+    return static_cast<uint64>(elapsed() / m_tick);
+}
+
+uint64 TimingWheel::toTicks(double seconds) const
+{
+    // round up, never expire early
+    if (seconds <= 0.0)
+        return 0;
+    uint64 ticks = static_cast<uint64>(seconds / m_tick);
+    if (ticks * m_tick < seconds)
+        ticks++;
+    return ticks;
+}
+
+void TimingWheel::schedule(Entry& entry, TimerCallbackPtr const & callback, double delay, double period)
+{
+    {
+        Lock guard(m_mutex);
+        if (m_alive)
+        {
+            m_wheel.remove(entry);
+
+            // count from the actual time, the wheel may be behind while idle
+            uint64 now = currentTick();
+            if (now < m_wheel.current())
+                now = m_wheel.current();
+
+            entry.m_callback = callback;
+            entry.m_period = (period > 0.0) ? toTicks(period) : 0;
+            if (period > 0.0 && entry.m_period == 0)
+                entry.m_period = 1;
+            m_wheel.add(entry, now + toTicks(delay));
+
+            if (entry.m_deadline < m_wakeTick)
+            {
+                m_wakeTick = entry.m_deadline;
+                m_wakeup.signal();
+            }
+            return;
+        }
+    }
+
+    callback->timerStopped();
+}
+
+bool TimingWheel::cancel(Entry& entry)
+{
+    TimerCallbackPtr callback;
+    {
+        Lock guard(m_mutex);
+        if (!m_wheel.remove(entry))
+            return false;
+        // release outside of the lock
+        callback.swap(entry.m_callback);
+    }
+    return true;
+}
+
+bool TimingWheel::isScheduled(Entry const & entry) const
+{
+    Lock guard(m_mutex);
+    return entry.linked();
+}
+
+std::size_t TimingWheel::size() const
+{
+    Lock guard(m_mutex);
+    return m_wheel.size();
+}
+
+void TimingWheel::close()
+{
+    {
+        Lock guard(m_mutex);
+        if (!m_alive)
+            return;
+        m_alive = false;
+    }
+    m_wakeup.signal();
+    m_thread.exitWait();
+
+    // stop all the entries, nothing can be added any more
+    std::vector<TimerCallbackPtr> stopped;
+    {
+        Lock guard(m_mutex);
+        std::vector<Entry*> entries;
+        m_wheel.clear(entries);
+        stopped.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            stopped.push_back(TimerCallbackPtr());
+            stopped.back().swap(entries[i]->m_callback);
+        }
+    }
+
+    for (size_t i = 0; i < stopped.size(); i++)
+    {
+        try {
+            stopped[i]->timerStopped();
+        } catch (std::exception& e) {
+            LOG(logLevelError, "Unhandled exception caught from timerStopped(): %s", e.what());
+        }
+    }
+}
+
+void TimingWheel::run()
+{
+    std::vector<TimerCallbackPtr> callbacks;
+
+    while (true)
+    {
+        double wait = -1.0;
+        {
+            Lock guard(m_mutex);
+            if (!m_alive)
+                break;
+
+            const double time = elapsed();
+            const uint64 now = static_cast<uint64>(time / m_tick);
+            m_wheel.advance(now, m_expired);
+            for (size_t i = 0; i < m_expired.size(); i++)
+            {
+                Entry* entry = m_expired[i];
+                if (entry->m_period)
+                {
+                    callbacks.push_back(entry->m_callback);
+                    // keep the phase, but skip periods missed while late
+                    uint64 deadline = entry->m_deadline + entry->m_period;
+                    if (deadline <= now)
+                        deadline = now + entry->m_period - (now - entry->m_deadline) % entry->m_period;
+                    m_wheel.add(*entry, deadline);
+                }
+                else
+                {
+                    callbacks.push_back(TimerCallbackPtr());
+                    callbacks.back().swap(entry->m_callback);
+                }
+            }
+            m_expired.clear();
+
+            uint64 next;
+            if (m_wheel.nextTick(next))
+            {
+                m_wakeTick = next;
+                if (callbacks.empty())
+                {
+                    wait = next * m_tick - time;
+                    if (wait < 0.0)
+                        wait = 0.0;
+                }
+            }
+            else
+            {
+                m_wakeTick = ~uint64(0);
+            }
+        }
+
+        if (!callbacks.empty())
+        {
+            for (size_t i = 0; i < callbacks.size(); i++)
+            {
+                try {
+                    callbacks[i]->callback();
+                } catch (std::exception& e) {
+                    LOG(logLevelError, "Unhandled exception caught from timer callback: %s", e.what());
+                } catch (...) {
+                    LOG(logLevelError, "Unhandled exception caught from timer callback.");
+                }
+            }
+            callbacks.clear();
+            // check again, time has passed
+            continue;
+        }
+
+        if (wait < 0.0)
+            m_wakeup.wait();
+        else
+            m_wakeup.wait(wait);
+    }
+}
+
+}
+}
@@ -4,6 +4,8 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
+
 #include <epicsString.h>
 
 #define epicsExportSharedSymbols
@@ -16,3 +18,191 @@ Wildcard::wildcardfit (const char *wildcard, const char *test)
 {
     return epicsStrGlobMatch(test, wildcard);
 }
+
+namespace {
+// bound of the lazily built automaton, it is rebuilt from scratch when exceeded
+const std::size_t maxStates = 4096;
+}
+
+WildcardMatcher::WildcardMatcher() :
+    m_patterns(),
+    m_compiled(false),
+    m_tokens(),
+    m_owner(),
+    m_initial(),
+    m_classCount(1),
+    m_states(),
+    m_index(),
+    m_start(-1)
+{
+}
+
+std::size_t
+WildcardMatcher::add(std::string const & pattern)
+{
+    m_patterns.push_back(pattern);
+    m_compiled = false;
+    return m_patterns.size() - 1;
+}
+
+void
+WildcardMatcher::remove(std::size_t index)
+{
+    if (index >= m_patterns.size())
+        return;
+    m_patterns.erase(m_patterns.begin() + index);
+    m_compiled = false;
+}
+
+void
+WildcardMatcher::clear()
+{
+    m_patterns.clear();
+    m_compiled = false;
+}
+
+void
+WildcardMatcher::compile()
+{
+    m_tokens.clear();
+    m_owner.clear();
+    m_initial.clear();
+
+    for (std::size_t i = 0; i < 256; i++)
+        m_class[i] = 0;
+    m_classCount = 1;
+
+    for (std::size_t k = 0; k < m_patterns.size(); k++)
+    {
+        m_initial.push_back(int(m_tokens.size()));
+
+        const std::string& pattern = m_patterns[k];
+        for (std::size_t i = 0; i < pattern.size(); i++)
+        {
+            const unsigned char c = static_cast<unsigned char>(pattern[i]);
+            int token;
+            if (c == '*')
+            {
+                // consecutive '*' are the same as one
+                if (!m_tokens.empty() && m_owner.back() == int(k) && m_tokens.back() == ANY_SEQUENCE)
+                    continue;
+                token = ANY_SEQUENCE;
+            }
+            else if (c == '?')
+                token = ANY_ONE;
+            else
+            {
+                token = c;
+                if (!m_class[c])
+                    m_class[c] = static_cast<unsigned char>(m_classCount++);
+            }
+            m_tokens.push_back(token);
+            m_owner.push_back(int(k));
+        }
+
+        m_tokens.push_back(END);
+        m_owner.push_back(int(k));
+    }
+
+    m_compiled = true;
+    reset();
+}
+
+void
+WildcardMatcher::reset()
+{
+    m_states.clear();
+    m_index.clear();
+
+    NFAStates initial(m_initial);
+    closure(initial);
+    m_start = intern(initial);
+}
+
+void
+WildcardMatcher::closure(NFAStates& states) const
+{
+    // '*' also matches the empty sequence
+    const std::size_t count = states.size();
+    for (std::size_t i = 0; i < count; i++)
+        if (m_tokens[states[i]] == ANY_SEQUENCE)
+            states.push_back(states[i] + 1);
+
+    std::sort(states.begin(), states.end());
+    states.erase(std::unique(states.begin(), states.end()), states.end());
+}
+
+int
+WildcardMatcher::intern(NFAStates& states)
+{
+    std::map<NFAStates, int>::const_iterator it = m_index.find(states);
+    if (it != m_index.end())
+        return it->second;
+
+    const int index = int(m_states.size());
+    m_states.push_back(State());
+    State& state = m_states.back();
+    state.nfa.swap(states);
+    state.next.resize(m_classCount, -1);
+    state.accept = -1;
+    for (std::size_t i = 0; i < state.nfa.size(); i++)
+    {
+        const int s = state.nfa[i];
+        if (m_tokens[s] == END && (state.accept < 0 || m_owner[s] < state.accept))
+            state.accept = m_owner[s];
+    }
+
+    m_index[state.nfa] = index;
+    return index;
+}
+
+int
+WildcardMatcher::step(int state, unsigned char c)
+{
+    const unsigned char cls = m_class[c];
+    int next = m_states[state].next[cls];
+    if (next >= 0)
+        return next;
+
+    NFAStates target;
+    const NFAStates& nfa = m_states[state].nfa;
+    for (std::size_t i = 0; i < nfa.size(); i++)
+    {
+        const int s = nfa[i];
+        const int token = m_tokens[s];
+        if (token == ANY_SEQUENCE)
+            target.push_back(s);
+        else if (token == ANY_ONE || (cls && token >= 0 && m_class[token] == cls))
+            target.push_back(s + 1);
+    }
+    closure(target);
+
+    if (m_states.size() >= maxStates)
+    {
+        reset();
+        return intern(target);
+    }
+
+    next = intern(target);
+    m_states[state].next[cls] = next;
+    return next;
+}
+
+int
+WildcardMatcher::match(const char *test)
+{
+    if (m_patterns.empty())
+        return -1;
+    if (!m_compiled)
+        compile();
+
+    int state = m_start;
+    for (const char* p = test; *p; p++)
+    {
+        state = step(state, static_cast<unsigned char>(*p));
+        // no pattern can match any more
+        if (m_states[state].nfa.empty())
+            return -1;
+    }
+    return m_states[state].accept;
+}
@@ -0,0 +1,232 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <sstream>
+
+#define epicsExportSharedSymbols
+#include <pv/workerPool.h>
+#include <pv/logger.h>
+
+using namespace epics::pvData;
+
+namespace epics {
+namespace pvAccess {
+
+WorkerPool::WorkerPool(std::string const & name, std::size_t threads, std::size_t capacity, unsigned int priority) :
+    m_capacity(capacity > 0 ? capacity : 1),
+    m_mutex(),
+    m_strands(),
+    m_ready(),
+    m_queued(0),
+    m_waiting(0),
+    m_alive(true),
+    m_work(),
+    m_space(),
+    m_stats(),
+    m_threads()
+{
+    if (threads == 0)
+        threads = 1;
+
+    m_stats.threads = threads;
+    m_stats.capacity = m_capacity;
+    m_stats.queued = m_stats.maxQueued = 0;
+    m_stats.executed = m_stats.blocked = 0;
+    m_stats.totalLatency = m_stats.maxLatency = 0.0;
+    m_stats.totalRunTime = m_stats.maxRunTime = 0.0;
+
+    m_threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        std::ostringstream threadName;
+        threadName << name << ' ' << i;
+        std::tr1::shared_ptr<Thread> thread(new Thread(Thread::Config(this, &WorkerPool::run)
+                                            .prio(priority)
+                                            .name(threadName.str())
+                                            .autostart(false)));
+        m_threads.push_back(thread);
+        thread->start();
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    close();
+}
+
+bool WorkerPool::submit(const void* key, Task::shared_pointer const & task)
+{
+    Lock guard(m_mutex);
+
+    if (m_alive && m_queued >= m_capacity)
+    {
+        m_stats.blocked++;
+        m_waiting++;
+        while (m_alive && m_queued >= m_capacity)
+        {
+            guard.unlock();
+            m_space.wait();
+            guard.lock();
+        }
+        m_waiting--;
+    }
+
+    if (!m_alive)
+    {
+        // let other waiting submitters see it too
+        if (m_waiting)
+            m_space.signal();
+        return false;
+    }
+
+    enqueue(key, task);
+    return true;
+}
+
+bool WorkerPool::trySubmit(const void* key, Task::shared_pointer const & task)
+{
+    Lock guard(m_mutex);
+
+    if (!m_alive || m_queued >= m_capacity)
+        return false;
+
+    enqueue(key, task);
+    return true;
+}
+
+// called with m_mutex locked, the queue not full
+void WorkerPool::enqueue(const void* key, Task::shared_pointer const & task)
+{
+    Strand& strand = m_strands[key];
+    strand.items.push_back(Item());
+    strand.items.back().task = task;
+    strand.items.back().queued = epicsTime::getCurrent();
+
+    if (++m_queued > m_stats.maxQueued)
+        m_stats.maxQueued = m_queued;
+
+    if (!strand.running && strand.items.size() == 1)
+    {
+        m_ready.push_back(key);
+        m_work.signal();
+    }
+
+    // events do not count, pass on a free slot
+    if (m_waiting && m_queued < m_capacity)
+        m_space.signal();
+}
+
+void WorkerPool::run()
+{
+    Lock guard(m_mutex);
+
+    while (true)
+    {
+        if (m_ready.empty())
+        {
+            if (!m_alive)
+                break;
+
+            guard.unlock();
+            m_work.wait();
+            guard.lock();
+            continue;
+        }
+
+        const void* key = m_ready.front();
+        m_ready.pop_front();
+
+        // wake up another worker if there is more to do
+        if (!m_ready.empty())
+            m_work.signal();
+
+        strands_t::iterator it = m_strands.find(key);
+        Item item(it->second.items.front());
+        it->second.items.pop_front();
+        it->second.running = true;
+        m_queued--;
+
+        if (m_waiting)
+            m_space.signal();
+
+        guard.unlock();
+
+        const epicsTime start(epicsTime::getCurrent());
+        try {
+            item.task->run();
+        } catch (std::exception& e) {
+            LOG(logLevelError, "Unhandled exception caught from worker task: %s", e.what());
+        } catch (...) {
+            LOG(logLevelError, "Unhandled exception caught from worker task.");
+        }
+        const epicsTime end(epicsTime::getCurrent());
+        // release outside of the lock
+        item.task.reset();
+
+        guard.lock();
+
+        const double latency = start - item.queued;
+        const double runTime = end - start;
+        m_stats.executed++;
+        m_stats.totalLatency += latency;
+        if (latency > m_stats.maxLatency)
+            m_stats.maxLatency = latency;
+        m_stats.totalRunTime += runTime;
+        if (runTime > m_stats.maxRunTime)
+            m_stats.maxRunTime = runTime;
+
+        // iterators of a map stay valid, only this thread removes the running strand
+        it->second.running = false;
+        if (it->second.items.empty())
+            m_strands.erase(it);
+        else
+            m_ready.push_back(key);
+    }
+
+    // let the next worker exit
+    m_work.signal();
+}
+
+void WorkerPool::close()
+{
+    {
+        Lock guard(m_mutex);
+        if (!m_alive)
+            return;
+        m_alive = false;
+    }
+    m_work.signal();
+    m_space.signal();
+
+    for (std::size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i]->exitWait();
+}
+
+void WorkerPool::getStats(Stats& stats) const
+{
+    Lock guard(m_mutex);
+    stats = m_stats;
+    stats.queued = m_queued;
+}
+
+void WorkerPool::printInfo(std::ostream& out) const
+{
+    Stats stats;
+    getStats(stats);
+
+    const double executed = stats.executed ? double(stats.executed) : 1.0;
+    out << "WORKER_THREADS : " << stats.threads << std::endl
+        << "WORKER_QUEUE : " << stats.queued << " (max " << stats.maxQueued
+        << ", capacity " << stats.capacity << ")" << std::endl
+        << "WORKER_EXECUTED : " << stats.executed << " (blocked submits " << stats.blocked << ")" << std::endl
+        << "WORKER_LATENCY : avg " << stats.totalLatency / executed
+        << " s, max " << stats.maxLatency << " s" << std::endl
+        << "WORKER_RUN_TIME : avg " << stats.totalRunTime / executed
+        << " s, max " << stats.maxRunTime << " s" << std::endl;
+}
+
+}
+}
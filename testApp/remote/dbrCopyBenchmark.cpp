@@ -0,0 +1,145 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * Throughput of the DBR to pvData array copy of the ca provider (copyDBRArray()),
+ * compared with the former reuse()/resize()/copy sequence and with memcpy,
+ * for large waveforms.  "held" means the consumer keeps a reference to the
+ * previous array (e.g. a monitor element not yet sent), "free" that it does not.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/pvData.h>
+
+#include <dbrCopy.h>
+
+using namespace std;
+using namespace epics::pvData;
+using epics::pvAccess::ca::copyDBRArray;
+
+#define DEFAULT_COUNT 1000000
+#define DEFAULT_ITERATIONS 200
+
+namespace {
+
+// the copy code of the ca provider before copyDBRArray()
+template<typename pT, typename aF>
+void copyReuse(const pT * from, unsigned count, aF & value)
+{
+    typename aF::svector temp(value.reuse());
+    temp.resize(count);
+    std::copy(from, from + count, temp.begin());
+    value.replace(freeze(temp));
+}
+
+void report(const char * type, const char * method, size_t bytes, int iterations, double elapsed)
+{
+    printf("%-7s %-18s %8.3f ms/copy %10.1f MB/s\n", type, method,
+           elapsed * 1e3 / iterations, double(bytes) * iterations / elapsed / 1e6);
+}
+
+template<typename pT, typename aF>
+void benchmark(const char * type, unsigned count, int iterations)
+{
+    vector<pT> dbr(count);
+    for (unsigned i = 0; i < count; i++)
+        dbr[i] = static_cast<pT>(i);
+    const size_t bytes = count * sizeof(pT);
+
+    typename aF::shared_pointer value(getPVDataCreate()->createPVScalarArray<aF>());
+    typename aF::const_svector held;
+
+    for (int pass = 0; pass < 4; pass++)
+    {
+        const bool newCode = (pass & 1);
+        const bool hold = (pass & 2);
+
+        epicsTime start(epicsTime::getCurrent());
+        for (int i = 0; i < iterations; i++)
+        {
+            if (newCode)
+                copyDBRArray(&dbr[0], count, *value);
+            else
+                copyReuse(&dbr[0], count, *value);
+            if (hold)
+                held = value->view();
+        }
+        double elapsed = epicsTime::getCurrent() - start;
+        held.clear();
+
+        report(type, newCode ? (hold ? "copyDBRArray held" : "copyDBRArray free")
+                             : (hold ? "reuse held" : "reuse free"),
+               bytes, iterations, elapsed);
+    }
+
+    vector<pT> target(count);
+    epicsTime start(epicsTime::getCurrent());
+    for (int i = 0; i < iterations; i++)
+        memcpy(&target[0], &dbr[0], bytes);
+    report(type, "memcpy", bytes, iterations, epicsTime::getCurrent() - start);
+}
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: dbrCopyBenchmark [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -n <count>:        number of elements, default is %d\n"
+             "  -i <iterations>:   number of copies, default is %d\n\n"
+             , DEFAULT_COUNT, DEFAULT_ITERATIONS);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int opt;
+    int count = DEFAULT_COUNT;
+    int iterations = DEFAULT_ITERATIONS;
+
+    while ((opt = getopt(argc, argv, ":hn:i:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'n':
+            count = atoi(optarg);
+            if (count < 1)
+                count = DEFAULT_COUNT;
+            break;
+        case 'i':
+            iterations = atoi(optarg);
+            if (iterations < 1)
+                iterations = DEFAULT_ITERATIONS;
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'. ('dbrCopyBenchmark -h' for help.)\n", optopt);
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument. ('dbrCopyBenchmark -h' for help.)\n", optopt);
+            return 1;
+        default :
+            usage();
+            return 1;
+        }
+    }
+
+    printf("%d elements, %d copies\n", count, iterations);
+    benchmark<double, PVDoubleArray>("double", unsigned(count), iterations);
+    benchmark<float, PVFloatArray>("float", unsigned(count), iterations);
+    benchmark<int32, PVIntArray>("int", unsigned(count), iterations);
+    benchmark<int16, PVShortArray>("short", unsigned(count), iterations);
+    benchmark<int8, PVByteArray>("char", unsigned(count), iterations);
+
+    return 0;
+}
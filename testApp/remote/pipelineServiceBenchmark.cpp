@@ -0,0 +1,459 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * Throughput of the element path of a pipeline service (the counter service
+ * of pipelineServiceExample), without the network: the service fills elements
+ * from its own thread (or threads, with -p), a consumer thread plays the part of the server sending
+ * thread (poll(), release()) and of the client acks (reportRemoteQueueStatus()).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/pvData.h>
+#include <pv/createRequest.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/pipelineServer.h>
+
+using namespace std;
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+#define DEFAULT_QUEUE_SIZE 1024
+#define DEFAULT_COUNT 1000000
+
+namespace {
+
+Structure::const_shared_pointer dataStructure =
+    getFieldCreate()->createFieldBuilder()->
+    add("count", pvInt)->
+    createStructure();
+
+/**
+ * Counter session, the elements are filled by one or more producer threads.
+ */
+class BenchmarkSession :
+    public PipelineSession
+{
+public:
+    POINTER_DEFINITIONS(BenchmarkSession);
+
+    BenchmarkSession(int32 max, size_t producers) :
+        m_max(max),
+        m_counter(0),
+        m_published(0),
+        m_canceled(false),
+        m_started(false),
+        m_threads()
+    {
+        for (size_t i = 0; i < producers; i++)
+        {
+            std::ostringstream name;
+            name << "pipeline producer " << i;
+            m_threads.push_back(std::tr1::shared_ptr<Thread>(
+                new Thread(Thread::Config(this, producers > 1 ? &BenchmarkSession::runClaim : &BenchmarkSession::run)
+                           .name(name.str())
+                           .autostart(false))));
+        }
+    }
+
+    virtual ~BenchmarkSession()
+    {
+        cancel();
+        if (m_started)
+            for (size_t i = 0; i < m_threads.size(); i++)
+                m_threads[i]->exitWait();
+    }
+
+    void startProducers()
+    {
+        m_started = true;
+        for (size_t i = 0; i < m_threads.size(); i++)
+            m_threads[i]->start();
+    }
+
+    size_t getMinQueueSize() const {
+        return 16;
+    }
+
+    Structure::const_shared_pointer getStructure() const {
+        return dataStructure;
+    }
+
+    virtual void request(PipelineControl::shared_pointer const & control, size_t /*elementCount*/) {
+        {
+            Lock guard(m_mutex);
+            if (!m_control && !m_canceled)
+                m_control = control;
+        }
+        m_work.signal();
+    }
+
+    virtual void cancel() {
+        {
+            Lock guard(m_mutex);
+            m_canceled = true;
+            m_control.reset();
+        }
+        m_work.signal();
+    }
+
+private:
+    // null when canceled or finished, waits for a request otherwise
+    PipelineControl::shared_pointer waitControl()
+    {
+        m_work.wait();
+
+        Lock guard(m_mutex);
+        if (m_canceled)
+        {
+            // let the other producers exit
+            m_work.signal();
+            return PipelineControl::shared_pointer();
+        }
+        return m_control;
+    }
+
+    // one producer, getFreeElement() and putElement()
+    void run()
+    {
+        while (true)
+        {
+            PipelineControl::shared_pointer control(waitControl());
+            if (!control)
+            {
+                if (isFinished())
+                    break;
+                continue;
+            }
+
+            MonitorElement::shared_pointer element;
+            while (m_counter < m_max && (element = control->getFreeElement()))
+            {
+                element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->put(m_counter++);
+                control->putElement(element);
+            }
+
+            if (m_counter == m_max)
+            {
+                finish(control);
+                break;
+            }
+        }
+    }
+
+    // several producers, claimElement() and publishElement() keep the order of the counter
+    void runClaim()
+    {
+        while (true)
+        {
+            PipelineControl::shared_pointer control(waitControl());
+            if (!control)
+            {
+                if (isFinished())
+                    break;
+                continue;
+            }
+
+            bool woken = false;
+            while (true)
+            {
+                size_t sequence;
+                MonitorElement::shared_pointer element;
+                {
+                    // claim only as many elements as there are to send, sequences start at 0
+                    Lock guard(m_mutex);
+                    if (m_counter == m_max)
+                        break;
+                    element = control->claimElement(sequence);
+                    if (!element)
+                        break;
+                    m_counter++;
+                }
+
+                // there is work, wake up another producer
+                if (!woken)
+                {
+                    woken = true;
+                    m_work.signal();
+                }
+
+                element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->put(static_cast<int32>(sequence));
+                control->publishElement(element, sequence);
+
+                bool last;
+                {
+                    Lock guard(m_mutex);
+                    last = (++m_published == m_max);
+                }
+                if (last)
+                    finish(control);
+            }
+
+            if (isFinished())
+                break;
+        }
+    }
+
+    void finish(PipelineControl::shared_pointer const & control)
+    {
+        control->done();
+        {
+            // no reference cycle with the monitor
+            Lock guard(m_mutex);
+            m_control.reset();
+            m_canceled = true;
+        }
+        m_work.signal();
+    }
+
+    bool isFinished()
+    {
+        Lock guard(m_mutex);
+        return m_canceled || m_counter == m_max;
+    }
+
+    const int32 m_max;
+    int32 m_counter;
+    int32 m_published;
+
+    Mutex m_mutex;
+    PipelineControl::shared_pointer m_control;
+    bool m_canceled;
+    bool m_started;
+    Event m_work;
+    std::vector<std::tr1::shared_ptr<Thread> > m_threads;
+};
+
+class BenchmarkService :
+    public PipelineService
+{
+public:
+    BenchmarkService(int32 max, size_t producers) : m_max(max), m_producers(producers) {}
+
+    virtual PipelineSession::shared_pointer createPipeline(
+        epics::pvData::PVStructure::shared_pointer const & /*pvRequest*/)
+    {
+        m_session.reset(new BenchmarkSession(m_max, m_producers));
+        return m_session;
+    }
+
+    BenchmarkSession::shared_pointer m_session;
+
+private:
+    const int32 m_max;
+    const size_t m_producers;
+};
+
+/**
+ * Consumes the elements, and acks them like a client does.
+ */
+class Consumer :
+    public MonitorRequester
+{
+public:
+    POINTER_DEFINITIONS(Consumer);
+
+    Consumer(size_t queueSize, size_t ackAny) :
+        m_queueSize(queueSize),
+        m_ackAny(ackAny),
+        m_received(0),
+        m_ordered(true),
+        m_finished(false),
+        m_thread(Thread::Config(this, &Consumer::run).name("pipeline consumer").autostart(false))
+    {
+    }
+
+    virtual string getRequesterName() { return "Consumer"; }
+
+    virtual void monitorConnect(Status const & status,
+                                Monitor::shared_pointer const & monitor,
+                                StructureConstPtr const & /*structure*/)
+    {
+        if (!status.isSuccess())
+            fprintf(stderr, "monitorConnect failed: %s\n", status.getMessage().c_str());
+        m_monitor = monitor;
+    }
+
+    virtual void monitorEvent(Monitor::shared_pointer const & /*monitor*/)
+    {
+        m_event.signal();
+    }
+
+    // from poll() or from the producer thread (PipelineControl::done())
+    virtual void unlisten(Monitor::shared_pointer const & /*monitor*/)
+    {
+        {
+            Lock guard(m_mutex);
+            m_finished = true;
+        }
+        m_event.signal();
+    }
+
+    void start()
+    {
+        m_thread.start();
+    }
+
+    void waitDone()
+    {
+        m_thread.exitWait();
+    }
+
+    uint64 getReceived() const { return m_received; }
+    bool isOrdered() const { return m_ordered; }
+
+private:
+    void run()
+    {
+        // initial credit, the client queue
+        m_monitor->reportRemoteQueueStatus(static_cast<int32>(m_queueSize));
+
+        size_t released = 0;
+        while (!isFinished())
+        {
+            MonitorElement::shared_pointer element;
+            while ((element = m_monitor->poll()))
+            {
+                if (element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->get() != static_cast<int32>(m_received))
+                    m_ordered = false;
+                m_received++;
+                m_monitor->release(element);
+
+                if (++released >= m_ackAny)
+                {
+                    m_monitor->reportRemoteQueueStatus(static_cast<int32>(released));
+                    released = 0;
+                }
+            }
+
+            if (!isFinished())
+                m_event.wait();
+        }
+    }
+
+    bool isFinished()
+    {
+        Lock guard(m_mutex);
+        return m_finished;
+    }
+
+    const size_t m_queueSize;
+    const size_t m_ackAny;
+    Monitor::shared_pointer m_monitor;
+    uint64 m_received;
+    bool m_ordered;
+    Mutex m_mutex;
+    bool m_finished;
+    Event m_event;
+    Thread m_thread;
+};
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: pipelineServiceBenchmark [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -q <queue size>:   pipeline queue size, default is %d\n"
+             "  -a <ack any>:      number of released elements per ack, default is half of the queue size\n"
+             "  -n <count>:        number of elements, default is %d\n"
+             "  -w:                adaptive window (pvRequest option adaptive=true)\n"
+             "  -p <producers>:    number of producer threads, default is 1\n\n"
+             , DEFAULT_QUEUE_SIZE, DEFAULT_COUNT);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int opt;
+    int queueSize = DEFAULT_QUEUE_SIZE;
+    int ackAny = 0;
+    int count = DEFAULT_COUNT;
+    bool adaptive = false;
+    int producers = 1;
+
+    while ((opt = getopt(argc, argv, ":hq:a:n:wp:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'q':
+            queueSize = atoi(optarg);
+            if (queueSize < 2)
+                queueSize = DEFAULT_QUEUE_SIZE;
+            break;
+        case 'a':
+            ackAny = atoi(optarg);
+            break;
+        case 'n':
+            count = atoi(optarg);
+            if (count < 1)
+                count = DEFAULT_COUNT;
+            break;
+        case 'w':
+            adaptive = true;
+            break;
+        case 'p':
+            producers = atoi(optarg);
+            if (producers < 1)
+                producers = 1;
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'. ('pipelineServiceBenchmark -h' for help.)\n", optopt);
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument. ('pipelineServiceBenchmark -h' for help.)\n", optopt);
+            return 1;
+        default :
+            usage();
+            return 1;
+        }
+    }
+
+    if (ackAny <= 0 || ackAny > queueSize)
+        ackAny = queueSize / 2;
+
+    std::tr1::shared_ptr<BenchmarkService> service(new BenchmarkService(count, producers));
+    Channel::shared_pointer channel(createPipelineChannel(ChannelProvider::shared_pointer(), "benchmark",
+                                    DefaultChannelRequester::build(), service));
+
+    std::ostringstream request;
+    request << "record[queueSize=" << queueSize << ",pipeline=true"
+            << (adaptive ? ",adaptive=true" : "") << "]field()";
+
+    Consumer::shared_pointer consumer(new Consumer(queueSize, ackAny));
+    Monitor::shared_pointer monitor(channel->createMonitor(consumer, createRequest(request.str())));
+    if (!monitor)
+        return 1;
+    monitor->start();
+
+    epicsTime start(epicsTime::getCurrent());
+    service->m_session->startProducers();
+    consumer->start();
+    consumer->waitDone();
+    double elapsed = epicsTime::getCurrent() - start;
+
+    Monitor::Stats stats;
+    monitor->getStats(stats);
+
+    printf("%llu elements (%s), queue size %d, ack any %d, window %u, producers %d: %f s, %.0f elements/s\n",
+           (unsigned long long)consumer->getReceived(), consumer->isOrdered() ? "in order" : "NOT in order",
+           queueSize, ackAny, unsigned(stats.window), producers, elapsed, consumer->getReceived() / elapsed);
+
+    monitor->destroy();
+    channel->destroy();
+
+    return (consumer->isOrdered() && consumer->getReceived() == uint64(count)) ? 0 : 1;
+}
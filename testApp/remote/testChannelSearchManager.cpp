@@ -0,0 +1,65 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/simpleChannelSearchManagerImpl.h>
+
+using namespace epics::pvAccess;
+
+static const int SAMPLES = 1000;
+
+static
+void testSearchPeriod()
+{
+    testDiag("Test search period jitter");
+
+    double min = 1e9, max = -1e9;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        double period = SimpleChannelSearchManagerImpl::searchPeriod();
+        if (period < min) min = period;
+        if (period > max) max = period;
+    }
+
+    // 225ms +/- 25ms
+    testOk(min >= 0.2 - 1e-9 && max <= 0.25 + 1e-9, "period in [%f, %f]", min, max);
+    testOk(max - min >= 0.025, "periods are spread");
+}
+
+static
+void testReconnectDelay()
+{
+    testDiag("Test reconnect delay damping");
+
+    testOk1(SimpleChannelSearchManagerImpl::reconnectDelay(0.0) == 0.0);
+    testOk1(SimpleChannelSearchManagerImpl::reconnectDelay(-1.0) == 0.0);
+
+    const double spread = 2.0;
+    double min = 1e9, max = -1e9, sum = 0.0;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        double delay = SimpleChannelSearchManagerImpl::reconnectDelay(spread);
+        if (delay < min) min = delay;
+        if (delay > max) max = delay;
+        sum += delay;
+    }
+
+    testOk(min >= 0.0 && max <= spread, "delay in [%f, %f]", min, max);
+    // the reconnects are spread over the whole interval, not bunched
+    testOk(min < 0.1*spread && max > 0.9*spread, "delays cover the spread");
+    double mean = sum/SAMPLES;
+    testOk(mean > 0.4*spread && mean < 0.6*spread, "mean delay %f", mean);
+}
+
+MAIN(testChannelSearchManager)
+{
+    testPlan(7);
+    testSearchPeriod();
+    testReconnectDelay();
+    return testDone();
+}
@@ -0,0 +1,110 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <epicsThread.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/event.h>
+#include <pv/heartbeatService.h>
+
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+namespace {
+
+class SweepCounter : public HeartbeatService::Client
+{
+public:
+    POINTER_DEFINITIONS(SweepCounter);
+
+    SweepCounter() : count(0) {}
+
+    virtual void heartbeatSweep(epicsTimeStamp const & /*now*/)
+    {
+        {
+            Lock guard(mutex);
+            count++;
+        }
+        event.signal();
+    }
+
+    int getCount()
+    {
+        Lock guard(mutex);
+        return count;
+    }
+
+    Event event;
+private:
+    Mutex mutex;
+    int count;
+};
+
+void testSweeps()
+{
+    testDiag("Test testSweeps()");
+
+    TimingWheel::shared_pointer wheel(new TimingWheel("testHeartbeatService", epicsThreadPriorityMedium));
+    HeartbeatService::shared_pointer service(new HeartbeatService(wheel, 0.02));
+
+    // nothing scheduled without clients
+    testOk1(wheel->size() == 0);
+
+    SweepCounter::shared_pointer a(new SweepCounter()), b(new SweepCounter());
+    service->add(a);
+    service->add(b);
+    testOk1(service->size() == 2);
+    // one timer for all the clients
+    testOk1(wheel->size() == 1);
+
+    for (int i = 0; i < 3; i++)
+    {
+        a->event.wait(5.0);
+        b->event.wait(5.0);
+    }
+    testOk1(a->getCount() >= 3 && b->getCount() >= 3);
+
+    service->remove(a.get());
+    testOk1(service->size() == 1);
+    testOk1(wheel->size() == 1);
+
+    // expired clients are dropped by the next sweep
+    b.reset();
+    epicsThreadSleep(0.1);
+    testOk1(service->size() == 0);
+    testOk1(wheel->size() == 0);
+
+    wheel->close();
+}
+
+void testRemoveLast()
+{
+    testDiag("Test testRemoveLast()");
+
+    TimingWheel::shared_pointer wheel(new TimingWheel("testHeartbeatService", epicsThreadPriorityMedium));
+    HeartbeatService::shared_pointer service(new HeartbeatService(wheel, 10.0));
+
+    SweepCounter::shared_pointer a(new SweepCounter());
+    service->add(a);
+    testOk1(wheel->size() == 1);
+    service->remove(a.get());
+    testOk1(wheel->size() == 0);
+    // the timer does not keep the service alive any more
+    testOk1(service.unique());
+
+    wheel->close();
+}
+
+} // namespace
+
+MAIN(testHeartbeatService)
+{
+    testPlan(11);
+    testSweeps();
+    testRemoveLast();
+    return testDone();
+}
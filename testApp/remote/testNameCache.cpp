@@ -0,0 +1,249 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+
+#include <osiSock.h>
+#include <epicsTime.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/event.h>
+#include <pv/pvAccess.h>
+#include <pv/clientFactory.h>
+#include <pv/configuration.h>
+#include <pv/rpcServer.h>
+#include <pv/nameCache.h>
+
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+static const char cacheFile[] = "testNameCache.tmp";
+
+static
+void testRoundTrip()
+{
+    testDiag("Test save()/load() round trip");
+
+    remove(cacheFile);
+
+    osiSockAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    aToIPAddr("10.1.2.3", 5075, &addr.ia);
+
+    ServerGUID guid;
+    for (unsigned i = 0; i < sizeof(guid.value); i++)
+        guid.value[i] = (char)(0xF0 + i);
+
+    {
+        ChannelNameCache cache(cacheFile);
+        testOk1(cache.load() == 0u);
+
+        cache.update("pv:one", addr, guid);
+        cache.update("pv:two with space", addr, guid);
+        cache.update("pv:three", addr, guid);
+        cache.remove("pv:three");
+        testOk1(cache.size() == 2u);
+        testOk1(cache.save());
+    }
+
+    ChannelNameCache cache(cacheFile);
+    testOk1(cache.load() == 2u);
+
+    ChannelNameCache::Entry entry;
+    testOk1(!cache.lookup("pv:three", entry));
+    testOk1(cache.lookup("pv:two with space", entry));
+    testOk1(cache.lookup("pv:one", entry));
+    testOk1(sockAddrAreIdentical(&entry.address, &addr));
+    testOk1(memcmp(entry.guid.value, guid.value, sizeof(guid.value)) == 0);
+
+    remove(cacheFile);
+}
+
+static
+void testMalformed()
+{
+    testDiag("Test malformed lines are skipped");
+
+    {
+        std::ofstream out(cacheFile);
+        out << "# comment\n"
+            << "\n"
+            << "10.1.2.3:5075 0011223344556677\n"
+            << "10.1.2.3:5075 00112233445566778899aabb\n"
+            << "10.1.2.3:5075 zz112233445566778899aabb bad:guid\n"
+            << "10.1.2.3 00112233445566778899aabb bad:port\n"
+            << "10.1.2.3:5075 00112233445566778899aabb good\n";
+    }
+
+    ChannelNameCache cache(cacheFile);
+    testOk1(cache.load() == 1u);
+
+    ChannelNameCache::Entry entry;
+    testOk1(cache.lookup("good", entry));
+    testOk1(ntohs(entry.address.ia.sin_port) == 5075);
+
+    remove(cacheFile);
+}
+
+namespace {
+
+class NopService : public RPCService
+{
+public:
+    virtual PVStructure::shared_pointer request(PVStructure::shared_pointer const & args)
+    {
+        return args;
+    }
+};
+
+class ConnectWaiter : public ChannelRequester
+{
+public:
+    POINTER_DEFINITIONS(ConnectWaiter);
+
+    virtual std::string getRequesterName() { return "ConnectWaiter"; }
+    virtual void channelCreated(const Status& /*status*/, Channel::shared_pointer const & /*channel*/) {}
+    virtual void channelStateChange(Channel::shared_pointer const & /*channel*/, Channel::ConnectionState connectionState)
+    {
+        if (connectionState == Channel::CONNECTED)
+            connected.signal();
+    }
+
+    Event connected;
+};
+
+/* A TCP port which accepts connections (in the backlog) and never answers,
+ * the client waits for the connection validation until it times out.
+ */
+class DeadServer
+{
+public:
+    DeadServer() : m_socket(epicsSocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP))
+    {
+        memset(&address, 0, sizeof(address));
+        aToIPAddr("127.0.0.1", 0, &address.ia);
+        osiSocklen_t len = sizeof(address);
+        if (m_socket == INVALID_SOCKET || bind(m_socket, &address.sa, sizeof(address.ia)) ||
+                listen(m_socket, 4) || getsockname(m_socket, &address.sa, &len))
+            testAbort("Can't create a listening socket");
+    }
+    ~DeadServer() { epicsSocketDestroy(m_socket); }
+
+    osiSockAddr address;
+private:
+    SOCKET m_socket;
+};
+
+std::string entry(const osiSockAddr& address, const char* name)
+{
+    char text[64];
+    ipAddrToDottedIP(&address.ia, text, sizeof(text));
+    std::string line(text);
+    line += " 000000000000000000000000 ";
+    return line + name + "\n";
+}
+
+} // namespace
+
+static
+void testFallback()
+{
+    testDiag("Test stale and unreachable entries fall back to search");
+
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .push_map()
+                                       .build());
+
+    RPCServer server(conf), other(conf);
+    RPCService::shared_pointer service(new NopService());
+    server.registerService("cache:stale", service);
+    server.registerService("cache:dead", service);
+    server.registerService("cache:refused", service);
+
+    // nothing listens on a port just released
+    osiSockAddr refused;
+    {
+        DeadServer closed;
+        refused = closed.address;
+    }
+    DeadServer dead;
+
+    osiSockAddr stale;
+    memset(&stale, 0, sizeof(stale));
+    aToIPAddr("127.0.0.1", other.getServer()->getServerPort(), &stale.ia);
+
+    {
+        std::ofstream out(cacheFile);
+        out << entry(stale, "cache:stale")
+            << entry(dead.address, "cache:dead")
+            << entry(refused, "cache:refused");
+    }
+
+    Configuration::shared_pointer clientConf(ConfigurationBuilder()
+                                             .push_config(server.getServer()->getCurrentConfig())
+                                             .add("EPICS_PVA_NAME_CACHE", cacheFile)
+                                             .push_map()
+                                             .build());
+
+    ClientFactory::start();
+    ChannelProvider::shared_pointer provider(ChannelProviderRegistry::clients()->createProvider("pva", clientConf));
+    if (!provider)
+        testAbort("No pva provider");
+
+    const char* names[] = { "cache:stale", "cache:dead", "cache:refused" };
+    ConnectWaiter::shared_pointer waiters[3];
+    Channel::shared_pointer channels[3];
+
+    epicsTime start(epicsTime::getCurrent());
+    for (int i = 0; i < 3; i++)
+    {
+        waiters[i].reset(new ConnectWaiter());
+        channels[i] = provider->createChannel(names[i], waiters[i]);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        bool connected = waiters[i]->connected.wait(10.0);
+        // the dead server does not answer the validation for 5 s
+        double elapsed = epicsTime::getCurrent() - start;
+        testOk(connected && elapsed < 4.0, "%s connected by search after %f s", names[i], elapsed);
+    }
+
+    for (int i = 0; i < 3; i++)
+        channels[i]->destroy();
+    provider->destroy();
+
+    // saved on destroy, now pointing to the right server
+    ChannelNameCache cache(cacheFile);
+    cache.load();
+    bool updated = true;
+    for (int i = 0; i < 3; i++)
+    {
+        ChannelNameCache::Entry found;
+        updated = updated && cache.lookup(names[i], found) &&
+                  ntohs(found.address.ia.sin_port) == server.getServer()->getServerPort();
+    }
+    testOk(updated, "cache entries updated");
+
+    remove(cacheFile);
+}
+
+MAIN(testNameCache)
+{
+    testPlan(16);
+    osiSockAttach();
+    testRoundTrip();
+    testMalformed();
+    testFallback();
+    return testDone();
+}
@@ -0,0 +1,489 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/pvData.h>
+#include <pv/createRequest.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/clientFactory.h>
+#include <pv/configuration.h>
+#include <pv/pipelineServer.h>
+
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+namespace {
+
+Structure::const_shared_pointer dataStructure =
+    getFieldCreate()->createFieldBuilder()->
+    add("count", pvInt)->
+    createStructure();
+
+/**
+ * Counter session, fills all the elements it may on request(), on the calling thread.
+ */
+class CounterSession :
+    public PipelineSession
+{
+public:
+    CounterSession() : m_counter(0) {}
+
+    size_t getMinQueueSize() const {
+        return 2;
+    }
+
+    Structure::const_shared_pointer getStructure() const {
+        return dataStructure;
+    }
+
+    virtual void request(PipelineControl::shared_pointer const & control, size_t /*elementCount*/) {
+        Lock guard(m_mutex);
+        MonitorElement::shared_pointer element;
+        for (size_t n = control->getFreeElementCount(); n > 0 && (element = control->getFreeElement()); n--)
+        {
+            element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->put(m_counter++);
+            control->putElement(element);
+        }
+    }
+
+    virtual void cancel() {}
+
+private:
+    Mutex m_mutex;
+    int32 m_counter;
+};
+
+class CounterService :
+    public PipelineService
+{
+public:
+    virtual PipelineSession::shared_pointer createPipeline(
+        epics::pvData::PVStructure::shared_pointer const & /*pvRequest*/)
+    {
+        return PipelineSession::shared_pointer(new CounterSession());
+    }
+};
+
+/**
+ * Session of producer threads using claimElement() and publishElement(),
+ * request() only wakes them up.
+ */
+class ProducerSession :
+    public PipelineSession
+{
+public:
+    POINTER_DEFINITIONS(ProducerSession);
+
+    ProducerSession() : m_canceled(false) {}
+
+    size_t getMinQueueSize() const {
+        return 2;
+    }
+
+    Structure::const_shared_pointer getStructure() const {
+        return dataStructure;
+    }
+
+    virtual void request(PipelineControl::shared_pointer const & control, size_t /*elementCount*/) {
+        {
+            Lock guard(m_mutex);
+            if (!m_control && !m_canceled)
+                m_control = control;
+        }
+        m_work.signal();
+    }
+
+    virtual void cancel() {
+        Lock guard(m_mutex);
+        m_canceled = true;
+        m_control.reset();
+    }
+
+    PipelineControl::shared_pointer getControl() {
+        Lock guard(m_mutex);
+        return m_control;
+    }
+
+    Event m_work;
+
+private:
+    Mutex m_mutex;
+    PipelineControl::shared_pointer m_control;
+    bool m_canceled;
+};
+
+class ProducerService :
+    public PipelineService
+{
+public:
+    virtual PipelineSession::shared_pointer createPipeline(
+        epics::pvData::PVStructure::shared_pointer const & /*pvRequest*/)
+    {
+        m_session.reset(new ProducerSession());
+        return m_session;
+    }
+
+    ProducerSession::shared_pointer m_session;
+};
+
+class MonitorWaiter :
+    public MonitorRequester
+{
+public:
+    POINTER_DEFINITIONS(MonitorWaiter);
+
+    virtual std::string getRequesterName() { return "MonitorWaiter"; }
+
+    virtual void monitorConnect(Status const & status,
+                                Monitor::shared_pointer const & /*monitor*/,
+                                StructureConstPtr const & /*structure*/)
+    {
+        if (status.isSuccess())
+            connected.signal();
+    }
+
+    virtual void monitorEvent(Monitor::shared_pointer const & /*monitor*/)
+    {
+        event.signal();
+    }
+
+    virtual void unlisten(Monitor::shared_pointer const & /*monitor*/) {}
+
+    Event connected;
+    Event event;
+};
+
+Monitor::shared_pointer createMonitor(Channel::shared_pointer const & channel,
+                                      MonitorRequester::shared_pointer const & requester,
+                                      const char* request)
+{
+    Monitor::shared_pointer monitor(channel->createMonitor(requester, createRequest(request)));
+    if (!monitor)
+        testAbort("createMonitor(\"%s\") failed", request);
+    return monitor;
+}
+
+void testServerWindow()
+{
+    testDiag("Test adaptive window of the server");
+
+    PipelineService::shared_pointer service(new CounterService());
+    Channel::shared_pointer channel(createPipelineChannel(ChannelProvider::shared_pointer(), "counter",
+                                    DefaultChannelRequester::build(), service));
+    MonitorWaiter::shared_pointer requester(new MonitorWaiter());
+
+    Monitor::shared_pointer monitor(createMonitor(channel, requester,
+                                    "record[queueSize=64,pipeline=true,adaptive=true]field()"));
+    monitor->start();
+
+    // produces only as far ahead as the client grants credits
+    Monitor::Stats stats;
+    monitor->reportRemoteQueueStatus(8);
+    monitor->getStats(stats);
+    testOk(stats.window == 8 && stats.nfilled == 8, "window %u, %u produced ahead",
+           unsigned(stats.window), unsigned(stats.nfilled));
+
+    // sent by the sending thread
+    size_t sent = 0;
+    MonitorElement::shared_pointer element;
+    while ((element = monitor->poll()))
+    {
+        sent++;
+        monitor->release(element);
+    }
+    testOk(sent == 8, "%u sent", unsigned(sent));
+
+    // 4 credits in flight
+    monitor->reportRemoteQueueStatus(4);
+    monitor->getStats(stats);
+    testOk(stats.window == 7 && stats.nfilled == 7, "window decays slowly, %u, %u produced ahead",
+           unsigned(stats.window), unsigned(stats.nfilled));
+
+    // 24 credits in flight
+    monitor->reportRemoteQueueStatus(20);
+    monitor->getStats(stats);
+    testOk(stats.window == 24 && stats.nfilled == 24, "window follows an increase at once, %u, %u produced ahead",
+           unsigned(stats.window), unsigned(stats.nfilled));
+
+    monitor->destroy();
+
+    // fixed window, the whole queue
+    monitor = createMonitor(channel, requester, "record[queueSize=64,pipeline=true]field()");
+    monitor->start();
+    monitor->reportRemoteQueueStatus(8);
+    monitor->getStats(stats);
+    testOk(stats.window == 64 && stats.nfilled == 64, "fixed window %u, %u produced ahead",
+           unsigned(stats.window), unsigned(stats.nfilled));
+
+    monitor->destroy();
+    channel->destroy();
+}
+
+int32 countOf(MonitorElement::shared_pointer const & element)
+{
+    return element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->get();
+}
+
+void testReorderWrap()
+{
+    testDiag("Test claims do not wrap over a pending (claimed, not published) element");
+
+    std::tr1::shared_ptr<ProducerService> service(new ProducerService());
+    Channel::shared_pointer channel(createPipelineChannel(ChannelProvider::shared_pointer(), "producers",
+                                    DefaultChannelRequester::build(), service));
+    MonitorWaiter::shared_pointer requester(new MonitorWaiter());
+    Monitor::shared_pointer monitor(createMonitor(channel, requester, "record[queueSize=4,pipeline=true]field()"));
+    monitor->start();
+    monitor->reportRemoteQueueStatus(100);
+
+    PipelineControl::shared_pointer control(service->m_session->getControl());
+    if (!control)
+        testAbort("no pipeline control");
+
+    // a slow producer holds the first element
+    size_t pendingSequence;
+    MonitorElement::shared_pointer pending(control->claimElement(pendingSequence));
+    testOk1(pending && pendingSequence == 0);
+
+    // the others go out at once, and their elements come back to be claimed again
+    size_t claimed = 0, sent = 0;
+    while (claimed < 16)
+    {
+        size_t sequence;
+        MonitorElement::shared_pointer element(control->claimElement(sequence));
+        if (!element)
+            break;
+        claimed++;
+        element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->put(int32(sequence));
+        control->publishElement(element, sequence, false);
+
+        while ((element = monitor->poll()))
+        {
+            sent++;
+            monitor->release(element);
+        }
+    }
+    testOk(claimed == 3 && sent == 3, "%u claimed and sent while sequence 0 is pending",
+           unsigned(claimed));
+
+    pending->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->put(0);
+    control->publishElement(pending, pendingSequence, true);
+    MonitorElement::shared_pointer element(monitor->poll());
+    testOk(element && countOf(element) == 0, "pending element sent once published");
+    if (element)
+        monitor->release(element);
+
+    size_t sequence = 0;
+    element = control->claimElement(sequence);
+    testOk(element && sequence == 4, "claims continue with sequence %u", unsigned(sequence));
+    if (element)
+        control->publishElement(element, sequence);
+
+    monitor->destroy();
+    channel->destroy();
+}
+
+/**
+ * Producer thread, claims elements (up to a count) and publishes them, every third unordered.
+ */
+class Producer
+{
+public:
+    Producer(ProducerSession& session, Mutex& mutex, size_t& claimed, size_t count) :
+        m_session(session), m_mutex(mutex), m_claimed(claimed), m_count(count),
+        m_thread(Thread::Config(this, &Producer::run).name("pipeline producer").autostart(false))
+    {
+        m_thread.start();
+    }
+
+    void join() { m_thread.exitWait(); }
+
+private:
+    void run()
+    {
+        PipelineControl::shared_pointer control;
+        while (true)
+        {
+            size_t sequence;
+            MonitorElement::shared_pointer element;
+            {
+                Lock guard(m_mutex);
+                if (m_claimed == m_count)
+                    break;
+                if (!control)
+                    control = m_session.getControl();
+                if (control)
+                    element = control->claimElement(sequence);
+                if (element)
+                    m_claimed++;
+            }
+
+            if (!element)
+            {
+                // let the other producers publish
+                m_session.m_work.wait(0.01);
+                continue;
+            }
+
+            if (sequence % 5 == 0)
+                epicsThreadSleep(0.0);
+            element->pvStructurePtr->getSubField<PVInt>(1 /*"count"*/)->put(int32(sequence));
+            control->publishElement(element, sequence, sequence % 3 != 0);
+        }
+
+        // wake up the others
+        m_session.m_work.signal();
+    }
+
+    ProducerSession& m_session;
+    Mutex& m_mutex;
+    size_t& m_claimed;
+    const size_t m_count;
+    Thread m_thread;
+};
+
+void testProducers()
+{
+    testDiag("Test several producer threads, ordered and unordered elements");
+
+    std::tr1::shared_ptr<ProducerService> service(new ProducerService());
+    Channel::shared_pointer channel(createPipelineChannel(ChannelProvider::shared_pointer(), "producers",
+                                    DefaultChannelRequester::build(), service));
+    MonitorWaiter::shared_pointer requester(new MonitorWaiter());
+    Monitor::shared_pointer monitor(createMonitor(channel, requester, "record[queueSize=8,pipeline=true]field()"));
+    monitor->start();
+
+    const size_t count = 20000;
+    Mutex mutex;
+    size_t claimed = 0;
+    std::vector<std::tr1::shared_ptr<Producer> > producers;
+    for (int i = 0; i < 4; i++)
+        producers.push_back(std::tr1::shared_ptr<Producer>(
+                                new Producer(*service->m_session, mutex, claimed, count)));
+
+    // the client
+    monitor->reportRemoteQueueStatus(8);
+
+    std::vector<char> seen(count, 0);
+    size_t received = 0, duplicates = 0;
+    int32 lastOrdered = -1;
+    bool ordered = true;
+    const epicsTime start(epicsTime::getCurrent());
+    while (received < count && epicsTime::getCurrent() - start < 30.0)
+    {
+        MonitorElement::shared_pointer element;
+        int32 released = 0;
+        while ((element = monitor->poll()))
+        {
+            const int32 sequence = countOf(element);
+            if (sequence < 0 || size_t(sequence) >= count || seen[sequence]++)
+                duplicates++;
+            if (sequence % 3 != 0)
+            {
+                if (sequence < lastOrdered)
+                    ordered = false;
+                lastOrdered = sequence;
+            }
+            received++;
+            released++;
+            monitor->release(element);
+        }
+
+        if (released)
+            monitor->reportRemoteQueueStatus(released);
+        else
+            requester->event.wait(0.01);
+    }
+
+    for (size_t i = 0; i < producers.size(); i++)
+        producers[i]->join();
+
+    testOk(received == count && duplicates == 0, "%u of %u received, %u duplicates",
+           unsigned(received), unsigned(count), unsigned(duplicates));
+    testOk(ordered, "ordered elements in order");
+
+    monitor->destroy();
+    channel->destroy();
+}
+
+void testClientWindow()
+{
+    testDiag("Test adaptive window and round trip time of the client");
+
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .push_map()
+                                       .build());
+
+    PipelineServer server(conf);
+    server.registerService("counter", PipelineService::shared_pointer(new CounterService()));
+
+    ClientFactory::start();
+    ChannelProvider::shared_pointer provider(ChannelProviderRegistry::clients()->createProvider("pva",
+                                             server.getServer()->getCurrentConfig()));
+    if (!provider)
+        testAbort("No pva provider");
+
+    Channel::shared_pointer channel(provider->createChannel("counter"));
+    MonitorWaiter::shared_pointer requester(new MonitorWaiter());
+    Monitor::shared_pointer monitor(createMonitor(channel, requester,
+                                    "record[queueSize=64,pipeline=true,adaptive=true]field()"));
+    testOk1(requester->connected.wait(5.0));
+
+    Monitor::Stats stats;
+    monitor->getStats(stats);
+    testOk(stats.window == 16 && stats.rtt == 0.0, "initial window %u (a quarter of the queue)",
+           unsigned(stats.window));
+
+    monitor->start();
+
+    const size_t count = 2000;
+    size_t received = 0;
+    const epicsTime start(epicsTime::getCurrent());
+    while (received < count && epicsTime::getCurrent() - start < 10.0)
+    {
+        MonitorElement::shared_pointer element;
+        while ((element = monitor->poll()))
+        {
+            received++;
+            monitor->release(element);
+        }
+        requester->event.wait(0.1);
+    }
+    testOk(received >= count, "%u elements received", unsigned(received));
+
+    monitor->getStats(stats);
+    testOk(stats.rtt > 0.0 && stats.rtt < 1.0, "round trip time %f s", stats.rtt);
+    testOk(stats.window >= 2 && stats.window <= 64, "window %u", unsigned(stats.window));
+
+    monitor->destroy();
+    channel->destroy();
+    provider->destroy();
+}
+
+} // namespace
+
+MAIN(testPipelineService)
+{
+    testPlan(16);
+    testServerWindow();
+    testReorderWrap();
+    testProducers();
+    testClientWindow();
+    return testDone();
+}
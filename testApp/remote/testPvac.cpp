@@ -0,0 +1,816 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * pvac against an in-process provider, no network.
+ */
+
+#include <deque>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <epicsStdio.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/pvData.h>
+#include <pv/createRequest.h>
+#include <pv/lock.h>
+#include <pv/pvAccess.h>
+#include <pva/client.h>
+
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+namespace {
+
+Structure::const_shared_pointer valueType =
+    getFieldCreate()->createFieldBuilder()->
+    add("value", pvDouble)->
+    createStructure();
+
+/**
+ * Provider of the records added with addRecord(), any other name never connects.
+ * Operations are answered on the calling thread.
+ */
+class TestProvider : public ChannelProvider,
+    public std::tr1::enable_shared_from_this<TestProvider>
+{
+public:
+    POINTER_DEFINITIONS(TestProvider);
+
+    class TestChannel;
+    class TestMonitor;
+
+    struct Record {
+        PVStructure::shared_pointer value;
+        bool connected;
+        // puts fail
+        bool readOnly;
+        // get and put are never answered
+        bool silent;
+        std::vector<std::tr1::weak_ptr<TestChannel> > channels;
+        std::vector<std::tr1::weak_ptr<TestMonitor> > monitors;
+
+        Record() : connected(true), readOnly(false), silent(false) {}
+    };
+
+    class TestPut : public ChannelPut,
+        public std::tr1::enable_shared_from_this<TestPut>
+    {
+    public:
+        TestPut(std::tr1::shared_ptr<TestChannel> const & channel, ChannelPutRequester::shared_pointer const & requester) :
+            m_channel(channel), m_requester(requester) {}
+
+        virtual void put(PVStructure::shared_pointer const & pvPutStructure, BitSet::shared_pointer const & /*putBitSet*/)
+        {
+            Status status(m_channel->m_provider->putValue(m_channel->getChannelName(),
+                          pvPutStructure->getSubFieldT<PVDouble>("value")->get()));
+            m_requester->putDone(status, shared_from_this());
+        }
+
+        virtual void get()
+        {
+            PVStructure::shared_pointer value(getPVDataCreate()->createPVStructure(valueType));
+            value->getSubFieldT<PVDouble>("value")->put(m_channel->m_provider->getValue(m_channel->getChannelName()));
+            BitSet::shared_pointer changed(new BitSet());
+            changed->set(0);
+            m_requester->getDone(Status::Ok, shared_from_this(), value, changed);
+        }
+
+        virtual Channel::shared_pointer getChannel() { return m_channel; }
+        virtual void cancel() {}
+        virtual void lastRequest() {}
+        virtual void destroy() {}
+
+    private:
+        const std::tr1::shared_ptr<TestChannel> m_channel;
+        const ChannelPutRequester::shared_pointer m_requester;
+    };
+
+    /**
+     * Sends the value on start(), then every post() of the record, on the calling thread.
+     */
+    class TestMonitor : public Monitor,
+        public std::tr1::enable_shared_from_this<TestMonitor>
+    {
+    public:
+        TestMonitor(std::tr1::shared_ptr<TestChannel> const & channel, MonitorRequester::shared_pointer const & requester) :
+            m_channel(channel), m_requester(requester), m_started(false) {}
+
+        virtual Status start()
+        {
+            PVStructure::shared_pointer value(getPVDataCreate()->createPVStructure(valueType));
+            value->getSubFieldT<PVDouble>("value")->put(m_channel->m_provider->getValue(m_channel->getChannelName()));
+            {
+                Lock guard(m_mutex);
+                m_started = true;
+            }
+            if (push(value, 0))
+                event();
+            return Status::Ok;
+        }
+
+        virtual Status stop()
+        {
+            Lock guard(m_mutex);
+            m_started = false;
+            return Status::Ok;
+        }
+
+        virtual MonitorElementPtr poll()
+        {
+            Lock guard(m_mutex);
+            MonitorElementPtr element;
+            if (!m_queue.empty())
+            {
+                element = m_queue.front();
+                m_queue.pop_front();
+            }
+            return element;
+        }
+
+        virtual void release(MonitorElementPtr const & /*monitorElement*/) {}
+
+        virtual void destroy()
+        {
+            Lock guard(m_mutex);
+            m_started = false;
+            m_queue.clear();
+            m_requester.reset();
+        }
+
+        bool destroyed()
+        {
+            Lock guard(m_mutex);
+            return !m_requester;
+        }
+
+        // queue a copy of value, returns true if queued
+        bool push(PVStructure::shared_pointer const & value, uint32 changed)
+        {
+            MonitorElementPtr element(new MonitorElement(getPVDataCreate()->createPVStructure(valueType)));
+            element->pvStructurePtr->copyUnchecked(*value);
+            element->changedBitSet->set(changed);
+
+            Lock guard(m_mutex);
+            if (!m_started)
+                return false;
+            m_queue.push_back(element);
+            return true;
+        }
+
+        void event()
+        {
+            MonitorRequester::shared_pointer requester(getRequester());
+            if (requester)
+                requester->monitorEvent(shared_from_this());
+        }
+
+        void connect()
+        {
+            MonitorRequester::shared_pointer requester(getRequester());
+            if (requester)
+                requester->monitorConnect(Status::Ok, shared_from_this(), valueType);
+        }
+
+        void disconnect()
+        {
+            MonitorRequester::shared_pointer requester;
+            {
+                Lock guard(m_mutex);
+                m_started = false;
+                m_queue.clear();
+                requester = m_requester;
+            }
+            if (requester)
+                requester->channelDisconnect(false);
+        }
+
+    private:
+        MonitorRequester::shared_pointer getRequester()
+        {
+            Lock guard(m_mutex);
+            return m_requester;
+        }
+
+        const std::tr1::shared_ptr<TestChannel> m_channel;
+        Mutex m_mutex;
+        MonitorRequester::shared_pointer m_requester;
+        bool m_started;
+        std::deque<MonitorElementPtr> m_queue;
+    };
+
+    class TestChannel : public Channel,
+        public std::tr1::enable_shared_from_this<TestChannel>
+    {
+    public:
+        TestChannel(TestProvider::shared_pointer const & provider, std::string const & name,
+                    ChannelRequester::shared_pointer const & requester) :
+            m_provider(provider), m_name(name), m_requester(requester) {}
+
+        virtual ChannelProvider::shared_pointer getProvider() { return m_provider; }
+        virtual std::string getRemoteAddress() { return isConnected() ? "test" : ""; }
+        virtual ConnectionState getConnectionState() { return m_provider->getConnectionState(m_name); }
+        virtual std::string getChannelName() { return m_name; }
+        virtual ChannelRequester::shared_pointer getChannelRequester() { return ChannelRequester::shared_pointer(m_requester); }
+        virtual void destroy() {}
+
+        virtual ChannelPut::shared_pointer createChannelPut(ChannelPutRequester::shared_pointer const & requester,
+                                                            PVStructure::shared_pointer const & /*pvRequest*/)
+        {
+            std::tr1::shared_ptr<TestPut> op(new TestPut(shared_from_this(), requester));
+            // a not connected or silent channel holds the requester, as a pending network request
+            if (isConnected() && !m_provider->isSilent(m_name))
+                requester->channelPutConnect(Status::Ok, op, valueType);
+            return op;
+        }
+
+        virtual Monitor::shared_pointer createMonitor(MonitorRequester::shared_pointer const & requester,
+                                                      PVStructure::shared_pointer const & /*pvRequest*/)
+        {
+            std::tr1::shared_ptr<TestMonitor> op(new TestMonitor(shared_from_this(), requester));
+            // connected now, or by setConnected()
+            if (m_provider->addMonitor(m_name, op))
+                op->connect();
+            return op;
+        }
+
+        const TestProvider::shared_pointer m_provider;
+
+    private:
+        const std::string m_name;
+        const ChannelRequester::weak_pointer m_requester;
+    };
+
+    virtual std::string getProviderName() { return "testpvac"; }
+
+    virtual ChannelFind::shared_pointer channelFind(std::string const & /*name*/,
+            ChannelFindRequester::shared_pointer const & requester)
+    {
+        ChannelFind::shared_pointer nullFind;
+        requester->channelFindResult(Status::Ok, nullFind, false);
+        return nullFind;
+    }
+
+    virtual Channel::shared_pointer createChannel(std::string const & name,
+            ChannelRequester::shared_pointer const & requester,
+            short /*priority*/, std::string const & /*address*/)
+    {
+        std::tr1::shared_ptr<TestChannel> channel(new TestChannel(shared_from_this(), name, requester));
+        bool connected = false;
+        {
+            Lock guard(m_mutex);
+            m_created++;
+            std::map<std::string, Record>::iterator it(m_records.find(name));
+            if (it != m_records.end())
+            {
+                it->second.channels.push_back(channel);
+                connected = it->second.connected;
+            }
+        }
+
+        requester->channelCreated(Status::Ok, channel);
+        if (connected)
+            requester->channelStateChange(channel, Channel::CONNECTED);
+        return channel;
+    }
+
+    virtual void destroy() {}
+
+    TestProvider() : m_created(0) {}
+
+    void addRecord(std::string const & name, double value, bool readOnly = false, bool silent = false)
+    {
+        Record record;
+        record.value = getPVDataCreate()->createPVStructure(valueType);
+        record.value->getSubFieldT<PVDouble>("value")->put(value);
+        record.readOnly = readOnly;
+        record.silent = silent;
+
+        Lock guard(m_mutex);
+        m_records[name] = record;
+    }
+
+    double getValue(std::string const & name)
+    {
+        Lock guard(m_mutex);
+        return m_records[name].value->getSubFieldT<PVDouble>("value")->get();
+    }
+
+    Status putValue(std::string const & name, double value)
+    {
+        Lock guard(m_mutex);
+        Record& record(m_records[name]);
+        if (record.readOnly)
+            return Status(Status::STATUSTYPE_ERROR, "read-only");
+        record.value->getSubFieldT<PVDouble>("value")->put(value);
+        return Status::Ok;
+    }
+
+    // update the value, sent to the started monitors
+    void post(std::string const & name, double value)
+    {
+        PVStructure::shared_pointer copy(getPVDataCreate()->createPVStructure(valueType));
+        copy->getSubFieldT<PVDouble>("value")->put(value);
+        std::vector<std::tr1::shared_ptr<TestMonitor> > monitors;
+        {
+            Lock guard(m_mutex);
+            Record& record(m_records[name]);
+            record.value->getSubFieldT<PVDouble>("value")->put(value);
+            live(record.monitors, monitors);
+        }
+        for (size_t i = 0; i < monitors.size(); i++)
+        {
+            if (monitors[i]->push(copy, copy->getSubFieldT<PVDouble>("value")->getFieldOffset()))
+                monitors[i]->event();
+        }
+    }
+
+    // as a lost and regained server connection
+    void setConnected(std::string const & name, bool connected)
+    {
+        std::vector<std::tr1::shared_ptr<TestChannel> > channels;
+        std::vector<std::tr1::shared_ptr<TestMonitor> > monitors;
+        {
+            Lock guard(m_mutex);
+            Record& record(m_records[name]);
+            record.connected = connected;
+            live(record.channels, channels);
+            live(record.monitors, monitors);
+        }
+        for (size_t i = 0; i < channels.size(); i++)
+        {
+            ChannelRequester::shared_pointer requester(channels[i]->getChannelRequester());
+            requester->channelStateChange(channels[i], connected ? Channel::CONNECTED : Channel::DISCONNECTED);
+        }
+        for (size_t i = 0; i < monitors.size(); i++)
+        {
+            if (connected)
+                monitors[i]->connect();
+            else
+                monitors[i]->disconnect();
+        }
+    }
+
+    Channel::ConnectionState getConnectionState(std::string const & name)
+    {
+        Lock guard(m_mutex);
+        std::map<std::string, Record>::const_iterator it(m_records.find(name));
+        if (it == m_records.end())
+            return Channel::NEVER_CONNECTED;
+        return it->second.connected ? Channel::CONNECTED : Channel::DISCONNECTED;
+    }
+
+    // returns true if the record is connected
+    bool addMonitor(std::string const & name, std::tr1::shared_ptr<TestMonitor> const & monitor)
+    {
+        Lock guard(m_mutex);
+        std::map<std::string, Record>::iterator it(m_records.find(name));
+        if (it == m_records.end())
+            return false;
+        it->second.monitors.push_back(monitor);
+        return it->second.connected;
+    }
+
+    // number of not destroyed monitors of a record, the server subscriptions
+    size_t monitors(std::string const & name)
+    {
+        std::vector<std::tr1::shared_ptr<TestMonitor> > monitors;
+        {
+            Lock guard(m_mutex);
+            live(m_records[name].monitors, monitors);
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < monitors.size(); i++)
+            count += !monitors[i]->destroyed();
+        return count;
+    }
+
+    bool isSilent(std::string const & name)
+    {
+        Lock guard(m_mutex);
+        return m_records[name].silent;
+    }
+
+    size_t created()
+    {
+        Lock guard(m_mutex);
+        return m_created;
+    }
+
+private:
+    template<typename T>
+    static void live(std::vector<std::tr1::weak_ptr<T> > const & refs, std::vector<std::tr1::shared_ptr<T> >& ret)
+    {
+        for (size_t i = 0; i < refs.size(); i++)
+        {
+            std::tr1::shared_ptr<T> ref(refs[i].lock());
+            if (ref)
+                ret.push_back(ref);
+        }
+    }
+
+    Mutex m_mutex;
+    std::map<std::string, Record> m_records;
+    size_t m_created;
+};
+
+TestProvider::shared_pointer testProvider(new TestProvider());
+
+ChannelProvider::shared_pointer buildTestProvider(const std::tr1::shared_ptr<Configuration>& /*conf*/)
+{
+    return testProvider;
+}
+
+shared_vector<const void> scalar(double value)
+{
+    shared_vector<double> array(1, value);
+    return static_shared_vector_cast<const void>(freeze(array));
+}
+
+std::string itemName(const char* prefix, size_t i)
+{
+    char name[32];
+    epicsSnprintf(name, sizeof(name), "%s%u", prefix, unsigned(i));
+    return name;
+}
+
+void testConnectMany()
+{
+    testDiag("Test connect() of many names");
+
+    pvac::ClientProvider provider("server:testpvac");
+
+    std::vector<std::string> names;
+    names.push_back("pv:0");
+    names.push_back("pv:1");
+    names.push_back("pv:0");
+    names.push_back("nosuch");
+
+    const size_t created = testProvider->created();
+    std::vector<pvac::ClientChannel> channels;
+    provider.connect(names, channels);
+    testOk(channels.size() == 4, "%u channels", unsigned(channels.size()));
+    testOk(testProvider->created() - created == 3, "repeated name created once");
+    testOk1(channels[0].getChannel() == channels[2].getChannel());
+    testOk1(channels[3].name() == "nosuch");
+
+    // from the cache
+    testOk1(provider.connect("pv:1").getChannel() == channels[1].getChannel());
+    provider.connect(names, channels);
+    testOk(testProvider->created() - created == 3, "cached channels reused");
+}
+
+void testGetAll()
+{
+    testDiag("Test getAll()");
+
+    pvac::ClientProvider provider("server:testpvac");
+
+    pvac::ClientProvider::BatchItems items;
+    for (size_t i = 0; i < 10; i++)
+        items.push_back(pvac::ClientProvider::BatchItem(itemName("pv:", i)));
+
+    testOk1(provider.getAll(items, 1.0) == 10);
+    bool values = true;
+    for (size_t i = 0; i < items.size(); i++)
+        values &= items[i].event == pvac::PutEvent::Success && items[i].result &&
+                  items[i].result->getSubFieldT<PVDouble>("value")->get() == double(i);
+    testOk(values, "all values");
+}
+
+void testPutAll()
+{
+    testDiag("Test putAll()");
+
+    pvac::ClientProvider provider("server:testpvac");
+
+    pvac::ClientProvider::BatchItems items;
+    for (size_t i = 0; i < 10; i++)
+    {
+        items.push_back(pvac::ClientProvider::BatchItem(itemName("pv:", i)));
+        items.back().value = scalar(100.0 + i);
+    }
+
+    testOk1(provider.putAll(items, 1.0) == 10);
+    bool values = true;
+    for (size_t i = 0; i < items.size(); i++)
+        values &= testProvider->getValue(items[i].name) == 100.0 + i;
+    testOk(values, "all values put");
+}
+
+void testPartialFailure()
+{
+    testDiag("Test partial failure and timeout of a batch");
+
+    pvac::ClientProvider provider("server:testpvac");
+
+    pvac::ClientProvider::BatchItems items;
+    items.push_back(pvac::ClientProvider::BatchItem("pv:0"));
+    items.push_back(pvac::ClientProvider::BatchItem("ro:0"));
+    items.push_back(pvac::ClientProvider::BatchItem("nosuch"));
+    items.push_back(pvac::ClientProvider::BatchItem("silent:0"));
+    for (size_t i = 0; i < items.size(); i++)
+        items[i].value = scalar(42.0);
+
+    epicsTime start(epicsTime::getCurrent());
+    testOk1(provider.putAll(items, 0.5) == 1);
+    double elapsed = epicsTime::getCurrent() - start;
+    testOk(elapsed >= 0.4 && elapsed < 5.0, "waited %f s for the timeout", elapsed);
+
+    testOk1(items[0].event == pvac::PutEvent::Success);
+    testOk1(items[1].event == pvac::PutEvent::Fail && items[1].message == "read-only");
+    testOk1(items[2].event == pvac::PutEvent::Fail && items[2].message == "Timeout");
+    testOk1(items[3].event == pvac::PutEvent::Fail && items[3].message == "Timeout");
+    testOk1(testProvider->getValue("pv:0") == 42.0 && testProvider->getValue("ro:0") == 0.0);
+
+    // no timeout when all complete
+    items.resize(2);
+    start = epicsTime::getCurrent();
+    testOk1(provider.getAll(items, 5.0) == 2);
+    elapsed = epicsTime::getCurrent() - start;
+    testOk(elapsed < 1.0, "done in %f s", elapsed);
+    testOk1(items[1].result && items[1].result->getSubFieldT<PVDouble>("value")->get() == 0.0);
+}
+
+void testQueue()
+{
+    testDiag("Test CompletionQueue");
+
+    pvac::ClientProvider provider("server:testpvac");
+    pvac::CompletionQueue queue;
+    pvac::CompletionQueue::Completions completions;
+
+#ifdef __linux__
+    testOk(queue.fd() >= 0, "eventfd %d", queue.fd());
+#else
+    testSkip(1, "no eventfd");
+#endif
+
+    epicsTime start(epicsTime::getCurrent());
+    testOk1(!queue.wait(0.2));
+    testOk1(epicsTime::getCurrent() - start >= 0.15);
+    testOk1(queue.poll(completions) == 0);
+
+    // tags are the channel numbers
+    std::vector<pvac::ClientChannel> channels;
+    std::vector<pvac::Operation> ops;
+    for (size_t i = 0; i < 3; i++)
+    {
+        channels.push_back(provider.connect(itemName("pv:", i)));
+        ops.push_back(channels[i].get(queue, reinterpret_cast<void*>(i)));
+    }
+    testOk1(queue.wait(1.0));
+    testOk1(queue.poll(completions) == 3);
+    bool values = completions.size() == 3;
+    for (size_t i = 0; values && i < completions.size(); i++)
+    {
+        const size_t n = reinterpret_cast<size_t>(completions[i].tag);
+        values = !completions[i].monitor && completions[i].event == pvac::PutEvent::Success &&
+                 n < channels.size() && completions[i].value &&
+                 completions[i].value->getSubFieldT<PVDouble>("value")->get() == testProvider->getValue(itemName("pv:", n));
+    }
+    testOk(values, "values of the tagged gets");
+    testOk1(queue.poll(completions) == 0 && completions.empty());
+
+    // puts of the value, built by the queue
+    shared_vector<double> two(2, 1.0);
+    ops.clear();
+    ops.push_back(channels[0].put(queue, &channels[0], scalar(7.0)));
+    ops.push_back(provider.connect("ro:0").put(queue, &channels[1], scalar(7.0)));
+    ops.push_back(channels[2].put(queue, &channels[2], static_shared_vector_cast<const void>(freeze(two))));
+    testOk1(queue.poll(completions) == 3);
+    testOk1(completions[0].tag == &channels[0] && completions[0].event == pvac::PutEvent::Success &&
+            testProvider->getValue("pv:0") == 7.0);
+    testOk1(completions[1].tag == &channels[1] && completions[1].event == pvac::PutEvent::Fail &&
+            completions[1].message == "read-only");
+    testOk(completions[2].tag == &channels[2] && completions[2].event == pvac::PutEvent::Fail,
+           "array to a scalar fails: %s", completions[2].message.c_str());
+
+    // pending until cancelled
+    ops.clear();
+    ops.push_back(provider.connect("silent:0").get(queue, &queue));
+    testOk1(!queue.wait(0.1));
+    ops[0].cancel();
+    testOk1(queue.poll(completions) == 1 && completions[0].tag == &queue &&
+            completions[0].event == pvac::PutEvent::Cancel);
+}
+
+struct Consumer : public pvac::ClientChannel::MonitorCallback
+{
+    std::vector<pvac::MonitorEvent::event_t> events;
+
+    virtual void monitorEvent(const pvac::MonitorEvent& evt)
+    {
+        events.push_back(evt.event);
+    }
+
+    pvac::MonitorEvent::event_t last() const
+    {
+        return events.empty() ? pvac::MonitorEvent::Fail : events.back();
+    }
+};
+
+// the values of the queued updates, -1.0 for an overrun one
+std::vector<double> drain(pvac::Monitor& monitor)
+{
+    std::vector<double> values;
+    while (monitor.poll())
+    {
+        const double value = monitor.root->getSubFieldT<PVDouble>("value")->get();
+        values.push_back(monitor.overrun.isEmpty() ? value : -value);
+    }
+    return values;
+}
+
+std::string str(std::vector<double> const & values)
+{
+    std::ostringstream strm;
+    for (size_t i = 0; i < values.size(); i++)
+        strm << (i ? " " : "") << values[i];
+    return strm.str();
+}
+
+void testMonitorShared()
+{
+    testDiag("Test monitorShared() join, late joiner and exact pvRequest match");
+
+    pvac::ClientProvider provider("server:testpvac");
+    pvac::ClientChannel channel(provider.connect("mon:0"));
+    Consumer first, second, small1, small2;
+
+    pvac::Monitor m1(channel.monitorShared(&first));
+    testOk(testProvider->monitors("mon:0") == 1, "one subscription");
+    testOk1(first.last() == pvac::MonitorEvent::Data);
+    testOk1(m1.poll() && m1.root->getSubFieldT<PVDouble>("value")->get() == 1.0 && m1.changed.get(0));
+    testOk1(!m1.poll());
+
+    // joins, starts with the value received before
+    pvac::Monitor m2(channel.monitorShared(&second, createRequest("field()")));
+    testOk(testProvider->monitors("mon:0") == 1, "joined the subscription");
+    testOk1(second.last() == pvac::MonitorEvent::Data);
+    testOk1(m2.poll() && m2.root->getSubFieldT<PVDouble>("value")->get() == 1.0 && m2.changed.get(0));
+
+    testProvider->post("mon:0", 2.0);
+    std::vector<double> values1(drain(m1)), values2(drain(m2));
+    testOk(str(values1) == "2" && str(values2) == "2", "update to both: %s, %s",
+           str(values1).c_str(), str(values2).c_str());
+
+    // another queueSize is another pvRequest
+    pvac::Monitor s1(channel.monitorShared(&small1, createRequest("record[queueSize=2]field()")));
+    testOk(testProvider->monitors("mon:0") == 2, "queueSize=2 not shared with the default");
+    pvac::Monitor s2(channel.monitorShared(&small2, createRequest("record[queueSize=2]field()")));
+    testOk(testProvider->monitors("mon:0") == 2, "queueSize=2 shared");
+    drain(s1);
+    drain(s2);
+
+    testDiag("Test overrun of one consumer queue");
+    for (int i = 3; i <= 6; i++)
+    {
+        testProvider->post("mon:0", i);
+        drain(s2);
+    }
+    values1 = drain(s1);
+    testOk(str(values1) == "3 -6", "full queue squashed: %s", str(values1).c_str());
+    testOk1(str(drain(m1)) == "3 4 5 6");
+
+    testDiag("Test close with the last consumer");
+    m1.cancel();
+    testOk1(first.last() == pvac::MonitorEvent::Cancel);
+    testOk1(testProvider->monitors("mon:0") == 2);
+    m2.cancel();
+    testOk1(testProvider->monitors("mon:0") == 1);
+    s1.cancel();
+    s2.cancel();
+    testOk1(testProvider->monitors("mon:0") == 0);
+
+    // a new subscription
+    m1 = channel.monitorShared(&first);
+    testOk1(testProvider->monitors("mon:0") == 1);
+    testOk1(str(drain(m1)) == "6");
+    m1.cancel();
+}
+
+void testMonitorReconnect()
+{
+    testDiag("Test reconnect of a shared subscription");
+
+    pvac::ClientProvider provider("server:testpvac");
+    pvac::ClientChannel channel(provider.connect("mon:1"));
+    Consumer first, second;
+
+    pvac::Monitor m1(channel.monitorShared(&first));
+    pvac::Monitor m2(channel.monitorShared(&second));
+    drain(m1);
+    drain(m2);
+
+    testProvider->setConnected("mon:1", false);
+    testOk1(first.last() == pvac::MonitorEvent::Disconnect && second.last() == pvac::MonitorEvent::Disconnect);
+
+    testProvider->post("mon:1", 2.0);
+    testProvider->setConnected("mon:1", true);
+    testOk1(testProvider->monitors("mon:1") == 1);
+    testOk1(first.last() == pvac::MonitorEvent::Data && second.last() == pvac::MonitorEvent::Data);
+    std::vector<double> values1(drain(m1)), values2(drain(m2));
+    testOk(str(values1) == "2" && str(values2) == "2", "value after reconnect to both: %s, %s",
+           str(values1).c_str(), str(values2).c_str());
+
+    testProvider->post("mon:1", 3.0);
+    testOk1(str(drain(m1)) == "3" && str(drain(m2)) == "3");
+
+    m1.cancel();
+    m2.cancel();
+}
+
+// blocking get(), -1.0 on timeout
+double getValue(pvac::ClientChannel& channel, double timeout,
+                PVStructure::const_shared_pointer const & pvRequest = PVStructure::const_shared_pointer())
+{
+    try {
+        return channel.get(timeout, pvRequest)->getSubFieldT<PVDouble>("value")->get();
+    } catch (pvac::Timeout&) {
+        return -1.0;
+    }
+}
+
+void testCachedGet()
+{
+    testDiag("Test get() from a shared subscription");
+
+    pvac::ClientProvider provider("server:testpvac");
+    pvac::ClientChannel channel(provider.connect("cache:0"));
+    pvac::ClientChannel other(provider.connect("cache:1"));
+    Consumer consumer, plain;
+
+    channel.cacheGets(0.2);
+    other.cacheGets(0.2);
+
+    // the server value changes without an update
+    pvac::Monitor monitor(channel.monitorShared(&consumer));
+    testProvider->putValue("cache:0", 2.0);
+    testOk1(getValue(channel, 1.0) == 1.0);
+
+    // up to date while connected, however old the last update
+    epicsThreadSleep(0.3);
+    testOk(getValue(channel, 1.0) == 1.0, "connected subscription used after maxAge");
+    testOk(getValue(channel, 1.0, createRequest("record[process=true]field()")) == 2.0,
+           "process goes to the server");
+    channel.cacheGets(-1.0);
+    testOk(getValue(channel, 1.0) == 2.0, "cache disabled");
+    channel.cacheGets(0.2);
+
+    testDiag("Test get() after a disconnect");
+    testProvider->setConnected("cache:0", false);
+    testOk(getValue(channel, 0.2) == -1.0, "disconnected subscription is not used, goes to the (disconnected) server");
+
+    testProvider->setConnected("cache:0", true);
+    testOk(getValue(channel, 1.0) == 2.0, "value of the reconnected subscription");
+
+    testDiag("Test get() without a shared subscription");
+    testOk1(getValue(other, 1.0) == 1.0);
+    pvac::Monitor unshared(other.monitor(&plain));
+    testProvider->putValue("cache:1", 2.0);
+    testOk(getValue(other, 1.0) == 2.0, "monitor() is not used");
+    unshared.cancel();
+
+    monitor.cancel();
+    testProvider->putValue("cache:0", 3.0);
+    testOk(getValue(channel, 1.0) == 3.0, "closed subscription is not used");
+}
+
+} // namespace
+
+MAIN(testPvac)
+{
+    testPlan(66);
+
+    for (size_t i = 0; i < 10; i++)
+        testProvider->addRecord(itemName("pv:", i), double(i));
+    testProvider->addRecord("ro:0", 0.0, true);
+    testProvider->addRecord("silent:0", 0.0, false, true);
+    testProvider->addRecord("mon:0", 1.0);
+    testProvider->addRecord("mon:1", 1.0);
+    testProvider->addRecord("cache:0", 1.0);
+    testProvider->addRecord("cache:1", 1.0);
+    ChannelProviderRegistry::servers()->add("testpvac", buildTestProvider);
+
+    testConnectMany();
+    testGetAll();
+    testPutAll();
+    testPartialFailure();
+    testQueue();
+    testMonitorShared();
+    testMonitorReconnect();
+    testCachedGet();
+
+    ChannelProviderRegistry::servers()->remove("testpvac");
+    return testDone();
+}
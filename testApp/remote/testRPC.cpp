@@ -1,4 +1,9 @@
 
+#include <vector>
+
+#include <epicsThread.h>
+#include <epicsTime.h>
+
 #include <pv/epicsException.h>
 #include <pv/valueBuilder.h>
 
@@ -106,11 +111,319 @@ void testRPCFail(const pva::ChannelProvider::shared_pointer& cli_prov)
     }
 }
 
+struct SlowService : public pva::RPCService
+{
+    virtual epics::pvData::PVStructure::shared_pointer request(
+        epics::pvData::PVStructure::shared_pointer const & args
+    ) OVERRIDE FINAL
+    {
+        epicsThreadSleep(0.5);
+        pvd::PVStructure::shared_pointer reply(pvd::getPVDataCreate()->createPVStructure(reply_type));
+        reply->getSubFieldT<pvd::PVDouble>("value")->put(1.0);
+        return reply;
+    }
+};
+
+pvd::PVStructurePtr slowArgs(const char* path)
+{
+    pvd::ValueBuilder args("epics:nt/NTURI:1.0");
+    args.add<pvd::pvString>("scheme", "pva")
+        .add<pvd::pvString>("path", path);
+    return args.buildPVStructure();
+}
+
+void testWorkers(const pva::ChannelProvider::shared_pointer& cli_prov)
+{
+    testDiag("Workers");
+
+    // all the requests go over the same connection
+    const size_t count = 4;
+    std::vector<std::tr1::shared_ptr<pva::RPCClient> > clients;
+    for (size_t i = 0; i < count; i++)
+    {
+        clients.push_back(std::tr1::shared_ptr<pva::RPCClient>(
+                              new pva::RPCClient("slow", pvd::createRequest("field()"), cli_prov)));
+        clients.back()->waitConnect();
+    }
+
+    epicsTime start(epicsTime::getCurrent());
+    for (size_t i = 0; i < count; i++)
+        clients[i]->issueRequest(slowArgs("slow"));
+
+    size_t ok = 0;
+    for (size_t i = 0; i < count; i++)
+        if (clients[i]->waitResponse())
+            ok++;
+    double elapsed = epicsTime::getCurrent() - start;
+
+    testOk(ok == count, "%u of %u responses", (unsigned)ok, (unsigned)count);
+    // executed one after the other it would take 2 s
+    testOk(elapsed < 1.5, "executed in parallel, %f s", elapsed);
+}
+
+void testRejected(const pva::ChannelProvider::shared_pointer& cli_prov)
+{
+    testDiag("Rejected");
+
+    pva::RPCClient first("busy", pvd::createRequest("field()"), cli_prov);
+    pva::RPCClient second("busy", pvd::createRequest("field()"), cli_prov);
+    first.waitConnect();
+    second.waitConnect();
+
+    // one in flight, none may wait
+    first.issueRequest(slowArgs("busy"));
+    epicsThreadSleep(0.1);
+    second.issueRequest(slowArgs("busy"));
+
+    try {
+        (void)second.waitResponse();
+        testFail("Missing expected exception");
+    } catch(pva::RPCRequestException& e) {
+        testPass("caught expected rpc exception: %s", e.what());
+    }
+
+    testOk1(!!first.waitResponse());
+}
+
+pvd::PVStructurePtr sumArgs(double lhs, double rhs)
+{
+    pvd::ValueBuilder args("epics:nt/NTURI:1.0");
+    args.add<pvd::pvString>("scheme", "pva")
+        .add<pvd::pvString>("path", "sum");
+    return args.addNested("query")
+                   .add<pvd::pvDouble>("lhs", lhs)
+                   .add<pvd::pvDouble>("rhs", rhs)
+               .endNested()
+               .buildPVStructure();
+}
+
+void testIssueCollect(const pva::ChannelProvider::shared_pointer& cli_prov)
+{
+    testDiag("Issue/collect, not multiplexed");
+
+    pva::RPCClient client("sum", pvd::createRequest("field()"), cli_prov);
+
+    // issued before connected, sent one after the other
+    std::vector<pvd::uint32> ids;
+    for (int i = 0; i < 3; i++)
+        ids.push_back(client.issue(sumArgs(i, 1.0)));
+
+    bool ok = true;
+    for (int i = 2; i >= 0; i--)
+        ok = ok && client.collect(ids[i])->getSubFieldT<pvd::PVDouble>("value")->get() == i + 1.0;
+    testOk(ok, "responses collected in any order");
+
+    try {
+        (void)client.collect(ids[0]);
+        testFail("Missing expected exception");
+    } catch(std::logic_error& e) {
+        testPass("caught expected exception: %s", e.what());
+    }
+}
+
+void testMultiplexed(const pva::ChannelProvider::shared_pointer& cli_prov)
+{
+    testDiag("Multiplexed");
+
+    pva::RPCClient client("slow", pvd::createRequest("record[multiplex=true]field()"), cli_prov);
+    testOk1(client.waitConnect());
+
+    // a single channel, no other request pending error
+    const size_t count = 4;
+    epicsTime start(epicsTime::getCurrent());
+    std::vector<pvd::uint32> ids;
+    for (size_t i = 0; i < count; i++)
+        ids.push_back(client.issue(slowArgs("slow")));
+
+    size_t ok = 0;
+    for (size_t i = 0; i < count; i++)
+        if (client.collect(ids[i]))
+            ok++;
+    double elapsed = epicsTime::getCurrent() - start;
+
+    testOk(ok == count && elapsed < 1.5, "%u of %u responses, in flight together, %f s",
+           (unsigned)ok, (unsigned)count, elapsed);
+
+    // a synchronous service, run by the server workers
+    pva::RPCClient sync("slowsync", pvd::createRequest("record[multiplex=true]field()"), cli_prov);
+    sync.waitConnect();
+
+    start = epicsTime::getCurrent();
+    ids.clear();
+    for (size_t i = 0; i < count; i++)
+        ids.push_back(sync.issue(slowArgs("slowsync")));
+
+    ok = 0;
+    for (size_t i = 0; i < count; i++)
+        if (sync.collect(ids[i]))
+            ok++;
+    elapsed = epicsTime::getCurrent() - start;
+
+    // executed one after the other it would take 2 s
+    testOk(ok == count && elapsed < 1.5, "%u of %u responses, executed in parallel, %f s",
+           (unsigned)ok, (unsigned)count, elapsed);
+
+    // small requests over one connection
+    const size_t small = 200;
+    pva::RPCClient serial("sum", pvd::createRequest("field()"), cli_prov);
+    pva::RPCClient multiplexed("sum", pvd::createRequest("record[multiplex=true]field()"), cli_prov);
+    serial.waitConnect();
+    multiplexed.waitConnect();
+
+    start = epicsTime::getCurrent();
+    for (size_t i = 0; i < small; i++)
+        (void)serial.request(sumArgs(i, 1.0));
+    double serialTime = epicsTime::getCurrent() - start;
+
+    start = epicsTime::getCurrent();
+    ids.clear();
+    for (size_t i = 0; i < small; i++)
+        ids.push_back(multiplexed.issue(sumArgs(i, 1.0)));
+    bool correct = true;
+    for (size_t i = 0; i < small; i++)
+        correct = correct && multiplexed.collect(ids[i])->getSubFieldT<pvd::PVDouble>("value")->get() == i + 1.0;
+    double multiplexedTime = epicsTime::getCurrent() - start;
+
+    testOk1(correct);
+    testDiag("%u requests: serial %f s, multiplexed %f s",
+             (unsigned)small, serialTime, multiplexedTime);
+}
+
+void testRequestAll(const pva::ChannelProvider::shared_pointer& cli_prov)
+{
+    testDiag("Request all");
+
+    pva::RPCClient::BatchRequests requests;
+    for (int i = 0; i < 4; i++)
+        requests.push_back(pva::RPCClient::BatchRequest("slow", slowArgs("slow")));
+    requests.push_back(pva::RPCClient::BatchRequest("sum", sumArgs(2.0, 3.0)));
+    requests.push_back(pva::RPCClient::BatchRequest("fail", sumArgs(2.0, 3.0)));
+    requests.push_back(pva::RPCClient::BatchRequest("nonexistent", sumArgs(2.0, 3.0)));
+
+    const double timeout = 1.5;
+    epicsTime start(epicsTime::getCurrent());
+    size_t ok = pva::RPCClient::requestAll(requests, timeout, pvd::createRequest("field()"), cli_prov);
+    double elapsed = epicsTime::getCurrent() - start;
+
+    testOk(ok == 5 && requests[4].response->getSubFieldT<pvd::PVDouble>("value")->get() == 5.0
+           && !requests[5].status.isSuccess() && !requests[5].response
+           && !requests[6].status.isSuccess(),
+           "%u of %u succeeded, \"%s\", \"%s\"", (unsigned)ok, (unsigned)requests.size(),
+           requests[5].status.getMessage().c_str(), requests[6].status.getMessage().c_str());
+    // 4 slow requests (0.5 s each) and a missing service, bounded by the deadline
+    testOk(elapsed >= timeout - 0.1 && elapsed < timeout + 0.5, "completed in %f s", elapsed);
+}
+
+struct CountingService : public pva::RPCService
+{
+    CountingService() : calls(0) {}
+
+    virtual epics::pvData::PVStructure::shared_pointer request(
+        epics::pvData::PVStructure::shared_pointer const & args
+    ) OVERRIDE FINAL
+    {
+        {
+            pvd::Lock guard(mutex);
+            calls++;
+        }
+        double a = args->getSubFieldT<pvd::PVScalar>("query.lhs")->getAs<double>(),
+               b = args->getSubFieldT<pvd::PVScalar>("query.rhs")->getAs<double>();
+        pvd::PVStructure::shared_pointer reply(pvd::getPVDataCreate()->createPVStructure(reply_type));
+        reply->getSubFieldT<pvd::PVDouble>("value")->put(a+b);
+        return reply;
+    }
+
+    unsigned count()
+    {
+        pvd::Lock guard(mutex);
+        return calls;
+    }
+
+    pvd::Mutex mutex;
+    unsigned calls;
+};
+
+// slow, the value is the number of the call
+struct VersionService : public pva::RPCService
+{
+    VersionService() : calls(0) {}
+
+    virtual epics::pvData::PVStructure::shared_pointer request(
+        epics::pvData::PVStructure::shared_pointer const & /*args*/
+    ) OVERRIDE FINAL
+    {
+        unsigned call;
+        {
+            pvd::Lock guard(mutex);
+            call = ++calls;
+        }
+        epicsThreadSleep(0.5);
+        pvd::PVStructure::shared_pointer reply(pvd::getPVDataCreate()->createPVStructure(reply_type));
+        reply->getSubFieldT<pvd::PVDouble>("value")->put(call);
+        return reply;
+    }
+
+    pvd::Mutex mutex;
+    unsigned calls;
+};
+
+void testCacheInvalidateInFlight(const pva::ChannelProvider::shared_pointer& cli_prov,
+                                 pva::RPCServer& serv)
+{
+    testDiag("Cache invalidated while a call is in progress");
+
+    pva::RPCClient first("versioned", pvd::createRequest("field()"), cli_prov);
+    pva::RPCClient second("versioned", pvd::createRequest("field()"), cli_prov);
+    first.waitConnect();
+    second.waitConnect();
+
+    first.issueRequest(slowArgs("versioned"));
+    epicsThreadSleep(0.2);
+    testOk1(serv.invalidateCache("versioned"));
+    // not coalesced with the stale call
+    second.issueRequest(slowArgs("versioned"));
+
+    double a = first.waitResponse()->getSubFieldT<pvd::PVDouble>("value")->get();
+    double b = second.waitResponse()->getSubFieldT<pvd::PVDouble>("value")->get();
+    testOk(a == 1.0 && b == 2.0, "stale call %f, new call %f", a, b);
+
+    // the stale response is not cached
+    double c = first.request(slowArgs("versioned"))->getSubFieldT<pvd::PVDouble>("value")->get();
+    testOk(c == 2.0, "cached %f", c);
+}
+
+void testCache(const pva::ChannelProvider::shared_pointer& cli_prov,
+               pva::RPCServer& serv, CountingService& service)
+{
+    testDiag("Cache");
+
+    pva::RPCClient client("cached", pvd::createRequest("field()"), cli_prov);
+
+    double first = client.request(sumArgs(1.0, 1.0))->getSubFieldT<pvd::PVDouble>("value")->get();
+    double second = client.request(sumArgs(1.0, 1.0))->getSubFieldT<pvd::PVDouble>("value")->get();
+    testOk(service.count() == 1 && first == 2.0 && second == 2.0,
+           "second request served from the cache, %u call(s)", service.count());
+
+    pva::RPCServer::CacheStats stats;
+    testOk1(serv.getCacheStats("cached", stats) && stats.hits == 1 && stats.misses == 1 && stats.entries == 1);
+
+    testOk1(serv.invalidateCache("cached", sumArgs(1.0, 1.0)));
+    (void)client.request(sumArgs(1.0, 1.0));
+    testOk(service.count() == 2, "invalidated, %u call(s)", service.count());
+
+    // at most 2 entries
+    (void)client.request(sumArgs(2.0, 1.0));
+    (void)client.request(sumArgs(3.0, 1.0));
+    serv.getCacheStats("cached", stats);
+    testOk(stats.entries == 2 && stats.evictions == 1, "%u entries, %u evicted",
+           (unsigned)stats.entries, (unsigned)stats.evictions);
+}
+
 } // namespace
 
 MAIN(testRPC)
 {
-    testPlan(3);
+    testPlan(23);
     try {
         pva::Configuration::shared_pointer conf(pva::ConfigurationBuilder()
                                                 //.push_env()
@@ -120,6 +433,7 @@ MAIN(testRPC)
                                                 .add("EPICS_PVA_AUTO_ADDR_LIST","0")
                                                 .add("EPICS_PVA_SERVER_PORT", "0")
                                                 .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                .add("EPICS_PVAS_WORKER_THREADS", "4")
                                                 .push_map()
                                                 .build());
 
@@ -137,6 +451,19 @@ MAIN(testRPC)
             std::tr1::shared_ptr<pva::RPCService> service(new FailService);
             serv.registerService("fail", service);
         }
+        {
+            std::tr1::shared_ptr<pva::RPCService> service(new SlowService);
+            serv.registerService("slow", service, pva::RPCServer::ExecutionPolicy().workers(4));
+            serv.registerService("slowsync", service);
+            serv.registerService("busy", service, pva::RPCServer::ExecutionPolicy()
+                                                      .workers(1)
+                                                      .maxInFlight(1)
+                                                      .maxQueued(0));
+        }
+        std::tr1::shared_ptr<CountingService> counting(new CountingService);
+        serv.registerService("cached", counting, pva::RPCServer::CachePolicy().maxEntries(2));
+        serv.registerService("versioned", std::tr1::shared_ptr<pva::RPCService>(new VersionService),
+                             pva::RPCServer::ExecutionPolicy().workers(2), pva::RPCServer::CachePolicy());
 
         testDiag("Client Setup");
         pva::ClientFactory::start();
@@ -148,6 +475,13 @@ MAIN(testRPC)
 
         testSum(cli_prov);
         testRPCFail(cli_prov);
+        testWorkers(cli_prov);
+        testRejected(cli_prov);
+        testIssueCollect(cli_prov);
+        testMultiplexed(cli_prov);
+        testCache(cli_prov, serv, *counting);
+        testCacheInvalidateInFlight(cli_prov, serv);
+        testRequestAll(cli_prov);
 
     }catch(std::exception& e){
         PRINT_EXCEPTION(e);
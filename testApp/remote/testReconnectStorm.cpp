@@ -0,0 +1,382 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * Manual benchmark, not a unit test (nothing is asserted, not run by "make runtests").
+ * Restarts a (localhost) server with many clients attached and reports
+ * the rate of channel (re)connects the new server instance has to handle.
+ * Used to compare settings of EPICS_PVA_RECONNECT_SPREAD and EPICS_PVA_MAX_CONNECT_RATE,
+ * the numbers depend on the host and are only meaningful relative to each other.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <sstream>
+
+#include <epicsStdlib.h>
+#include <epicsGetopt.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pv/logger.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/pvAccess.h>
+#include <pv/clientFactory.h>
+#include <pv/serverContext.h>
+#include <pv/configuration.h>
+
+using namespace std;
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+#define DEFAULT_CLIENTS 20
+#define DEFAULT_CHANNELS 100
+#define DEFAULT_TIMEOUT 60.0
+#define DEFAULT_BIN 0.1
+
+namespace {
+
+const char* channelPrefix = "storm:";
+
+/**
+ * Provider hosting channels "storm:<n>", records the time of each channel creation.
+ */
+class StormProvider : public ChannelProvider,
+    public std::tr1::enable_shared_from_this<StormProvider>
+{
+public:
+    POINTER_DEFINITIONS(StormProvider);
+
+    class Find : public ChannelFind
+    {
+    public:
+        explicit Find(StormProvider::shared_pointer const & provider) : m_provider(provider) {}
+        virtual ChannelProvider::shared_pointer getChannelProvider() { return m_provider.lock(); }
+        virtual void cancel() {}
+        virtual void destroy() {}
+    private:
+        StormProvider::weak_pointer m_provider;
+    };
+
+    class StormChannel : public Channel
+    {
+    public:
+        StormChannel(StormProvider::shared_pointer const & provider, string const & name,
+                     ChannelRequester::shared_pointer const & requester) :
+            m_provider(provider), m_name(name), m_requester(requester) {}
+        virtual ChannelProvider::shared_pointer getProvider() { return m_provider; }
+        virtual string getRemoteAddress() { return "storm"; }
+        virtual string getChannelName() { return m_name; }
+        virtual ChannelRequester::shared_pointer getChannelRequester() { return ChannelRequester::shared_pointer(m_requester); }
+        virtual void destroy() {}
+    private:
+        StormProvider::shared_pointer m_provider;
+        const string m_name;
+        ChannelRequester::weak_pointer m_requester;
+    };
+
+    explicit StormProvider(int channels) : m_channels(channels) {}
+
+    virtual string getProviderName() { return "storm"; }
+
+    virtual ChannelFind::shared_pointer channelFind(string const & name,
+            ChannelFindRequester::shared_pointer const & requester)
+    {
+        ChannelFind::shared_pointer find(new Find(shared_from_this()));
+        requester->channelFindResult(Status::Ok, find, hosts(name));
+        return find;
+    }
+
+    virtual Channel::shared_pointer createChannel(string const & name,
+            ChannelRequester::shared_pointer const & requester,
+            short /*priority*/, string const & /*address*/)
+    {
+        Channel::shared_pointer channel;
+        if (!hosts(name))
+        {
+            requester->channelCreated(Status(Status::STATUSTYPE_ERROR, "no such channel"), channel);
+            return channel;
+        }
+
+        {
+            Lock guard(m_mutex);
+            m_created.push_back(epicsTime::getCurrent());
+        }
+
+        channel.reset(new StormChannel(shared_from_this(), name, requester));
+        requester->channelCreated(Status::Ok, channel);
+        return channel;
+    }
+
+    virtual void destroy() {}
+
+    void getCreated(vector<epicsTime>& created)
+    {
+        Lock guard(m_mutex);
+        created = m_created;
+    }
+
+private:
+    bool hosts(string const & name) const
+    {
+        if (name.compare(0, strlen(channelPrefix), channelPrefix) != 0)
+            return false;
+        int n = atoi(name.c_str() + strlen(channelPrefix));
+        return n >= 0 && n < m_channels;
+    }
+
+    const int m_channels;
+    Mutex m_mutex;
+    vector<epicsTime> m_created;
+};
+
+/**
+ * Counts connected channels of all the clients.
+ */
+class ConnectionCounter : public ChannelRequester
+{
+public:
+    POINTER_DEFINITIONS(ConnectionCounter);
+
+    ConnectionCounter() : m_connected(0), m_target(-1) {}
+
+    virtual string getRequesterName() { return "ConnectionCounter"; }
+
+    virtual void channelCreated(const Status& status, Channel::shared_pointer const & /*channel*/)
+    {
+        if (!status.isSuccess())
+            fprintf(stderr, "channel creation failed: %s\n", status.getMessage().c_str());
+    }
+
+    virtual void channelStateChange(Channel::shared_pointer const & /*channel*/, Channel::ConnectionState connectionState)
+    {
+        Lock guard(m_mutex);
+        if (connectionState == Channel::CONNECTED)
+            m_connected++;
+        else if (connectionState == Channel::DISCONNECTED)
+            m_connected--;
+        if (m_connected == m_target)
+            m_event.signal();
+    }
+
+    bool waitFor(int target, double timeout)
+    {
+        {
+            Lock guard(m_mutex);
+            m_target = target;
+            if (m_connected == target)
+                return true;
+        }
+        return m_event.wait(timeout);
+    }
+
+    int connected()
+    {
+        Lock guard(m_mutex);
+        return m_connected;
+    }
+
+private:
+    Mutex m_mutex;
+    Event m_event;
+    int m_connected;
+    int m_target;
+};
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testReconnectStorm [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -c <clients>:      number of client contexts, default is '%d'\n"
+             "  -n <channels>:     number of channels per client, default is '%d'\n"
+             "  -r <rate>:         EPICS_PVA_MAX_CONNECT_RATE of the clients, default is not set\n"
+             "  -s <sec>:          EPICS_PVA_RECONNECT_SPREAD of the clients, default is not set\n"
+             "  -b <sec>:          bin used to compute peak rate, default is %f second(s)\n"
+             "  -w <sec>:          wait time, specifies timeout, default is %f second(s)\n\n"
+             , DEFAULT_CLIENTS, DEFAULT_CHANNELS, DEFAULT_BIN, DEFAULT_TIMEOUT);
+}
+
+ServerContext::shared_pointer startServer(Configuration::shared_pointer const & conf,
+                                          StormProvider::shared_pointer const & provider)
+{
+    return ServerContext::create(ServerContext::Config()
+                                 .config(conf)
+                                 .provider(provider));
+}
+
+void report(vector<epicsTime>& created, epicsTime const & start, double bin)
+{
+    if (created.empty())
+    {
+        printf("no channels created\n");
+        return;
+    }
+
+    std::sort(created.begin(), created.end());
+
+    const double duration = created.back() - start;
+    vector<int> bins(static_cast<size_t>(duration / bin) + 1, 0);
+    for (size_t i = 0; i < created.size(); i++)
+    {
+        double t = created[i] - start;
+        if (t < 0.0)
+            t = 0.0;
+        bins[static_cast<size_t>(t / bin)]++;
+    }
+
+    int peak = 0;
+    for (size_t i = 0; i < bins.size(); i++)
+        if (bins[i] > peak)
+            peak = bins[i];
+
+    printf("channels reconnected: %u\n", (unsigned)created.size());
+    printf("first connect after:  %f s\n", created.front() - start);
+    printf("last connect after:   %f s\n", duration);
+    printf("peak connect rate:    %f connects/s (%d in %f s)\n", peak / bin, peak, bin);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int opt;
+    int clients = DEFAULT_CLIENTS;
+    int channels = DEFAULT_CHANNELS;
+    double timeOut = DEFAULT_TIMEOUT;
+    double bin = DEFAULT_BIN;
+    string maxConnectRate, reconnectSpread;
+
+    setvbuf(stdout,NULL,_IOLBF,BUFSIZ);    // Set stdout to line buffering
+
+    while ((opt = getopt(argc, argv, ":hc:n:r:s:b:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'c':
+            clients = atoi(optarg);
+            break;
+        case 'n':
+            channels = atoi(optarg);
+            break;
+        case 'r':
+            maxConnectRate = optarg;
+            break;
+        case 's':
+            reconnectSpread = optarg;
+            break;
+        case 'b':
+            if (epicsScanDouble(optarg, &bin) != 1 || bin <= 0.0)
+                bin = DEFAULT_BIN;
+            break;
+        case 'w':
+            if (epicsScanDouble(optarg, &timeOut) != 1)
+                timeOut = DEFAULT_TIMEOUT;
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'. ('testReconnectStorm -h' for help.)\n", optopt);
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument. ('testReconnectStorm -h' for help.)\n", optopt);
+            return 1;
+        default :
+            usage();
+            return 1;
+        }
+    }
+
+    SET_LOG_LEVEL(logLevelError);
+
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .push_map()
+                                       .build());
+
+    StormProvider::shared_pointer provider(new StormProvider(channels));
+    ServerContext::shared_pointer server(startServer(conf, provider));
+
+    // restarted server has to use the same ports
+    Configuration::shared_pointer serverConf(server->getCurrentConfig());
+
+    ConfigurationBuilder clientConfBuilder;
+    clientConfBuilder.push_config(serverConf);
+    if (!maxConnectRate.empty())
+        clientConfBuilder.add("EPICS_PVA_MAX_CONNECT_RATE", maxConnectRate);
+    if (!reconnectSpread.empty())
+        clientConfBuilder.add("EPICS_PVA_RECONNECT_SPREAD", reconnectSpread);
+    Configuration::shared_pointer clientConf(clientConfBuilder.push_map().build());
+
+    printf("%d clients, %d channels each, server on ports TCP=%u UDP=%u\n",
+           clients, channels, server->getServerPort(), server->getBroadcastPort());
+
+    ClientFactory::start();
+
+    ConnectionCounter::shared_pointer counter(new ConnectionCounter());
+    vector<ChannelProvider::shared_pointer> clientProviders;
+    vector<Channel::shared_pointer> clientChannels;
+    for (int c = 0; c < clients; c++)
+    {
+        ChannelProvider::shared_pointer client(ChannelProviderRegistry::clients()->createProvider("pva", clientConf));
+        if (!client)
+        {
+            fprintf(stderr, "no pva provider\n");
+            return 1;
+        }
+        clientProviders.push_back(client);
+
+        for (int n = 0; n < channels; n++)
+        {
+            std::ostringstream name;
+            name << channelPrefix << n;
+            clientChannels.push_back(client->createChannel(name.str(), counter));
+        }
+    }
+
+    const int total = clients * channels;
+    if (!counter->waitFor(total, timeOut))
+    {
+        fprintf(stderr, "initial connect timed out, %d of %d connected\n", counter->connected(), total);
+        return 2;
+    }
+    printf("all %d channels connected, restarting server\n", total);
+
+    server.reset();
+    provider.reset();
+
+    if (!counter->waitFor(0, timeOut))
+        fprintf(stderr, "not all channels disconnected, %d still connected\n", counter->connected());
+
+    epicsThreadSleep(1.0);
+
+    epicsTime start(epicsTime::getCurrent());
+    provider.reset(new StormProvider(channels));
+    server = startServer(serverConf, provider);
+
+    bool ok = counter->waitFor(total, timeOut);
+    if (!ok)
+        fprintf(stderr, "reconnect timed out, %d of %d connected\n", counter->connected(), total);
+
+    vector<epicsTime> created;
+    provider->getCreated(created);
+    report(created, start, bin);
+
+    clientChannels.clear();
+    clientProviders.clear();
+    server.reset();
+
+    return ok ? 0 : 2;
+}
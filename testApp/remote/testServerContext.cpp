@@ -2,7 +2,17 @@
  * testServerContext.cpp
  */
 
+#include <string.h>
+
+#include <osiSock.h>
+#include <epicsThread.h>
+#include <pv/byteBuffer.h>
+#include <pv/pvaConstants.h>
+#include <pv/remote.h>
 #include <pv/serverContext.h>
+#include <pv/serverContextImpl.h>
+#include <pv/configuration.h>
+#include <pv/rpcServer.h>
 #include <epicsExit.h>
 #include <testMain.h>
 
@@ -61,6 +71,88 @@ public:
     }
 };
 
+/**
+ * Provider with a channel list, or with dynamic names, or without channelList().
+ */
+class ListChannelProvider : public TestChannelProvider
+{
+public:
+    enum List { listed, dynamic, unlisted };
+
+    explicit ListChannelProvider(List list) : _list(list) {}
+
+    ChannelFind::shared_pointer channelList(ChannelListRequester::shared_pointer const & channelListRequester)
+    {
+        if (_list == unlisted)
+            return ChannelProvider::channelList(channelListRequester);
+
+        ChannelFind::shared_pointer nullCF;
+        PVStringArray::svector names;
+        names.push_back("listed");
+        channelListRequester->channelListResult(Status::Ok, nullCF, freeze(names), _list == dynamic);
+        return nullCF;
+    }
+
+private:
+    const List _list;
+};
+
+Configuration::shared_pointer beaconFilterConfig()
+{
+    return ConfigurationBuilder()
+           .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+           .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+           .add("EPICS_PVA_SERVER_PORT", "0")
+           .add("EPICS_PVA_BROADCAST_PORT", "0")
+           .add("EPICS_PVAS_BEACON_FILTER_FPP", "0.01")
+           .push_map()
+           .build();
+}
+
+bool hasBeaconFilter(ServerContext::shared_pointer const & ctx)
+{
+    std::tr1::shared_ptr<ServerContextImpl> impl(std::tr1::dynamic_pointer_cast<ServerContextImpl>(ctx));
+    if (!impl)
+        testAbort("ServerContext is not a ServerContextImpl");
+    impl->beaconChannelListChanged();
+    impl->refreshBeaconChannelFilter();
+    return !!impl->getBeaconChannelFilterData();
+}
+
+class NullService : public RPCService
+{
+public:
+    PVStructure::shared_pointer request(PVStructure::shared_pointer const & args)
+    {
+        return args;
+    }
+};
+
+void testBeaconFilter()
+{
+    testDiag("Test no beacon channel filter for providers with names they can not list");
+
+    static const char* names[] = { "listed", "dynamic", "unlisted" };
+    for (int list = ListChannelProvider::listed; list <= ListChannelProvider::unlisted; list++)
+    {
+        ChannelProvider::shared_pointer prov(new ListChannelProvider(ListChannelProvider::List(list)));
+        ServerContext::shared_pointer ctx(ServerContext::create(ServerContext::Config()
+                                                                    .config(beaconFilterConfig())
+                                                                    .provider(prov)));
+        testOk(hasBeaconFilter(ctx) == (list == ListChannelProvider::listed), "%s channels: filter %s",
+               names[list], list == ListChannelProvider::listed ? "advertised" : "not advertised");
+    }
+
+    RPCServer server(beaconFilterConfig());
+    RPCService::shared_pointer service(new NullService());
+    server.registerService("plain", service);
+    testOk(hasBeaconFilter(server.getServer()), "RPC services: filter advertised");
+    server.registerService("svc*", service);
+    testOk(!hasBeaconFilter(server.getServer()), "RPC wildcard service: filter not advertised");
+    server.unregisterService("svc*");
+    testOk(hasBeaconFilter(server.getServer()), "RPC wildcard service removed: filter advertised");
+}
+
 void testServerContext()
 {
     ChannelProvider::shared_pointer prov(new TestChannelProvider);
@@ -79,11 +171,217 @@ void testServerContext()
     testOk(!wctx.lock(), "# ServerContext cleanup leaves use_count=%u", (unsigned)wctx.use_count());
 }
 
+void testSearchRateLimit()
+{
+    ChannelProvider::shared_pointer prov(new TestChannelProvider);
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .add("EPICS_PVAS_SEARCH_RATE", "1")
+                                       .add("EPICS_PVAS_SEARCH_BURST", "20")
+                                       .push_map()
+                                       .build());
+    ServerContext::shared_pointer ctx(ServerContext::create(ServerContext::Config()
+                                                                .config(conf)
+                                                                .provider(prov)));
+    std::tr1::shared_ptr<ServerContextImpl> impl(std::tr1::dynamic_pointer_cast<ServerContextImpl>(ctx));
+    if (!impl)
+        testAbort("ServerContext is not a ServerContextImpl");
+
+    osiSockAddr client1, client2;
+    memset(&client1, 0, sizeof(client1));
+    client1.ia.sin_family = AF_INET;
+    client1.ia.sin_addr.s_addr = htonl(0x0A000001);
+    client2 = client1;
+    client2.ia.sin_addr.s_addr = htonl(0x0A000002);
+
+    testOk1(impl->acquireSearchTokens(client1, 15) == 15);
+    testOk1(impl->acquireSearchTokens(client1, 10) == 5);
+    testOk1(impl->acquireSearchTokens(client1, 1) == 0);
+    testOk1(impl->acquireSearchTokens(client2, 10) == 10);
+    testOk1(impl->getDroppedSearchCount() == 6);
+}
+
+// send a search of one name, by default unicast with the reply going to the sending socket
+void sendSearch(SOCKET sock, const osiSockAddr& to, int32 seq,
+                uint32 responseAddress = 0, bool unicast = true)
+{
+    ByteBuffer buffer(128, EPICS_ENDIAN_BIG);
+    buffer.putByte(PVA_MAGIC);
+    buffer.putByte(PVA_PROTOCOL_REVISION);
+    buffer.putByte((int8)0x80);    // big endian client message
+    buffer.putByte((int8)CMD_SEARCH);
+    buffer.putInt(0);              // payload size, set below
+
+    buffer.putInt(seq);
+    buffer.putByte((int8)(unicast ? 0x81 : 0x01));    // (unicast,) reply required
+    buffer.putByte(0);
+    buffer.putShort(0);
+    buffer.putLong(0);             // response address: IPv4 mapped IPv6, any is the source address
+    buffer.putShort(0);
+    buffer.putShort(responseAddress ? (int16)0xFFFF : 0);
+    buffer.putInt((int32)responseAddress);
+    buffer.putShort(0);            // port 0 (source port)
+    buffer.putByte(1);             // protocols
+    buffer.putByte(3);
+    buffer.put("tcp", 0, 3);
+    buffer.putShort(1);            // names
+    buffer.putInt(seq);
+    buffer.putByte(4);
+    buffer.put("test", 0, 4);
+    buffer.putInt(4, buffer.getPosition() - PVA_MESSAGE_HEADER_SIZE);
+
+    sendto(sock, buffer.getArray(), buffer.getPosition(), 0, &to.sa, sizeof(to.ia));
+}
+
+SOCKET clientSocket(const char* address)
+{
+    SOCKET sock = epicsSocketCreate(AF_INET, SOCK_DGRAM, 0);
+    osiSockAddr bindAddr;
+    memset(&bindAddr, 0, sizeof(bindAddr));
+    aToIPAddr(address, 0, &bindAddr.ia);
+    if (sock != INVALID_SOCKET && bind(sock, &bindAddr.sa, sizeof(bindAddr.ia)) != 0)
+    {
+        epicsSocketDestroy(sock);
+        sock = INVALID_SOCKET;
+    }
+    return sock;
+}
+
+void testForwardedSearchRate()
+{
+    testDiag("Test search rate limit of unicast (forwarded) searches");
+
+    ChannelProvider::shared_pointer prov(new TestChannelProvider);
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .add("EPICS_PVAS_SEARCH_RATE", "0.1")
+                                       .add("EPICS_PVAS_SEARCH_BURST", "5")
+                                       .push_map()
+                                       .build());
+    ServerContext::shared_pointer ctx(ServerContext::create(ServerContext::Config()
+                                                                .config(conf)
+                                                                .provider(prov)));
+    std::tr1::shared_ptr<ServerContextImpl> impl(std::tr1::dynamic_pointer_cast<ServerContextImpl>(ctx));
+    if (!impl)
+        testAbort("ServerContext is not a ServerContextImpl");
+
+    osiSockAddr server;
+    memset(&server, 0, sizeof(server));
+    aToIPAddr("127.0.0.1", ctx->getBroadcastPort(), &server.ia);
+
+    // two clients on different (loopback) addresses, searches forwarded
+    // to the local multicast group all arrive from 127.0.0.1
+    SOCKET client1 = clientSocket("127.0.0.2");
+    SOCKET client2 = clientSocket("127.0.0.3");
+    epics::pvData::uint64 dropped1 = 0;
+    if (client1 != INVALID_SOCKET && client2 != INVALID_SOCKET)
+    {
+        for (int32 i = 0; i < 8; i++)
+            sendSearch(client1, server, i);
+        epicsThreadSleep(0.5);
+        dropped1 = impl->getDroppedSearchCount();
+    }
+
+    if (client1 == INVALID_SOCKET || client2 == INVALID_SOCKET)
+    {
+        testSkip(3, "127.0.0.2/3 not available");
+    }
+    else if (dropped1 == 0)
+    {
+        testSkip(3, "searches not processed (no local multicast)");
+    }
+    else
+    {
+        testOk(dropped1 == 3, "over the limit of the 1st client: %u", (unsigned)dropped1);
+
+        for (int32 i = 0; i < 5; i++)
+            sendSearch(client2, server, i);
+        epicsThreadSleep(0.5);
+        epics::pvData::uint64 dropped2 = impl->getDroppedSearchCount();
+        testOk(dropped2 == dropped1, "2nd client not charged for the 1st: %u", (unsigned)(dropped2 - dropped1));
+
+        sendSearch(client1, server, 8);
+        epicsThreadSleep(0.5);
+        testOk(impl->getDroppedSearchCount() == dropped2 + 1, "1st client still limited");
+    }
+
+    if (client1 != INVALID_SOCKET)
+        epicsSocketDestroy(client1);
+    if (client2 != INVALID_SOCKET)
+        epicsSocketDestroy(client2);
+}
+
+void testRotatingResponseAddress()
+{
+    testDiag("Test search rate limit of a client rotating its response address");
+
+    ChannelProvider::shared_pointer prov(new TestChannelProvider);
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .add("EPICS_PVAS_SEARCH_RATE", "0.1")
+                                       .add("EPICS_PVAS_SEARCH_BURST", "5")
+                                       .push_map()
+                                       .build());
+    ServerContext::shared_pointer ctx(ServerContext::create(ServerContext::Config()
+                                                                .config(conf)
+                                                                .provider(prov)));
+    std::tr1::shared_ptr<ServerContextImpl> impl(std::tr1::dynamic_pointer_cast<ServerContextImpl>(ctx));
+    if (!impl)
+        testAbort("ServerContext is not a ServerContextImpl");
+
+    osiSockAddr server;
+    memset(&server, 0, sizeof(server));
+    aToIPAddr("127.0.0.1", ctx->getBroadcastPort(), &server.ia);
+
+    // replies go to 127.0.0.10 - 127.0.0.17, where nobody listens
+    SOCKET client1 = clientSocket("127.0.0.4");
+    SOCKET client2 = clientSocket("127.0.0.5");
+    if (client1 == INVALID_SOCKET || client2 == INVALID_SOCKET)
+    {
+        testSkip(2, "127.0.0.4/5 not available");
+    }
+    else
+    {
+        // processed directly
+        for (int32 i = 0; i < 8; i++)
+            sendSearch(client1, server, i, 0x7F00000A + i, false);
+        epicsThreadSleep(0.5);
+        epics::pvData::uint64 dropped1 = impl->getDroppedSearchCount();
+        testOk(dropped1 == 3, "direct searches limited: %u dropped", (unsigned)dropped1);
+
+        // forwarded to the local multicast group (if available)
+        for (int32 i = 0; i < 8; i++)
+            sendSearch(client2, server, i, 0x7F00000A + i);
+        epicsThreadSleep(0.5);
+        epics::pvData::uint64 dropped2 = impl->getDroppedSearchCount();
+        testOk(dropped2 - dropped1 == 3, "unicast searches limited: %u dropped", (unsigned)(dropped2 - dropped1));
+    }
+
+    if (client1 != INVALID_SOCKET)
+        epicsSocketDestroy(client1);
+    if (client2 != INVALID_SOCKET)
+        epicsSocketDestroy(client2);
+}
+
 MAIN(testServerContext)
 {
     testPlan(0);
+    osiSockAttach();
 
     testServerContext();
+    testSearchRateLimit();
+    testForwardedSearchRate();
+    testRotatingResponseAddress();
+    testBeaconFilter();
 
     return testDone();
 }
@@ -0,0 +1,272 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * An in-process server stops answering a connection (its receive thread
+ * blocks in createChannel()), the client has to close the transport within
+ * EPICS_PVA_LIVENESS_TMO and reconnect the channel on a new one.
+ */
+
+#include <string>
+#include <sstream>
+
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/pvAccess.h>
+#include <pv/clientFactory.h>
+#include <pv/serverContext.h>
+#include <pv/configuration.h>
+
+using namespace std;
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+namespace {
+
+const double heartbeatPeriod = 0.2;
+const double livenessTimeout = 0.6;
+
+const char* aliveName = "alive";
+const char* blockName = "block";
+
+/**
+ * Provider hosting two channels, the first creation of blockName
+ * blocks (the server receive thread) until released.
+ */
+class BlockingProvider : public ChannelProvider,
+    public std::tr1::enable_shared_from_this<BlockingProvider>
+{
+public:
+    POINTER_DEFINITIONS(BlockingProvider);
+
+    class Find : public ChannelFind
+    {
+    public:
+        explicit Find(BlockingProvider::shared_pointer const & provider) : m_provider(provider) {}
+        virtual ChannelProvider::shared_pointer getChannelProvider() { return m_provider.lock(); }
+        virtual void cancel() {}
+        virtual void destroy() {}
+    private:
+        BlockingProvider::weak_pointer m_provider;
+    };
+
+    class SimpleChannel : public Channel
+    {
+    public:
+        SimpleChannel(BlockingProvider::shared_pointer const & provider,
+                      string const & name,
+                      ChannelRequester::shared_pointer const & requester) :
+            m_provider(provider), m_name(name), m_requester(requester) {}
+        virtual ChannelProvider::shared_pointer getProvider() { return m_provider; }
+        virtual string getRemoteAddress() { return "local"; }
+        virtual string getChannelName() { return m_name; }
+        virtual ChannelRequester::shared_pointer getChannelRequester() { return ChannelRequester::shared_pointer(m_requester); }
+        virtual void destroy() {}
+    private:
+        BlockingProvider::shared_pointer m_provider;
+        string m_name;
+        ChannelRequester::weak_pointer m_requester;
+    };
+
+    BlockingProvider() : m_blocked(false) {}
+
+    virtual string getProviderName() { return "blocking"; }
+
+    virtual ChannelFind::shared_pointer channelFind(string const & name,
+            ChannelFindRequester::shared_pointer const & requester)
+    {
+        ChannelFind::shared_pointer find(new Find(shared_from_this()));
+        requester->channelFindResult(Status::Ok, find, name == aliveName || name == blockName);
+        return find;
+    }
+
+    virtual Channel::shared_pointer createChannel(string const & name,
+            ChannelRequester::shared_pointer const & requester,
+            short /*priority*/, string const & /*address*/)
+    {
+        Channel::shared_pointer channel;
+        if (name != aliveName && name != blockName)
+        {
+            requester->channelCreated(Status(Status::STATUSTYPE_ERROR, "no such channel"), channel);
+            return channel;
+        }
+
+        if (name == blockName)
+        {
+            bool block;
+            {
+                Lock guard(m_mutex);
+                block = !m_blocked;
+                m_blocked = true;
+            }
+
+            if (block)
+            {
+                m_blockStarted.signal();
+                m_release.wait(30.0);
+            }
+        }
+
+        channel.reset(new SimpleChannel(shared_from_this(), name, requester));
+        requester->channelCreated(Status::Ok, channel);
+        return channel;
+    }
+
+    virtual void destroy() {}
+
+    bool waitBlocked(double timeout) {
+        return m_blockStarted.wait(timeout);
+    }
+
+    void release() {
+        m_release.signal();
+    }
+
+private:
+    Mutex m_mutex;
+    bool m_blocked;
+    Event m_blockStarted;
+    Event m_release;
+};
+
+/**
+ * Records the time of the channel state changes.
+ */
+class StateMonitor : public ChannelRequester
+{
+public:
+    POINTER_DEFINITIONS(StateMonitor);
+
+    StateMonitor() : m_state(Channel::NEVER_CONNECTED) {}
+
+    virtual string getRequesterName() { return "StateMonitor"; }
+
+    virtual void channelCreated(const Status& status, Channel::shared_pointer const & /*channel*/)
+    {
+        if (!status.isSuccess())
+            testDiag("channel creation failed: %s", status.getMessage().c_str());
+    }
+
+    virtual void channelStateChange(Channel::shared_pointer const & /*channel*/, Channel::ConnectionState connectionState)
+    {
+        {
+            Lock guard(m_mutex);
+            m_state = connectionState;
+            m_changed = epicsTime::getCurrent();
+        }
+        m_event.signal();
+    }
+
+    bool waitFor(Channel::ConnectionState state, double timeout, epicsTime& changed)
+    {
+        epicsTime end(epicsTime::getCurrent() + timeout);
+        while (true)
+        {
+            {
+                Lock guard(m_mutex);
+                if (m_state == state)
+                {
+                    changed = m_changed;
+                    return true;
+                }
+            }
+            double left = end - epicsTime::getCurrent();
+            if (left <= 0.0 || !m_event.wait(left))
+                return false;
+        }
+    }
+
+private:
+    Mutex m_mutex;
+    Event m_event;
+    Channel::ConnectionState m_state;
+    epicsTime m_changed;
+};
+
+void testUnresponsiveServer()
+{
+    testDiag("Test disconnect and reconnect of a channel of an unresponsive server");
+
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .push_map()
+                                       .build());
+
+    BlockingProvider::shared_pointer provider(new BlockingProvider());
+    ServerContext::shared_pointer server(ServerContext::create(ServerContext::Config()
+                                         .config(conf)
+                                         .provider(provider)));
+
+    std::ostringstream heartbeat, liveness;
+    heartbeat << heartbeatPeriod;
+    liveness << livenessTimeout;
+
+    Configuration::shared_pointer clientConf(ConfigurationBuilder()
+                                             .push_config(server->getCurrentConfig())
+                                             .add("EPICS_PVA_HEARTBEAT_PERIOD", heartbeat.str())
+                                             .add("EPICS_PVA_LIVENESS_TMO", liveness.str())
+                                             .push_map()
+                                             .build());
+
+    ClientFactory::start();
+    ChannelProvider::shared_pointer client(ChannelProviderRegistry::clients()->createProvider("pva", clientConf));
+    if (!client)
+        testAbort("no pva provider");
+
+    StateMonitor::shared_pointer aliveMonitor(new StateMonitor());
+    Channel::shared_pointer alive(client->createChannel(aliveName, aliveMonitor));
+
+    epicsTime changed;
+    testOk(aliveMonitor->waitFor(Channel::CONNECTED, 5.0, changed), "channel connected");
+
+    // the server stops reading from the connection
+    StateMonitor::shared_pointer blockMonitor(new StateMonitor());
+    Channel::shared_pointer block(client->createChannel(blockName, blockMonitor));
+    bool blocked = provider->waitBlocked(5.0);
+    epicsTime stopped(epicsTime::getCurrent());
+    testOk(blocked, "server stopped answering");
+
+    // no traffic since (before) stopped, one echo after heartbeatPeriod,
+    // the transport is closed after livenessTimeout (sweeps every heartbeatPeriod/4)
+    const double bound = livenessTimeout + heartbeatPeriod + 1.0;
+    if (blocked && aliveMonitor->waitFor(Channel::DISCONNECTED, bound, changed))
+    {
+        double elapsed = changed - stopped;
+        testOk(elapsed <= bound, "disconnected after %f s (bound %f s)", elapsed, bound);
+    }
+    else
+    {
+        testFail("not disconnected within %f s", bound);
+    }
+
+    // the blocked receive thread of the old connection can finish
+    provider->release();
+
+    testOk(aliveMonitor->waitFor(Channel::CONNECTED, 10.0, changed), "channel reconnected");
+
+    block->destroy();
+    alive->destroy();
+    client->destroy();
+    server->shutdown();
+}
+
+} // namespace
+
+MAIN(testServerLiveness)
+{
+    testPlan(4);
+    testUnresponsiveServer();
+    return testDone();
+}
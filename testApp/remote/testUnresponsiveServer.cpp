@@ -0,0 +1,356 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * Freezes a (localhost) server process with SIGSTOP and measures how long
+ * it takes the client to notice and disconnect the channel.
+ * Used to check EPICS_PVA_HEARTBEAT_PERIOD and EPICS_PVA_LIVENESS_TMO.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <sstream>
+
+#include <epicsStdlib.h>
+#include <epicsGetopt.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pv/logger.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/pvAccess.h>
+#include <pv/clientFactory.h>
+#include <pv/serverContext.h>
+#include <pv/configuration.h>
+
+using namespace std;
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+#define DEFAULT_HEARTBEAT 1.0
+#define DEFAULT_TIMEOUT 30.0
+
+namespace {
+
+const char* channelName = "frozen";
+
+/**
+ * Provider hosting a single channel.
+ */
+class FrozenProvider : public ChannelProvider,
+    public std::tr1::enable_shared_from_this<FrozenProvider>
+{
+public:
+    POINTER_DEFINITIONS(FrozenProvider);
+
+    class Find : public ChannelFind
+    {
+    public:
+        explicit Find(FrozenProvider::shared_pointer const & provider) : m_provider(provider) {}
+        virtual ChannelProvider::shared_pointer getChannelProvider() { return m_provider.lock(); }
+        virtual void cancel() {}
+        virtual void destroy() {}
+    private:
+        FrozenProvider::weak_pointer m_provider;
+    };
+
+    class FrozenChannel : public Channel
+    {
+    public:
+        FrozenChannel(FrozenProvider::shared_pointer const & provider,
+                      ChannelRequester::shared_pointer const & requester) :
+            m_provider(provider), m_requester(requester) {}
+        virtual ChannelProvider::shared_pointer getProvider() { return m_provider; }
+        virtual string getRemoteAddress() { return "frozen"; }
+        virtual string getChannelName() { return channelName; }
+        virtual ChannelRequester::shared_pointer getChannelRequester() { return ChannelRequester::shared_pointer(m_requester); }
+        virtual void destroy() {}
+    private:
+        FrozenProvider::shared_pointer m_provider;
+        ChannelRequester::weak_pointer m_requester;
+    };
+
+    virtual string getProviderName() { return "frozen"; }
+
+    virtual ChannelFind::shared_pointer channelFind(string const & name,
+            ChannelFindRequester::shared_pointer const & requester)
+    {
+        ChannelFind::shared_pointer find(new Find(shared_from_this()));
+        requester->channelFindResult(Status::Ok, find, name == channelName);
+        return find;
+    }
+
+    virtual Channel::shared_pointer createChannel(string const & name,
+            ChannelRequester::shared_pointer const & requester,
+            short /*priority*/, string const & /*address*/)
+    {
+        Channel::shared_pointer channel;
+        if (name != channelName)
+        {
+            requester->channelCreated(Status(Status::STATUSTYPE_ERROR, "no such channel"), channel);
+            return channel;
+        }
+
+        channel.reset(new FrozenChannel(shared_from_this(), requester));
+        requester->channelCreated(Status::Ok, channel);
+        return channel;
+    }
+
+    virtual void destroy() {}
+};
+
+/**
+ * Records the time of the channel state changes.
+ */
+class StateMonitor : public ChannelRequester
+{
+public:
+    POINTER_DEFINITIONS(StateMonitor);
+
+    StateMonitor() : m_state(Channel::NEVER_CONNECTED) {}
+
+    virtual string getRequesterName() { return "StateMonitor"; }
+
+    virtual void channelCreated(const Status& status, Channel::shared_pointer const & /*channel*/)
+    {
+        if (!status.isSuccess())
+            fprintf(stderr, "channel creation failed: %s\n", status.getMessage().c_str());
+    }
+
+    virtual void channelStateChange(Channel::shared_pointer const & /*channel*/, Channel::ConnectionState connectionState)
+    {
+        {
+            Lock guard(m_mutex);
+            m_state = connectionState;
+            m_changed = epicsTime::getCurrent();
+        }
+        m_event.signal();
+    }
+
+    bool waitFor(Channel::ConnectionState state, double timeout, epicsTime& changed)
+    {
+        epicsTime end(epicsTime::getCurrent() + timeout);
+        while (true)
+        {
+            {
+                Lock guard(m_mutex);
+                if (m_state == state)
+                {
+                    changed = m_changed;
+                    return true;
+                }
+            }
+            double left = end - epicsTime::getCurrent();
+            if (left <= 0.0 || !m_event.wait(left))
+                return false;
+        }
+    }
+
+private:
+    Mutex m_mutex;
+    Event m_event;
+    Channel::ConnectionState m_state;
+    epicsTime m_changed;
+};
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testUnresponsiveServer [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -b <sec>:          EPICS_PVA_HEARTBEAT_PERIOD of the client, default is %f second(s)\n"
+             "  -l <sec>:          EPICS_PVA_LIVENESS_TMO of the client, default is 2 x heartbeat period\n"
+             "  -w <sec>:          wait time, specifies timeout, default is %f second(s)\n\n"
+             , DEFAULT_HEARTBEAT, DEFAULT_TIMEOUT);
+}
+
+/**
+ * Runs the server in the (forked) child process, reports its broadcast port
+ * through the pipe and waits to be killed.
+ */
+void runServer(int fd)
+{
+    Configuration::shared_pointer conf(ConfigurationBuilder()
+                                       .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                       .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                       .add("EPICS_PVA_SERVER_PORT", "0")
+                                       .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                       .push_map()
+                                       .build());
+
+    FrozenProvider::shared_pointer provider(new FrozenProvider());
+    ServerContext::shared_pointer server(ServerContext::create(ServerContext::Config()
+                                         .config(conf)
+                                         .provider(provider)));
+
+    unsigned short port = server->getBroadcastPort();
+    if (write(fd, &port, sizeof(port)) != (ssize_t)sizeof(port))
+        _exit(1);
+    close(fd);
+
+    while (true)
+        epicsThreadSleep(1000.0);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int opt;
+    double heartbeat = DEFAULT_HEARTBEAT;
+    double liveness = -1.0;
+    double timeOut = DEFAULT_TIMEOUT;
+
+    setvbuf(stdout,NULL,_IOLBF,BUFSIZ);    // Set stdout to line buffering
+
+    while ((opt = getopt(argc, argv, ":hb:l:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'b':
+            if (epicsScanDouble(optarg, &heartbeat) != 1 || heartbeat <= 0.0)
+                heartbeat = DEFAULT_HEARTBEAT;
+            break;
+        case 'l':
+            if (epicsScanDouble(optarg, &liveness) != 1)
+                liveness = -1.0;
+            break;
+        case 'w':
+            if (epicsScanDouble(optarg, &timeOut) != 1)
+                timeOut = DEFAULT_TIMEOUT;
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'. ('testUnresponsiveServer -h' for help.)\n", optopt);
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument. ('testUnresponsiveServer -h' for help.)\n", optopt);
+            return 1;
+        default :
+            usage();
+            return 1;
+        }
+    }
+
+    if (liveness <= heartbeat)
+        liveness = 2 * heartbeat;
+
+    SET_LOG_LEVEL(logLevelError);
+
+    // fork before any thread is started
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        fprintf(stderr, "pipe() failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    pid_t server = fork();
+    if (server < 0)
+    {
+        fprintf(stderr, "fork() failed: %s\n", strerror(errno));
+        return 1;
+    }
+    else if (server == 0)
+    {
+        close(fds[0]);
+        runServer(fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    unsigned short port = 0;
+    bool started = read(fds[0], &port, sizeof(port)) == (ssize_t)sizeof(port);
+    close(fds[0]);
+    if (!started)
+    {
+        fprintf(stderr, "server failed to start\n");
+        kill(server, SIGKILL);
+        waitpid(server, NULL, 0);
+        return 1;
+    }
+
+    std::ostringstream broadcastPort, heartbeatPeriod, livenessTimeout;
+    broadcastPort << port;
+    heartbeatPeriod << heartbeat;
+    livenessTimeout << liveness;
+
+    Configuration::shared_pointer clientConf(ConfigurationBuilder()
+                                             .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                             .add("EPICS_PVA_AUTO_ADDR_LIST", "0")
+                                             .add("EPICS_PVA_BROADCAST_PORT", broadcastPort.str())
+                                             .add("EPICS_PVA_HEARTBEAT_PERIOD", heartbeatPeriod.str())
+                                             .add("EPICS_PVA_LIVENESS_TMO", livenessTimeout.str())
+                                             .push_map()
+                                             .build());
+
+    printf("server pid %d on UDP port %u, heartbeat period %f s, liveness timeout %f s\n",
+           (int)server, port, heartbeat, liveness);
+
+    ClientFactory::start();
+
+    int ret = 0;
+    {
+        ChannelProvider::shared_pointer client(ChannelProviderRegistry::clients()->createProvider("pva", clientConf));
+        if (!client)
+        {
+            fprintf(stderr, "no pva provider\n");
+            kill(server, SIGKILL);
+            waitpid(server, NULL, 0);
+            return 1;
+        }
+
+        StateMonitor::shared_pointer monitor(new StateMonitor());
+        Channel::shared_pointer channel(client->createChannel(channelName, monitor));
+
+        epicsTime changed;
+        if (!monitor->waitFor(Channel::CONNECTED, timeOut, changed))
+        {
+            fprintf(stderr, "connect timed out\n");
+            ret = 2;
+        }
+        else
+        {
+            kill(server, SIGSTOP);
+            epicsTime stopped(epicsTime::getCurrent());
+            printf("connected, server stopped\n");
+
+            if (!monitor->waitFor(Channel::DISCONNECTED, timeOut, changed))
+            {
+                fprintf(stderr, "disconnect not detected within %f s\n", timeOut);
+                ret = 2;
+            }
+            else
+            {
+                // sweep resolution (1/4 of the heartbeat period), plus some scheduling slack
+                const double bound = liveness + heartbeat / 4 + 0.1;
+                const double latency = changed - stopped;
+                printf("disconnect detected after: %f s (bound %f s)\n", latency, bound);
+                if (latency > bound)
+                    ret = 2;
+            }
+        }
+
+        channel->destroy();
+        client->destroy();
+    }
+
+    kill(server, SIGKILL);
+    waitpid(server, NULL, 0);
+
+    return ret;
+}
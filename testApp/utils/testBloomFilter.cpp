@@ -0,0 +1,109 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <sstream>
+
+#include <pv/bloomFilter.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using epics::pvAccess::BloomFilter;
+
+namespace {
+
+std::string channelName(const char* prefix, int i)
+{
+    std::ostringstream strm;
+    strm << prefix << i;
+    return strm.str();
+}
+
+void testEmpty()
+{
+    testDiag("Test testEmpty()");
+
+    BloomFilter filter;
+    testOk1(filter.empty());
+    testOk1(!filter.mightContain("anything"));
+    testOk1(filter.count() == 0);
+}
+
+void testMembership()
+{
+    testDiag("Test testMembership()");
+
+    const int N = 1000;
+    BloomFilter filter(N, 0.01);
+    testOk1(!filter.empty());
+    testOk1(filter.getHashCount() > 0);
+
+    for (int i = 0; i < N; i++)
+        filter.add(channelName("ioc:pv", i));
+    testOk1(filter.count() == (size_t)N);
+
+    int misses = 0;
+    for (int i = 0; i < N; i++)
+        if (!filter.mightContain(channelName("ioc:pv", i)))
+            misses++;
+    testOk(misses == 0, "no false negatives (%d)", misses);
+
+    int falsePositives = 0;
+    for (int i = 0; i < 10*N; i++)
+        if (filter.mightContain(channelName("other:pv", i)))
+            falsePositives++;
+    // 1% expected (100), allow for some slack
+    testOk(falsePositives < 2*N/10, "false-positive count %d of %d", falsePositives, 10*N);
+
+    testOk1(filter.mightContain(BloomFilter::Hash("ioc:pv0")));
+
+    filter.clear();
+    testOk1(!filter.mightContain("ioc:pv0"));
+}
+
+void testMaxBytes()
+{
+    testDiag("Test testMaxBytes()");
+
+    BloomFilter filter(100000, 0.001, 1024);
+    testOk1(filter.getBits().size() <= 1024);
+
+    filter.add("ioc:pv");
+    testOk1(filter.mightContain("ioc:pv"));
+}
+
+void testEncoded()
+{
+    testDiag("Test testEncoded()");
+
+    BloomFilter filter(100, 0.01);
+    filter.add("ioc:a");
+    filter.add("ioc:b");
+
+    BloomFilter copy(filter.getBits(), filter.getHashCount());
+    testOk1(copy.getBits() == filter.getBits());
+    testOk1(copy.mightContain("ioc:a"));
+    testOk1(copy.mightContain("ioc:b"));
+
+    BloomFilter empty;
+    empty.swap(copy);
+    testOk1(copy.empty());
+    testOk1(empty.mightContain("ioc:a"));
+}
+
+} // namespace
+
+MAIN(testBloomFilter)
+{
+    testPlan(17);
+    testDiag("Tests for BloomFilter util");
+
+    testEmpty();
+    testMembership();
+    testMaxBytes();
+    testEncoded();
+    return testDone();
+}
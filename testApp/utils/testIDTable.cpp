@@ -0,0 +1,203 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <set>
+#include <vector>
+#include <stdexcept>
+
+#include <pv/idTable.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using epics::pvAccess::IDTable;
+using epics::pvAccess::pvAccessID;
+
+namespace {
+
+void testInsertFind()
+{
+    testDiag("Test testInsertFind()");
+
+    IDTable<int> table;
+    testOk1(table.empty());
+
+    pvAccessID a = table.insert(10);
+    pvAccessID b = table.insert(20);
+    testOk1(a > 0 && b > 0 && a != b);
+    testOk1(table.size() == 2);
+
+    testOk1(table.find(a) && *table.find(a) == 10);
+    testOk1(table.find(b) && *table.find(b) == 20);
+    testOk1(table.find(0) == 0);
+    testOk1(table.find(-1) == 0);
+    testOk1(table.find(a + b) == 0);
+
+    *table.find(a) = 11;
+    testOk1(*table.find(a) == 11);
+}
+
+void testErase()
+{
+    testDiag("Test testErase()");
+
+    IDTable<int> table;
+    pvAccessID a = table.insert(1);
+    testOk1(table.erase(a));
+    testOk1(!table.erase(a));
+    testOk1(table.find(a) == 0);
+    testOk1(table.empty());
+}
+
+void testStaleID()
+{
+    testDiag("Test testStaleID()");
+
+    // no free slots kept, slot is reused immediately
+    IDTable<int> table(20, 0);
+    pvAccessID a = table.insert(1);
+    table.erase(a);
+    pvAccessID b = table.insert(2);
+    testOk1(table.capacity() == 1);
+    testOk1(a != b);
+    testOk1(table.find(a) == 0);
+    testOk1(!table.erase(a));
+    testOk1(table.find(b) && *table.find(b) == 2);
+}
+
+void testReuseSpread()
+{
+    testDiag("Test testReuseSpread()");
+
+    const std::size_t minFree = 8;
+    IDTable<int> table(20, minFree);
+
+    // one live ID at a time, slots are still reused round-robin
+    std::set<pvAccessID> seen;
+    bool unique = true;
+    for (int i = 0; i < 100; i++)
+    {
+        pvAccessID id = table.insert(i);
+        unique = unique && seen.insert(id).second;
+        table.erase(id);
+    }
+    testOk1(unique);
+    testOk1(table.capacity() == minFree + 1);
+}
+
+void testReuseDistance()
+{
+    testDiag("Test testReuseDistance()");
+
+    // 26 index bits leave 5 bits of generation (1..31),
+    // 5 slots are used round-robin, so an ID repeats after 5 * 31 IDs
+    IDTable<int> table(26, 4);
+    std::set<pvAccessID> seen;
+    int repeated = -1;
+    for (int i = 0; i < 1000 && repeated < 0; i++)
+    {
+        pvAccessID id = table.insert(i);
+        if (!seen.insert(id).second)
+            repeated = i;
+        table.erase(id);
+    }
+    testOk(repeated == 5 * 31, "first repeated ID at %d", repeated);
+
+    // defaults, well over 2^17 IDs without a repeat
+    IDTable<int> defaultTable;
+    seen.clear();
+    bool unique = true;
+    for (int i = 0; i < 200000; i++)
+    {
+        pvAccessID id = defaultTable.insert(i);
+        unique = unique && seen.insert(id).second;
+        defaultTable.erase(id);
+    }
+    testOk1(unique);
+}
+
+void testGenerationWrap()
+{
+    testDiag("Test testGenerationWrap()");
+
+    // 29 index bits leave 2 bits of generation (1..3)
+    IDTable<int> table(29, 0);
+    bool positive = true;
+    pvAccessID first = table.insert(0);
+    table.erase(first);
+    for (int i = 0; i < 2; i++)
+    {
+        pvAccessID id = table.insert(0);
+        positive = positive && id > 0;
+        table.erase(id);
+    }
+    pvAccessID wrapped = table.insert(0);
+    testOk1(positive && wrapped > 0);
+    testOk1(wrapped == first);
+}
+
+void testFull()
+{
+    testDiag("Test testFull()");
+
+    IDTable<int> table(2, 0);
+    std::vector<pvAccessID> ids;
+    for (int i = 0; i < 4; i++)
+        ids.push_back(table.insert(i));
+
+    bool thrown = false;
+    try {
+        table.insert(4);
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    testOk1(thrown);
+
+    // free slot is reused even if less than minFree are free
+    table.erase(ids[1]);
+    pvAccessID id = table.insert(5);
+    testOk1(table.find(id) && *table.find(id) == 5);
+    testOk1(table.capacity() == 4);
+}
+
+void testValuesClear()
+{
+    testDiag("Test testValuesClear()");
+
+    IDTable<int> table;
+    std::vector<pvAccessID> ids;
+    for (int i = 0; i < 100; i++)
+        ids.push_back(table.insert(i));
+    for (int i = 0; i < 100; i += 2)
+        table.erase(ids[i]);
+
+    std::vector<int> values;
+    table.values(values);
+    bool odd = values.size() == 50;
+    for (std::size_t i = 0; i < values.size(); i++)
+        odd = odd && (values[i] % 2) == 1;
+    testOk1(odd);
+
+    table.clear();
+    testOk1(table.empty());
+    testOk1(table.find(ids[1]) == 0);
+}
+
+} // namespace
+
+MAIN(testIDTable)
+{
+    testPlan(30);
+    testInsertFind();
+    testErase();
+    testStaleID();
+    testReuseSpread();
+    testReuseDistance();
+    testGenerationWrap();
+    testFull();
+    testValuesClear();
+    return testDone();
+}
@@ -0,0 +1,199 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * Compares IDTable with the std::map based ID tables it replaces
+ * (lookup, and allocate/release churn) with many live IDs.
+ * Manual benchmark, no reference numbers are kept; measure both schemes
+ * on the target host with an optimized build, e.g.
+ *   testIDTablePerformance -l 100000 -n 10000000
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <vector>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/lock.h>
+#include <pv/sharedPtr.h>
+#include <pv/idTable.h>
+
+using namespace std;
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+#define DEFAULT_LIVE 100000
+#define DEFAULT_OPERATIONS 10000000
+
+namespace {
+
+typedef std::tr1::weak_ptr<int> value_t;
+
+/**
+ * ID table as used by the client and server contexts before IDTable:
+ * a map, and a linear search for the next free ID.
+ */
+class MapTable
+{
+public:
+    MapTable() : m_last(0) {}
+
+    pvAccessID insert(value_t const & value)
+    {
+        Lock guard(m_mutex);
+        while (m_map.find(++m_last) != m_map.end()) ;
+        m_map[m_last] = value;
+        return m_last;
+    }
+
+    bool find(pvAccessID id)
+    {
+        Lock guard(m_mutex);
+        map_t::iterator it = m_map.find(id);
+        return it != m_map.end() && !it->second.expired();
+    }
+
+    void erase(pvAccessID id)
+    {
+        Lock guard(m_mutex);
+        m_map.erase(id);
+    }
+
+private:
+    typedef std::map<pvAccessID, value_t> map_t;
+    map_t m_map;
+    pvAccessID m_last;
+    Mutex m_mutex;
+};
+
+class SlabTable
+{
+public:
+    // as the client context tables, the default allows only 64k live IDs
+    SlabTable() : m_table(20, 16384) {}
+
+    pvAccessID insert(value_t const & value)
+    {
+        Lock guard(m_mutex);
+        return m_table.insert(value);
+    }
+
+    bool find(pvAccessID id)
+    {
+        Lock guard(m_mutex);
+        value_t* value = m_table.find(id);
+        return value && !value->expired();
+    }
+
+    void erase(pvAccessID id)
+    {
+        Lock guard(m_mutex);
+        m_table.erase(id);
+    }
+
+private:
+    IDTable<value_t> m_table;
+    Mutex m_mutex;
+};
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testIDTablePerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -l <count>:        number of live IDs, default is '%d'\n"
+             "  -n <count>:        number of operations per test, default is '%d'\n\n"
+             , DEFAULT_LIVE, DEFAULT_OPERATIONS);
+}
+
+template<typename Table>
+void run(const char* name, int live, int operations)
+{
+    std::tr1::shared_ptr<int> object(new int(0));
+    Table table;
+    vector<pvAccessID> ids(live);
+
+    epicsTime start(epicsTime::getCurrent());
+    for (int i = 0; i < live; i++)
+        ids[i] = table.insert(object);
+    epicsTime end(epicsTime::getCurrent());
+    double fill = end - start;
+
+    // random access pattern, as responses arrive for arbitrary requests
+    vector<int> order(operations < live ? operations : live);
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = rand() % live;
+
+    int found = 0;
+    start = epicsTime::getCurrent();
+    for (int i = 0; i < operations; i++)
+        if (table.find(ids[order[i % order.size()]]))
+            found++;
+    end = epicsTime::getCurrent();
+    double lookup = end - start;
+
+    // request completes, new request is issued
+    start = epicsTime::getCurrent();
+    for (int i = 0; i < operations; i++)
+    {
+        pvAccessID& id = ids[order[i % order.size()]];
+        table.erase(id);
+        id = table.insert(object);
+    }
+    end = epicsTime::getCurrent();
+    double churn = end - start;
+
+    printf("%-8s fill: %8.1f ns/op  lookup: %8.1f ns/op  erase+insert: %8.1f ns/op  (%d found)\n",
+           name, fill * 1e9 / live, lookup * 1e9 / operations, churn * 1e9 / operations, found);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int opt;
+    int live = DEFAULT_LIVE;
+    int operations = DEFAULT_OPERATIONS;
+
+    while ((opt = getopt(argc, argv, ":hl:n:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'l':
+            live = atoi(optarg);
+            break;
+        case 'n':
+            operations = atoi(optarg);
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'. ('testIDTablePerformance -h' for help.)\n", optopt);
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument. ('testIDTablePerformance -h' for help.)\n", optopt);
+            return 1;
+        default :
+            usage();
+            return 1;
+        }
+    }
+
+    if (live <= 0 || operations <= 0)
+    {
+        usage();
+        return 1;
+    }
+
+    printf("%d live IDs, %d operations\n", live, operations);
+    run<MapTable>("map", live, operations);
+    run<SlabTable>("IDTable", live, operations);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <epicsThread.h>
+
+#include <pv/thread.h>
+#include <pv/spscRing.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using namespace epics::pvData;
+using epics::pvAccess::SPSCRing;
+
+namespace {
+
+void testBasic()
+{
+    testDiag("Test testBasic()");
+
+    SPSCRing<int> ring(3);
+    testOk(ring.capacity() == 4, "capacity %u", unsigned(ring.capacity()));
+    testOk1(ring.empty());
+
+    int value = -1;
+    testOk1(!ring.pop(value) && value == -1);
+
+    // wrap around a few times
+    bool ok = true;
+    for (int n = 0; n < 10; n++)
+    {
+        for (int i = 0; i < 4; i++)
+            ok = ok && ring.push(n * 4 + i);
+        ok = ok && !ring.push(-1) && ring.size() == 4;
+        for (int i = 0; i < 4; i++)
+            ok = ok && ring.pop(value) && value == n * 4 + i;
+        ok = ok && ring.empty();
+    }
+    testOk1(ok);
+}
+
+class Consumer
+{
+public:
+    Consumer(SPSCRing<int>& ring, int count) :
+        ring(ring), count(count), ordered(true),
+        thread(Thread::Config(this, &Consumer::run).name("testSPSCRing consumer").autostart(false))
+    {
+        thread.start();
+    }
+
+    void run()
+    {
+        int next = 0;
+        while (next < count)
+        {
+            int value;
+            if (!ring.pop(value))
+            {
+                epicsThreadSleep(0.0);
+                continue;
+            }
+            if (value != next)
+                ordered = false;
+            next++;
+        }
+    }
+
+    SPSCRing<int>& ring;
+    const int count;
+    bool ordered;
+    Thread thread;
+};
+
+void testThreads()
+{
+    testDiag("Test testThreads()");
+
+    const int count = 1000000;
+    SPSCRing<int> ring(64);
+    Consumer consumer(ring, count);
+
+    for (int i = 0; i < count; i++)
+        while (!ring.push(i))
+            epicsThreadSleep(0.0);
+
+    consumer.thread.exitWait();
+    testOk1(consumer.ordered);
+    testOk1(ring.empty());
+}
+
+} // namespace
+
+MAIN(testSPSCRing)
+{
+    testPlan(6);
+    testBasic();
+    testThreads();
+    return testDone();
+}
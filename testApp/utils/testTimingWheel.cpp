@@ -0,0 +1,240 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include <pv/timingWheel.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using namespace epics::pvData;
+using epics::pvAccess::TimingWheelBase;
+using epics::pvAccess::TimingWheel;
+
+namespace {
+
+typedef TimingWheelBase::Entry Entry;
+
+// expires exactly at the deadline, not before
+bool expiresAt(TimingWheelBase& wheel, Entry& entry, uint64 deadline)
+{
+    std::vector<Entry*> expired;
+    wheel.advance(deadline - 1, expired);
+    if (!expired.empty() || !entry.linked())
+        return false;
+    wheel.advance(deadline, expired);
+    return expired.size() == 1 && expired[0] == &entry && !entry.linked();
+}
+
+void testLevels()
+{
+    testDiag("Test testLevels()");
+
+    const uint64 deltas[] = { 1, 255, 256, 257, 65535, 65536, 70000, (1u << 24) + 5, 0xFFFFFFFFull, 0x100000010ull };
+    const size_t count = sizeof(deltas)/sizeof(deltas[0]);
+
+    TimingWheelBase wheel;
+    for (size_t i = 0; i < count; i++)
+    {
+        Entry entry;
+        const uint64 deadline = wheel.current() + deltas[i];
+        wheel.add(entry, deadline);
+        testOk(expiresAt(wheel, entry, deadline), "delta %llu", (unsigned long long)deltas[i]);
+    }
+    testOk1(wheel.size() == 0);
+}
+
+void testPast()
+{
+    testDiag("Test testPast()");
+
+    TimingWheelBase wheel;
+    std::vector<Entry*> expired;
+    wheel.advance(1000, expired);
+
+    Entry entry;
+    wheel.add(entry, 10);
+    testOk1(entry.deadline() == 1001);
+    testOk1(expiresAt(wheel, entry, 1001));
+}
+
+void testRemove()
+{
+    testDiag("Test testRemove()");
+
+    TimingWheelBase wheel;
+    Entry a, b;
+    wheel.add(a, 100);
+    wheel.add(b, 100000);
+    testOk1(wheel.size() == 2);
+
+    testOk1(wheel.remove(b));
+    testOk1(!wheel.remove(b));
+    testOk1(wheel.size() == 1);
+
+    std::vector<Entry*> expired;
+    wheel.advance(200000, expired);
+    testOk1(expired.size() == 1 && expired[0] == &a);
+    testOk1(wheel.size() == 0);
+}
+
+void testNextTick()
+{
+    testDiag("Test testNextTick()");
+
+    TimingWheelBase wheel;
+    uint64 tick;
+    testOk1(!wheel.nextTick(tick));
+
+    Entry a, b;
+    wheel.add(a, 100);
+    testOk1(wheel.nextTick(tick) && tick == 100);
+
+    // cascade of the level 1 slot comes first
+    wheel.remove(a);
+    wheel.add(b, 1000);
+    testOk1(wheel.nextTick(tick) && tick == 768);
+    wheel.remove(b);
+}
+
+void testRandom()
+{
+    testDiag("Test testRandom()");
+
+    const size_t count = 10000;
+    Entry* entries = new Entry[count];
+    std::vector<uint64> deadlines(count);
+
+    TimingWheelBase wheel;
+    for (size_t i = 0; i < count; i++)
+    {
+        deadlines[i] = 1 + (uint64)rand() % (1u << 20);
+        wheel.add(entries[i], deadlines[i]);
+    }
+    testOk1(wheel.size() == count);
+
+    bool ok = true;
+    size_t fired = 0;
+    uint64 previous = 0;
+    std::vector<Entry*> expired;
+    while (wheel.size())
+    {
+        const uint64 now = previous + 1 + rand() % 5000;
+        expired.clear();
+        wheel.advance(now, expired);
+        for (size_t i = 0; i < expired.size(); i++)
+        {
+            const size_t n = expired[i] - &entries[0];
+            ok = ok && deadlines[n] > previous && deadlines[n] <= now;
+            // in order
+            ok = ok && (i == 0 || expired[i-1]->deadline() <= expired[i]->deadline());
+        }
+        fired += expired.size();
+        previous = now;
+    }
+    testOk1(ok);
+    testOk1(fired == count);
+    delete[] entries;
+}
+
+void testClear()
+{
+    testDiag("Test testClear()");
+
+    TimingWheelBase wheel;
+    Entry a, b;
+    wheel.add(a, 10);
+    wheel.add(b, 1u << 30);
+
+    std::vector<Entry*> removed;
+    wheel.clear(removed);
+    testOk1(removed.size() == 2);
+    testOk1(wheel.size() == 0 && !a.linked() && !b.linked());
+}
+
+class Counter : public TimerCallback
+{
+public:
+    POINTER_DEFINITIONS(Counter);
+    Counter() : count(0), stopped(false) {}
+    virtual void callback() {
+        {
+            Lock guard(mutex);
+            count++;
+        }
+        event.signal();
+    }
+    virtual void timerStopped() {
+        Lock guard(mutex);
+        stopped = true;
+    }
+    int getCount() {
+        Lock guard(mutex);
+        return count;
+    }
+    bool isStopped() {
+        Lock guard(mutex);
+        return stopped;
+    }
+
+    TimingWheel::Entry entry;
+    Event event;
+private:
+    Mutex mutex;
+    int count;
+    bool stopped;
+};
+
+void testTimingWheel()
+{
+    testDiag("Test testTimingWheel()");
+
+    TimingWheel::shared_pointer wheel(new TimingWheel("testTimingWheel", epicsThreadPriorityMedium));
+
+    Counter::shared_pointer once(new Counter());
+    wheel->schedule(once->entry, once, 0.05);
+    testOk1(wheel->isScheduled(once->entry));
+    testOk1(once->event.wait(5.0));
+    testOk1(once->getCount() == 1);
+    testOk1(!wheel->isScheduled(once->entry));
+
+    Counter::shared_pointer periodic(new Counter());
+    wheel->schedule(periodic->entry, periodic, 0.02, 0.02);
+    for (int i = 0; i < 3; i++)
+        periodic->event.wait(5.0);
+    testOk1(periodic->getCount() >= 3);
+    testOk1(wheel->cancel(periodic->entry));
+    testOk1(!wheel->cancel(periodic->entry));
+
+    Counter::shared_pointer later(new Counter());
+    wheel->schedule(later->entry, later, 100.0);
+    testOk1(wheel->size() == 1);
+    wheel->close();
+    testOk1(later->isStopped() && later->getCount() == 0);
+
+    // scheduling on a closed wheel stops immediately
+    Counter::shared_pointer closed(new Counter());
+    wheel->schedule(closed->entry, closed, 0.0);
+    testOk1(closed->isStopped());
+}
+
+} // namespace
+
+MAIN(testTimingWheel)
+{
+    testPlan(37);
+    testLevels();
+    testPast();
+    testRemove();
+    testNextTick();
+    testRandom();
+    testClear();
+    testTimingWheel();
+    return testDone();
+}
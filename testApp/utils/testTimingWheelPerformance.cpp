@@ -0,0 +1,189 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/*
+ * Compares the cost of scheduling and cancelling many timers
+ * with TimingWheel and epics::pvData::Timer, and measures
+ * how long TimingWheel takes to fire many timers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include <epicsGetopt.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/timer.h>
+#include <pv/timingWheel.h>
+
+using namespace std;
+using namespace epics::pvData;
+using namespace epics::pvAccess;
+
+#define DEFAULT_MAX_TIMERS 1000000
+#define DEFAULT_MAX_PVDATA_TIMERS 100000
+
+namespace {
+
+class Callback : public TimerCallback
+{
+public:
+    POINTER_DEFINITIONS(Callback);
+
+    Callback(Mutex& mutex, Event& done, size_t& pending) :
+        m_mutex(mutex), m_done(done), m_pending(pending) {}
+
+    virtual void callback()
+    {
+        Lock guard(m_mutex);
+        if (--m_pending == 0)
+            m_done.signal();
+    }
+
+    virtual void timerStopped() {}
+
+    TimingWheel::Entry entry;
+
+private:
+    Mutex& m_mutex;
+    Event& m_done;
+    size_t& m_pending;
+};
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testTimingWheelPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -n <count>:        maximum number of timers, default is '%d'\n"
+             "  -m <count>:        maximum number of timers for pvData Timer, default is '%d'\n\n"
+             , DEFAULT_MAX_TIMERS, DEFAULT_MAX_PVDATA_TIMERS);
+}
+
+// timers far in the future, as heartbeats and timeouts mostly are
+double randomDelay()
+{
+    return 100.0 + (rand() % 100000) / 1000.0;
+}
+
+void runTimingWheel(vector<Callback::shared_pointer>& callbacks)
+{
+    TimingWheel wheel("benchmark wheel", epicsThreadPriorityMedium);
+    const size_t count = callbacks.size();
+
+    epicsTime start(epicsTime::getCurrent());
+    for (size_t i = 0; i < count; i++)
+        wheel.schedule(callbacks[i]->entry, callbacks[i], randomDelay());
+    epicsTime end(epicsTime::getCurrent());
+    double schedule = end - start;
+
+    start = epicsTime::getCurrent();
+    for (size_t i = 0; i < count; i++)
+        wheel.cancel(callbacks[i]->entry);
+    end = epicsTime::getCurrent();
+    double cancel = end - start;
+
+    printf("%8u timers  TimingWheel   schedule: %8.1f ns  cancel: %8.1f ns\n",
+           (unsigned)count, schedule * 1e9 / count, cancel * 1e9 / count);
+}
+
+void runTimer(vector<Callback::shared_pointer>& callbacks)
+{
+    Timer timer("benchmark timer", lowPriority);
+    const size_t count = callbacks.size();
+
+    epicsTime start(epicsTime::getCurrent());
+    for (size_t i = 0; i < count; i++)
+        timer.scheduleAfterDelay(callbacks[i], randomDelay());
+    epicsTime end(epicsTime::getCurrent());
+    double schedule = end - start;
+
+    start = epicsTime::getCurrent();
+    for (size_t i = 0; i < count; i++)
+        timer.cancel(callbacks[i]);
+    end = epicsTime::getCurrent();
+    double cancel = end - start;
+
+    printf("%8u timers  pvData Timer  schedule: %8.1f ns  cancel: %8.1f ns\n",
+           (unsigned)count, schedule * 1e9 / count, cancel * 1e9 / count);
+}
+
+void runExpire(vector<Callback::shared_pointer>& callbacks, Mutex& mutex, Event& done, size_t& pending)
+{
+    TimingWheel wheel("benchmark wheel", epicsThreadPriorityMedium);
+    const size_t count = callbacks.size();
+    const double spread = 1.0;
+
+    {
+        Lock guard(mutex);
+        pending = count;
+    }
+
+    epicsTime start(epicsTime::getCurrent());
+    for (size_t i = 0; i < count; i++)
+        wheel.schedule(callbacks[i]->entry, callbacks[i], (rand() % 1000) * spread / 1000);
+    bool ok = done.wait(60.0);
+    epicsTime end(epicsTime::getCurrent());
+
+    printf("%8u timers  TimingWheel   fired within %.1f s in: %.3f s%s\n",
+           (unsigned)count, spread, end - start, ok ? "" : " (timed out)");
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int opt;
+    size_t maxTimers = DEFAULT_MAX_TIMERS;
+    size_t maxPVDataTimers = DEFAULT_MAX_PVDATA_TIMERS;
+
+    while ((opt = getopt(argc, argv, ":hn:m:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'n':
+            maxTimers = atoi(optarg);
+            break;
+        case 'm':
+            maxPVDataTimers = atoi(optarg);
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'. ('testTimingWheelPerformance -h' for help.)\n", optopt);
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument. ('testTimingWheelPerformance -h' for help.)\n", optopt);
+            return 1;
+        default :
+            usage();
+            return 1;
+        }
+    }
+
+    Mutex mutex;
+    Event done;
+    size_t pending = 0;
+
+    for (size_t count = 1000; count <= maxTimers; count *= 10)
+    {
+        vector<Callback::shared_pointer> callbacks;
+        callbacks.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            callbacks.push_back(Callback::shared_pointer(new Callback(mutex, done, pending)));
+
+        runTimingWheel(callbacks);
+        if (count <= maxPVDataTimers)
+            runTimer(callbacks);
+        runExpire(callbacks, mutex, done, pending);
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <pv/tokenBucket.h>
+
+#include <epicsThread.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using epics::pvAccess::TokenBucket;
+
+namespace {
+
+void testUnlimited()
+{
+    testDiag("Test testUnlimited()");
+
+    TokenBucket bucket;
+    testOk1(bucket.unlimited());
+
+    bool all = true;
+    for (int i = 0; i < 1000; i++)
+        all = all && bucket.tryAcquire(0.0);
+    testOk1(all);
+    testOk1(bucket.delay(0.0) == 0.0);
+}
+
+void testRate()
+{
+    testDiag("Test testRate()");
+
+    // 10 per second, burst of 5
+    TokenBucket bucket(10.0, 5.0);
+    testOk1(!bucket.unlimited());
+    testOk1(bucket.full(100.0));
+
+    int acquired = 0;
+    while (bucket.tryAcquire(100.0))
+        acquired++;
+    testOk(acquired == 5, "burst %d", acquired);
+    testOk1(!bucket.full(100.0));
+
+    double delay = bucket.delay(100.0);
+    testOk(delay > 0.09 && delay < 0.11, "delay %f", delay);
+
+    testOk1(!bucket.tryAcquire(100.05));
+    testOk1(bucket.tryAcquire(100.2));
+
+    // clock going backwards does not add tokens...
+    while (bucket.tryAcquire(100.2)) {}
+    testOk1(!bucket.tryAcquire(99.0));
+    // ... nor does it stop refilling
+    testOk1(!bucket.tryAcquire(99.05));
+    testOk1(bucket.tryAcquire(99.1));
+
+    // refill does not exceed the burst
+    acquired = 0;
+    while (bucket.tryAcquire(1000.0))
+        acquired++;
+    testOk(acquired == 5, "refilled burst %d", acquired);
+}
+
+void testMinBurst()
+{
+    testDiag("Test testMinBurst()");
+
+    TokenBucket bucket(0.5, 0.0);
+    testOk1(bucket.tryAcquire(0.0));
+    testOk1(!bucket.tryAcquire(1.0));
+    testOk1(bucket.tryAcquire(2.0));
+}
+
+void testNow()
+{
+    testDiag("Test testNow()");
+
+    double start = TokenBucket::now();
+    testOk1(TokenBucket::now() >= start);
+
+    epicsThreadSleep(0.1);
+    double elapsed = TokenBucket::now() - start;
+    testOk(elapsed >= 0.09 && elapsed < 10.0, "elapsed %f", elapsed);
+}
+
+} // namespace
+
+MAIN(testTokenBucket)
+{
+    testPlan(19);
+    testDiag("Tests for TokenBucket util");
+
+    testUnlimited();
+    testRate();
+    testMinBurst();
+    testNow();
+    return testDone();
+}
@@ -4,12 +4,16 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <string>
+#include <vector>
+
 #include <pv/wildcard.h>
 
 #include <epicsUnitTest.h>
 #include <testMain.h>
 
 using epics::pvAccess::Wildcard;
+using epics::pvAccess::WildcardMatcher;
 
 static
 void testWildcardCases()
@@ -43,11 +47,110 @@ void testWildcardCases()
     //testOk1(Wildcard::wildcardfit("**?*x*[abh-]*Q", "XYZxabbauuZQ"));
 }
 
+static
+int firstFit(std::vector<std::string> const & patterns, const char* test)
+{
+    for (size_t i = 0; i < patterns.size(); i++)
+        if (Wildcard::wildcardfit(patterns[i].c_str(), test))
+            return int(i);
+    return -1;
+}
+
+static
+void testMatcher()
+{
+    testDiag("Test testMatcher()");
+
+    static const char* patterns[] = {
+        "pv:*:set", "pv:?:get", "pv:a*", "*zz", "?*?", "x**y?", "*.*", "ab?d*", "*", ""
+    };
+    static const char* tests[] = {
+        "", "a", "zz", "pv:a:set", "pv:b:get", "pv:bb:get", "pv:abc", "xy", "xyz", "xaaayz",
+        "command.com", "/var/etc", "abcd", "abxdefg", "pv:", "pv:1:setpoint", "x*y?"
+    };
+    const size_t npatterns = sizeof(patterns)/sizeof(patterns[0]);
+    const size_t ntests = sizeof(tests)/sizeof(tests[0]);
+
+    // every prefix of the pattern list, so that each pattern is the first match for some test
+    bool same = true;
+    for (size_t n = 0; n <= npatterns; n++)
+    {
+        std::vector<std::string> list(patterns, patterns + n);
+        WildcardMatcher matcher;
+        for (size_t i = 0; i < n; i++)
+            matcher.add(list[i]);
+        for (size_t t = 0; t < ntests; t++)
+        {
+            const int expected = firstFit(list, tests[t]);
+            const int actual = matcher.match(tests[t]);
+            if (expected != actual)
+            {
+                testDiag("%u patterns, '%s': expected %d, got %d", unsigned(n), tests[t], expected, actual);
+                same = false;
+            }
+        }
+    }
+    testOk(same, "same first match as Wildcard::wildcardfit()");
+
+    // first registered pattern wins
+    WildcardMatcher matcher;
+    matcher.add("pv:*");
+    matcher.add("pv:a*");
+    testOk1(matcher.match("pv:abc") == 0);
+    matcher.remove(0);
+    testOk1(matcher.match("pv:abc") == 0 && matcher.match("pv:xyz") == -1);
+    matcher.clear();
+    testOk1(matcher.match("pv:abc") == -1);
+}
+
+static
+void testMatcherManyPatterns()
+{
+    testDiag("Test testMatcherManyPatterns()");
+
+    // many overlapping patterns, checked against a linear scan
+    std::vector<std::string> patterns;
+    for (int i = 0; i < 200; i++)
+    {
+        std::string pattern("*");
+        pattern += char('a' + i % 7);
+        pattern += '*';
+        pattern += char('a' + (i * 3) % 11);
+        if (i % 2)
+            pattern += '?';
+        pattern += char('a' + (i * 5) % 13);
+        patterns.push_back(pattern);
+    }
+
+    WildcardMatcher matcher;
+    for (size_t i = 0; i < patterns.size(); i++)
+        matcher.add(patterns[i]);
+
+    bool same = true;
+    unsigned seed = 1;
+    for (int t = 0; t < 2000; t++)
+    {
+        std::string test;
+        const int length = t % 24;
+        for (int i = 0; i < length; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            test += char('a' + (seed >> 16) % 14);
+        }
+        if (matcher.match(test.c_str()) != firstFit(patterns, test.c_str()))
+            same = false;
+    }
+    testDiag("%u automaton states", unsigned(matcher.getStateCount()));
+    testOk1(same);
+}
+
 MAIN(testWildcard)
 {
-    testPlan(12);
+    testPlan(17);
     testDiag("Tests for Wildcard util");
 
     testWildcardCases();
+    testMatcher();
+    testMatcherManyPatterns();
     return testDone();
 }
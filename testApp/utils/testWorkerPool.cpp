@@ -0,0 +1,240 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <epicsThread.h>
+
+#include <pv/workerPool.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using namespace epics::pvData;
+using epics::pvAccess::WorkerPool;
+
+namespace {
+
+/**
+ * Checks the order of the tasks of a key, and that they never overlap.
+ */
+class Sequence
+{
+public:
+    Sequence() : next(0), running(0), ordered(true), overlapped(false) {}
+
+    void enter(int n)
+    {
+        Lock guard(mutex);
+        if (n != next)
+            ordered = false;
+        next = n + 1;
+        if (running++)
+            overlapped = true;
+    }
+
+    void leave()
+    {
+        Lock guard(mutex);
+        running--;
+    }
+
+    Mutex mutex;
+    int next;
+    int running;
+    bool ordered;
+    bool overlapped;
+};
+
+/**
+ * Counts tasks running at the same time over all keys.
+ */
+class Concurrency
+{
+public:
+    Concurrency() : running(0), maxRunning(0) {}
+
+    void enter()
+    {
+        Lock guard(mutex);
+        if (++running > maxRunning)
+            maxRunning = running;
+    }
+
+    void leave()
+    {
+        Lock guard(mutex);
+        running--;
+    }
+
+    Mutex mutex;
+    int running;
+    int maxRunning;
+};
+
+class SequenceTask : public WorkerPool::Task
+{
+public:
+    SequenceTask(Sequence& sequence, Concurrency& concurrency, int n, double sleep) :
+        m_sequence(sequence), m_concurrency(concurrency), m_n(n), m_sleep(sleep) {}
+
+    virtual void run()
+    {
+        m_sequence.enter(m_n);
+        m_concurrency.enter();
+        if (m_sleep > 0.0)
+            epicsThreadSleep(m_sleep);
+        m_concurrency.leave();
+        m_sequence.leave();
+    }
+
+private:
+    Sequence& m_sequence;
+    Concurrency& m_concurrency;
+    const int m_n;
+    const double m_sleep;
+};
+
+class BlockingTask : public WorkerPool::Task
+{
+public:
+    virtual void run()
+    {
+        started.signal();
+        release.wait();
+    }
+
+    Event started;
+    Event release;
+};
+
+class NopTask : public WorkerPool::Task
+{
+public:
+    virtual void run() {}
+};
+
+void testOrdering()
+{
+    testDiag("Test testOrdering()");
+
+    const int keys = 4;
+    const int tasks = 1000;
+
+    Sequence sequences[keys];
+    Concurrency concurrency;
+    {
+        WorkerPool pool("testOrdering", 4, 64, epicsThreadPriorityMedium);
+        for (int n = 0; n < tasks; n++)
+            for (int k = 0; k < keys; k++)
+                pool.submit(&sequences[k],
+                            WorkerPool::Task::shared_pointer(new SequenceTask(sequences[k], concurrency, n, 0.0)));
+        pool.close();
+
+        WorkerPool::Stats stats;
+        pool.getStats(stats);
+        testOk(stats.executed == unsigned(keys * tasks), "executed %u", unsigned(stats.executed));
+        testOk1(stats.queued == 0 && stats.maxQueued <= 64);
+    }
+
+    bool ordered = true, overlapped = false;
+    for (int k = 0; k < keys; k++)
+    {
+        ordered = ordered && sequences[k].ordered && sequences[k].next == tasks;
+        overlapped = overlapped || sequences[k].overlapped;
+    }
+    testOk1(ordered);
+    testOk1(!overlapped);
+}
+
+void testParallel()
+{
+    testDiag("Test testParallel()");
+
+    const int keys = 4;
+    Sequence sequences[keys];
+    Concurrency concurrency;
+
+    WorkerPool pool("testParallel", keys, 16, epicsThreadPriorityMedium);
+    for (int k = 0; k < keys; k++)
+        pool.submit(&sequences[k],
+                    WorkerPool::Task::shared_pointer(new SequenceTask(sequences[k], concurrency, 0, 0.2)));
+    pool.close();
+
+    // different keys run at the same time
+    testOk(concurrency.maxRunning > 1, "max. concurrency %d", concurrency.maxRunning);
+
+    WorkerPool::Stats stats;
+    pool.getStats(stats);
+    testOk1(stats.maxRunTime >= 0.19);
+}
+
+class Submitter
+{
+public:
+    Submitter(WorkerPool& pool) :
+        pool(pool), result(false),
+        thread(Thread::Config(this, &Submitter::run).name("testBounded submitter").autostart(false))
+    {
+        thread.start();
+    }
+
+    void run()
+    {
+        result = pool.submit(this, WorkerPool::Task::shared_pointer(new NopTask()));
+        done.signal();
+    }
+
+    WorkerPool& pool;
+    bool result;
+    Event done;
+    Thread thread;
+};
+
+void testBounded()
+{
+    testDiag("Test testBounded()");
+
+    WorkerPool pool("testBounded", 1, 2, epicsThreadPriorityMedium);
+
+    std::tr1::shared_ptr<BlockingTask> blocking(new BlockingTask());
+    testOk1(pool.submit(0, blocking));
+    testOk1(blocking->started.wait(5.0));
+
+    // fill the queue
+    testOk1(pool.submit(0, WorkerPool::Task::shared_pointer(new NopTask())));
+    testOk1(pool.submit(0, WorkerPool::Task::shared_pointer(new NopTask())));
+    // does not wait for a free slot
+    testOk1(!pool.trySubmit(0, WorkerPool::Task::shared_pointer(new NopTask())));
+
+    Submitter submitter(pool);
+    testOk1(!submitter.done.wait(0.2));
+
+    WorkerPool::Stats stats;
+    pool.getStats(stats);
+    testOk1(stats.queued == 2 && stats.blocked == 1);
+
+    blocking->release.signal();
+    testOk1(submitter.done.wait(5.0) && submitter.result);
+    submitter.thread.exitWait();
+
+    pool.close();
+    pool.getStats(stats);
+    testOk1(stats.executed == 4);
+
+    // closed
+    testOk1(!pool.submit(0, WorkerPool::Task::shared_pointer(new NopTask())));
+    testOk1(!pool.trySubmit(0, WorkerPool::Task::shared_pointer(new NopTask())));
+}
+
+} // namespace
+
+MAIN(testWorkerPool)
+{
+    testPlan(17);
+    testOrdering();
+    testParallel();
+    testBounded();
+    return testDone();
+}